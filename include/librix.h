@@ -34,6 +34,14 @@
  *     RIX_TAILQ   -- doubly-linked tail queue
  *     RIX_CIRCLEQ -- circular queue
  *
+ *   Ring (rix/rix_ring.h)
+ *     rix_ring    -- bounded lock-free ring of u32 indices,
+ *                    SPSC / MPMC, bulk and burst enqueue/dequeue
+ *
+ *   Free list (rix/rix_freelist.h)
+ *     RIX_FREELIST -- lock-free tagged Treiber stack over an index pool,
+ *                     per-thread magazines for batched alloc/free
+ *
  *   Tree (rix/rix_tree.h)
  *     RIX_RB      -- red-black tree
  *
@@ -73,6 +81,8 @@
  */
 
 #  include <rix/rix_queue.h>
+#  include <rix/rix_ring.h>
+#  include <rix/rix_freelist.h>
 #  include <rix/rix_tree.h>
 #  include <rix/rix_hash.h>
 
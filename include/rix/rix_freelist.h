@@ -0,0 +1,271 @@
+/*-
+ * SPDX-License-Identifier: BSD 3-Clause License
+ *
+ * Copyright (c) 2026 deadcafe.beef@gmail.com
+ * All rights reserved.
+ */
+
+/*
+ * rix_freelist.h - lock-free free list (Treiber stack) over an index pool.
+ *
+ * Lets several threads or processes allocate from and free to one shared
+ * element pool instead of statically partitioning the pool per core.
+ *
+ * The head is one 64-bit word updated by CAS:
+ *
+ *   bits  0..31   index of the top element (1-origin, RIX_NIL = empty)
+ *   bits 32..63   generation tag, incremented by every successful update
+ *
+ * The tag defeats ABA: a pop that read top A and next B cannot succeed
+ * after A was popped, reused, and pushed again, because the tag moved.
+ * (A stall across exactly 2^32 updates would still alias; not a concern
+ * in practice.)  The link is an unsigned index field inside the element,
+ * so the list stays pointer-free and valid in shared memory mapped at
+ * different addresses by 32-bit and 64-bit processes.
+ *
+ * Every operation on the head costs one contended CAS, so hot paths
+ * should go through a per-thread magazine: a small private array of
+ * indices refilled from, and flushed to, the shared list in batches of
+ * RIX_FREELIST_MAG_BATCH with a single CAS each.
+ *
+ * Generated functions (RIX_FREELIST_GENERATE(name, type, link_field)):
+ *
+ *   name_init(fl, base, nb)               link base[0..nb-1] as free
+ *   name_pop(fl, base)                    type * or NULL when empty
+ *   name_push(fl, base, elm)
+ *   name_pop_bulk(fl, base, idx, n)       pop up to n, one CAS; count
+ *   name_push_bulk(fl, base, idx, n)      push n, one CAS
+ *   name_mag_alloc(fl, mag, base)         pop via magazine
+ *   name_mag_free(fl, mag, base, elm)     push via magazine
+ *   name_mag_flush(fl, mag, base)         return all cached to the list
+ *
+ * link_field names an unsigned member of type (e.g. free_link.rsle_next
+ * of an RIX_SLIST_ENTRY); it is only touched while the element is free.
+ * Element memory must stay mapped: a racing pop may read the link of an
+ * element just taken by another thread (its CAS then fails).
+ *
+ * Usage:
+ *
+ *   struct obj { ...; RIX_SLIST_ENTRY(obj) free_link; };
+ *   RIX_FREELIST_GENERATE_STATIC(objfl, struct obj, free_link.rsle_next)
+ *
+ *   static struct rix_freelist_s fl;           // shared
+ *   objfl_init(&fl, pool, NB);
+ *
+ *   struct rix_freelist_mag_s mag = { 0 };     // per thread
+ *   struct obj *o = objfl_mag_alloc(&fl, &mag, pool);
+ *   objfl_mag_free(&fl, &mag, pool, o);
+ *   objfl_mag_flush(&fl, &mag, pool);          // at thread exit
+ */
+
+#ifndef _RIX_FREELIST_H_
+#  define _RIX_FREELIST_H_
+
+#  include "rix_defs_private.h"
+
+#  ifndef RIX_FREELIST_MAG_SIZE
+#    define RIX_FREELIST_MAG_SIZE   64u
+#  endif
+#  define RIX_FREELIST_MAG_BATCH    (RIX_FREELIST_MAG_SIZE / 2u)
+
+RIX_STATIC_ASSERT(RIX_FREELIST_MAG_SIZE >= 2u,
+                  "RIX_FREELIST_MAG_SIZE must be at least 2");
+
+/*===========================================================================
+ * Shared head and per-thread magazine
+ *===========================================================================*/
+struct rix_freelist_s {
+    u64 head;                   /* tag << 32 | top index */
+    u32 _rsv[14];               /* keep the head alone on its line */
+} __attribute__((aligned(64)));
+
+struct rix_freelist_mag_s {
+    u32 nb;                     /* cached indices in idx[0..nb-1] */
+    u32 idx[RIX_FREELIST_MAG_SIZE];
+};
+
+static RIX_FORCE_INLINE u64
+_rix_freelist_pack(u64 old, unsigned top)
+{
+    return (((old >> 32) + 1u) << 32) | (u64)top;
+}
+
+static RIX_FORCE_INLINE unsigned
+_rix_freelist_top(u64 head)
+{
+    return (unsigned)(u32)head;
+}
+
+/* Snapshot: non-zero when the shared list looked empty. */
+static inline int
+rix_freelist_empty(const struct rix_freelist_s *fl)
+{
+    return _rix_freelist_top(__atomic_load_n(&fl->head,
+                                             __ATOMIC_RELAXED)) == RIX_NIL;
+}
+
+/*===========================================================================
+ * Generator
+ *===========================================================================*/
+#  define RIX_FREELIST_GENERATE(name, type, link_field)                       \
+    RIX_FREELIST_GENERATE_INTERNAL(name, type, link_field, )
+
+#  define RIX_FREELIST_GENERATE_STATIC(name, type, link_field)                \
+    RIX_FREELIST_GENERATE_INTERNAL(name, type, link_field, RIX_UNUSED static)
+
+#  define RIX_FREELIST_GENERATE_INTERNAL(name, type, link_field, attr)        \
+static RIX_FORCE_INLINE unsigned                                              \
+name##_link_get(type *base, unsigned idx)                                     \
+{                                                                             \
+    RIX_STATIC_ASSERT(sizeof(base->link_field) == sizeof(u32),                \
+                      "freelist link_field must be 32-bit");                  \
+    return __atomic_load_n(&base[RIX_IDX_TO_OFF0(idx)].link_field,            \
+                           __ATOMIC_RELAXED);                                 \
+}                                                                             \
+                                                                              \
+static RIX_FORCE_INLINE void                                                  \
+name##_link_set(type *base, unsigned idx, unsigned next)                      \
+{                                                                             \
+    __atomic_store_n(&base[RIX_IDX_TO_OFF0(idx)].link_field, next,            \
+                     __ATOMIC_RELAXED);                                       \
+}                                                                             \
+                                                                              \
+/* Link the chain first..last (already linked) on top of the list. */         \
+static RIX_FORCE_INLINE void                                                  \
+name##_push_chain(struct rix_freelist_s *fl, type *base,                      \
+                  unsigned first, unsigned last)                              \
+{                                                                             \
+    u64 old = __atomic_load_n(&fl->head, __ATOMIC_RELAXED);                   \
+                                                                              \
+    do {                                                                      \
+        name##_link_set(base, last, _rix_freelist_top(old));                  \
+    } while (!__atomic_compare_exchange_n(&fl->head, &old,                    \
+                                          _rix_freelist_pack(old, first),     \
+                                          1, __ATOMIC_RELEASE,                \
+                                          __ATOMIC_RELAXED));                 \
+}                                                                             \
+                                                                              \
+/* Single-threaded: the list must not be in use. */                           \
+attr void                                                                     \
+name##_init(struct rix_freelist_s *fl, type *base, unsigned nb)               \
+{                                                                             \
+    for (unsigned i = 1; i <= nb; i++)                                        \
+        name##_link_set(base, i, (i < nb) ? i + 1u : RIX_NIL);                \
+    __atomic_store_n(&fl->head, (u64)(nb ? 1u : RIX_NIL),                     \
+                     __ATOMIC_RELEASE);                                       \
+}                                                                             \
+                                                                              \
+attr void                                                                     \
+name##_push(struct rix_freelist_s *fl, type *base, type *elm)                 \
+{                                                                             \
+    unsigned idx = RIX_IDX_FROM_PTR(base, elm);                               \
+                                                                              \
+    name##_push_chain(fl, base, idx, idx);                                    \
+}                                                                             \
+                                                                              \
+attr type *                                                                   \
+name##_pop(struct rix_freelist_s *fl, type *base)                             \
+{                                                                             \
+    u64 old = __atomic_load_n(&fl->head, __ATOMIC_ACQUIRE);                   \
+    unsigned top;                                                             \
+                                                                              \
+    do {                                                                      \
+        top = _rix_freelist_top(old);                                         \
+        if (top == RIX_NIL)                                                   \
+            return NULL;                                                      \
+    } while (!__atomic_compare_exchange_n(&fl->head, &old,                    \
+                 _rix_freelist_pack(old, name##_link_get(base, top)),         \
+                 1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));                     \
+    return RIX_PTR_FROM_IDX(base, top);                                       \
+}                                                                             \
+                                                                              \
+/* Push idx[0..n-1] with one CAS; idx[0] ends up on top. */                   \
+attr void                                                                     \
+name##_push_bulk(struct rix_freelist_s *fl, type *base,                       \
+                 const u32 *idx, unsigned n)                                  \
+{                                                                             \
+    if (n == 0u)                                                              \
+        return;                                                               \
+    for (unsigned i = 0; i + 1u < n; i++)                                     \
+        name##_link_set(base, idx[i], idx[i + 1u]);                           \
+    name##_push_chain(fl, base, idx[0], idx[n - 1u]);                         \
+}                                                                             \
+                                                                              \
+/* Pop up to n into idx[] with one CAS; returns the count taken. */           \
+attr unsigned                                                                 \
+name##_pop_bulk(struct rix_freelist_s *fl, type *base,                        \
+                u32 *idx, unsigned n)                                         \
+{                                                                             \
+    u64 old = __atomic_load_n(&fl->head, __ATOMIC_ACQUIRE);                   \
+    unsigned k, next;                                                         \
+                                                                              \
+    if (n == 0u)                                                              \
+        return 0u;                                                            \
+    do {                                                                      \
+        /* links read here are only trusted if the tag did not move */        \
+        next = _rix_freelist_top(old);                                        \
+        for (k = 0; k < n && next != RIX_NIL; k++) {                          \
+            idx[k] = next;                                                    \
+            next = name##_link_get(base, next);                               \
+        }                                                                     \
+        if (k == 0u)                                                          \
+            return 0u;                                                        \
+    } while (!__atomic_compare_exchange_n(&fl->head, &old,                    \
+                                          _rix_freelist_pack(old, next),      \
+                                          1, __ATOMIC_ACQUIRE,                \
+                                          __ATOMIC_ACQUIRE));                 \
+    return k;                                                                 \
+}                                                                             \
+                                                                              \
+attr type *                                                                   \
+name##_mag_alloc(struct rix_freelist_s *fl,                                   \
+                 struct rix_freelist_mag_s *mag, type *base)                  \
+{                                                                             \
+    unsigned nb = mag->nb;                                                    \
+                                                                              \
+    if (RIX_UNLIKELY(nb == 0u)) {                                             \
+        u32 tmp[RIX_FREELIST_MAG_BATCH];                                      \
+                                                                              \
+        nb = name##_pop_bulk(fl, base, tmp, RIX_FREELIST_MAG_BATCH);          \
+        if (nb == 0u)                                                         \
+            return NULL;                                                      \
+        /* list top (most recently freed) goes last: handed out first */      \
+        for (unsigned i = 0; i < nb; i++)                                     \
+            mag->idx[i] = tmp[nb - 1u - i];                                   \
+    }                                                                         \
+    mag->nb = --nb;                                                           \
+    return &base[RIX_IDX_TO_OFF0(mag->idx[nb])];                              \
+}                                                                             \
+                                                                              \
+attr void                                                                     \
+name##_mag_free(struct rix_freelist_s *fl,                                    \
+                struct rix_freelist_mag_s *mag, type *base, type *elm)        \
+{                                                                             \
+    if (RIX_UNLIKELY(mag->nb == RIX_FREELIST_MAG_SIZE)) {                     \
+        /* hand the older half back, keep the cache-warm newer half */        \
+        name##_push_bulk(fl, base, mag->idx, RIX_FREELIST_MAG_BATCH);         \
+        mag->nb -= RIX_FREELIST_MAG_BATCH;                                    \
+        for (unsigned i = 0; i < mag->nb; i++)                                \
+            mag->idx[i] = mag->idx[i + RIX_FREELIST_MAG_BATCH];               \
+    }                                                                         \
+    mag->idx[mag->nb++] = RIX_IDX_FROM_PTR(base, elm);                        \
+}                                                                             \
+                                                                              \
+attr void                                                                     \
+name##_mag_flush(struct rix_freelist_s *fl,                                   \
+                 struct rix_freelist_mag_s *mag, type *base)                  \
+{                                                                             \
+    name##_push_bulk(fl, base, mag->idx, mag->nb);                            \
+    mag->nb = 0u;                                                             \
+}
+
+#endif /* _RIX_FREELIST_H_ */
+
+/*
+ * Local Variables:
+ * c-file-style: "bsd"
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * tab-width: 4
+ * End:
+ */
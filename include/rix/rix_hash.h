@@ -18,8 +18,15 @@
  *   rix_hash_slot.h    - slot variant (hash_field + slot_field in node)
  *   rix_hash_keyonly.h  - key-only variant (no auxiliary fields in node)
  *
+ * rix_hash_tag.h adds a fourth, single-cache-line bucket layout (10 slots
+ * of 16-bit tag + u32 idx) with the same pipeline and node contract as
+ * the fingerprint variant.
+ *
+ * rix_hash_filter.h is a cuckoo filter on the same bucket machinery: it
+ * stores 8-, 12- or 16-bit fingerprints only (approximate membership).
+ *
  * Usage:
- *   #include <rix/rix_hash.h>            // all three variants
+ *   #include <rix/rix_hash.h>            // all variants
  *   #include <rix/rix_hash_fp.h>         // fp only
  *   #include <rix/rix_hash_keyonly.h>    // keyonly only
  */
@@ -29,6 +36,8 @@
 
 #  include "rix_hash_fp.h"
 #  include "rix_hash_slot.h"
+#  include "rix_hash_tag.h"
+#  include "rix_hash_filter.h"
 #  include "rix_hash_keyonly.h"
 #  include "rix_hash32.h"
 #  include "rix_hash64.h"
@@ -45,7 +54,14 @@
  *   RIX_HASH_FIND        (name, head, buckets, base, key)
  *   RIX_HASH_INSERT      (name, head, buckets, base, elm)
  *   RIX_HASH_REMOVE      (name, head, buckets, base, elm)
+ *   RIX_HASH_RELOCATE    (name, head, buckets, base, src, dst)  slot only
+ *   RIX_HASH_SWAP        (name, head, buckets, base, a, b)      slot only
+ *   RIX_HASH_PROMOTE     (name, head, buckets, base, elm)       slot only
  *   RIX_HASH_WALK        (name, head, buckets, base, cb, arg)
+ *   RIX_HASH_WALK_STEP   (name, head, buckets, cursor, budget,
+ *                         idx_out, max_out, n_out)
+ *   RIX_HASH_WALK_RANGE  (name, head, buckets, base, bk_begin, bk_end,
+ *                         cb, arg)
  *
  * Staged find - x1:
  *   RIX_HASH_HASH_KEY    (name, ctx, head, buckets, key) key: const key_type *
@@ -87,9 +103,27 @@
 #  define RIX_HASH_REMOVE_AT(name, head, buckets, bk, slot)                     \
     name##_remove_at(head, buckets, bk, slot)
 
+#  define RIX_HASH_RELOCATE(name, head, buckets, base, src, dst)                \
+    name##_relocate(head, buckets, base, src, dst)
+
+#  define RIX_HASH_SWAP(name, head, buckets, base, a, b)                        \
+    name##_swap(head, buckets, base, a, b)
+
+#  define RIX_HASH_PROMOTE(name, head, buckets, base, elm)                      \
+    name##_promote(head, buckets, base, elm)
+
+#  define RIX_HASH_PROMOTE_HASHED(name, head, buckets, base, elm)               \
+    name##_promote_hashed(head, buckets, base, elm)
+
 #  define RIX_HASH_WALK(name, head, buckets, base, cb, arg)                     \
     name##_walk(head, buckets, base, cb, arg)
 
+#  define RIX_HASH_WALK_STEP(name, head, buckets, cursor, budget, idx_out, max_out, n_out) \
+    name##_walk_step(head, buckets, cursor, budget, idx_out, max_out, n_out)
+
+#  define RIX_HASH_WALK_RANGE(name, head, buckets, base, bk_begin, bk_end, cb, arg) \
+    name##_walk_range(head, buckets, base, bk_begin, bk_end, cb, arg)
+
 /* ---- staged find - x1 --------------------------------------------------- */
 #  define RIX_HASH_HASH_KEY(name, ctx, head, buckets, key)                      \
     name##_hash_key(ctx, head, buckets, key)
@@ -46,6 +46,10 @@
  * remove re-hashes elm->key_field to locate the bucket, then uses find_u32x16
  * directly on idx[16] (16 u32, perfectly sized) to find the slot by index.
  * kickout re-hashes the victim key to find the alternate bucket.
+ * RIX_HASH64_GENERATE_SLOT records (bucket, slot) in the node instead, so
+ * remove is a direct store.
+ * RIX_HASH64_GENERATE_MAP stores a value next to each key instead of a
+ * node index (no node pool).
  *
  * Slot count vs rix_hash32:
  *   rix_hash32: 16 slots/bucket, 128 B/bucket (2 CL)
@@ -111,6 +115,22 @@ struct rix_hash64_find_ctx_s {
     struct rix_hash64_bucket_s *bk[2];
     u64                    key;        /* 64-bit search key             */
     u32                    hits[2];    /* bitmask: key match in bk[i]   */
+    u32                    seq[2];     /* name_mt_*: bucket versions    */
+};
+
+/*===========================================================================
+ * Map bucket and find context (RIX_HASH64_GENERATE_MAP)
+ * 256 bytes = 4 x 64-byte cache lines (2 key lines + 2 value lines), aligned to 64 bytes.
+ *===========================================================================*/
+struct rix_hash64_map_bucket_s {
+    u64 key[RIX_HASH_BUCKET_ENTRY_SZ]; /* keys; invalid_key = empty      */
+    u64 val[RIX_HASH_BUCKET_ENTRY_SZ]; /* values                         */
+} __attribute__((aligned(64)));
+
+struct rix_hash64_map_find_ctx_s {
+    struct rix_hash64_map_bucket_s *bk[2];
+    u64                        key;
+    u32                        hits[2];
 };
 
 /*===========================================================================
@@ -165,6 +185,22 @@ struct rix_hash64_find_ctx_s {
  *     type *name_insert(head, buckets, base, elm)
  *     type *name_remove(head, buckets, base, elm)   elm is type *
  *     int   name_walk  (head, buckets, base, cb, arg)
+ *     int   name_walk_range(head, buckets, base, bk_begin, bk_end, cb, arg)
+ *       part of the table, see "Bucket range walk" in rix_hash_common.h
+ *     unsigned name_walk_step(head, buckets, cursor, budget,
+ *                             idx_out, max_out, n_out)
+ *       resumable walk, see "Resumable walk" in rix_hash_common.h
+ *
+ *   Bulk ops (pipelined, see "Bulk insert / remove" in rix_hash_common.h):
+ *     unsigned name_insert_bulk(head, buckets, base, elms, n, results)
+ *     unsigned name_remove_bulk(head, buckets, base, elms, n)
+ *
+ *   Parallel bulk build (see "Parallel bulk build" in rix_hash_common.h):
+ *     unsigned name_build_bk    (head, elm)
+ *     unsigned name_build_range (head, buckets, base, elms, n,
+ *                                bk_begin, bk_end, spill, nb_spill)
+ *     unsigned name_build_finish(head, buckets, base, nb_placed,
+ *                                spill, nb_spill, results)
  *===========================================================================*/
 #  define RIX_HASH64_PROTOTYPE_INTERNAL(name, type, key_field, invalid_key, attr) \
     attr void name##_init(struct name *head,                                    \
@@ -180,7 +216,39 @@ struct rix_hash64_find_ctx_s {
                          struct rix_hash64_bucket_s *buckets,                   \
                          type *base,                                            \
                          int (*cb)(type *, void *),                             \
-                         void *arg);
+                         void *arg);                                            \
+    attr int name##_walk_range(struct name *head,                               \
+                               struct rix_hash64_bucket_s *buckets,             \
+                               type *base,                                      \
+                               unsigned bk_begin, unsigned bk_end,              \
+                               int (*cb)(type *, void *),                       \
+                               void *arg);                                      \
+    attr unsigned name##_walk_step(struct name *head,                           \
+                                   struct rix_hash64_bucket_s *buckets,         \
+                                   unsigned cursor, unsigned budget,            \
+                                   u32 *idx_out, unsigned max_out,              \
+                                   unsigned *n_out);                            \
+    attr unsigned name##_insert_bulk(struct name *head,                         \
+                                     struct rix_hash64_bucket_s *buckets,       \
+                                     type *base, type * const *elms,            \
+                                     unsigned n, type **results);               \
+    attr unsigned name##_remove_bulk(struct name *head,                         \
+                                     struct rix_hash64_bucket_s *buckets,       \
+                                     type *base, type * const *elms,            \
+                                     unsigned n);                               \
+    attr unsigned name##_build_bk(struct name *head,                            \
+                                  const type *elm);                             \
+    attr unsigned name##_build_range(struct name *head,                         \
+                                     struct rix_hash64_bucket_s *buckets,       \
+                                     type *base, type * const *elms,            \
+                                     unsigned n, unsigned bk_begin,             \
+                                     unsigned bk_end, type **spill,             \
+                                     unsigned *nb_spill);                       \
+    attr unsigned name##_build_finish(struct name *head,                        \
+                                      struct rix_hash64_bucket_s *buckets,      \
+                                      type *base, unsigned nb_placed,           \
+                                      type * const *spill,                      \
+                                      unsigned nb_spill, type **results);
 
 #  define RIX_HASH64_PROTOTYPE(name, type, key_field, invalid_key) \
     RIX_HASH64_PROTOTYPE_INTERNAL(name, type, key_field, invalid_key, )
@@ -194,7 +262,7 @@ struct rix_hash64_find_ctx_s {
 #  define RIX_HASH64_GENERATE_STATIC(name, type, key_field, invalid_key) \
     RIX_HASH64_GENERATE_INTERNAL(name, type, key_field, invalid_key, RIX_UNUSED static)
 
-#  define RIX_HASH64_GENERATE_INTERNAL(name, type, key_field, invalid_key, attr) \
+#  define _RIX_HASH64_GENERATE_CORE(name, type, key_field, invalid_key, attr) \
                                                                               \
 /* ================================================================== */      \
 /* Initialisation                                                     */      \
@@ -232,6 +300,10 @@ name##_hptr(type *base, unsigned i) {                                         \
     return RIX_PTR_FROM_IDX(base, i);                                         \
 }                                                                             \
                                                                               \
+/* Entry idx now lives at (bk, slot); a no-op unless GENERATE_SLOT. */        \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_set_pos(type *base, unsigned idx, unsigned bk, unsigned slot);         \
+                                                                              \
 /* ================================================================== */      \
 /* Staged find - x1                                                   */      \
 /* ================================================================== */      \
@@ -318,8 +390,20 @@ name##_hash_key_n(struct rix_hash64_find_ctx_s *ctx,                          \
                   struct rix_hash64_bucket_s *buckets,                        \
                   const u64 *keys)                                       \
 {                                                                             \
-    for (int _j = 0; _j < n; _j++)                                            \
-        name##_hash_key(&ctx[_j], head, buckets, keys[_j]);                   \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h[RIX_HASH_N_LANES];                               \
+    for (int _b = 0; _b < n; _b += (int)RIX_HASH_N_LANES) {                   \
+        unsigned _m = (unsigned)(n - _b) < RIX_HASH_N_LANES ?                 \
+                      (unsigned)(n - _b) : RIX_HASH_N_LANES;                  \
+        rix_hash_arch->hash_u64_n(keys + _b, _m, mask, _h);                   \
+        for (unsigned _j = 0; _j < _m; _j++) {                                \
+            struct rix_hash64_find_ctx_s *_c = &ctx[_b + (int)_j];            \
+            _c->key   = keys[_b + (int)_j];                                   \
+            _c->bk[0] = buckets + (_h[_j].val32[0] & mask);                   \
+            _c->bk[1] = buckets + (_h[_j].val32[1] & mask);                   \
+            __builtin_prefetch(_c->bk[0], 0, 1);                              \
+        }                                                                     \
+    }                                                                         \
 }                                                                             \
                                                                               \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
@@ -385,6 +469,7 @@ name##_find_empty(struct rix_hash64_bucket_s *buckets,                        \
 /* ================================================================== */      \
 static RIX_UNUSED int                                                         \
 name##_flipflop(struct rix_hash64_bucket_s *buckets,                          \
+                type *base,                                                   \
                 unsigned mask,                                                \
                 unsigned bk_idx,                                              \
                 unsigned slot)                                                \
@@ -402,6 +487,7 @@ name##_flipflop(struct rix_hash64_bucket_s *buckets,                          \
     struct rix_hash64_bucket_s *_alt = buckets + _ab;                         \
     _alt->key[_es] = _key;                                                     \
     _alt->idx[_es] = _idx;                                                     \
+    name##_set_pos(base, _idx, _ab, (unsigned)_es);                           \
     _bk->key[slot] = (u64)(invalid_key);                                 \
     _bk->idx[slot] = (u32)RIX_NIL;                                       \
     return (int)slot;                                                         \
@@ -415,6 +501,7 @@ name##_flipflop(struct rix_hash64_bucket_s *buckets,                          \
 /* ================================================================== */      \
 static RIX_UNUSED int                                                         \
 name##_kickout(struct rix_hash64_bucket_s *buckets,                           \
+               type *base,                                                    \
                unsigned mask,                                                 \
                unsigned bk_idx,                                               \
                int depth)                                                     \
@@ -423,7 +510,7 @@ name##_kickout(struct rix_hash64_bucket_s *buckets,                           \
     struct rix_hash64_bucket_s *_bk = buckets + bk_idx;                       \
                                                                               \
     for (unsigned _s = 0; _s < RIX_HASH64_BUCKET_ENTRY_SZ; _s++) {           \
-        if (name##_flipflop(buckets, mask, bk_idx, _s) >= 0)                 \
+        if (name##_flipflop(buckets, base, mask, bk_idx, _s) >= 0)            \
             return (int)_s;                                                   \
     }                                                                         \
     for (unsigned _s = 0; _s < RIX_HASH64_BUCKET_ENTRY_SZ; _s++) {           \
@@ -434,7 +521,7 @@ name##_kickout(struct rix_hash64_bucket_s *buckets,                           \
         unsigned _sb0 = _sh.val32[0] & mask;                                   \
         unsigned _sb1 = _sh.val32[1] & mask;                                   \
         unsigned _ab  = (bk_idx == _sb0) ? _sb1 : _sb0;                       \
-        if (name##_kickout(buckets, mask, _ab, depth - 1) >= 0) {             \
+        if (name##_kickout(buckets, base, mask, _ab, depth - 1) >= 0) {       \
             /* Re-check: recursive chain may have relocated bk[_s] */        \
             if (_bk->key[_s] != _key || _bk->idx[_s] != _si) {              \
                 int _fs = name##_find_empty(buckets, bk_idx);                \
@@ -445,6 +532,7 @@ name##_kickout(struct rix_hash64_bucket_s *buckets,                           \
             struct rix_hash64_bucket_s *_alt = buckets + _ab;                 \
             _alt->key[_es] = _key;                                             \
             _alt->idx[_es] = _si;                                              \
+            name##_set_pos(base, _si, _ab, (unsigned)_es);                    \
             _bk->key[_s] = (u64)(invalid_key);                           \
             _bk->idx[_s] = (u32)RIX_NIL;                                \
             return (int)_s;                                                   \
@@ -454,6 +542,76 @@ name##_kickout(struct rix_hash64_bucket_s *buckets,                           \
 }                                                                             \
                                                                               \
 /* ================================================================== */      \
+/* kickout_bfs - shortest cuckoo path, breadth first                  */      \
+/* (see rix_hash_common.h).  Returns the freed slot and stores its    */      \
+/* bucket (bk0 or bk1) in *bk_out; -1 with the table untouched.       */      \
+/* ================================================================== */      \
+static RIX_UNUSED int                                                         \
+name##_kickout_bfs(struct rix_hash64_bucket_s *buckets,                       \
+                   type *base,                                                \
+                   unsigned mask,                                             \
+                   unsigned bk0,                                              \
+                   unsigned bk1,                                              \
+                   unsigned *bk_out)                                          \
+{                                                                             \
+    struct rix_hash_bfs_s _q[RIX_HASH_BFS_QUEUE];                             \
+    union rix_hash_hash_u _sh[RIX_HASH_BUCKET_ENTRY_SZ];                      \
+    unsigned _head = 0u, _tail = 0u;                                          \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk0, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk1, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    while (_head < _tail) {                                                   \
+        unsigned _qi = _head++;                                               \
+        unsigned _b  = _q[_qi].bk;                                            \
+        struct rix_hash64_bucket_s *_bk = buckets + _b;                       \
+        if (_q[_qi].depth != 0u) {                                            \
+            int _es = name##_find_empty(buckets, _b);                         \
+            if (_es >= 0) {                                                   \
+                /* shift occupants backwards along the path */                \
+                unsigned _cs = (unsigned)_es;                                 \
+                while (_q[_qi].parent != RIX_HASH_BFS_ROOT) {                 \
+                    struct rix_hash64_bucket_s *_src =                        \
+                        buckets + _q[_q[_qi].parent].bk;                      \
+                    struct rix_hash64_bucket_s *_dst = buckets + _q[_qi].bk;  \
+                    unsigned _ps = _q[_qi].slot;                              \
+                    _dst->key[_cs] = _src->key[_ps];                          \
+                    _dst->idx[_cs] = _src->idx[_ps];                          \
+                    name##_set_pos(base, _dst->idx[_cs], _q[_qi].bk, _cs);    \
+                    _src->key[_ps] = (u64)(invalid_key);                      \
+                    _src->idx[_ps] = (u32)RIX_NIL;                            \
+                    _cs = _ps;                                                \
+                    _qi = _q[_qi].parent;                                     \
+                }                                                             \
+                *bk_out = _q[_qi].bk;                                         \
+                return (int)_cs;                                              \
+            }                                                                 \
+        }                                                                     \
+        if (_q[_qi].depth >= RIX_HASH_FOLLOW_DEPTH)                           \
+            continue;                                                         \
+        /* all occupants hashed in one batch call */                          \
+        rix_hash_arch->hash_u64_n(_bk->key, RIX_HASH64_BUCKET_ENTRY_SZ,       \
+                                  mask, _sh);                                 \
+        for (unsigned _n = 0, _fan = _rix_hash_bfs_fanout(_q, _qi);           \
+             _n < RIX_HASH64_BUCKET_ENTRY_SZ && _fan != 0u; _n++) {           \
+            unsigned _s = _rix_hash_bfs_slot(_qi, _n,                         \
+                                             RIX_HASH64_BUCKET_ENTRY_SZ);     \
+            unsigned _sb0, _ab;                                               \
+            if (_tail >= RIX_HASH_BFS_QUEUE)                                  \
+                break;                                                        \
+            if (_bk->idx[_s] == (u32)RIX_NIL) continue;                       \
+            _sb0 = _sh[_s].val32[0] & mask;                                   \
+            _ab  = (_b == _sb0) ? (_sh[_s].val32[1] & mask) : _sb0;           \
+            if (_rix_hash_bfs_on_path(_q, _qi, _ab))                          \
+                continue;                                                     \
+            __builtin_prefetch(&buckets[_ab].key[0], 0, 1);                   \
+            __builtin_prefetch(&buckets[_ab].key[8], 0, 1);                   \
+            _q[_tail++] = (struct rix_hash_bfs_s){                            \
+                _ab, (u16)_qi, (u8)_s, (u8)(_q[_qi].depth + 1u) };            \
+            _fan--;                                                           \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+/* ================================================================== */      \
 /* Insert with cuckoo kickout                                         */      \
 /*                                                                    */      \
 /* Returns:                                                           */      \
@@ -461,15 +619,14 @@ name##_kickout(struct rix_hash64_bucket_s *buckets,                           \
 /*   elm      - table full (kickout exhausted)                        */      \
 /*   other    - duplicate found, returns the existing node            */      \
 /* ================================================================== */      \
-attr type *                                                                   \
-name##_insert(struct name *head,                                              \
-              struct rix_hash64_bucket_s *buckets,                            \
-              type *base,                                                     \
-              type *elm)                                                      \
+static RIX_UNUSED RIX_FORCE_INLINE type *                                     \
+name##_insert_hashed(struct name *head,                                       \
+                     struct rix_hash64_bucket_s *buckets,                     \
+                     type *base,                                              \
+                     type *elm,                                               \
+                     union rix_hash_hash_u _h)                                \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        rix_hash_arch->hash_u64((u64)elm->key_field, mask);              \
     unsigned _bk0 = _h.val32[0] & mask;                                       \
     unsigned _bk1 = _h.val32[1] & mask;                                       \
                                                                               \
@@ -493,63 +650,299 @@ name##_insert(struct name *head,                                              \
             struct rix_hash64_bucket_s *_bk = buckets + _bki;                 \
             _bk->key[_slot] = (u64)elm->key_field;                       \
             _bk->idx[_slot] = name##_hidx(base, elm);                         \
+            name##_set_pos(base, _bk->idx[_slot], _bki, (unsigned)_slot);     \
             head->rhh_nb++;                                                   \
             return NULL;                                                      \
         }                                                                     \
     }                                                                         \
                                                                               \
-    /* Slow path: non-destructive recursive kickout */                        \
+    /* Slow path: non-destructive kickout (BFS or recursive DFS) */           \
     {                                                                         \
-        int _slot; unsigned _bki;                                             \
-        _slot = name##_kickout(buckets, mask, _bk0,                           \
-                               RIX_HASH_FOLLOW_DEPTH);                        \
-        if (_slot >= 0) { _bki = _bk0; }                                      \
-        else {                                                                \
-            _slot = name##_kickout(buckets, mask, _bk1,                       \
+        int _slot; unsigned _bki = _bk0;                                      \
+        if (RIX_HASH_KICKOUT_BFS) {                                           \
+            _slot = name##_kickout_bfs(buckets, base, mask, _bk0, _bk1,       \
+                                       &_bki);                                \
+        } else {                                                              \
+            _slot = name##_kickout(buckets, base, mask, _bk0,                 \
                                    RIX_HASH_FOLLOW_DEPTH);                    \
-            if (_slot < 0) return elm; /* table full - no modification */     \
-            _bki = _bk1;                                                      \
+            if (_slot < 0) {                                                  \
+                _bki  = _bk1;                                                 \
+                _slot = name##_kickout(buckets, base, mask, _bk1,             \
+                                       RIX_HASH_FOLLOW_DEPTH);                \
+            }                                                                 \
         }                                                                     \
+        if (_slot < 0) return elm; /* table full - no modification */         \
         struct rix_hash64_bucket_s *_bk = buckets + _bki;                     \
         _bk->key[_slot] = (u64)elm->key_field;                           \
         _bk->idx[_slot] = name##_hidx(base, elm);                             \
+        name##_set_pos(base, _bk->idx[_slot], _bki, (unsigned)_slot);         \
         head->rhh_nb++;                                                       \
         return NULL;                                                          \
     }                                                                         \
 }                                                                             \
                                                                               \
+attr type *                                                                   \
+name##_insert(struct name *head,                                              \
+              struct rix_hash64_bucket_s *buckets,                            \
+              type *base,                                                     \
+              type *elm)                                                      \
+{                                                                             \
+    union rix_hash_hash_u _h =                                                \
+        rix_hash_arch->hash_u64((u64)elm->key_field, head->rhh_mask);         \
+    return name##_insert_hashed(head, buckets, base, elm, _h);                \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Walk - iterate over all occupied slots                             */      \
+/* ================================================================== */      \
+_RIX_HASH_GENERATE_WALK_RANGE(name, walk_range, struct rix_hash64_bucket_s,   \
+                              type, RIX_HASH64_BUCKET_ENTRY_SZ,               \
+                              head->rhh_mask + 1u, 0, attr)                   \
+                                                                              \
+attr int                                                                      \
+name##_walk(struct name *head,                                                \
+            struct rix_hash64_bucket_s *buckets,                              \
+            type *base,                                                       \
+            int (*cb)(type *, void *),                                        \
+            void *arg)                                                        \
+{                                                                             \
+    return name##_walk_range(head, buckets, base, 0u, head->rhh_mask + 1u,    \
+                             cb, arg);                                        \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_STEP(name, walk_step, struct rix_hash64_bucket_s,     \
+                             RIX_HASH64_BUCKET_ENTRY_SZ,                      \
+                             head->rhh_mask + 1u, 0, attr)                    \
+                                                                              \
+/* ================================================================== */      \
+/* Bulk insert / remove (pipelined; see rix_hash_common.h)            */      \
+/*                                                                    */      \
+/* Keys live in the bucket, so there is no duplicate-candidate stage: */      \
+/* prefetch node -> hash + prefetch both buckets -> commit.           */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_bulk_prefetch_bk(const struct rix_hash64_bucket_s *_b)                 \
+{                                                                             \
+    __builtin_prefetch((const char *)_b +   0, 0, 1); /* key lo */            \
+    __builtin_prefetch((const char *)_b +  64, 0, 1); /* key hi */            \
+    __builtin_prefetch((const char *)_b + 128, 0, 1); /* idx    */            \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_bulk_hash_blk(struct name *head,                                       \
+                     struct rix_hash64_bucket_s *buckets,                     \
+                     type * const *elms,                                      \
+                     unsigned m,                                              \
+                     union rix_hash_hash_u *out)                              \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    u64 _k[RIX_HASH_BULK_AHEAD];                                              \
+    for (unsigned _j = 0u; _j < m; _j++)                                      \
+        _k[_j] = (u64)elms[_j]->key_field;                                    \
+    rix_hash_arch->hash_u64_n(_k, m, mask, out);                              \
+    for (unsigned _j = 0u; _j < m; _j++) {                                    \
+        name##_bulk_prefetch_bk(buckets + (out[_j].val32[0] & mask));         \
+        name##_bulk_prefetch_bk(buckets + (out[_j].val32[1] & mask));         \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_insert_bulk(struct name *head,                                         \
+                   struct rix_hash64_bucket_s *buckets,                       \
+                   type *base,                                                \
+                   type * const *elms,                                        \
+                   unsigned n,                                                \
+                   type **results)                                            \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _hs[_RIX_HASH_BULK_RING];                           \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t++) {                          \
+        /* Stage 2: commit */                                                 \
+        if (_t >= 2u * _a) {                                                  \
+            unsigned _i = _t - 2u * _a;                                       \
+            type *_r = name##_insert_hashed(head, buckets, base, elms[_i],    \
+                                            _hs[_i % _RIX_HASH_BULK_RING]);   \
+            if (_r == NULL)                                                   \
+                _ok++;                                                        \
+            if (results)                                                      \
+                results[_i] = _r;                                             \
+        }                                                                     \
+        /* Stage 1: batch hash, prefetch candidate buckets */                 \
+        if (_t >= _a && _t - _a < n && (_t - _a) % _a == 0u) {                \
+            unsigned _i = _t - _a;                                            \
+            name##_bulk_hash_blk(head, buckets, elms + _i,                    \
+                                 (n - _i < _a) ? n - _i : _a,                 \
+                                 &_hs[_i % _RIX_HASH_BULK_RING]);             \
+        }                                                                     \
+        /* Stage 0: prefetch a block of nodes (key) */                        \
+        if (_t < n && _t % _a == 0u)                                          \
+            for (unsigned _j = _t; _j < n && _j < _t + _a; _j++)              \
+                __builtin_prefetch(elms[_j], 0, 1);                           \
+    }                                                                         \
+    return _ok;                                                               \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Parallel bulk build (see rix_hash_common.h)                        */      \
+/* ================================================================== */      \
+attr unsigned                                                                 \
+name##_build_bk(struct name *head,                                            \
+                const type *elm)                                              \
+{                                                                             \
+    union rix_hash_hash_u _h =                                                \
+        rix_hash_arch->hash_u64((u64)elm->key_field, head->rhh_mask);         \
+    return _h.val32[0] & head->rhh_mask;                                      \
+}                                                                             \
+                                                                              \
+/* 0 placed, 1 spill, -1 bk0 not in [bk_begin, bk_end). */                    \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_build_one(struct rix_hash64_bucket_s *buckets,                         \
+                 type *base,                                                  \
+                 unsigned mask,                                               \
+                 type *elm,                                                   \
+                 union rix_hash_hash_u _h,                                    \
+                 unsigned bk_begin,                                           \
+                 unsigned bk_end,                                             \
+                 int nonempty)                                                \
+{                                                                             \
+    unsigned _bk[2];                                                          \
+    int _nb;                                                                  \
+    _bk[0] = _h.val32[0] & mask;                                              \
+    _bk[1] = _h.val32[1] & mask;                                              \
+    if (_bk[0] - bk_begin >= bk_end - bk_begin)                               \
+        return -1;                                                            \
+    _nb = (_bk[1] - bk_begin < bk_end - bk_begin) ? 2 : 1;                    \
+    /* bk1 belongs to another range: on a non-empty table a copy of the */    \
+    /* key may sit there unseen, so name_insert_bulk has to decide.     */    \
+    if (_nb == 1 && nonempty)                                                 \
+        return 1;                                                             \
+    for (int _i = 0; _i < _nb; _i++)                                          \
+        if (rix_hash_arch->find_u64x16(buckets[_bk[_i]].key,                  \
+                                       (u64)elm->key_field))                  \
+            return 1;                                                         \
+    for (int _i = 0; _i < _nb; _i++) {                                        \
+        int _slot = name##_find_empty(buckets, _bk[_i]);                      \
+        if (_slot >= 0) {                                                     \
+            struct rix_hash64_bucket_s *_b = buckets + _bk[_i];               \
+            _b->key[_slot] = (u64)elm->key_field;                             \
+            _b->idx[_slot] = name##_hidx(base, elm);                          \
+            name##_set_pos(base, _b->idx[_slot], _bk[_i], (unsigned)_slot);   \
+            return 0;                                                         \
+        }                                                                     \
+    }                                                                         \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_build_range(struct name *head,                                         \
+                   struct rix_hash64_bucket_s *buckets,                       \
+                   type *base,                                                \
+                   type * const *elms,                                        \
+                   unsigned n,                                                \
+                   unsigned bk_begin,                                         \
+                   unsigned bk_end,                                           \
+                   type **spill,                                              \
+                   unsigned *nb_spill)                                        \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _hs[_RIX_HASH_BULK_RING];                           \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _placed = 0u, _ns = 0u;                                          \
+    const int _nonempty = head->rhh_nb != 0u;                                 \
+    if (bk_end > mask + 1u)                                                   \
+        bk_end = mask + 1u;                                                   \
+    if (bk_begin > bk_end)                                                    \
+        bk_begin = bk_end;                                                    \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t += _a) {                      \
+        /* Stage 2: place (or spill) a block */                               \
+        if (_t >= 2u * _a) {                                                  \
+            for (unsigned _i = _t - 2u * _a; _i < _t - _a && _i < n; _i++) {  \
+                int _r = name##_build_one(buckets, base, mask, elms[_i],      \
+                                          _hs[_i % _RIX_HASH_BULK_RING],      \
+                                          bk_begin, bk_end, _nonempty);       \
+                if (_r == 0)                                                  \
+                    _placed++;                                                \
+                else if (_r > 0)                                              \
+                    spill[_ns++] = elms[_i];                                  \
+            }                                                                 \
+        }                                                                     \
+        /* Stage 1: batch hash, prefetch the buckets of this range */         \
+        if (_t >= _a && _t - _a < n) {                                        \
+            unsigned _i = _t - _a;                                            \
+            unsigned _m = (n - _i < _a) ? n - _i : _a;                        \
+            union rix_hash_hash_u *_o = &_hs[_i % _RIX_HASH_BULK_RING];       \
+            u64 _k[RIX_HASH_BULK_AHEAD];                                      \
+            for (unsigned _j = 0u; _j < _m; _j++)                             \
+                _k[_j] = (u64)elms[_i + _j]->key_field;                       \
+            rix_hash_arch->hash_u64_n(_k, _m, mask, _o);                      \
+            for (unsigned _j = 0u; _j < _m; _j++) {                           \
+                unsigned _b0 = _o[_j].val32[0] & mask;                        \
+                if (_b0 - bk_begin < bk_end - bk_begin)                       \
+                    name##_bulk_prefetch_bk(buckets + _b0);                   \
+            }                                                                 \
+        }                                                                     \
+        /* Stage 0: prefetch a block of nodes (key) */                        \
+        for (unsigned _j = _t; _j < n && _j < _t + _a; _j++)                  \
+            __builtin_prefetch(elms[_j], 0, 1);                               \
+    }                                                                         \
+    *nb_spill = _ns;                                                          \
+    return _placed;                                                           \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_build_finish(struct name *head,                                        \
+                    struct rix_hash64_bucket_s *buckets,                      \
+                    type *base,                                               \
+                    unsigned nb_placed,                                       \
+                    type * const *spill,                                      \
+                    unsigned nb_spill,                                        \
+                    type **results)                                           \
+{                                                                             \
+    head->rhh_nb += nb_placed;                                                \
+    return name##_insert_bulk(head, buckets, base, spill, nb_spill, results); \
+}
+
+#  define RIX_HASH64_GENERATE_INTERNAL(name, type, key_field, invalid_key, attr) \
+    _RIX_HASH64_GENERATE_CORE(name, type, key_field, invalid_key, attr)       \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_set_pos(type *base, unsigned idx, unsigned bk, unsigned slot)          \
+{                                                                             \
+    (void)base; (void)idx; (void)bk; (void)slot;                              \
+}                                                                             \
+                                                                              \
 /* ================================================================== */      \
 /* Remove - evict a known node from the table                         */      \
 /*                                                                    */      \
 /* Re-hashes elm->key_field to locate the two candidate buckets, then */      \
 /* searches each by node index using find_u32x16 on idx[16] (exactly  */      \
-/* 16 u32).                                                      */      \
+/* 16 u32).                                                      */           \
 /* Returns elm on success, NULL if elm is not currently in the table. */      \
 /* ================================================================== */      \
-attr type *                                                                   \
-name##_remove(struct name *head,                                              \
-              struct rix_hash64_bucket_s *buckets,                            \
-              type *base,                                                     \
-              type *elm)                                                      \
+static RIX_UNUSED RIX_FORCE_INLINE type *                                     \
+name##_remove_hashed(struct name *head,                                       \
+                     struct rix_hash64_bucket_s *buckets,                     \
+                     type *base,                                              \
+                     type *elm,                                               \
+                     union rix_hash_hash_u _h)                                \
 {                                                                             \
     unsigned mask     = head->rhh_mask;                                       \
     unsigned node_idx = name##_hidx(base, elm);                               \
-    union rix_hash_hash_u _h =                                                \
-        rix_hash_arch->hash_u64((u64)elm->key_field, mask);              \
     unsigned _bk0 = _h.val32[0] & mask;                                       \
     unsigned _bk1 = _h.val32[1] & mask;                                       \
                                                                               \
     for (int _i = 0; _i < 2; _i++) {                                          \
         struct rix_hash64_bucket_s *_bk =                                     \
             buckets + (_i == 0 ? _bk0 : _bk1);                                \
-        /* Scan idx[16] as u32[16] to locate slot by node index */       \
-        u32 _hits = rix_hash_arch->find_u32x16(                          \
-                             (const u32 *)_bk->idx,                      \
-                             (u32)node_idx);                             \
+        /* Scan idx[16] as u32[16] to locate slot by node index */            \
+        u32 _hits = rix_hash_arch->find_u32x16(                               \
+                             (const u32 *)_bk->idx,                           \
+                             (u32)node_idx);                                  \
         if (_hits) {                                                          \
             unsigned _slot    = (unsigned)__builtin_ctz(_hits);               \
-            _bk->key[_slot] = (u64)(invalid_key);                        \
-            _bk->idx[_slot] = (u32)RIX_NIL;                              \
+            _bk->key[_slot] = (u64)(invalid_key);                             \
+            _bk->idx[_slot] = (u32)RIX_NIL;                                   \
             head->rhh_nb--;                                                   \
             return elm;                                                       \
         }                                                                     \
@@ -557,30 +950,619 @@ name##_remove(struct name *head,                                              \
     return NULL; /* not in table */                                           \
 }                                                                             \
                                                                               \
+attr type *                                                                   \
+name##_remove(struct name *head,                                              \
+              struct rix_hash64_bucket_s *buckets,                            \
+              type *base,                                                     \
+              type *elm)                                                      \
+{                                                                             \
+    union rix_hash_hash_u _h =                                                \
+        rix_hash_arch->hash_u64((u64)elm->key_field, head->rhh_mask);         \
+    return name##_remove_hashed(head, buckets, base, elm, _h);                \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_remove_bulk(struct name *head,                                         \
+                   struct rix_hash64_bucket_s *buckets,                       \
+                   type *base,                                                \
+                   type * const *elms,                                        \
+                   unsigned n)                                                \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _hs[_RIX_HASH_BULK_RING];                           \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t++) {                          \
+        /* Stage 2: commit */                                                 \
+        if (_t >= 2u * _a) {                                                  \
+            unsigned _i = _t - 2u * _a;                                       \
+            if (name##_remove_hashed(head, buckets, base, elms[_i],           \
+                                     _hs[_i % _RIX_HASH_BULK_RING]) != NULL)  \
+                _ok++;                                                        \
+        }                                                                     \
+        /* Stage 1: batch re-hash, prefetch candidate buckets */              \
+        if (_t >= _a && _t - _a < n && (_t - _a) % _a == 0u) {                \
+            unsigned _i = _t - _a;                                            \
+            name##_bulk_hash_blk(head, buckets, elms + _i,                    \
+                                 (n - _i < _a) ? n - _i : _a,                 \
+                                 &_hs[_i % _RIX_HASH_BULK_RING]);             \
+        }                                                                     \
+        /* Stage 0: prefetch a block of nodes (key) */                        \
+        if (_t < n && _t % _a == 0u)                                          \
+            for (unsigned _j = _t; _j < n && _j < _t + _a; _j++)              \
+                __builtin_prefetch(elms[_j], 0, 1);                           \
+    }                                                                         \
+    return _ok;                                                               \
+}
+
+/*===========================================================================
+ * RIX_HASH64_GENERATE_SLOT(name, type, key_field, bk_field, slot_field,
+ *                          invalid_key)
+ *
+ * Same table as RIX_HASH64_GENERATE, but every node also records where it
+ * sits: bk_field (bucket index, holds 0..nb_bk-1) and slot_field (holds
+ * 0..15), kept current on insert and on every kickout move.  name_remove
+ * then clears the slot directly: no re-hash, no idx scan, one bucket
+ * touched.  The price is a node write per kickout move.
+ *
+ * name_remove verifies buckets[bk_field].idx[slot_field] before clearing,
+ * so removing a node that is not in the table still returns NULL.
+ *
+ * Generated functions (in addition to RIX_HASH64_GENERATE):
+ *   unsigned name_remove_at(head, buckets, bk, slot)
+ *            clear (bk, slot); returns the removed idx or RIX_NIL
+ *===========================================================================*/
+#  define RIX_HASH64_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, invalid_key, attr) \
+    RIX_HASH64_PROTOTYPE_INTERNAL(name, type, key_field, invalid_key, attr)   \
+    attr unsigned name##_remove_at(struct name *head,                         \
+                                   struct rix_hash64_bucket_s *buckets,       \
+                                   unsigned bk, unsigned slot);
+
+#  define RIX_HASH64_PROTOTYPE_SLOT(name, type, key_field, bk_field, slot_field, invalid_key) \
+    RIX_HASH64_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, invalid_key, )
+
+#  define RIX_HASH64_PROTOTYPE_STATIC_SLOT(name, type, key_field, bk_field, slot_field, invalid_key) \
+    RIX_HASH64_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, invalid_key, RIX_UNUSED static)
+
+#  define RIX_HASH64_GENERATE_SLOT(name, type, key_field, bk_field, slot_field, invalid_key) \
+    RIX_HASH64_GENERATE_SLOT_INTERNAL(name, type, key_field, bk_field, slot_field, invalid_key, )
+
+#  define RIX_HASH64_GENERATE_STATIC_SLOT(name, type, key_field, bk_field, slot_field, invalid_key) \
+    RIX_HASH64_GENERATE_SLOT_INTERNAL(name, type, key_field, bk_field, slot_field, invalid_key, RIX_UNUSED static)
+
+#  define RIX_HASH64_GENERATE_SLOT_INTERNAL(name, type, key_field, bk_field, slot_field, invalid_key, attr) \
+    _RIX_HASH64_GENERATE_CORE(name, type, key_field, invalid_key, attr)       \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_set_pos(type *base, unsigned idx, unsigned bk, unsigned slot)          \
+{                                                                             \
+    type *_node = name##_hptr(base, idx);                                     \
+    _node->bk_field   = bk;                                                   \
+    _node->slot_field = slot;                                                 \
+}                                                                             \
+                                                                              \
 /* ================================================================== */      \
-/* Walk - iterate over all occupied slots                             */      \
+/* Remove - O(1) through the recorded (bucket, slot)                  */      \
 /* ================================================================== */      \
-attr int                                                                      \
-name##_walk(struct name *head,                                                \
-            struct rix_hash64_bucket_s *buckets,                              \
-            type *base,                                                       \
-            int (*cb)(type *, void *),                                        \
-            void *arg)                                                        \
+attr unsigned                                                                 \
+name##_remove_at(struct name *head,                                           \
+                 struct rix_hash64_bucket_s *buckets,                         \
+                 unsigned bk,                                                 \
+                 unsigned slot)                                               \
 {                                                                             \
-    unsigned _nb_bk = head->rhh_mask + 1u;                                    \
-    for (unsigned _b = 0u; _b < _nb_bk; _b++) {                               \
-        struct rix_hash64_bucket_s *_bk = buckets + _b;                       \
-        for (unsigned _s = 0u; _s < RIX_HASH64_BUCKET_ENTRY_SZ; _s++) {       \
-            unsigned _nidx = _bk->idx[_s];                                    \
-            if (_nidx == (unsigned)RIX_NIL)                                   \
+    struct rix_hash64_bucket_s *_bk = buckets + bk;                           \
+    unsigned _idx;                                                            \
+    RIX_ASSERT(slot < RIX_HASH_BUCKET_ENTRY_SZ);                              \
+    if (slot >= RIX_HASH_BUCKET_ENTRY_SZ)                                     \
+        return (unsigned)RIX_NIL;                                             \
+    _idx = _bk->idx[slot];                                                    \
+    if (_idx == (unsigned)RIX_NIL)                                            \
+        return (unsigned)RIX_NIL;                                             \
+    _bk->key[slot] = (u64)(invalid_key);                                      \
+    _bk->idx[slot] = (u32)RIX_NIL;                                            \
+    head->rhh_nb--;                                                           \
+    return _idx;                                                              \
+}                                                                             \
+                                                                              \
+attr type *                                                                   \
+name##_remove(struct name *head,                                              \
+              struct rix_hash64_bucket_s *buckets,                            \
+              type *base,                                                     \
+              type *elm)                                                      \
+{                                                                             \
+    unsigned _bk   = (unsigned)elm->bk_field;                                 \
+    unsigned _slot = (unsigned)elm->slot_field;                               \
+    if (_bk > head->rhh_mask || _slot >= RIX_HASH_BUCKET_ENTRY_SZ ||          \
+        buckets[_bk].idx[_slot] != (u32)name##_hidx(base, elm))               \
+        return NULL; /* not in table */                                       \
+    name##_remove_at(head, buckets, _bk, _slot);                              \
+    return elm;                                                               \
+}                                                                             \
+                                                                              \
+/* Bulk remove: prefetch node -> prefetch its bucket -> commit.       */      \
+attr unsigned                                                                 \
+name##_remove_bulk(struct name *head,                                         \
+                   struct rix_hash64_bucket_s *buckets,                       \
+                   type *base,                                                \
+                   type * const *elms,                                        \
+                   unsigned n)                                                \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t++) {                          \
+        /* Stage 2: commit */                                                 \
+        if (_t >= 2u * _a &&                                                  \
+            name##_remove(head, buckets, base, elms[_t - 2u * _a]) != NULL)   \
+            _ok++;                                                            \
+        /* Stage 1: prefetch the recorded bucket */                           \
+        if (_t >= _a && _t - _a < n)                                          \
+            name##_bulk_prefetch_bk(buckets +                                 \
+                                    (elms[_t - _a]->bk_field & mask));        \
+        /* Stage 0: prefetch node */                                          \
+        if (_t < n)                                                           \
+            __builtin_prefetch(elms[_t], 0, 1);                               \
+    }                                                                         \
+    return _ok;                                                               \
+}
+
+/*===========================================================================
+ * RIX_HASH64_GENERATE_MAP(name, invalid_key)
+ *
+ * u64 -> u64 map with the value stored in the bucket next to the key (see
+ * "Inline-value maps" in rix_hash_common.h): a lookup touches only bucket
+ * lines, with no node pool.  The head is RIX_HASH64_HEAD(name); buckets are
+ * struct rix_hash64_map_bucket_s.
+ *
+ * Generated functions:
+ *   void     name_init     (head, buckets, nb_bk)
+ *   u64     *name_find     (head, buckets, key)       NULL on miss
+ *   int      name_insert   (head, buckets, key, val)  0 / 1 present / -1 full
+ *   int      name_remove   (head, buckets, key)       0 / -1 not present
+ *   unsigned name_find_bulk(head, buckets, keys, n, vals, miss)
+ *            vals[i] = value or miss; returns the number of hits
+ *   int      name_walk     (head, buckets, cb, arg)   cb(key, &val, arg)
+ *   int      name_walk_range(head, buckets, bk_begin, bk_end, cb, arg)
+ *   unsigned name_walk_step(head, buckets, cursor, budget,
+ *                           keys_out, vals_out, max_out, n_out)
+ *            resumable walk: next cursor, 0 when done
+ *
+ *   Staged find (+ _n forms; name_get_n(ctx, n, results)):
+ *     void  name_hash_key(ctx, head, buckets, key)
+ *     void  name_scan_bk (ctx, head, buckets)
+ *     u64  *name_get     (ctx)
+ *===========================================================================*/
+#  define RIX_HASH64_PROTOTYPE_MAP_INTERNAL(name, invalid_key, attr) \
+    attr void name##_init(struct name *head,                                  \
+                          struct rix_hash64_map_bucket_s *buckets,            \
+                          unsigned nb_bk);                                    \
+    attr int name##_insert(struct name *head,                                 \
+                           struct rix_hash64_map_bucket_s *buckets,           \
+                           u64 key, u64 val);                                 \
+    attr int name##_remove(struct name *head,                                 \
+                           struct rix_hash64_map_bucket_s *buckets,           \
+                           u64 key);                                          \
+    attr unsigned name##_find_bulk(struct name *head,                         \
+                                   struct rix_hash64_map_bucket_s *buckets,   \
+                                   const u64 *keys, unsigned n,               \
+                                   u64 *vals, u64 miss);                      \
+    attr int name##_walk(struct name *head,                                   \
+                         struct rix_hash64_map_bucket_s *buckets,             \
+                         int (*cb)(u64, u64 *, void *),                       \
+                         void *arg);                                          \
+    attr int name##_walk_range(struct name *head,                             \
+                               struct rix_hash64_map_bucket_s *buckets,       \
+                               unsigned bk_begin, unsigned bk_end,            \
+                               int (*cb)(u64, u64 *, void *),                 \
+                               void *arg);                                    \
+    attr unsigned name##_walk_step(struct name *head,                         \
+                                   struct rix_hash64_map_bucket_s *buckets,   \
+                                   unsigned cursor, unsigned budget,          \
+                                   u64 *keys_out, u64 *vals_out,              \
+                                   unsigned max_out, unsigned *n_out);
+
+#  define RIX_HASH64_PROTOTYPE_MAP(name, invalid_key) \
+    RIX_HASH64_PROTOTYPE_MAP_INTERNAL(name, invalid_key, )
+
+#  define RIX_HASH64_PROTOTYPE_STATIC_MAP(name, invalid_key) \
+    RIX_HASH64_PROTOTYPE_MAP_INTERNAL(name, invalid_key, RIX_UNUSED static)
+
+#  define RIX_HASH64_GENERATE_MAP(name, invalid_key) \
+    RIX_HASH64_GENERATE_MAP_INTERNAL(name, invalid_key, )
+
+#  define RIX_HASH64_GENERATE_STATIC_MAP(name, invalid_key) \
+    RIX_HASH64_GENERATE_MAP_INTERNAL(name, invalid_key, RIX_UNUSED static)
+
+#  define RIX_HASH64_GENERATE_MAP_INTERNAL(name, invalid_key, attr) \
+    _RIX_HASH_GENERATE_MAP(name, struct rix_hash64_map_bucket_s,              \
+                           struct rix_hash64_map_find_ctx_s,                  \
+                           u64, u64, hash_u64, hash_u64_n, find_u64x16,       \
+                           invalid_key, attr)
+
+/*===========================================================================
+ * RIX_HASH64_GENERATE_MT(name, type, key_field, invalid_key)
+ *
+ * Same table as RIX_HASH64_GENERATE plus name_mt_* ops that may be called
+ * from several threads at once (any mix of insert / remove / find).
+ * The single-thread ops above must not run concurrently with them.
+ *
+ * The caller provides  u32 seq[nb_bk]  next to the bucket array (zeroed,
+ * no pointers, so both may live in shared memory).  Each word is the lock
+ * and the version of one bucket (see rix_hash_common.h):
+ *
+ *   - insert-if-absent claims the key's bucket pair with CAS, re-checks
+ *     for a duplicate and fills an empty slot; key and idx are stored in
+ *     the bucket, so no node write is part of the critical section.
+ *   - when both buckets are full, a cuckoo path is searched breadth
+ *     first without taking any lock, on bucket copies validated against
+ *     their seq words.  The path is then executed from the far end back
+ *     to bk0/bk1; each hop locks only the two buckets it touches and
+ *     re-validates its entry, and a hop whose entry has gone abandons the
+ *     path.  The insert then retries (at most RIX_HASH_MT_INSERT_RETRY
+ *     times), so a failing insert takes at most that many path searches
+ *     and RIX_HASH_FOLLOW_DEPTH pair locks per search.
+ *   - remove locks the pair, clears the slot and unlocks.
+ *   - find never locks: it snapshots both words, scans, and retries only
+ *     if either word was odd or changed.
+ *
+ * rhh_nb is maintained with atomic add / sub.  name_walk is not safe
+ * against concurrent writers.
+ *
+ * Generated functions (in addition to RIX_HASH64_GENERATE):
+ *   type *name_mt_find  (head, buckets, seq, base, key)
+ *   type *name_mt_insert(head, buckets, seq, base, elm)
+ *   type *name_mt_remove(head, buckets, seq, base, elm)
+ *
+ *   Staged lock-free find:
+ *     void  name_mt_hash_key (ctx, head, buckets, seq, key)
+ *     void  name_mt_scan_bk  (ctx, head, buckets, seq)
+ *     type *name_mt_cmp_key  (ctx, head, buckets, seq, base)
+ *     (+ _n forms; name_prefetch_node may be used between scan and cmp)
+ *===========================================================================*/
+#  define RIX_HASH64_PROTOTYPE_MT_INTERNAL(name, type, key_field, invalid_key, attr) \
+    RIX_HASH64_PROTOTYPE_INTERNAL(name, type, key_field, invalid_key, attr)    \
+    attr type *name##_mt_find(struct name *head,                                \
+                              struct rix_hash64_bucket_s *buckets,             \
+                              const u32 *seq, type *base, u64 key);           \
+    attr type *name##_mt_insert(struct name *head,                              \
+                                struct rix_hash64_bucket_s *buckets,           \
+                                u32 *seq, type *base, type *elm);               \
+    attr type *name##_mt_remove(struct name *head,                              \
+                                struct rix_hash64_bucket_s *buckets,           \
+                                u32 *seq, type *base, type *elm);
+
+#  define RIX_HASH64_PROTOTYPE_MT(name, type, key_field, invalid_key) \
+    RIX_HASH64_PROTOTYPE_MT_INTERNAL(name, type, key_field, invalid_key, )
+
+#  define RIX_HASH64_PROTOTYPE_STATIC_MT(name, type, key_field, invalid_key) \
+    RIX_HASH64_PROTOTYPE_MT_INTERNAL(name, type, key_field, invalid_key, RIX_UNUSED static)
+
+#  define RIX_HASH64_GENERATE_MT(name, type, key_field, invalid_key) \
+    RIX_HASH64_GENERATE_MT_INTERNAL(name, type, key_field, invalid_key, )
+
+#  define RIX_HASH64_GENERATE_STATIC_MT(name, type, key_field, invalid_key) \
+    RIX_HASH64_GENERATE_MT_INTERNAL(name, type, key_field, invalid_key, RIX_UNUSED static)
+
+#  define RIX_HASH64_GENERATE_MT_INTERNAL(name, type, key_field, invalid_key, attr) \
+    RIX_HASH64_GENERATE_INTERNAL(name, type, key_field, invalid_key, attr)     \
+                                                                              \
+/* ================================================================== */      \
+/* Multi-writer ops                                                   */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_mt_buckets(struct name *head, u64 key,                                 \
+                  unsigned *bk0, unsigned *bk1)                               \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h = rix_hash_arch->hash_u64(key, mask);            \
+    *bk0 = _h.val32[0] & mask;                                                \
+    *bk1 = _h.val32[1] & mask;                                                \
+}                                                                             \
+                                                                              \
+/* Stage 1: as hash_key, plus bk[1] and both seq words prefetched.    */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_mt_hash_key(struct rix_hash64_find_ctx_s *ctx,                         \
+                   struct name *head,                                         \
+                   struct rix_hash64_bucket_s *buckets,                       \
+                   const u32 *seq,                                            \
+                   u64 key)                                                   \
+{                                                                             \
+    name##_hash_key(ctx, head, buckets, key);                                 \
+    __builtin_prefetch(ctx->bk[1], 0, 1);                                     \
+    __builtin_prefetch(&seq[ctx->bk[0] - buckets], 0, 1);                     \
+    __builtin_prefetch(&seq[ctx->bk[1] - buckets], 0, 1);                     \
+}                                                                             \
+                                                                              \
+/* Stage 2: snapshot both seq words, then scan bk[0].                 */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_mt_scan_bk(struct rix_hash64_find_ctx_s *ctx,                          \
+                  struct name *head,                                          \
+                  struct rix_hash64_bucket_s *buckets,                        \
+                  const u32 *seq)                                             \
+{                                                                             \
+    ctx->seq[0] = rix_hash_seq_snapshot(seq,                                  \
+                                        (unsigned)(ctx->bk[0] - buckets));    \
+    ctx->seq[1] = rix_hash_seq_snapshot(seq,                                  \
+                                        (unsigned)(ctx->bk[1] - buckets));    \
+    name##_scan_bk(ctx, head, buckets);                                       \
+}                                                                             \
+                                                                              \
+/* Stage 4: cmp_key, then validate; rescan only if a word moved.      */      \
+static RIX_UNUSED RIX_FORCE_INLINE type *                                     \
+name##_mt_cmp_key(struct rix_hash64_find_ctx_s *ctx,                          \
+                  struct name *head,                                          \
+                  struct rix_hash64_bucket_s *buckets,                        \
+                  const u32 *seq,                                             \
+                  type *base)                                                 \
+{                                                                             \
+    unsigned _b0 = (unsigned)(ctx->bk[0] - buckets);                          \
+    unsigned _b1 = (unsigned)(ctx->bk[1] - buckets);                          \
+    type *_node = name##_cmp_key(ctx, base);                                  \
+    while (RIX_UNLIKELY(rix_hash_seq_read_retry2(seq, _b0, ctx->seq[0],       \
+                                                 _b1, ctx->seq[1]))) {        \
+        ctx->seq[0] = rix_hash_seq_read_begin(seq, _b0);                      \
+        ctx->seq[1] = rix_hash_seq_read_begin(seq, _b1);                      \
+        name##_scan_bk(ctx, head, buckets);                                   \
+        _node = name##_cmp_key(ctx, base);                                    \
+    }                                                                         \
+    return _node;                                                             \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_mt_hash_key_n(struct rix_hash64_find_ctx_s *ctx,                       \
+                     int n,                                                   \
+                     struct name *head,                                       \
+                     struct rix_hash64_bucket_s *buckets,                     \
+                     const u32 *seq,                                          \
+                     const u64 *keys)                                         \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        name##_mt_hash_key(&ctx[_j], head, buckets, seq, keys[_j]);           \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_mt_scan_bk_n(struct rix_hash64_find_ctx_s *ctx,                        \
+                    int n,                                                    \
+                    struct name *head,                                        \
+                    struct rix_hash64_bucket_s *buckets,                      \
+                    const u32 *seq)                                           \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        name##_mt_scan_bk(&ctx[_j], head, buckets, seq);                      \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_mt_cmp_key_n(struct rix_hash64_find_ctx_s *ctx,                        \
+                    int n,                                                    \
+                    struct name *head,                                        \
+                    struct rix_hash64_bucket_s *buckets,                      \
+                    const u32 *seq,                                           \
+                    type *base,                                               \
+                    type **results)                                           \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        results[_j] = name##_mt_cmp_key(&ctx[_j], head, buckets, seq, base);  \
+}                                                                             \
+                                                                              \
+attr type *                                                                   \
+name##_mt_find(struct name *head,                                             \
+               struct rix_hash64_bucket_s *buckets,                           \
+               const u32 *seq,                                                \
+               type *base,                                                    \
+               u64 key)                                                       \
+{                                                                             \
+    struct rix_hash64_find_ctx_s _ctx;                                        \
+    name##_mt_hash_key(&_ctx, head, buckets, seq, key);                       \
+    name##_mt_scan_bk(&_ctx, head, buckets, seq);                             \
+    return name##_mt_cmp_key(&_ctx, head, buckets, seq, base);                \
+}                                                                             \
+                                                                              \
+/* One cuckoo hop under the pair lock.  (key, idx) is an unlocked      */     \
+/* snapshot of bk_idx/slot; the hop is refused if it no longer holds  */      \
+/* or the alternate bucket has no room.                               */      \
+static RIX_UNUSED int                                                         \
+name##_mt_move(struct name *head,                                             \
+               struct rix_hash64_bucket_s *buckets,                           \
+               u32 *seq,                                                      \
+               unsigned bk_idx,                                               \
+               unsigned slot,                                                 \
+               u64 key,                                                       \
+               unsigned idx)                                                  \
+{                                                                             \
+    struct rix_hash64_bucket_s *_bk = buckets + bk_idx;                       \
+    unsigned _rb0, _rb1, _ab;                                                 \
+    int _rc = -1;                                                             \
+    name##_mt_buckets(head, key, &_rb0, &_rb1);                               \
+    _ab = (bk_idx == _rb0) ? _rb1 : _rb0;                                     \
+    rix_hash_seq_lock2(seq, bk_idx, _ab);                                     \
+    if (_bk->key[slot] == key && _bk->idx[slot] == idx) {                     \
+        int _es = name##_find_empty(buckets, _ab);                            \
+        if (_es >= 0) {                                                       \
+            struct rix_hash64_bucket_s *_alt = buckets + _ab;                 \
+            _alt->key[_es] = key;                                             \
+            _alt->idx[_es] = (u32)idx;                                        \
+            _bk->key[slot] = (u64)(invalid_key);                              \
+            _bk->idx[slot] = (u32)RIX_NIL;                                    \
+            _rc = (int)slot;                                                  \
+        }                                                                     \
+    }                                                                         \
+    rix_hash_seq_unlock2(seq, bk_idx, _ab);                                   \
+    return _rc;                                                               \
+}                                                                             \
+                                                                              \
+/* Breadth-first cuckoo path for a full bk0/bk1 pair (see             */      \
+/* rix_hash_common.h), searched without locks: each bucket is copied  */      \
+/* under a seq snapshot and copied again if a writer moved it.  Node  */      \
+/* i records in pkey[i] / pidx[i] the entry that would move into it.  */      \
+/* Returns the queue index of a bucket with a free slot, or -1.       */      \
+static RIX_UNUSED int                                                         \
+name##_mt_path(struct name *head,                                             \
+               struct rix_hash64_bucket_s *buckets,                           \
+               const u32 *seq,                                                \
+               unsigned bk0,                                                  \
+               unsigned bk1,                                                  \
+               struct rix_hash_bfs_s *q,                                      \
+               u64 *pkey,                                                     \
+               u32 *pidx)                                                     \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    u64 _key[RIX_HASH64_BUCKET_ENTRY_SZ];                                     \
+    u32 _idx[RIX_HASH64_BUCKET_ENTRY_SZ];                                     \
+    union rix_hash_hash_u _sh[RIX_HASH64_BUCKET_ENTRY_SZ];                    \
+    unsigned _head = 0u, _tail = 0u;                                          \
+    q[_tail++] = (struct rix_hash_bfs_s){ bk0, RIX_HASH_BFS_ROOT, 0u, 0u };   \
+    q[_tail++] = (struct rix_hash_bfs_s){ bk1, RIX_HASH_BFS_ROOT, 0u, 0u };   \
+    while (_head < _tail) {                                                   \
+        unsigned _qi = _head++;                                               \
+        unsigned _b  = q[_qi].bk;                                             \
+        u32 _sq;                                                              \
+        do {                                                                  \
+            _sq = rix_hash_seq_read_begin(seq, _b);                           \
+            for (unsigned _s = 0; _s < RIX_HASH64_BUCKET_ENTRY_SZ; _s++) {    \
+                _key[_s] = buckets[_b].key[_s];                               \
+                _idx[_s] = buckets[_b].idx[_s];                               \
+            }                                                                 \
+        } while (rix_hash_seq_read_retry(seq, _b, _sq));                      \
+        for (unsigned _s = 0; _s < RIX_HASH64_BUCKET_ENTRY_SZ; _s++) {        \
+            if (_idx[_s] == (u32)RIX_NIL)                                     \
+                return (int)_qi;                                              \
+        }                                                                     \
+        if (q[_qi].depth >= RIX_HASH_FOLLOW_DEPTH)                            \
+            continue;                                                         \
+        rix_hash_arch->hash_u64_n(_key, RIX_HASH64_BUCKET_ENTRY_SZ,           \
+                                  mask, _sh);                                 \
+        for (unsigned _n = 0, _fan = _rix_hash_bfs_fanout(q, _qi);            \
+             _n < RIX_HASH64_BUCKET_ENTRY_SZ && _fan != 0u; _n++) {           \
+            unsigned _s = _rix_hash_bfs_slot(_qi, _n,                         \
+                                             RIX_HASH64_BUCKET_ENTRY_SZ);     \
+            unsigned _sb0, _ab;                                               \
+            if (_tail >= RIX_HASH_BFS_QUEUE)                                  \
+                break;                                                        \
+            _sb0 = _sh[_s].val32[0] & mask;                                   \
+            _ab  = (_b == _sb0) ? (_sh[_s].val32[1] & mask) : _sb0;           \
+            if (_rix_hash_bfs_on_path(q, _qi, _ab))                           \
                 continue;                                                     \
-            type *_node = name##_hptr(base, _nidx);                           \
-            int   _r    = cb(_node, arg);                                     \
-            if (_r)                                                           \
-                return _r;                                                    \
+            __builtin_prefetch(&buckets[_ab].key[0], 0, 1);                   \
+            __builtin_prefetch(&buckets[_ab].key[8], 0, 1);                   \
+            __builtin_prefetch(&seq[_ab], 0, 1);                              \
+            q[_tail] = (struct rix_hash_bfs_s){                               \
+                _ab, (u16)_qi, (u8)_s, (u8)(q[_qi].depth + 1u) };             \
+            pkey[_tail] = _key[_s];                                           \
+            pidx[_tail] = _idx[_s];                                           \
+            _tail++;                                                          \
+            _fan--;                                                           \
         }                                                                     \
     }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+/* Make room in bk0 or bk1: find a path with name_mt_path, then move  */      \
+/* its entries leaf first, locking only the two buckets of each hop.  */      \
+/* Returns 0 (a slot was freed), 1 (a hop found its entry gone: the   */      \
+/* path is stale, search again) or -1 (no path: table full).  The     */      \
+/* freed slot may be taken by another writer before the caller        */      \
+/* relocks, hence the caller's retries.                               */      \
+static RIX_UNUSED int                                                         \
+name##_mt_kickout(struct name *head,                                          \
+                  struct rix_hash64_bucket_s *buckets,                        \
+                  u32 *seq,                                                   \
+                  unsigned bk0,                                               \
+                  unsigned bk1)                                               \
+{                                                                             \
+    struct rix_hash_bfs_s _q[RIX_HASH_BFS_QUEUE];                             \
+    u64 _pkey[RIX_HASH_BFS_QUEUE];                                            \
+    u32 _pidx[RIX_HASH_BFS_QUEUE];                                            \
+    int _qi = name##_mt_path(head, buckets, seq, bk0, bk1,                    \
+                             _q, _pkey, _pidx);                               \
+    if (_qi < 0)                                                              \
+        return -1;                                                            \
+    while (_q[_qi].parent != RIX_HASH_BFS_ROOT) {                             \
+        unsigned _pi = _q[_qi].parent;                                        \
+        if (name##_mt_move(head, buckets, seq, _q[_pi].bk, _q[_qi].slot,      \
+                           _pkey[_qi], _pidx[_qi]) < 0)                       \
+            return 1;                                                         \
+        _qi = (int)_pi;                                                       \
+    }                                                                         \
     return 0;                                                                 \
+}                                                                             \
+                                                                              \
+/* Insert-if-absent on a locked bucket pair.                          */      \
+/* Returns NULL (inserted), existing node (duplicate) or elm (full).  */      \
+static RIX_UNUSED RIX_FORCE_INLINE type *                                     \
+name##_mt_insert_locked(struct name *head,                                    \
+                        struct rix_hash64_bucket_s *buckets,                  \
+                        type *base,                                           \
+                        type *elm,                                            \
+                        unsigned bk0,                                         \
+                        unsigned bk1)                                         \
+{                                                                             \
+    u64 _key = (u64)elm->key_field;                                           \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        struct rix_hash64_bucket_s *_bk = buckets + (_i == 0 ? bk0 : bk1);    \
+        u32 _hits = rix_hash_arch->find_u64x16(_bk->key, _key);               \
+        if (_hits)                                                            \
+            return name##_hptr(base, _bk->idx[__builtin_ctz(_hits)]);         \
+    }                                                                         \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        unsigned _bki = (_i == 0) ? bk0 : bk1;                                \
+        int _slot = name##_find_empty(buckets, _bki);                         \
+        if (_slot >= 0) {                                                     \
+            buckets[_bki].key[_slot] = _key;                                  \
+            buckets[_bki].idx[_slot] = name##_hidx(base, elm);                \
+            __atomic_fetch_add(&head->rhh_nb, 1u, __ATOMIC_RELAXED);          \
+            return NULL;                                                      \
+        }                                                                     \
+    }                                                                         \
+    return elm;                                                               \
+}                                                                             \
+                                                                              \
+attr type *                                                                   \
+name##_mt_insert(struct name *head,                                           \
+                 struct rix_hash64_bucket_s *buckets,                         \
+                 u32 *seq,                                                    \
+                 type *base,                                                  \
+                 type *elm)                                                   \
+{                                                                             \
+    unsigned _bk0, _bk1;                                                      \
+    name##_mt_buckets(head, (u64)elm->key_field, &_bk0, &_bk1);               \
+    for (int _try = 0; _try < RIX_HASH_MT_INSERT_RETRY; _try++) {             \
+        type *_ret;                                                           \
+        rix_hash_seq_lock2(seq, _bk0, _bk1);                                  \
+        _ret = name##_mt_insert_locked(head, buckets, base, elm, _bk0, _bk1); \
+        rix_hash_seq_unlock2(seq, _bk0, _bk1);                                \
+        if (_ret != elm)                                                      \
+            return _ret;                                                      \
+        if (name##_mt_kickout(head, buckets, seq, _bk0, _bk1) < 0)            \
+            return elm;     /* no cuckoo path: table full */                  \
+    }                                                                         \
+    return elm;                                                               \
+}                                                                             \
+                                                                              \
+attr type *                                                                   \
+name##_mt_remove(struct name *head,                                           \
+                 struct rix_hash64_bucket_s *buckets,                         \
+                 u32 *seq,                                                    \
+                 type *base,                                                  \
+                 type *elm)                                                   \
+{                                                                             \
+    unsigned node_idx = name##_hidx(base, elm);                               \
+    unsigned _bk0, _bk1;                                                      \
+    type *_ret = NULL;                                                        \
+    name##_mt_buckets(head, (u64)elm->key_field, &_bk0, &_bk1);               \
+    rix_hash_seq_lock2(seq, _bk0, _bk1);                                      \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        struct rix_hash64_bucket_s *_bk = buckets + (_i == 0 ? _bk0 : _bk1);  \
+        u32 _hits = rix_hash_arch->find_u32x16(_bk->idx, (u32)node_idx);      \
+        if (_hits) {                                                          \
+            unsigned _slot = (unsigned)__builtin_ctz(_hits);                  \
+            _bk->key[_slot] = (u64)(invalid_key);                             \
+            _bk->idx[_slot] = (u32)RIX_NIL;                                   \
+            __atomic_fetch_sub(&head->rhh_nb, 1u, __ATOMIC_RELAXED);          \
+            _ret = elm;                                                       \
+            break;                                                            \
+        }                                                                     \
+    }                                                                         \
+    rix_hash_seq_unlock2(seq, _bk0, _bk1);                                    \
+    return _ret;                                                              \
 }
 
 /*===========================================================================
@@ -592,6 +1574,8 @@ name##_walk(struct name *head,                                                \
  *   RIX_HASH64_INSERT      (name, head, buckets, base, elm)
  *   RIX_HASH64_REMOVE      (name, head, buckets, base, elm)
  *   RIX_HASH64_WALK        (name, head, buckets, base, cb, arg)
+ *   RIX_HASH64_WALK_STEP   (name, head, buckets, cursor, budget,
+ *                           idx_out, max_out, n_out)
  *
  * Staged find - x1:
  *   RIX_HASH64_HASH_KEY    (name, ctx, head, buckets, key)
@@ -633,6 +1617,12 @@ name##_walk(struct name *head,                                                \
 #  define RIX_HASH64_WALK(name, head, buckets, base, cb, arg)                   \
     name##_walk(head, buckets, base, cb, arg)
 
+#  define RIX_HASH64_WALK_STEP(name, head, buckets, cursor, budget, idx_out, max_out, n_out) \
+    name##_walk_step(head, buckets, cursor, budget, idx_out, max_out, n_out)
+
+#  define RIX_HASH64_WALK_RANGE(name, head, buckets, base, bk_begin, bk_end, cb, arg) \
+    name##_walk_range(head, buckets, base, bk_begin, bk_end, cb, arg)
+
 /* ---- staged find - x1 --------------------------------------------------- */
 #  define RIX_HASH64_HASH_KEY(name, ctx, head, buckets, key)                    \
     name##_hash_key(ctx, head, buckets, key)
@@ -685,6 +1675,16 @@ name##_walk(struct name *head,                                                \
 #  define RIX_HASH64_CMP_KEY_N(name, ctx, n, base, results)                     \
     name##_cmp_key_n(ctx, n, base, results)
 
+/* ---- multi-writer ops (RIX_HASH64_GENERATE_MT) ------------------------- */
+#  define RIX_HASH64_MT_FIND(name, head, buckets, seq, base, key)               \
+    name##_mt_find(head, buckets, seq, base, key)
+
+#  define RIX_HASH64_MT_INSERT(name, head, buckets, seq, base, elm)             \
+    name##_mt_insert(head, buckets, seq, base, elm)
+
+#  define RIX_HASH64_MT_REMOVE(name, head, buckets, seq, base, elm)             \
+    name##_mt_remove(head, buckets, seq, base, elm)
+
 #endif /* _RIX_HASH64_H_ */
 
 /*
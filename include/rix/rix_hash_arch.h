@@ -33,8 +33,14 @@
  * rix_hash_arch.h - arch-dependent infrastructure shared by all hash variants
  *
  * Provides runtime dispatch (Generic / SSE / AVX2 / AVX-512) for:
- *   - Fingerprint/key search:  find_u32x16, find_u64x16
+ *   - Fingerprint/key search:  find_u32x16, find_u64x16, find_u16x16,
+ *                              find_u8x16
  *   - Hash computation:        hash_bytes, hash_u32, hash_u64
+ *                              (+ _n batch forms)
+ *
+ * rix_hash_hash_bytes_aes() (+ _n) / rix_hash_hash_bytes_keyed() are
+ * direct-call (not dispatched) AES-round alternatives to hash_bytes
+ * (-maes); the keyed form takes a per-table seed.
  *
  * Used by rix_hash.h, rix_hash32.h, rix_hash64.h, and rix_hash_key.h.
  *
@@ -44,6 +50,8 @@
  * Each source file starts in the Generic dispatch mode by default.
  * Call rix_hash_arch_init() in a source file that uses hash tables to
  * enable the best SIMD level allowed by `enable`.
+ * Defining RIX_HASH_ARCH_DIRECT instead binds the TU at compile time to
+ * the best level it is compiled for, with direct calls (see below).
  *
  * Dispatch matrix (find / hash):
  *
@@ -125,14 +133,23 @@ union rix_hash_hash_u {
 /*===========================================================================
  * Arch handler - runtime dispatch
  *
- * find_u32x16 / find_u64x16:
+ * find_u32x16 / find_u64x16 / find_u16x16 / find_u8x16:
  *   Search 16-element arrays; return 16-bit bitmask of matching positions.
+ * find_u16x12:
+ *   Same for a 12-element u16 array; reads exactly 24 bytes.
  *   Dispatched to GEN scalar, SSE, AVX2, or AVX-512 depending on CPU.
  *
  * hash_bytes / hash_u32 / hash_u64:
  *   Compute two independent 32-bit hashes such that
  *   (val32[0] & mask) != (val32[1] & mask) is always guaranteed.
  *   Dispatched to CRC32C (x86_64 + SSE4.2) or GEN multiplicative fallback.
+ *
+ * hash_bytes_n / hash_u32_n / hash_u64_n:
+ *   out[i] = hash_*(keys[i], mask) for i < n, bit-identical to the single
+ *   key form, so tables may mix both.  The CRC32C forms run the per-key
+ *   CRC chains of RIX_HASH_N_LANES keys interleaved (CRC32 has 3-cycle
+ *   latency but 1-cycle throughput); hash_bytes_n takes one fixed
+ *   key_bytes for the whole batch.
  *===========================================================================*/
 struct rix_hash_arch_s {
     /* find val in u32[16], returns 16-bit bitmask of hit positions */
@@ -148,6 +165,22 @@ struct rix_hash_arch_s {
                           u32 *mask0, u32 *mask1);
     /* find val in u64[16], returns 16-bit bitmask of hit positions */
     u32 (*find_u64x16)(const u64 *arr, u64  val);
+    /*
+     * find val in u16[16] (32 bytes), returns 16-bit bitmask of hit
+     * positions.  Used by the 12/16-bit cuckoo filter (rix_hash_filter.h).
+     */
+    u32 (*find_u16x16)(const u16 *arr, u16 val);
+    /*
+     * find val in u16[12] (24 bytes), returns 12-bit bitmask of hit
+     * positions.  Used by the single-cache-line tag bucket (rix_hash_tag.h),
+     * whose tag array is followed by idx[] in the same line.
+     */
+    u32 (*find_u16x12)(const u16 *arr, u16 val);
+    /*
+     * find val in u8[16] (16 bytes), returns 16-bit bitmask of hit
+     * positions.  Used by the 8-bit cuckoo filter (rix_hash_filter.h).
+     */
+    u32 (*find_u8x16)(const u8 *arr, u8 val);
     /* hash arbitrary-length byte key */
     union rix_hash_hash_u (*hash_bytes)(const void *key, size_t key_bytes,
                                         u32 mask);
@@ -155,12 +188,26 @@ struct rix_hash_arch_s {
     union rix_hash_hash_u (*hash_u32)(u32 key, u32 mask);
     /* hash u64 key */
     union rix_hash_hash_u (*hash_u64)(u64 key, u32 mask);
+    /* batch forms: n keys of the same size */
+    void (*hash_bytes_n)(const void * const *keys, size_t key_bytes,
+                         unsigned n, u32 mask, union rix_hash_hash_u *out);
+    void (*hash_u32_n)(const u32 *keys, unsigned n, u32 mask,
+                       union rix_hash_hash_u *out);
+    void (*hash_u64_n)(const u64 *keys, unsigned n, u32 mask,
+                       union rix_hash_hash_u *out);
 };
 
+/* Keys per interleaved group in the _n hash forms (and per hash_key_n block). */
+#    ifndef RIX_HASH_N_LANES
+#      define RIX_HASH_N_LANES 8u
+#    endif
+
 /* Per-TU dispatch handle.  Defaults to Generic until init enables SIMD. */
 static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_GEN;
+#    if !defined(RIX_HASH_ARCH_DIRECT)
 static RIX_UNUSED const struct rix_hash_arch_s *rix_hash_arch =
     &_rix_hash_arch_GEN;
+#    endif
 
 /*===========================================================================
  * Generic (scalar) find implementations
@@ -202,6 +249,41 @@ _rix_hash_find_u64x16_GEN(const u64 *arr, u64 val)
     return mask;
 }
 
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u16x16_GEN(const u16 *arr, u16 val)
+{
+    u16 tmp[16];
+    u32 mask = 0u;
+    /* arr may be shorter than 16 elements inside a larger object */
+    memcpy(tmp, arr, sizeof(tmp));
+    for (unsigned i = 0u; i < 16u; i++)
+        if (tmp[i] == val)
+            mask |= (1u << i);
+    return mask;
+}
+
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u16x12_GEN(const u16 *arr, u16 val)
+{
+    u32 mask = 0u;
+    for (unsigned i = 0u; i < 12u; i++)
+        if (arr[i] == val)
+            mask |= (1u << i);
+    return mask;
+}
+
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u8x16_GEN(const u8 *arr, u8 val)
+{
+    u8 tmp[16];
+    u32 mask = 0u;
+    memcpy(tmp, arr, sizeof(tmp));
+    for (unsigned i = 0u; i < 16u; i++)
+        if (tmp[i] == val)
+            mask |= (1u << i);
+    return mask;
+}
+
 /*===========================================================================
  * Generic (scalar) hash implementations
  *
@@ -270,6 +352,30 @@ _rix_hash_hash_bytes_GEN(const void *key, size_t key_bytes, u32 mask)
     return r;
 }
 
+static RIX_FORCE_INLINE void
+_rix_hash_hash_bytes_n_GEN(const void * const *keys, size_t key_bytes,
+                           unsigned n, u32 mask, union rix_hash_hash_u *out)
+{
+    for (unsigned i = 0u; i < n; i++)
+        out[i] = _rix_hash_hash_bytes_GEN(keys[i], key_bytes, mask);
+}
+
+static RIX_FORCE_INLINE void
+_rix_hash_hash_u32_n_GEN(const u32 *keys, unsigned n, u32 mask,
+                         union rix_hash_hash_u *out)
+{
+    for (unsigned i = 0u; i < n; i++)
+        out[i] = _rix_hash_hash_u32_GEN(keys[i], mask);
+}
+
+static RIX_FORCE_INLINE void
+_rix_hash_hash_u64_n_GEN(const u64 *keys, unsigned n, u32 mask,
+                         union rix_hash_hash_u *out)
+{
+    for (unsigned i = 0u; i < n; i++)
+        out[i] = _rix_hash_hash_u64_GEN(keys[i], mask);
+}
+
 /*===========================================================================
  * CRC32C (SSE4.2) hash implementations
  *===========================================================================*/
@@ -363,14 +469,150 @@ _rix_hash_hash_u64_CRC32(u64 key, u32 mask)
     return r;
 }
 
+
+/*
+ * Batch forms: pass 1 computes h0 for up to RIX_HASH_N_LANES keys, pass 2
+ * the first h1 candidate (seed ~h0) - no dependency between lanes inside a
+ * pass.  The rare bucket collision falls back to the scalar retry chain,
+ * which continues from the same seed as the single-key form.
+ */
+/* crc[l] = CRC32C(crc[l], keys[l][0 .. key_bytes)), lanes interleaved. */
+static RIX_FORCE_INLINE void
+_rix_hash_crc32_bytes_x(u32 *crc, const void * const *keys,
+                        size_t key_bytes, unsigned nl)
+{
+    size_t off = 0u;
+
+    for (; off + 8u <= key_bytes; off += 8u)
+        for (unsigned l = 0u; l < nl; l++) {
+            u64 w;
+            memcpy(&w, (const u8 *)keys[l] + off, 8u);
+            crc[l] = (u32)__builtin_ia32_crc32di((u64)crc[l], w);
+        }
+    if (off + 4u <= key_bytes) {
+        for (unsigned l = 0u; l < nl; l++) {
+            u32 w;
+            memcpy(&w, (const u8 *)keys[l] + off, 4u);
+            crc[l] = (u32)__builtin_ia32_crc32si(crc[l], w);
+        }
+        off += 4u;
+    }
+    if (off + 2u <= key_bytes) {
+        for (unsigned l = 0u; l < nl; l++) {
+            u16 w;
+            memcpy(&w, (const u8 *)keys[l] + off, 2u);
+            crc[l] = (u32)__builtin_ia32_crc32hi(crc[l], (unsigned short)w);
+        }
+        off += 2u;
+    }
+    if (off < key_bytes)
+        for (unsigned l = 0u; l < nl; l++)
+            crc[l] = (u32)__builtin_ia32_crc32qi(
+                crc[l], ((const u8 *)keys[l])[off]);
+}
+
+static RIX_FORCE_INLINE void
+_rix_hash_hash_bytes_n_CRC32(const void * const *keys, size_t key_bytes,
+                             unsigned n, u32 mask, union rix_hash_hash_u *out)
+{
+    for (unsigned b = 0u; b < n; b += RIX_HASH_N_LANES) {
+        unsigned nl = (n - b < RIX_HASH_N_LANES) ? n - b : RIX_HASH_N_LANES;
+        u32 h0[RIX_HASH_N_LANES], h1[RIX_HASH_N_LANES];
+
+        for (unsigned l = 0u; l < nl; l++)
+            h0[l] = 0u;
+        _rix_hash_crc32_bytes_x(h0, keys + b, key_bytes, nl);
+        for (unsigned l = 0u; l < nl; l++)
+            h1[l] = ~h0[l];
+        _rix_hash_crc32_bytes_x(h1, keys + b, key_bytes, nl);
+        for (unsigned l = 0u; l < nl; l++) {
+            u32 bk0 = h0[l] & mask;
+            if (RIX_UNLIKELY((h1[l] & mask) == bk0)) {
+                u32 seed = (u32)__builtin_ia32_crc32di((u64)~h0[l],
+                                                       (u64)h0[l]);
+                do {
+                    h1[l] = _rix_hash_crc32_bytes(seed, keys[b + l],
+                                                  key_bytes);
+                    seed  = (u32)__builtin_ia32_crc32di((u64)seed,
+                                                        (u64)h0[l]);
+                } while ((h1[l] & mask) == bk0);
+            }
+            out[b + l].val32[0] = h0[l];
+            out[b + l].val32[1] = h1[l];
+        }
+    }
+}
+
+static RIX_FORCE_INLINE void
+_rix_hash_hash_u32_n_CRC32(const u32 *keys, unsigned n, u32 mask,
+                           union rix_hash_hash_u *out)
+{
+    for (unsigned b = 0u; b < n; b += RIX_HASH_N_LANES) {
+        unsigned nl = (n - b < RIX_HASH_N_LANES) ? n - b : RIX_HASH_N_LANES;
+        u32 h0[RIX_HASH_N_LANES], h1[RIX_HASH_N_LANES];
+
+        for (unsigned l = 0u; l < nl; l++)
+            h0[l] = (u32)__builtin_ia32_crc32si(0u, keys[b + l]);
+        for (unsigned l = 0u; l < nl; l++)
+            h1[l] = (u32)__builtin_ia32_crc32si(~h0[l], keys[b + l]);
+        for (unsigned l = 0u; l < nl; l++) {
+            u32 key = keys[b + l];
+            u32 bk0 = h0[l] & mask;
+            if (RIX_UNLIKELY((h1[l] & mask) == bk0)) {
+                u32 seed = (u32)__builtin_ia32_crc32si(~h0[l], ~key);
+                do {
+                    h1[l] = (u32)__builtin_ia32_crc32si(seed, key);
+                    seed  = (u32)__builtin_ia32_crc32si(seed, ~key);
+                } while ((h1[l] & mask) == bk0);
+            }
+            out[b + l].val32[0] = h0[l];
+            out[b + l].val32[1] = h1[l];
+        }
+    }
+}
+
+static RIX_FORCE_INLINE void
+_rix_hash_hash_u64_n_CRC32(const u64 *keys, unsigned n, u32 mask,
+                           union rix_hash_hash_u *out)
+{
+    for (unsigned b = 0u; b < n; b += RIX_HASH_N_LANES) {
+        unsigned nl = (n - b < RIX_HASH_N_LANES) ? n - b : RIX_HASH_N_LANES;
+        u32 h0[RIX_HASH_N_LANES], h1[RIX_HASH_N_LANES];
+
+        for (unsigned l = 0u; l < nl; l++)
+            h0[l] = (u32)__builtin_ia32_crc32di(0ULL, keys[b + l]);
+        for (unsigned l = 0u; l < nl; l++)
+            h1[l] = (u32)__builtin_ia32_crc32di((u64)~h0[l], keys[b + l]);
+        for (unsigned l = 0u; l < nl; l++) {
+            u64 key = keys[b + l];
+            u32 bk0 = h0[l] & mask;
+            if (RIX_UNLIKELY((h1[l] & mask) == bk0)) {
+                u32 seed = (u32)__builtin_ia32_crc32di((u64)~h0[l], ~key);
+                do {
+                    h1[l] = (u32)__builtin_ia32_crc32di((u64)seed, key);
+                    seed  = (u32)__builtin_ia32_crc32di((u64)seed, ~key);
+                } while ((h1[l] & mask) == bk0);
+            }
+            out[b + l].val32[0] = h0[l];
+            out[b + l].val32[1] = h1[l];
+        }
+    }
+}
+
 /* GEN find + CRC32 hash: for SIMD=gen (scalar scan, hardware hash) */
 static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_GEN = {
     _rix_hash_find_u32x16_GEN,
     _rix_hash_find_u32x16_2_GEN,
     _rix_hash_find_u64x16_GEN,
+    _rix_hash_find_u16x16_GEN,
+    _rix_hash_find_u16x12_GEN,
+    _rix_hash_find_u8x16_GEN,
     _rix_hash_hash_bytes_CRC32,
     _rix_hash_hash_u32_CRC32,
     _rix_hash_hash_u64_CRC32,
+    _rix_hash_hash_bytes_n_CRC32,
+    _rix_hash_hash_u32_n_CRC32,
+    _rix_hash_hash_u64_n_CRC32,
 };
 
 #    else /* !(__x86_64__ && __SSE4_2__) */
@@ -380,9 +622,15 @@ static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_GEN = {
     _rix_hash_find_u32x16_GEN,
     _rix_hash_find_u32x16_2_GEN,
     _rix_hash_find_u64x16_GEN,
+    _rix_hash_find_u16x16_GEN,
+    _rix_hash_find_u16x12_GEN,
+    _rix_hash_find_u8x16_GEN,
     _rix_hash_hash_bytes_GEN,
     _rix_hash_hash_u32_GEN,
     _rix_hash_hash_u64_GEN,
+    _rix_hash_hash_bytes_n_GEN,
+    _rix_hash_hash_u32_n_GEN,
+    _rix_hash_hash_u64_n_GEN,
 };
 
 #    endif /* __x86_64__ && __SSE4_2__ */
@@ -392,6 +640,8 @@ static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_GEN = {
  *
  * find_u32x16: _mm_cmpeq_epi32 (SSE) - 4 elements/reg, 4 loads
  * find_u64x16: _mm_cmpeq_epi64 (SSE4.1) - 2 elements/reg, 8 loads
+ * find_u16x16: _mm_cmpeq_epi16 (SSE) - 8 elements/reg, 2 loads
+ * find_u16x12: _mm_cmpeq_epi16 (SSE) - 16-byte + 8-byte load
  *
  * Compiled when __SSE4_2__ is defined (SSE4.2 > SSE4.1 > SSE).
  * SSE is mandated by the x86_64 ABI; no CPUID check is needed at runtime.
@@ -479,20 +729,61 @@ _rix_hash_find_u64x16_SSE(const u64 *arr, u64 val)
            (m4 <<  8) | (m5 << 10) | (m6 << 12) | (m7 << 14);
 }
 
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u16x16_SSE(const u16 *arr, u16 val)
+{
+    __m128i vval = _mm_set1_epi16((short)val);
+    __m128i eq0  = _mm_cmpeq_epi16(
+        _mm_loadu_si128((const __m128i *)(const void *)(arr + 0)), vval);
+    __m128i eq1  = _mm_cmpeq_epi16(
+        _mm_loadu_si128((const __m128i *)(const void *)(arr + 8)), vval);
+    /* 0xffff / 0x0000 lanes saturate to 0xff / 0x00: one byte per tag */
+    return (u32)_mm_movemask_epi8(_mm_packs_epi16(eq0, eq1));
+}
+
+/* 8 tags + 4 tags: the movl load stops at the end of the array. */
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u16x12_SSE(const u16 *arr, u16 val)
+{
+    __m128i vval = _mm_set1_epi16((short)val);
+    __m128i eq0  = _mm_cmpeq_epi16(
+        _mm_loadu_si128((const __m128i *)(const void *)(arr + 0)), vval);
+    __m128i eq1  = _mm_cmpeq_epi16(
+        _mm_loadl_epi64((const __m128i *)(const void *)(arr + 8)), vval);
+    /* lanes 12..15 were zero-filled by the load: drop them */
+    return (u32)_mm_movemask_epi8(_mm_packs_epi16(eq0, eq1)) & 0x0fffu;
+}
+
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u8x16_SSE(const u8 *arr, u8 val)
+{
+    __m128i va = _mm_loadu_si128((const __m128i *)(const void *)arr);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(va, _mm_set1_epi8((char)val)));
+}
+
 /* SSE find + CRC32 hash (SSE4.2 is our baseline, so CRC32 always available) */
 static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_SSE = {
     _rix_hash_find_u32x16_SSE,
     _rix_hash_find_u32x16_2_SSE,
     _rix_hash_find_u64x16_SSE,
+    _rix_hash_find_u16x16_SSE,
+    _rix_hash_find_u16x12_SSE,
+    _rix_hash_find_u8x16_SSE,
     _rix_hash_hash_bytes_CRC32,
     _rix_hash_hash_u32_CRC32,
     _rix_hash_hash_u64_CRC32,
+    _rix_hash_hash_bytes_n_CRC32,
+    _rix_hash_hash_u32_n_CRC32,
+    _rix_hash_hash_u64_n_CRC32,
 };
 
 #    endif /* __x86_64__ && __SSE4_2__ */
 
 /*===========================================================================
  * AVX2 find implementations
+ *
+ * find_u8x16 reuses the SSE kernel: 16 bytes fill exactly one XMM register.
+ * find_u16x12 reuses it too: a YMM load would read past the 24 bytes.
  *===========================================================================*/
 #    if defined(__x86_64__) && defined(__AVX2__)
 
@@ -558,20 +849,41 @@ _rix_hash_find_u64x16_AVX2(const u64 *arr, u64 val)
     return m0 | (m1 << 4) | (m2 << 8) | (m3 << 12);
 }
 
+static RIX_FORCE_INLINE u32
+_rix_hash_find_u16x16_AVX2(const u16 *arr, u16 val)
+{
+    __m256i vval = _mm256_set1_epi16((short)val);
+    __m256i va   = _mm256_loadu_si256((const __m256i *)(const void *)arr);
+    __m256i eq   = _mm256_cmpeq_epi16(va, vval);
+    /* packs works per 128-bit lane: bytes [0..7 | dup | 8..15 | dup] */
+    u32 m = (u32)_mm256_movemask_epi8(_mm256_packs_epi16(eq, eq));
+    return (m & 0xffu) | ((m >> 8) & 0xff00u);
+}
+
 /* AVX2 find + CRC32 hash (AVX2 always implies SSE4.2) */
 static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_AVX2 = {
     _rix_hash_find_u32x16_AVX2,
     _rix_hash_find_u32x16_2_AVX2,
     _rix_hash_find_u64x16_AVX2,
+    _rix_hash_find_u16x16_AVX2,
+    _rix_hash_find_u16x12_SSE,
+    _rix_hash_find_u8x16_SSE,
     _rix_hash_hash_bytes_CRC32,
     _rix_hash_hash_u32_CRC32,
     _rix_hash_hash_u64_CRC32,
+    _rix_hash_hash_bytes_n_CRC32,
+    _rix_hash_hash_u32_n_CRC32,
+    _rix_hash_hash_u64_n_CRC32,
 };
 
 #    endif /* __x86_64__ && __AVX2__ */
 
 /*===========================================================================
  * AVX-512 find implementations
+ *
+ * find_u16x16 keeps the AVX2 kernel: a 16-bit mask compare needs AVX512BW,
+ * and 16 tags fit one YMM register anyway.  find_u8x16 (16 bytes, one XMM
+ * register) and find_u16x12 keep the SSE kernels for the same reason.
  *===========================================================================*/
 #    if defined(__x86_64__) && defined(__AVX512F__)
 
@@ -611,19 +923,523 @@ static RIX_UNUSED const struct rix_hash_arch_s _rix_hash_arch_AVX512 = {
     _rix_hash_find_u32x16_AVX512,
     _rix_hash_find_u32x16_2_AVX512,
     _rix_hash_find_u64x16_AVX512,
+    _rix_hash_find_u16x16_AVX2,
+    _rix_hash_find_u16x12_SSE,
+    _rix_hash_find_u8x16_SSE,
     _rix_hash_hash_bytes_CRC32,
     _rix_hash_hash_u32_CRC32,
     _rix_hash_hash_u64_CRC32,
+    _rix_hash_hash_bytes_n_CRC32,
+    _rix_hash_hash_u32_n_CRC32,
+    _rix_hash_hash_u64_n_CRC32,
 };
 
 #    endif /* __x86_64__ && __AVX512F__ */
 
+/*---------------------------------------------------------------------------
+ * RIX_HASH_ARCH_DIRECT - compile-time binding (define before any include).
+ *
+ * rix_hash_arch becomes the address of the best table this TU is compiled
+ * for (-mavx512f > -mavx2 > -msse4.2 > GEN) instead of a per-TU pointer.
+ * Every rix_hash_arch->op() call site then loads from a static const
+ * table, which the compiler folds into a direct, inlinable call: no
+ * indirect call per find / hash, and no rix_hash_arch_init() to forget.
+ *
+ * The compile flags become the CPU contract (a -mavx2 TU already assumes
+ * AVX2 anyway); pick the object per CPU at a higher level, as
+ * samples/fcache does with its _gen / _sse / _avx2 / _avx512 builds.
+ * rix_hash_arch_init() is a no-op in this mode.
+ *
+ * GNU ifunc / target_clones were not used: both resolve through a
+ * GOT / PLT slot, i.e. still an indirect call that cannot be inlined.
+ *---------------------------------------------------------------------------*/
+#    if defined(RIX_HASH_ARCH_DIRECT)
+#      if defined(__x86_64__) && defined(__AVX512F__)
+#        define rix_hash_arch (&_rix_hash_arch_AVX512)
+#      elif defined(__x86_64__) && defined(__AVX2__)
+#        define rix_hash_arch (&_rix_hash_arch_AVX2)
+#      elif defined(__x86_64__) && defined(__SSE4_2__)
+#        define rix_hash_arch (&_rix_hash_arch_SSE)
+#      else
+#        define rix_hash_arch (&_rix_hash_arch_GEN)
+#      endif
+#    endif
+
 static RIX_FORCE_INLINE union rix_hash_hash_u
 rix_hash_hash_bytes_fast(const void *key, size_t key_bytes, u32 mask)
 {
     return rix_hash_arch->hash_bytes(key, key_bytes, mask);
 }
 
+static RIX_FORCE_INLINE void
+rix_hash_hash_bytes_n_fast(const void * const *keys, size_t key_bytes,
+                           unsigned n, u32 mask, union rix_hash_hash_u *out)
+{
+    rix_hash_arch->hash_bytes_n(keys, key_bytes, n, mask, out);
+}
+
+/*---------------------------------------------------------------------------
+ * rix_hash_hash_bytes_keyed - keyed dual hash (per-table seed).
+ * rix_hash_hash_bytes_aes   - the same with seed 0, for long keys.
+ *
+ * Same contract as hash_bytes: (val32[0] & mask) != (val32[1] & mask).
+ *
+ * With AES-NI (-maes) two 128-bit lanes start from the seed and absorb
+ * the key 16 bytes per step, lane 0 with aesenc and lane 1 with aesdec,
+ * so h0 and h1 come out of one pass over the key and the two round
+ * chains overlap (44 B key: 5 rounds per lane instead of two serial
+ * 6-deep crc32 chains).  Without AES-NI the keyed form falls back to a
+ * seeded 64-bit multiply-xorshift over 8-byte words, and the unkeyed
+ * form runs the same AES rounds in software (slow, but the same table
+ * layout as the AES-NI build).
+ *
+ * CRC32C is linear in its initial value, so seeding it does not stop
+ * chosen-key bucket collisions; these keyed forms do (they are not a
+ * MAC, only enough to make bucket targeting impractical without the
+ * seed).  A bk0 == bk1 collision re-mixes h1 only, as in the GEN hash.
+ *
+ * The bucket layout differs from the CRC32C hash; a table must be built
+ * and probed with the same hash and seed.
+ *---------------------------------------------------------------------------*/
+#    ifndef RIX_HASH_AES_SEED0
+#      define RIX_HASH_AES_SEED0 0x243f6a8885a308d3ULL
+#    endif
+#    ifndef RIX_HASH_AES_SEED1
+#      define RIX_HASH_AES_SEED1 0x13198a2e03707344ULL
+#    endif
+
+static RIX_FORCE_INLINE u64
+_rix_hash_mix64(u64 x)
+{
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+    x ^= x >> 32;
+    return x;
+}
+
+/*
+ * Software AES rounds, bit-identical to aesenc / aesdec (FIPS-197 S-box).
+ * State and round key are 16 bytes in _mm_loadu_si128() order.  Only the
+ * build without AES-NI uses them, so rix_hash_hash_bytes_aes() produces
+ * the same table layout with and without -maes.
+ */
+static const u8 _rix_hash_aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+    0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+    0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+    0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+    0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+    0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+    0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+    0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+    0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+    0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+    0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+    0xb0, 0x54, 0xbb, 0x16
+};
+
+static const u8 _rix_hash_aes_isbox[256] = {
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e,
+    0x81, 0xf3, 0xd7, 0xfb, 0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87,
+    0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb, 0x54, 0x7b, 0x94, 0x32,
+    0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49,
+    0x6d, 0x8b, 0xd1, 0x25, 0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16,
+    0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92, 0x6c, 0x70, 0x48, 0x50,
+    0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05,
+    0xb8, 0xb3, 0x45, 0x06, 0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02,
+    0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b, 0x3a, 0x91, 0x11, 0x41,
+    0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8,
+    0x1c, 0x75, 0xdf, 0x6e, 0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89,
+    0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b, 0xfc, 0x56, 0x3e, 0x4b,
+    0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59,
+    0x27, 0x80, 0xec, 0x5f, 0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d,
+    0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef, 0xa0, 0xe0, 0x3b, 0x4d,
+    0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63,
+    0x55, 0x21, 0x0c, 0x7d
+};
+
+static RIX_FORCE_INLINE u8
+_rix_hash_aes_xt(u8 x)
+{
+    return (u8)((x << 1) ^ ((x >> 7) * 0x1bu));
+}
+
+/* ShiftRows, SubBytes, MixColumns, AddRoundKey */
+static RIX_FORCE_INLINE void
+_rix_hash_aesenc_soft(u8 *st, const u8 *rk)
+{
+    u8 t[16];
+
+    for (unsigned c = 0u; c < 4u; c++)
+        for (unsigned r = 0u; r < 4u; r++)
+            t[4u * c + r] = _rix_hash_aes_sbox[st[4u * ((c + r) & 3u) + r]];
+    for (unsigned c = 0u; c < 4u; c++) {
+        const u8 *a = &t[4u * c];
+        u8 x = (u8)(a[0] ^ a[1] ^ a[2] ^ a[3]);
+
+        for (unsigned r = 0u; r < 4u; r++) {
+            u8 m = (u8)(a[r] ^ a[(r + 1u) & 3u]);
+
+            st[4u * c + r] = (u8)(a[r] ^ x ^ _rix_hash_aes_xt(m) ^
+                                  rk[4u * c + r]);
+        }
+    }
+}
+
+/* InvShiftRows, InvSubBytes, InvMixColumns, AddRoundKey */
+static RIX_FORCE_INLINE void
+_rix_hash_aesdec_soft(u8 *st, const u8 *rk)
+{
+    u8 t[16];
+
+    for (unsigned c = 0u; c < 4u; c++)
+        for (unsigned r = 0u; r < 4u; r++)
+            t[4u * c + r] = _rix_hash_aes_isbox[st[4u * ((c - r) & 3u) + r]];
+    for (unsigned c = 0u; c < 4u; c++) {
+        u8 *a = &t[4u * c];
+        u8 u  = _rix_hash_aes_xt(_rix_hash_aes_xt((u8)(a[0] ^ a[2])));
+        u8 v  = _rix_hash_aes_xt(_rix_hash_aes_xt((u8)(a[1] ^ a[3])));
+        u8 x;
+
+        a[0] ^= u;
+        a[1] ^= v;
+        a[2] ^= u;
+        a[3] ^= v;
+        x = (u8)(a[0] ^ a[1] ^ a[2] ^ a[3]);
+        for (unsigned r = 0u; r < 4u; r++) {
+            u8 m = (u8)(a[r] ^ a[(r + 1u) & 3u]);
+
+            st[4u * c + r] = (u8)(a[r] ^ x ^ _rix_hash_aes_xt(m) ^
+                                  rk[4u * c + r]);
+        }
+    }
+}
+
+/* The AES-NI path of rix_hash_hash_bytes_aes(), one byte lane at a time. */
+static RIX_UNUSED union rix_hash_hash_u
+_rix_hash_hash_bytes_aes_soft(const void *key, size_t key_bytes, u32 mask)
+{
+    const u8 *p = (const u8 *)key;
+    union rix_hash_hash_u r;
+    u8 s0[16], s1[16], a[16], b[16], blk[16];
+    u64 w;
+    u32 fa[4], fb[4];
+    size_t i;
+
+    w = RIX_HASH_AES_SEED0;
+    memcpy(s0, &w, 8u);
+    w = (u64)key_bytes;
+    memcpy(s0 + 8, &w, 8u);
+    w = RIX_HASH_AES_SEED1;
+    memcpy(s1, &w, 8u);
+    w = (u64)key_bytes;
+    memcpy(s1 + 8, &w, 8u);
+    memcpy(a, s0, 16u);
+    memcpy(b, s1, 16u);
+    for (i = 0u; i + 16u <= key_bytes; i += 16u) {
+        _rix_hash_aesenc_soft(a, p + i);
+        _rix_hash_aesdec_soft(b, p + i);
+    }
+    if (i < key_bytes) {
+        memset(blk, 0, sizeof(blk));
+        memcpy(blk, p + i, key_bytes - i);
+        _rix_hash_aesenc_soft(a, blk);
+        _rix_hash_aesdec_soft(b, blk);
+    }
+    _rix_hash_aesenc_soft(a, s1);
+    _rix_hash_aesenc_soft(a, s0);
+    _rix_hash_aesdec_soft(b, s0);
+    _rix_hash_aesdec_soft(b, s1);
+
+    /* fold 128 -> 32 bits */
+    memcpy(fa, a, 16u);
+    memcpy(fb, b, 16u);
+    r.val32[0] = fa[0] ^ fa[1] ^ fa[2] ^ fa[3];
+    r.val32[1] = fb[0] ^ fb[1] ^ fb[2] ^ fb[3];
+    {
+        u32 bk0 = r.val32[0] & mask;
+        u32 inc = 1u;
+
+        while ((r.val32[1] & mask) == bk0) {
+            r.val32[1] = (r.val32[1] ^ inc) * 2246822519u;
+            inc++;
+        }
+    }
+    return r;
+}
+
+static RIX_FORCE_INLINE union rix_hash_hash_u
+rix_hash_hash_bytes_keyed(const void *key, size_t key_bytes, u32 mask,
+                          u64 seed)
+{
+    const u8 *p = (const u8 *)key;
+    union rix_hash_hash_u r;
+    size_t i;
+#    if defined(__x86_64__) && defined(__AES__)
+    const __m128i s0 = _mm_set_epi64x((long long)key_bytes,
+                                      (long long)(RIX_HASH_AES_SEED0 ^ seed));
+    const __m128i s1 = _mm_set_epi64x((long long)key_bytes,
+                                      (long long)(RIX_HASH_AES_SEED1 ^ seed));
+    __m128i a = s0, b = s1, blk;
+
+    for (i = 0u; i + 16u <= key_bytes; i += 16u) {
+        blk = _mm_loadu_si128((const __m128i *)(const void *)(p + i));
+        a   = _mm_aesenc_si128(a, blk);
+        b   = _mm_aesdec_si128(b, blk);
+    }
+    if (i < key_bytes) {
+        u8 tail[16] = { 0 };
+
+        memcpy(tail, p + i, key_bytes - i);
+        blk = _mm_loadu_si128((const __m128i *)(const void *)tail);
+        a   = _mm_aesenc_si128(a, blk);
+        b   = _mm_aesdec_si128(b, blk);
+    }
+    a = _mm_aesenc_si128(_mm_aesenc_si128(a, s1), s0);
+    b = _mm_aesdec_si128(_mm_aesdec_si128(b, s0), s1);
+
+    /* fold 128 -> 32 bits */
+    a = _mm_xor_si128(a, _mm_shuffle_epi32(a, 0x4e));
+    a = _mm_xor_si128(a, _mm_shuffle_epi32(a, 0xb1));
+    b = _mm_xor_si128(b, _mm_shuffle_epi32(b, 0x4e));
+    b = _mm_xor_si128(b, _mm_shuffle_epi32(b, 0xb1));
+    r.val32[0] = (u32)_mm_cvtsi128_si32(a);
+    r.val32[1] = (u32)_mm_cvtsi128_si32(b);
+#    else
+    u64 a = RIX_HASH_AES_SEED0 ^ seed ^ (u64)key_bytes;
+    u64 b = RIX_HASH_AES_SEED1 ^ (seed << 32 | seed >> 32);
+    u64 w;
+
+    for (i = 0u; i + 8u <= key_bytes; i += 8u) {
+        memcpy(&w, p + i, 8u);
+        a = _rix_hash_mix64(a ^ w);
+        b = _rix_hash_mix64(b + w);
+    }
+    if (i < key_bytes) {
+        w = 0u;
+        memcpy(&w, p + i, key_bytes - i);
+        a = _rix_hash_mix64(a ^ w);
+        b = _rix_hash_mix64(b + w);
+    }
+    a = _rix_hash_mix64(a ^ seed);
+    b = _rix_hash_mix64(b ^ ~seed);
+    r.val32[0] = (u32)(a ^ (a >> 32));
+    r.val32[1] = (u32)(b ^ (b >> 32));
+#    endif
+    {
+        u32 bk0 = r.val32[0] & mask;
+        u32 inc = 1u;
+
+        while ((r.val32[1] & mask) == bk0) {
+            r.val32[1] = (r.val32[1] ^ inc) * 2246822519u;
+            inc++;
+        }
+    }
+    return r;
+}
+
+static RIX_FORCE_INLINE union rix_hash_hash_u
+rix_hash_hash_bytes_aes(const void *key, size_t key_bytes, u32 mask)
+{
+#    if defined(__x86_64__) && defined(__AES__)
+    return rix_hash_hash_bytes_keyed(key, key_bytes, mask, 0u);
+#    else
+    return _rix_hash_hash_bytes_aes_soft(key, key_bytes, mask);
+#    endif
+}
+
+/*
+ * rix_hash_hash_bytes_aes_n - batch form of rix_hash_hash_bytes_aes().
+ *
+ * The round chains of RIX_HASH_N_LANES keys advance one 16-byte block at
+ * a time across all lanes, so the aesenc / aesdec latency of one key is
+ * hidden behind the rounds of the others.  Bit-identical to the
+ * single-key form, with or without AES-NI.
+ */
+static RIX_FORCE_INLINE void
+rix_hash_hash_bytes_aes_n(const void * const *keys, size_t key_bytes,
+                          unsigned n, u32 mask, union rix_hash_hash_u *out)
+{
+#    if defined(__x86_64__) && defined(__AES__)
+    const __m128i s0 = _mm_set_epi64x((long long)key_bytes,
+                                      (long long)RIX_HASH_AES_SEED0);
+    const __m128i s1 = _mm_set_epi64x((long long)key_bytes,
+                                      (long long)RIX_HASH_AES_SEED1);
+
+    for (unsigned b = 0u; b < n; b += RIX_HASH_N_LANES) {
+        unsigned nl = (n - b < RIX_HASH_N_LANES) ? n - b : RIX_HASH_N_LANES;
+        __m128i a[RIX_HASH_N_LANES], d[RIX_HASH_N_LANES], blk;
+        size_t i;
+
+        for (unsigned l = 0u; l < nl; l++) {
+            a[l] = s0;
+            d[l] = s1;
+        }
+        for (i = 0u; i + 16u <= key_bytes; i += 16u)
+            for (unsigned l = 0u; l < nl; l++) {
+                blk  = _mm_loadu_si128((const __m128i *)(const void *)
+                                       ((const u8 *)keys[b + l] + i));
+                a[l] = _mm_aesenc_si128(a[l], blk);
+                d[l] = _mm_aesdec_si128(d[l], blk);
+            }
+        if (i < key_bytes)
+            for (unsigned l = 0u; l < nl; l++) {
+                u8 tail[16] = { 0 };
+
+                memcpy(tail, (const u8 *)keys[b + l] + i, key_bytes - i);
+                blk  = _mm_loadu_si128((const __m128i *)(const void *)tail);
+                a[l] = _mm_aesenc_si128(a[l], blk);
+                d[l] = _mm_aesdec_si128(d[l], blk);
+            }
+        for (unsigned l = 0u; l < nl; l++) {
+            __m128i x = _mm_aesenc_si128(_mm_aesenc_si128(a[l], s1), s0);
+            __m128i y = _mm_aesdec_si128(_mm_aesdec_si128(d[l], s0), s1);
+            u32 h0, h1, bk0, inc = 1u;
+
+            x  = _mm_xor_si128(x, _mm_shuffle_epi32(x, 0x4e));
+            x  = _mm_xor_si128(x, _mm_shuffle_epi32(x, 0xb1));
+            y  = _mm_xor_si128(y, _mm_shuffle_epi32(y, 0x4e));
+            y  = _mm_xor_si128(y, _mm_shuffle_epi32(y, 0xb1));
+            h0 = (u32)_mm_cvtsi128_si32(x);
+            h1 = (u32)_mm_cvtsi128_si32(y);
+            bk0 = h0 & mask;
+            while ((h1 & mask) == bk0) {
+                h1 = (h1 ^ inc) * 2246822519u;
+                inc++;
+            }
+            out[b + l].val32[0] = h0;
+            out[b + l].val32[1] = h1;
+        }
+    }
+#    else
+    for (unsigned i = 0u; i < n; i++)
+        out[i] = _rix_hash_hash_bytes_aes_soft(keys[i], key_bytes, mask);
+#    endif
+}
+
+/*---------------------------------------------------------------------------
+ * rix_hash_hash_from_u32 - dual hash from a hash the caller already has.
+ *
+ * Typically the RSS hash the NIC wrote into the Rx descriptor: the key is
+ * not read at all.  h goes through a bijective mix first, because RSS
+ * picks the queue from the low bits of the hash, so every hash one queue
+ * sees shares those bits and would land in a fraction of the buckets.
+ * h1 is derived from the mixed h0 with the same bk0 != bk1 rule as the
+ * GEN hash.  Keys with equal h share both buckets and the fingerprint;
+ * only the key compare separates them.
+ *
+ * The bucket layout differs from every key-based hash; a table must be
+ * built and probed with hashes from the same source.
+ *---------------------------------------------------------------------------*/
+static RIX_FORCE_INLINE u32
+_rix_hash_from_u32_h1(u32 h0, u32 mask)
+{
+    u32 h1 = (h0 ^ 0x5bd1e995u) * 2246822519u;
+    u32 inc = 1u;
+
+    while ((h1 & mask) == (h0 & mask)) {
+        h1 = (h1 ^ inc) * 2246822519u;
+        inc++;
+    }
+    return h1;
+}
+
+static RIX_FORCE_INLINE union rix_hash_hash_u
+rix_hash_hash_from_u32(u32 h, u32 mask)
+{
+    union rix_hash_hash_u r;
+
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    r.val32[0] = h;
+    r.val32[1] = _rix_hash_from_u32_h1(h, mask);
+    return r;
+}
+
+/*---------------------------------------------------------------------------
+ * rix_hash_from_u32_is_bk1 - does a rix_hash_hash_from_u32() entry sit in
+ * its alternate bucket?
+ *
+ * cur is the hash of the bucket the entry is in (the slot variant's
+ * hash_field) and alt = cur ^ fingerprint the hash of the other one.  h1
+ * is a function of h0, so the pair alone says which of the two is the
+ * primary; neither the key nor the original hash is needed.  mask must
+ * be the one the hashes were expanded with.
+ *---------------------------------------------------------------------------*/
+static RIX_FORCE_INLINE int
+rix_hash_from_u32_is_bk1(u32 cur, u32 alt, u32 mask)
+{
+    return _rix_hash_from_u32_h1(alt, mask) == cur;
+}
+
+/*---------------------------------------------------------------------------
+ * rix_hash_toeplitz - software RSS (Toeplitz) hash.
+ *
+ * Computes the hash a NIC computes for RSS over data[0..len-1] (the
+ * tuple in network byte order: src addr, dst addr, then src port, dst
+ * port for the 4-tuple types) with rss_key, which must be at least
+ * len + 4 bytes (the usual 40-byte key covers IPv6 + ports).  Use it to
+ * hash keys that did not come with a NIC hash (control-plane inserts,
+ * software Rx) so they meet NIC-hashed lookups in the same buckets, or
+ * to compute which queue a flow will be steered to.
+ *
+ * Bit-serial, one XOR per set input bit: a slow path, not a substitute
+ * for CRC32C on keys that have no NIC hash at all.
+ *
+ * RIX_HASH_RSS_KEY_DEFAULT is the key from the Microsoft RSS spec, the
+ * default of many NIC drivers.
+ *---------------------------------------------------------------------------*/
+#    define RIX_HASH_RSS_KEY_DEFAULT                                          \
+    {                                                                         \
+        0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,                       \
+        0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,                       \
+        0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,                       \
+        0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,                       \
+        0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,                       \
+    }
+#    define RIX_HASH_RSS_KEY_LEN 40u
+
+static inline u32
+rix_hash_toeplitz(const u8 *rss_key, const void *data, size_t len)
+{
+    const u8 *p = (const u8 *)data;
+    /* the 32 key bits lined up with the next input bit */
+    u32 win = (u32)rss_key[0] << 24 | (u32)rss_key[1] << 16 |
+              (u32)rss_key[2] << 8 | (u32)rss_key[3];
+    u32 h = 0u;
+
+    for (size_t i = 0u; i < len; i++) {
+        u32 next = rss_key[i + 4u];
+
+        for (unsigned b = 0u; b < 8u; b++) {
+            if (p[i] & (0x80u >> b))
+                h ^= win;
+            win = win << 1 | ((next >> (7u - b)) & 1u);
+        }
+    }
+    return h;
+}
+
 /*---------------------------------------------------------------------------
  * rix_hash_arch_init - enable the best dispatch level for this source file.
  *
@@ -645,7 +1461,9 @@ rix_hash_hash_bytes_fast(const void *key, size_t key_bytes, u32 mask)
 static RIX_FORCE_INLINE void
 rix_hash_arch_init(u32 enable)
 {
-#    if defined(__x86_64__)
+#    if defined(RIX_HASH_ARCH_DIRECT)
+    (void)enable; /* bound at compile time */
+#    elif defined(__x86_64__)
     rix_hash_arch = &_rix_hash_arch_GEN; /* per-TU fallback */
 
     if (!enable)
@@ -64,7 +64,8 @@ struct rix_hash_find_ctx_s {
     u32                  fp;              /*  4B  offset 32 */
     u32                  fp_hits[2];      /*  8B  offset 36 */
     u32                  empties[2];      /*  8B  offset 44 */
-    /* 52B + 4B tail padding = 56B (8B aligned) */
+    u32                  seq[2];          /*  8B  offset 52 */
+    /* 60B + 4B tail padding = 64B (one cache line) */
 };
 
 /*---------------------------------------------------------------------------
@@ -144,6 +145,165 @@ _rix_hash_prefetch_bucket(const struct rix_hash_bucket_s *bucket)
     rix_hash_prefetch_bucket(bucket);
 }
 
+/*===========================================================================
+ * Per-bucket sequence counters (single-writer / multi-reader mode)
+ *
+ * The *_seq_* functions generated by RIX_HASH_GENERATE_SLOT take an extra
+ * caller-owned array  u32 seq[nb_bk]  (zero-initialised, placed next to
+ * the bucket array; it holds no pointers, so it can live in shared memory).
+ *
+ * Writer (exactly one thread):
+ *   every bucket modification -- insert, each flipflop step of a kickout,
+ *   remove_at -- is bracketed by write_begin / write_end on the buckets it
+ *   touches.  The counter is odd while the bucket is being modified.
+ *   A flipflop brackets both the source and the destination bucket, so a
+ *   reader can never observe an entry that is in neither bucket.
+ *
+ * Readers (any number of threads):
+ *   snapshot seq[bk0] and seq[bk1], scan both buckets, then re-check.
+ *   A lookup is retried only if a snapshot was odd or a counter moved.
+ *
+ * Node reclamation is the caller's responsibility: a node returned to a
+ * reader may be removed and reused by the writer afterwards (use an epoch
+ * or quiescent-state scheme before recycling pool entries).
+ *===========================================================================*/
+static RIX_FORCE_INLINE void
+rix_hash_cpu_relax(void)
+{
+#  if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#  elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#  else
+    __asm__ __volatile__("" ::: "memory");
+#  endif
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_seq_write_begin(u32 *seq, unsigned bk)
+{
+    __atomic_store_n(&seq[bk], seq[bk] + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_seq_write_end(u32 *seq, unsigned bk)
+{
+    __atomic_store_n(&seq[bk], seq[bk] + 1u, __ATOMIC_RELEASE);
+}
+
+/* Snapshot a counter without waiting (may be odd; retry check fails). */
+static RIX_FORCE_INLINE u32
+rix_hash_seq_snapshot(const u32 *seq, unsigned bk)
+{
+    return __atomic_load_n(&seq[bk], __ATOMIC_ACQUIRE);
+}
+
+/* Wait until the bucket is not being written, then snapshot it. */
+static RIX_FORCE_INLINE u32
+rix_hash_seq_read_begin(const u32 *seq, unsigned bk)
+{
+    u32 v;
+    while ((v = rix_hash_seq_snapshot(seq, bk)) & 1u)
+        rix_hash_cpu_relax();
+    return v;
+}
+
+/* Non-zero if data read under snapshot v may be inconsistent. */
+static RIX_FORCE_INLINE int
+rix_hash_seq_read_retry(const u32 *seq, unsigned bk, u32 v)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return ((v & 1u) | (__atomic_load_n(&seq[bk], __ATOMIC_RELAXED) ^ v))
+           != 0u;
+}
+
+/* Non-zero if data read under snapshots v0/v1 may be inconsistent. */
+static RIX_FORCE_INLINE int
+rix_hash_seq_read_retry2(const u32 *seq,
+                         unsigned bk0, u32 v0,
+                         unsigned bk1, u32 v1)
+{
+    u32 c0, c1;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    c0 = __atomic_load_n(&seq[bk0], __ATOMIC_RELAXED);
+    c1 = __atomic_load_n(&seq[bk1], __ATOMIC_RELAXED);
+    return (((v0 | v1) & 1u) | (c0 ^ v0) | (c1 ^ v1)) != 0u;
+}
+
+/*---------------------------------------------------------------------------
+ * Multi-writer bucket locks (name_mt_* in rix_hash32.h / rix_hash64.h)
+ *
+ * The same u32 word doubles as a bucket spinlock: a writer claims it with
+ * CAS even -> odd and releases it with write_end (odd -> even), so readers
+ * keep using the lock-free snapshot / retry protocol above.  Bucket pairs
+ * are always locked in ascending bucket order and no writer holds a lock
+ * while acquiring another pair, so writers cannot deadlock.
+ *---------------------------------------------------------------------------*/
+#  ifndef RIX_HASH_MT_INSERT_RETRY
+#    define RIX_HASH_MT_INSERT_RETRY 8
+#  endif
+
+static RIX_FORCE_INLINE void
+rix_hash_seq_lock(u32 *seq, unsigned bk)
+{
+    for (;;) {
+        u32 v = __atomic_load_n(&seq[bk], __ATOMIC_RELAXED);
+        if (!(v & 1u) &&
+            __atomic_compare_exchange_n(&seq[bk], &v, v + 1u, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return;
+        }
+        rix_hash_cpu_relax();
+    }
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_seq_unlock(u32 *seq, unsigned bk)
+{
+    rix_hash_seq_write_end(seq, bk);
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_seq_lock2(u32 *seq, unsigned bk0, unsigned bk1)
+{
+    if (bk0 > bk1) {
+        unsigned t = bk0;
+        bk0 = bk1;
+        bk1 = t;
+    }
+    rix_hash_seq_lock(seq, bk0);
+    if (bk1 != bk0)
+        rix_hash_seq_lock(seq, bk1);
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_seq_unlock2(u32 *seq, unsigned bk0, unsigned bk1)
+{
+    rix_hash_seq_unlock(seq, bk0);
+    if (bk1 != bk0)
+        rix_hash_seq_unlock(seq, bk1);
+}
+
+/*---------------------------------------------------------------------------
+ * Private aliases -- writer side; seq == NULL means single-thread mode and
+ * compiles away when the caller passes a constant NULL.
+ *---------------------------------------------------------------------------*/
+static RIX_FORCE_INLINE void
+_rix_hash_seq_write_begin(u32 *seq, unsigned bk)
+{
+    if (seq)
+        rix_hash_seq_write_begin(seq, bk);
+}
+
+static RIX_FORCE_INLINE void
+_rix_hash_seq_write_end(u32 *seq, unsigned bk)
+{
+    if (seq)
+        rix_hash_seq_write_end(seq, bk);
+}
+
 /*===========================================================================
  * Internal bucket-index arithmetic helpers
  *===========================================================================*/
@@ -188,6 +348,257 @@ _rix_hash_buckets(const union rix_hash_hash_u h, unsigned mask,
     rix_hash_buckets(h, mask, bk0_out, bk1_out, fp_out);
 }
 
+/*===========================================================================
+ * Breadth-first cuckoo path search (name_kickout_bfs)
+ *
+ * When both candidate buckets are full, insert searches for the shortest
+ * displacement path instead of recursing depth-first:
+ *
+ *   level 0: bk0, bk1                      (known full)
+ *   level 1: alt bucket of every occupant  (prefetched as it is queued)
+ *   level 2: ...                           up to RIX_HASH_FOLLOW_DEPTH moves
+ *
+ * A whole level is queued (and its buckets prefetched) before any of them
+ * is scanned for a free slot, so the cold misses of one level overlap
+ * instead of being taken one dependent miss at a time.  The first bucket
+ * found with a free slot ends the search; entries are then shifted
+ * backwards along the path, leaf first, so every intermediate state is a
+ * valid table and each move is a single entry copy.
+ *
+ * A bucket is never queued twice on the same path, which keeps the
+ * backwards moves independent of each other.  The search is bounded by
+ * RIX_HASH_BFS_QUEUE buckets (8 bytes each, on the stack).
+ *
+ * bk0 and bk1 queue the alt bucket of every occupant; deeper buckets
+ * queue only RIX_HASH_BFS_FANOUT of theirs, starting at a different slot
+ * per node.  With fan-out 16 at every level the queue would be full
+ * halfway through level 2; capped, the default queue holds all levels
+ * up to RIX_HASH_FOLLOW_DEPTH:  2 + 32 + 64 + 128 + 256 = 482 buckets.
+ *
+ * RIX_HASH_KICKOUT_BFS=0 restores the recursive DFS kickout.
+ *===========================================================================*/
+#  ifndef RIX_HASH_KICKOUT_BFS
+#    define RIX_HASH_KICKOUT_BFS 1
+#  endif
+
+#  ifndef RIX_HASH_BFS_FANOUT
+#    define RIX_HASH_BFS_FANOUT 2
+#  endif
+
+#  ifndef RIX_HASH_BFS_QUEUE
+#    define RIX_HASH_BFS_QUEUE 512
+#  endif
+
+#  define RIX_HASH_BFS_ROOT 0xffffu
+
+struct rix_hash_bfs_s {
+    u32 bk;      /* bucket index                                   */
+    u16 parent;  /* queue index of the parent, RIX_HASH_BFS_ROOT   */
+    u8  slot;    /* slot in the parent whose occupant moves here   */
+    u8  depth;   /* moves from the root                            */
+};
+
+/* Number of children node i may queue. */
+static RIX_FORCE_INLINE unsigned
+_rix_hash_bfs_fanout(const struct rix_hash_bfs_s *q, unsigned i)
+{
+    return q[i].depth ? RIX_HASH_BFS_FANOUT : RIX_HASH_BUCKET_ENTRY_SZ;
+}
+
+/* n-th slot visited when node i is expanded. */
+static RIX_FORCE_INLINE unsigned
+_rix_hash_bfs_slot(unsigned i, unsigned n, unsigned nb_slots)
+{
+    return (i + n) % nb_slots;
+}
+
+/* Non-zero if bk is node i or one of its ancestors. */
+static RIX_FORCE_INLINE int
+_rix_hash_bfs_on_path(const struct rix_hash_bfs_s *q, unsigned i, u32 bk)
+{
+    for (;;) {
+        if (q[i].bk == bk)
+            return 1;
+        if (q[i].parent == RIX_HASH_BFS_ROOT)
+            return 0;
+        i = q[i].parent;
+    }
+}
+
+/*===========================================================================
+ * Online resize (RIX_HASH_GENERATE_SLOT_RESIZE, see rix_hash_slot.h)
+ *
+ * A resizable table hashes keys with RIX_HASH_RESIZE_HASH_MASK instead of
+ * rhh_mask, so val32[0] / val32[1] (and fp) do not depend on the table
+ * size.  Doubling then only exposes one more hash bit: every entry of
+ * bucket b belongs to either b or b | old_nb under the new mask, and the
+ * node's hash_field tells which without re-hashing.
+ *
+ * While a grow is in flight:
+ *   rhh_mask      = new mask (2 * old_nb - 1)
+ *   rs.old_mask   = mask before the grow
+ *   rs.split      = buckets [0, split) of the old table already split
+ *
+ * A hash maps to  b = h & rhh_mask;  if b's parent (b & old_mask) is not
+ * split yet, the entry still lives in the parent, so b &= old_mask.
+ * Outside a grow  old_mask == rhh_mask  and  split == nb_bk, so the parent
+ * test never fires.
+ *
+ * Because the hash is computed against the full 32-bit mask, bk0 == bk1 is
+ * possible (probability 1/nb_bk); such a key simply has one candidate
+ * bucket.  fp != 0 still holds since val32[0] != val32[1].
+ *===========================================================================*/
+#  define RIX_HASH_RESIZE_HASH_MASK 0xffffffffu
+
+struct rix_hash_resize_s {
+    unsigned old_mask;
+    unsigned split;
+};
+
+#  define RIX_HASH_RESIZE_HEAD(name)                                            \
+    struct name {                                                             \
+        unsigned rhh_mask;                                                    \
+        unsigned rhh_nb;                                                      \
+        struct rix_hash_resize_s rhh_rs;                                      \
+    }
+
+/* rs == NULL: fixed-size table (compiles to h & mask for a constant NULL). */
+static RIX_FORCE_INLINE unsigned
+_rix_hash_rs_bucket(u32 h, unsigned mask, const struct rix_hash_resize_s *rs)
+{
+    unsigned b = h & mask;
+    if (rs && (b & rs->old_mask) >= rs->split)
+        b &= rs->old_mask;
+    return b;
+}
+
+/*===========================================================================
+ * Overflow stash (RIX_HASH_GENERATE_SLOT_STASH, see rix_hash_slot.h)
+ *
+ * A small overflow area that absorbs the inserts the kickout search gives
+ * up on.  It is made of rhh_st.nb_bk ordinary buckets (1 ..
+ * RIX_HASH_STASH_MAX_BK, i.e. 16 .. 256 entries) placed right after the
+ * main table in the same bucket array:
+ *
+ *   buckets[0 .. nb_bk)                  main table
+ *   buckets[nb_bk .. nb_bk + st_nb_bk)   stash
+ *
+ * A stash entry keeps the usual layout (hash[] = fp, idx[] = node), so it
+ * is searched with the same find_u32x16 kernel.  A stashed node has
+ *   hash_field = val32[0]
+ *   slot_field = RIX_HASH_BUCKET_ENTRY_SZ + stash position
+ * and its two candidate buckets are hash_field & mask and
+ * (fp ^ hash_field) & mask, so it can be moved back without re-hashing.
+ * slot_field must therefore hold RIX_HASH_BUCKET_ENTRY_SZ +
+ * 16 * st_nb_bk - 1 (a u16 is always enough).
+ *
+ *   rhh_st.nb     entries currently in the stash (also counted in rhh_nb)
+ *   rhh_st.nb_bk  stash size in buckets
+ *   rhh_st.filter one bit per fingerprint class (fp >> 24), set while a
+ *                 stashed entry of that class exists
+ *
+ * Lookups touch the stash only when both candidate buckets miss,
+ * rhh_st.nb != 0 and the key's filter bit is set.  An empty stash costs
+ * one compare; a non-empty one is scanned by about nb / 256 of the
+ * misses instead of all of them.
+ *===========================================================================*/
+#  ifndef RIX_HASH_STASH_MAX_BK
+#    define RIX_HASH_STASH_MAX_BK 16u
+#  endif
+
+#  define RIX_HASH_STASH_FILTER_BITS 256u
+
+struct rix_hash_stash_s {
+    unsigned nb;
+    unsigned nb_bk;
+    u64      filter[RIX_HASH_STASH_FILTER_BITS / 64u];
+};
+
+static RIX_FORCE_INLINE int
+rix_hash_stash_filter_test(const struct rix_hash_stash_s *st, u32 fp)
+{
+    unsigned b = fp >> 24;
+    return (int)((st->filter[b / 64u] >> (b % 64u)) & 1u);
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_stash_filter_set(struct rix_hash_stash_s *st, u32 fp)
+{
+    unsigned b = fp >> 24;
+    st->filter[b / 64u] |= (u64)1 << (b % 64u);
+}
+
+static RIX_FORCE_INLINE void
+rix_hash_stash_filter_clear(struct rix_hash_stash_s *st, u32 fp)
+{
+    unsigned b = fp >> 24;
+    st->filter[b / 64u] &= ~((u64)1 << (b % 64u));
+}
+
+#  define RIX_HASH_STASH_HEAD(name)                                             \
+    struct name {                                                             \
+        unsigned rhh_mask;                                                    \
+        unsigned rhh_nb;                                                      \
+        struct rix_hash_stash_s rhh_st;                                       \
+    }
+
+/*===========================================================================
+ * Keyed hash with online reseed (RIX_HASH_GENERATE_SLOT_SEED, see
+ * rix_hash_slot.h)
+ *
+ * The hash takes the table seed as a third argument,
+ *
+ *   union rix_hash_hash_u hash_fn(const key_type *key, u32 mask, u64 seed);
+ *
+ * (default: rix_hash_hash_bytes_keyed), so an attacker who does not know
+ * the seed cannot aim keys at one bucket pair.  A reseed switches to a new
+ * seed and moves entries over a few buckets per name_sd_reseed_step call;
+ * until it finishes, lookups that miss under the new seed retry under the
+ * old one.  Entries need no marker: a node is placed for the current seed
+ * iff its hash_field is one of the new h0 / h1 and its bucket holds the
+ * new fp.
+ *
+ *   rhh_sd.seed     seed for all inserts
+ *   rhh_sd.old      previous seed while a reseed runs
+ *   rhh_sd.busy     reseed running
+ *   rhh_sd.cursor   next bucket the reseed sweep visits
+ *   rhh_sd.stale    entries found still under the old seed in the current
+ *                   sweep pass (a pass that finds none ends the reseed)
+ *   rhh_sd.moved    of those, entries the new seed could place (a pass
+ *                   that places none rolls the reseed back)
+ *   rhh_sd.rollback the reseed was rolled back: the sweep returns the
+ *                   entries to the old seed, which is then kept
+ *   rhh_sd.nb_ins   insert attempts (refused ones included), and those
+ *   rhh_sd.nb_kick  that found both candidate buckets full, over a
+ *                   decaying window
+ *                   (name_sd_need_reseed)
+ *===========================================================================*/
+#  ifndef RIX_HASH_SEED_WINDOW
+#    define RIX_HASH_SEED_WINDOW 1024u     /* nb_ins halves at this count */
+#  endif
+#  ifndef RIX_HASH_SEED_KICK_PCT
+#    define RIX_HASH_SEED_KICK_PCT 25u     /* kickout % that asks for reseed */
+#  endif
+
+struct rix_hash_seed_s {
+    u64      seed;
+    u64      old;
+    unsigned busy;
+    unsigned cursor;
+    unsigned stale;
+    unsigned moved;
+    unsigned rollback;
+    unsigned nb_ins;
+    unsigned nb_kick;
+};
+
+#  define RIX_HASH_SEED_HEAD(name)                                              \
+    struct name {                                                             \
+        unsigned rhh_mask;                                                    \
+        unsigned rhh_nb;                                                      \
+        struct rix_hash_seed_s rhh_sd;                                        \
+    }
+
 /*===========================================================================
  * RIX_HASH_GENERATE(name, type, key_field, hash_field, cmp_fn)
  * RIX_HASH_GENERATE_EX(name, type, key_field, hash_field, cmp_fn, hash_fn)
@@ -272,6 +683,19 @@ _rix_hash_buckets(const union rix_hash_hash_u h, unsigned mask,
  *     struct type   *name_insert(head, buckets, base, elm)
  *     struct type   *name_remove(head, buckets, base, elm)
  *     int            name_walk  (head, buckets, base, cb, arg)
+ *     int            name_walk_range(head, buckets, base, bk_begin, bk_end,
+ *                                    cb, arg)   (see "Bucket range walk")
+ *
+ *   Bulk ops (pipelined, see "Bulk insert / remove" below):
+ *     unsigned       name_insert_bulk(head, buckets, base, elms, n, results)
+ *     unsigned       name_remove_bulk(head, buckets, base, elms, n)
+ *
+ *   Parallel bulk build (see "Parallel bulk build" below):
+ *     unsigned       name_build_bk    (head, elm)
+ *     unsigned       name_build_range (head, buckets, base, elms, n,
+ *                                      bk_begin, bk_end, spill, nb_spill)
+ *     unsigned       name_build_finish(head, buckets, base, nb_placed,
+ *                                      spill, nb_spill, results)
  *
  *   (key_type = __typeof__(((struct type *)0)->key_field))
  *===========================================================================*/
@@ -300,7 +724,45 @@ _rix_hash_buckets(const union rix_hash_hash_u h, unsigned mask,
                          struct rix_hash_bucket_s *buckets,                          \
                          struct type *base,                                          \
                          int (*cb)(struct type *, void *),                           \
-                         void *arg);
+                         void *arg);                                                 \
+    attr int name##_walk_range(struct name *head,                                    \
+                               struct rix_hash_bucket_s *buckets,                    \
+                               struct type *base,                                    \
+                               unsigned bk_begin, unsigned bk_end,                   \
+                               int (*cb)(struct type *, void *),                     \
+                               void *arg);                                           \
+    attr unsigned name##_walk_step(struct name *head,                                \
+                                   struct rix_hash_bucket_s *buckets,                \
+                                   unsigned cursor, unsigned budget,                 \
+                                   u32 *idx_out, unsigned max_out,                   \
+                                   unsigned *n_out);                                 \
+    attr unsigned name##_insert_bulk(struct name *head,                              \
+                                     struct rix_hash_bucket_s *buckets,              \
+                                     struct type *base,                              \
+                                     struct type * const *elms,                      \
+                                     unsigned n,                                     \
+                                     struct type **results);                         \
+    attr unsigned name##_remove_bulk(struct name *head,                              \
+                                     struct rix_hash_bucket_s *buckets,              \
+                                     struct type *base,                              \
+                                     struct type * const *elms,                      \
+                                     unsigned n);                                    \
+    attr unsigned name##_build_bk(struct name *head,                                 \
+                                  const struct type *elm);                           \
+    attr unsigned name##_build_range(struct name *head,                              \
+                                     struct rix_hash_bucket_s *buckets,              \
+                                     struct type *base,                              \
+                                     struct type * const *elms,                      \
+                                     unsigned n,                                     \
+                                     unsigned bk_begin, unsigned bk_end,             \
+                                     struct type **spill, unsigned *nb_spill);       \
+    attr unsigned name##_build_finish(struct name *head,                             \
+                                      struct rix_hash_bucket_s *buckets,             \
+                                      struct type *base,                             \
+                                      unsigned nb_placed,                            \
+                                      struct type * const *spill,                    \
+                                      unsigned nb_spill,                             \
+                                      struct type **results);
 
 #  define RIX_HASH_PROTOTYPE_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
     RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
@@ -314,17 +776,7 @@ _rix_hash_buckets(const union rix_hash_hash_u h, unsigned mask,
 #  define RIX_HASH_PROTOTYPE_STATIC(name, type, key_field, hash_field, cmp_fn) \
     RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
 
-#  define RIX_HASH_PROTOTYPE_SLOT_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
-
-#  define RIX_HASH_PROTOTYPE_SLOT(name, type, key_field, hash_field, slot_field, cmp_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
-
-#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
-
-#  define RIX_HASH_PROTOTYPE_STATIC_SLOT(name, type, key_field, hash_field, slot_field, cmp_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+/* SLOT prototypes (name_seq_* and name_rs_* forms) live in rix_hash_slot.h. */
 
 #  define _RIX_HASH_DEFAULT_HASH_FN_NAME(name) name ## _default_hash
 
@@ -336,8 +788,881 @@ _rix_hash_buckets(const union rix_hash_hash_u h, unsigned mask,
         return rix_hash_hash_bytes_fast((const void *)key,                      \
                                         sizeof(((struct type *)0)->key_field),  \
                                         mask);                                  \
+    }                                                                           \
+    static RIX_UNUSED RIX_FORCE_INLINE void                                     \
+    name ## _hash_n(const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys,    \
+                    unsigned n, u32 mask, union rix_hash_hash_u *out)           \
+    {                                                                           \
+        rix_hash_hash_bytes_n_fast((const void * const *)keys,                  \
+                                   sizeof(((struct type *)0)->key_field),       \
+                                   n, mask, out);                               \
+    }
+
+/*
+ * name_hash_n(keys, n, mask, out): hash a block of keys for the staged xN
+ * and bulk paths.  The default hash batches through rix_hash_arch
+ * (interleaved CRC32C chains); a caller-supplied hash_fn (_EX forms) is
+ * called back to back so its chains can still overlap.
+ */
+#  define _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)               \
+    static RIX_UNUSED RIX_FORCE_INLINE void                                     \
+    name ## _hash_n(const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys,    \
+                    unsigned n, u32 mask, union rix_hash_hash_u *out)           \
+    {                                                                           \
+        for (unsigned _i = 0; _i < n; _i++)                                     \
+            out[_i] = hash_fn(keys[_i], mask);                                  \
+    }
+
+/*
+ * Seeded tables (RIX_HASH_GENERATE_SLOT_SEED): the default keyed hash, and
+ * the seed-0 two-argument form the plain SLOT ops underneath are built on.
+ */
+#  define _RIX_HASH_KEYED_HASH_FN_NAME(name) name ## _keyed_hash
+
+#  define _RIX_HASH_DEFINE_KEYED_HASH_FN(name, type, key_field)                 \
+    static RIX_UNUSED RIX_FORCE_INLINE union rix_hash_hash_u                    \
+    _RIX_HASH_KEYED_HASH_FN_NAME(name)(                                         \
+        const _RIX_HASH_KEY_TYPE(type, key_field) *key, u32 mask, u64 seed)     \
+    {                                                                           \
+        return rix_hash_hash_bytes_keyed((const void *)key,                     \
+                                         sizeof(((struct type *)0)->key_field), \
+                                         mask, seed);                           \
     }
 
+#  define _RIX_HASH_DEFINE_SEED0_HASH_FN(name, type, key_field, hash_fn)        \
+    static RIX_UNUSED RIX_FORCE_INLINE union rix_hash_hash_u                    \
+    name ## _seed0_hash(const _RIX_HASH_KEY_TYPE(type, key_field) *key,         \
+                        u32 mask)                                               \
+    {                                                                           \
+        return hash_fn(key, mask, 0u);                                          \
+    }                                                                           \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, name ## _seed0_hash)
+
+/*===========================================================================
+ * Bulk insert / remove (name_insert_bulk, name_remove_bulk)
+ *
+ * The fp, slot, keyonly, hash32 and hash64 variants generate
+ *
+ *   unsigned name_insert_bulk(head, buckets, base, elms, n, results)
+ *   unsigned name_remove_bulk(head, buckets, base, elms, n)
+ *
+ * which behave exactly like n calls of name_insert / name_remove in array
+ * order (a key repeated inside the batch is reported as a duplicate of its
+ * first occurrence), but overlap the DRAM misses of RIX_HASH_BULK_AHEAD
+ * elements per stage:
+ *
+ *   insert:  stage 0  prefetch node (key)
+ *            stage 1  hash key, prefetch both candidate buckets
+ *            stage 2  scan fingerprints, prefetch duplicate candidates
+ *                     (fp / slot / keyonly only; hash32 / hash64 keep the
+ *                     key in the bucket and skip this stage)
+ *            stage 3  commit (name_insert_hashed: dup check, empty slot,
+ *                     kickout)
+ *
+ *   remove:  stage 0  prefetch node
+ *            stage 1  locate the current bucket (hash_field) or re-hash,
+ *                     prefetch it
+ *            stage 2  commit
+ *
+ * Stage k handles element i at step i + k * RIX_HASH_BULK_AHEAD; stages
+ * run last-first within a step.  Stages 0 and 1 work a whole block of
+ * RIX_HASH_BULK_AHEAD elements at its first step, so the hash stage goes
+ * through name_hash_n (the interleaved rix_hash_arch _n kernels for the
+ * default hash) and in-flight hashes fit a ring of 4 * RIX_HASH_BULK_AHEAD
+ * entries on the stack.  Earlier commits (and
+ * their kickouts) may change a bucket after it was scanned; the commit
+ * stage re-reads everything, the earlier stages only warm the cache.
+ *
+ * insert_bulk stores each per-element name_insert result in results[i]
+ * (NULL inserted, elm table full, other duplicate) when results != NULL,
+ * and returns the number of elements inserted.  remove_bulk returns the
+ * number of elements removed.
+ *===========================================================================*/
+#  ifndef RIX_HASH_BULK_AHEAD
+#    define RIX_HASH_BULK_AHEAD 8u
+#  endif
+
+#  define _RIX_HASH_BULK_RING (4u * RIX_HASH_BULK_AHEAD)
+
+/*
+ * name_insert_bulk for the fingerprint bucket layout (fp / slot / keyonly).
+ * Requires name_hptr and name_insert_hashed(head, buckets, base, elm, h).
+ */
+#  define _RIX_HASH_GENERATE_INSERT_BULK(name, type, key_field, hash_fn, attr) \
+/* Stage 1: hash one block of m keys, prefetch both candidate buckets. */     \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_bulk_hash_blk(struct rix_hash_bucket_s *buckets,                       \
+                     unsigned mask,                                           \
+                     struct type * const *elms,                               \
+                     unsigned m,                                              \
+                     union rix_hash_hash_u *out)                              \
+{                                                                             \
+    const _RIX_HASH_KEY_TYPE(type, key_field) *_kp[RIX_HASH_BULK_AHEAD];      \
+    for (unsigned _j = 0u; _j < m; _j++)                                      \
+        _kp[_j] = (const _RIX_HASH_KEY_TYPE(type, key_field) *)               \
+                  &elms[_j]->key_field;                                       \
+    name##_hash_n(_kp, m, mask, out);                                         \
+    for (unsigned _j = 0u; _j < m; _j++) {                                    \
+        _rix_hash_prefetch_bucket(buckets + (out[_j].val32[0] & mask));       \
+        _rix_hash_prefetch_bucket(buckets + (out[_j].val32[1] & mask));       \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/* Stage 2: prefetch the nodes the duplicate check will compare. */           \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_bulk_prefetch_dup(struct rix_hash_bucket_s *buckets,                   \
+                         struct type *base,                                   \
+                         unsigned mask,                                       \
+                         union rix_hash_hash_u _h)                            \
+{                                                                             \
+    unsigned _bk[2];                                                          \
+    u32 _fp;                                                                  \
+    _rix_hash_buckets(_h, mask, &_bk[0], &_bk[1], &_fp);                      \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        u32 _hits = _RIX_HASH_FIND_U32X16(buckets[_bk[_i]].hash, _fp);        \
+        while (_hits) {                                                       \
+            unsigned _bit = (unsigned)__builtin_ctz(_hits);                   \
+            _hits &= _hits - 1u;                                              \
+            _rix_hash_prefetch_entry(                                         \
+                name##_hptr(base, buckets[_bk[_i]].idx[_bit]));               \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_insert_bulk(struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   struct type *base,                                         \
+                   struct type * const *elms,                                 \
+                   unsigned n,                                                \
+                   struct type **results)                                     \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _hs[_RIX_HASH_BULK_RING];                           \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + 3u * _a; _t++) {                          \
+        /* Stage 3: commit */                                                 \
+        if (_t >= 3u * _a) {                                                  \
+            unsigned _i = _t - 3u * _a;                                       \
+            struct type *_r =                                                 \
+                name##_insert_hashed(head, buckets, base, elms[_i],           \
+                                     _hs[_i % _RIX_HASH_BULK_RING]);          \
+            if (_r == NULL)                                                   \
+                _ok++;                                                        \
+            if (results)                                                      \
+                results[_i] = _r;                                             \
+        }                                                                     \
+        /* Stage 2: scan fingerprints, prefetch duplicate candidates */       \
+        if (_t >= 2u * _a && _t - 2u * _a < n) {                              \
+            unsigned _i = _t - 2u * _a;                                       \
+            name##_bulk_prefetch_dup(buckets, base, mask,                     \
+                                     _hs[_i % _RIX_HASH_BULK_RING]);          \
+        }                                                                     \
+        /* Stage 1: batch-hash a block, prefetch candidate buckets */         \
+        if (_t >= _a && _t - _a < n && (_t - _a) % _a == 0u) {                \
+            unsigned _i = _t - _a;                                            \
+            name##_bulk_hash_blk(buckets, mask, elms + _i,                    \
+                                 (n - _i < _a) ? n - _i : _a,                 \
+                                 &_hs[_i % _RIX_HASH_BULK_RING]);             \
+        }                                                                     \
+        /* Stage 0: prefetch a block of nodes (key) */                        \
+        if (_t < n && _t % _a == 0u)                                          \
+            for (unsigned _j = _t; _j < n && _j < _t + _a; _j++)              \
+                _rix_hash_prefetch_entry(elms[_j]);                           \
+    }                                                                         \
+    return _ok;                                                               \
+}
+
+/*
+ * name_remove_bulk for variants that keep hash_field in the node (fp / slot):
+ * the current bucket is hash_field & mask, no re-hash needed.
+ */
+#  define _RIX_HASH_GENERATE_REMOVE_BULK(name, type, hash_field, attr)         \
+attr unsigned                                                                 \
+name##_remove_bulk(struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   struct type *base,                                         \
+                   struct type * const *elms,                                 \
+                   unsigned n)                                                \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t++) {                          \
+        /* Stage 2: commit */                                                 \
+        if (_t >= 2u * _a &&                                                  \
+            name##_remove(head, buckets, base, elms[_t - 2u * _a]) != NULL)   \
+            _ok++;                                                            \
+        /* Stage 1: prefetch the current bucket (hash_field & mask) */        \
+        if (_t >= _a && _t - _a < n)                                          \
+            _rix_hash_prefetch_bucket(                                        \
+                buckets + (elms[_t - _a]->hash_field & mask));                \
+        /* Stage 0: prefetch node */                                          \
+        if (_t < n)                                                           \
+            _rix_hash_prefetch_entry(elms[_t]);                               \
+    }                                                                         \
+    return _ok;                                                               \
+}
+
+/*===========================================================================
+ * Parallel bulk build (name_build_range, name_build_finish)
+ *
+ * Loading a large table with one thread is bound by the bucket misses of
+ * one core.  The build splits the bucket array into disjoint ranges, one
+ * per thread; each thread places the elements whose primary bucket (bk0)
+ * falls in its range and touches no bucket outside it, so the threads
+ * need no locking and share no cache line:
+ *
+ *   unsigned name_build_bk    (head, elm)
+ *            bk0 of elm, to partition elms before the build (optional)
+ *   unsigned name_build_range (head, buckets, base, elms, n,
+ *                              bk_begin, bk_end, spill, nb_spill)
+ *            places elms[] whose bk0 is in [bk_begin, bk_end) and skips
+ *            the others; returns the number placed
+ *   unsigned name_build_finish(head, buckets, base, nb_placed,
+ *                              spill, nb_spill, results)
+ *            serial: adds nb_placed to the count and inserts the spills
+ *
+ *   thread t:  placed[t] = name_build_range(head, bk, base, elms, n,
+ *                                           t * per, (t + 1) * per,
+ *                                           spill[t], &nb_spill[t]);
+ *   join, concatenate the spill[] lists, then
+ *   name_build_finish(head, bk, base, sum(placed), all_spill, nb, NULL);
+ *
+ * A range places into bk0, or bk1 when bk1 is in the same range, and
+ * never kicks out: an element whose candidate buckets in range are full,
+ * or whose key is already present there, goes to spill[] (room for n
+ * entries) and name_build_finish resolves it with name_insert_bulk, which
+ * may kick out across ranges and reports duplicates through results[]
+ * (indexed like spill[]).  Equal keys share bk0 and therefore a range, so
+ * the first occurrence in elms[] order is the one kept, as for
+ * name_insert_bulk.
+ *
+ * Passing every thread the whole elms[] is correct but makes each one hash
+ * all n keys; for large n partition first (in parallel, by name_build_bk)
+ * and hand each thread its own slice.  Until name_build_finish returns no
+ * other operation may run on the table and head->rhh_nb excludes the
+ * placed entries.  The table does not have to be empty, but a range
+ * cannot see a key already stored in a bk1 outside it, so on a non-empty
+ * table an element whose bk1 is in another range is always spilled.
+ *
+ * place_fn(elm, hv, slot) records in the node that elm now sits in
+ * slot of the bucket hv & mask (hv is h.val32[0] or h.val32[1]).
+ *===========================================================================*/
+#  define _RIX_HASH_GENERATE_BUILD(name, type, key_field, cmp_fn, place_fn, attr) \
+attr unsigned                                                                 \
+name##_build_bk(struct name *head,                                            \
+                const struct type *elm)                                       \
+{                                                                             \
+    const _RIX_HASH_KEY_TYPE(type, key_field) *_kp = &elm->key_field;         \
+    union rix_hash_hash_u _h;                                                 \
+    name##_hash_n(&_kp, 1u, head->rhh_mask, &_h);                             \
+    return _h.val32[0] & head->rhh_mask;                                      \
+}                                                                             \
+                                                                              \
+/* 0 placed, 1 spill, -1 bk0 not in [bk_begin, bk_end). */                    \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_build_one(struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 unsigned mask,                                               \
+                 struct type *elm,                                            \
+                 union rix_hash_hash_u _h,                                    \
+                 unsigned bk_begin,                                           \
+                 unsigned bk_end,                                             \
+                 int nonempty)                                                \
+{                                                                             \
+    unsigned _bk[2];                                                          \
+    u32 _fp, _hits_fp[2], _hits_zero[2];                                      \
+    int _nb;                                                                  \
+    _rix_hash_buckets(_h, mask, &_bk[0], &_bk[1], &_fp);                      \
+    if (_bk[0] - bk_begin >= bk_end - bk_begin)                               \
+        return -1;                                                            \
+    _nb = (_bk[1] - bk_begin < bk_end - bk_begin) ? 2 : 1;                    \
+    /* bk1 belongs to another range: on a non-empty table a copy of the */    \
+    /* key may sit there unseen, so name_insert_bulk has to decide.     */    \
+    if (_nb == 1 && nonempty)                                                 \
+        return 1;                                                             \
+    for (int _i = 0; _i < _nb; _i++) {                                        \
+        struct rix_hash_bucket_s *_b = buckets + _bk[_i];                     \
+        u32 _hits;                                                            \
+        _RIX_HASH_FIND_U32X16_2(_b->hash, _fp, 0u,                            \
+                                &_hits_fp[_i], &_hits_zero[_i]);              \
+        _hits = _hits_fp[_i];                                                 \
+        while (_hits) {                                                       \
+            unsigned _bit = (unsigned)__builtin_ctz(_hits);                   \
+            struct type *_node = name##_hptr(base, _b->idx[_bit]);            \
+            _hits &= _hits - 1u;                                              \
+            RIX_ASSUME_NONNULL(_node);                                        \
+            if (cmp_fn(&elm->key_field, &_node->key_field) == 0)              \
+                return 1;                                                     \
+        }                                                                     \
+    }                                                                         \
+    for (int _i = 0; _i < _nb; _i++) {                                        \
+        if (_hits_zero[_i]) {                                                 \
+            struct rix_hash_bucket_s *_b = buckets + _bk[_i];                 \
+            unsigned _slot = (unsigned)__builtin_ctz(_hits_zero[_i]);         \
+            _b->hash[_slot] = _fp;                                            \
+            _b->idx [_slot] = name##_hidx(base, elm);                         \
+            place_fn(elm, _h.val32[_i], _slot);                               \
+            return 0;                                                         \
+        }                                                                     \
+    }                                                                         \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_build_range(struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   struct type *base,                                         \
+                   struct type * const *elms,                                 \
+                   unsigned n,                                                \
+                   unsigned bk_begin,                                         \
+                   unsigned bk_end,                                           \
+                   struct type **spill,                                       \
+                   unsigned *nb_spill)                                        \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _hs[_RIX_HASH_BULK_RING];                           \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _placed = 0u, _ns = 0u;                                          \
+    const int _nonempty = head->rhh_nb != 0u;                                 \
+    if (bk_end > mask + 1u)                                                   \
+        bk_end = mask + 1u;                                                   \
+    if (bk_begin > bk_end)                                                    \
+        bk_begin = bk_end;                                                    \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t += _a) {                      \
+        /* Stage 2: place (or spill) a block */                               \
+        if (_t >= 2u * _a) {                                                  \
+            for (unsigned _i = _t - 2u * _a; _i < _t - _a && _i < n; _i++) {  \
+                int _r = name##_build_one(buckets, base, mask, elms[_i],      \
+                                          _hs[_i % _RIX_HASH_BULK_RING],      \
+                                          bk_begin, bk_end, _nonempty);       \
+                if (_r == 0)                                                  \
+                    _placed++;                                                \
+                else if (_r > 0)                                              \
+                    spill[_ns++] = elms[_i];                                  \
+            }                                                                 \
+        }                                                                     \
+        /* Stage 1: hash a block, prefetch the buckets of this range */       \
+        if (_t >= _a && _t - _a < n) {                                        \
+            unsigned _i = _t - _a;                                            \
+            unsigned _m = (n - _i < _a) ? n - _i : _a;                        \
+            union rix_hash_hash_u *_o = &_hs[_i % _RIX_HASH_BULK_RING];       \
+            const _RIX_HASH_KEY_TYPE(type, key_field)                         \
+                *_kp[RIX_HASH_BULK_AHEAD];                                    \
+            for (unsigned _j = 0u; _j < _m; _j++)                             \
+                _kp[_j] = &elms[_i + _j]->key_field;                          \
+            name##_hash_n(_kp, _m, mask, _o);                                 \
+            for (unsigned _j = 0u; _j < _m; _j++) {                           \
+                unsigned _b0 = _o[_j].val32[0] & mask;                        \
+                if (_b0 - bk_begin < bk_end - bk_begin)                       \
+                    _rix_hash_prefetch_bucket(buckets + _b0);                 \
+            }                                                                 \
+        }                                                                     \
+        /* Stage 0: prefetch a block of nodes (key) */                        \
+        for (unsigned _j = _t; _j < n && _j < _t + _a; _j++)                  \
+            _rix_hash_prefetch_entry(elms[_j]);                               \
+    }                                                                         \
+    *nb_spill = _ns;                                                          \
+    return _placed;                                                           \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_build_finish(struct name *head,                                        \
+                    struct rix_hash_bucket_s *buckets,                        \
+                    struct type *base,                                        \
+                    unsigned nb_placed,                                       \
+                    struct type * const *spill,                               \
+                    unsigned nb_spill,                                        \
+                    struct type **results)                                    \
+{                                                                             \
+    head->rhh_nb += nb_placed;                                                \
+    return name##_insert_bulk(head, buckets, base, spill, nb_spill, results); \
+}
+
+/*===========================================================================
+ * Resumable walk (name_walk_step)
+ *
+ * name_walk visits the whole table in one call, one callback per entry.
+ * name_walk_step instead covers at most budget buckets from cursor and
+ * stores the 1-origin node idx of each entry in idx_out[], so an audit or
+ * an export can be spread over many short calls inside a poll loop:
+ *
+ *   unsigned cur = 0u, n;
+ *   do {
+ *       cur = name_walk_step(head, buckets, cur, 64u, idx, 256u, &n);
+ *       ... idx[0 .. n) ...
+ *   } while (cur != 0u);
+ *
+ * It returns the cursor to resume from, or 0 once the last bucket is
+ * done.  A bucket is emitted whole or not at all: the step also ends
+ * before a bucket whose entries do not fit in idx_out[], so budget must
+ * be non-zero and max_out at least the slots per bucket.  The idx[] line
+ * of each bucket is prefetched RIX_HASH_BULK_AHEAD buckets ahead.
+ *
+ * The table may be modified between steps.  Entries that stay in their
+ * bucket are reported exactly once; an entry inserted, removed or moved
+ * by a kickout meanwhile may be reported once, twice or not at all.
+ *
+ * fn is the generated name (walk_step, rs_walk_step, ...), nb_expr the
+ * number of buckets to cover and skip_expr (of _b) a bucket filter.
+ *===========================================================================*/
+#  define _RIX_HASH_GENERATE_WALK_STEP(name, fn, bkt, nslots, nb_expr, skip_expr, attr) \
+attr unsigned                                                                 \
+name##_##fn(struct name *head,                                                \
+            bkt *buckets,                                                     \
+            unsigned cursor,                                                  \
+            unsigned budget,                                                  \
+            u32 *idx_out,                                                     \
+            unsigned max_out,                                                 \
+            unsigned *n_out)                                                  \
+{                                                                             \
+    unsigned _nb = (nb_expr);                                                 \
+    unsigned _end, _b, _n = 0u;                                               \
+    RIX_ASSERT(budget != 0u && max_out >= (nslots));                          \
+    if (cursor >= _nb) {                                                      \
+        *n_out = 0u;                                                          \
+        return 0u;                                                            \
+    }                                                                         \
+    _end = (budget < _nb - cursor) ? cursor + budget : _nb;                   \
+    for (_b = cursor; _b < _end && _b < cursor + RIX_HASH_BULK_AHEAD; _b++)   \
+        __builtin_prefetch(&buckets[_b].idx[0], 0, 1);                        \
+    for (_b = cursor; _b < _end; _b++) {                                      \
+        const bkt *_bk = buckets + _b;                                        \
+        unsigned _m = 0u;                                                     \
+        if (_b + RIX_HASH_BULK_AHEAD < _end)                                  \
+            __builtin_prefetch(&buckets[_b + RIX_HASH_BULK_AHEAD].idx[0],     \
+                               0, 1);                                         \
+        if (skip_expr)                                                        \
+            continue;                                                         \
+        for (unsigned _s = 0u; _s < (nslots); _s++)                           \
+            _m += (_bk->idx[_s] != (u32)RIX_NIL);                             \
+        if (_m > max_out - _n)                                                \
+            break;                                                            \
+        for (unsigned _s = 0u; _s < (nslots); _s++)                           \
+            if (_bk->idx[_s] != (u32)RIX_NIL)                                 \
+                idx_out[_n++] = _bk->idx[_s];                                 \
+    }                                                                         \
+    *n_out = _n;                                                              \
+    return (_b < _nb) ? _b : 0u;                                              \
+}
+
+/*===========================================================================
+ * Bucket range walk (name_walk_range)
+ *
+ * name_walk_range(head, buckets, base, bk_begin, bk_end, cb, arg) is
+ * name_walk restricted to buckets [bk_begin, bk_end); bk_end is clamped
+ * to the bucket count, so bk_end = UINT_MAX means "to the end".  Disjoint
+ * ranges visit disjoint sets of entries, which lets a read-only scan
+ * (statistics, export, audit) be split across threads:
+ *
+ *   unsigned nb = head->rhh_mask + 1u, per = nb / nthr;
+ *   thread t: name_walk_range(head, buckets, base, t * per,
+ *                             t == nthr - 1 ? nb : (t + 1) * per, cb, arg);
+ *
+ * No locking is done: the table must not be modified while any range is
+ * being walked.  name_walk is name_walk_range over the whole table.
+ *
+ * fn is the generated name (walk_range, rs_walk_range, ...), nodet the
+ * node type, nb_expr the number of buckets and skip_expr (of _b) a bucket
+ * filter, as for name_walk_step.
+ *===========================================================================*/
+#  define _RIX_HASH_GENERATE_WALK_RANGE(name, fn, bkt, nodet, nslots, nb_expr, skip_expr, attr) \
+attr int                                                                      \
+name##_##fn(struct name *head,                                                \
+            bkt *buckets,                                                     \
+            nodet *base,                                                      \
+            unsigned bk_begin,                                                \
+            unsigned bk_end,                                                  \
+            int (*cb)(nodet *, void *),                                       \
+            void *arg)                                                        \
+{                                                                             \
+    unsigned _nb = (nb_expr);                                                 \
+    if (bk_end > _nb)                                                         \
+        bk_end = _nb;                                                         \
+    for (unsigned _b = bk_begin; _b < bk_end; _b++) {                         \
+        const bkt *_bk = buckets + _b;                                        \
+        if (skip_expr)                                                        \
+            continue;                                                         \
+        for (unsigned _s = 0u; _s < (nslots); _s++) {                         \
+            unsigned _nidx = _bk->idx[_s];                                    \
+            int      _r;                                                      \
+            if (_nidx == (unsigned)RIX_NIL)                                   \
+                continue;                                                     \
+            _r = cb(name##_hptr(base, _nidx), arg);                           \
+            if (_r)                                                           \
+                return _r;                                                    \
+        }                                                                     \
+    }                                                                         \
+    return 0;                                                                 \
+}
+
+/*===========================================================================
+ * Inline-value maps (RIX_HASH32_GENERATE_MAP, RIX_HASH64_GENERATE_MAP)
+ *
+ * kt -> vt maps whose buckets hold the value next to the key
+ * (key[16] + val[16]), so a lookup ends inside the bucket lines: there is
+ * no node pool and no idx[] dereference.  A slot is empty iff its key is
+ * invalid_key; any value, including 0, may be stored.
+ *
+ * Values are returned as pointers into the bucket (read or update in
+ * place); such a pointer is valid only until the next insert or remove,
+ * which may move entries.  Kickout is always breadth-first.
+ *
+ * Shared body of both map variants; bkt / ctxt are the bucket and find
+ * context types, hfn / hnfn / ffn the rix_hash_arch hash, batch hash and
+ * key search members.
+ *===========================================================================*/
+#  define _RIX_HASH_GENERATE_MAP(name, bkt, ctxt, kt, vt, hfn, hnfn, ffn, invalid_key, attr) \
+attr void                                                                     \
+name##_init(struct name *head,                                                \
+            bkt *buckets,                                                     \
+            unsigned nb_bk)                                                   \
+{                                                                             \
+    head->rhh_mask = nb_bk - 1u;                                              \
+    head->rhh_nb   = 0u;                                                      \
+    for (unsigned _b = 0u; _b < nb_bk; _b++) {                                \
+        for (unsigned _s = 0u; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {         \
+            buckets[_b].key[_s] = (kt)(invalid_key);                          \
+            buckets[_b].val[_s] = (vt)0;                                      \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/* Stage 1: hash, resolve both buckets, prefetch every line of bk[0]. */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key(ctxt *ctx,                                                    \
+                struct name *head,                                            \
+                bkt *buckets,                                                 \
+                kt key)                                                       \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h = rix_hash_arch->hfn(key, mask);                 \
+    ctx->key   = key;                                                         \
+    ctx->bk[0] = buckets + (_h.val32[0] & mask);                              \
+    ctx->bk[1] = buckets + (_h.val32[1] & mask);                              \
+    for (unsigned _l = 0; _l < sizeof(bkt); _l += 64u)                        \
+        __builtin_prefetch((const char *)ctx->bk[0] + _l, 0, 1);              \
+}                                                                             \
+                                                                              \
+/* Stage 2: key match in bk[0]; bk[1] is scanned lazily by get.       */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_scan_bk(ctxt *ctx,                                                     \
+               struct name *head __attribute__((unused)),                     \
+               bkt *buckets __attribute__((unused)))                          \
+{                                                                             \
+    ctx->hits[0] = rix_hash_arch->ffn(ctx->bk[0]->key, ctx->key);             \
+    ctx->hits[1] = 0u;                                                        \
+}                                                                             \
+                                                                              \
+/* Stage 3: the value in the bucket, or NULL.  invalid_key marks empty */     \
+/* slots, so looking it up always misses.                             */      \
+static RIX_UNUSED RIX_FORCE_INLINE vt *                                       \
+name##_get(ctxt *ctx)                                                         \
+{                                                                             \
+    u32 _hits = ctx->hits[0];                                                 \
+    if (RIX_UNLIKELY(ctx->key == (kt)(invalid_key)))                          \
+        return NULL;                                                          \
+    if (_hits)                                                                \
+        return &ctx->bk[0]->val[__builtin_ctz(_hits)];                        \
+    _hits = rix_hash_arch->ffn(ctx->bk[1]->key, ctx->key);                    \
+    if (_hits)                                                                \
+        return &ctx->bk[1]->val[__builtin_ctz(_hits)];                        \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key_n(ctxt *ctx,                                                  \
+                  int n,                                                      \
+                  struct name *head,                                          \
+                  bkt *buckets,                                               \
+                  const kt *keys)                                             \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h[RIX_HASH_N_LANES];                               \
+    for (int _b = 0; _b < n; _b += (int)RIX_HASH_N_LANES) {                   \
+        unsigned _m = (unsigned)(n - _b) < RIX_HASH_N_LANES ?                 \
+                      (unsigned)(n - _b) : RIX_HASH_N_LANES;                  \
+        rix_hash_arch->hnfn(keys + _b, _m, mask, _h);                         \
+        for (unsigned _j = 0; _j < _m; _j++) {                                \
+            ctxt *_c = &ctx[_b + (int)_j];                                    \
+            _c->key   = keys[_b + (int)_j];                                   \
+            _c->bk[0] = buckets + (_h[_j].val32[0] & mask);                   \
+            _c->bk[1] = buckets + (_h[_j].val32[1] & mask);                   \
+            for (unsigned _l = 0; _l < sizeof(bkt); _l += 64u)                \
+                __builtin_prefetch((const char *)_c->bk[0] + _l, 0, 1);       \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_scan_bk_n(ctxt *ctx,                                                   \
+                 int n,                                                       \
+                 struct name *head,                                           \
+                 bkt *buckets)                                                \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        name##_scan_bk(&ctx[_j], head, buckets);                              \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_get_n(ctxt *ctx,                                                       \
+             int n,                                                           \
+             vt **results)                                                    \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        results[_j] = name##_get(&ctx[_j]);                                   \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE vt *                                       \
+name##_find(struct name *head,                                                \
+            bkt *buckets,                                                     \
+            kt key)                                                           \
+{                                                                             \
+    ctxt _ctx;                                                                \
+    if (RIX_UNLIKELY(key == (kt)(invalid_key)))                               \
+        return NULL;                                                          \
+    name##_hash_key(&_ctx, head, buckets, key);                               \
+    name##_scan_bk(&_ctx, head, buckets);                                     \
+    return name##_get(&_ctx);                                                 \
+}                                                                             \
+                                                                              \
+/* Look up n keys, RIX_HASH_BULK_AHEAD in flight; vals[i] = miss for   */     \
+/* absent keys and invalid_key (name_get).  Returns the number of hits. */    \
+attr unsigned                                                                 \
+name##_find_bulk(struct name *head,                                           \
+                 bkt *buckets,                                                \
+                 const kt *keys,                                              \
+                 unsigned n,                                                  \
+                 vt *vals,                                                    \
+                 vt miss)                                                     \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    ctxt _ctx[2u * RIX_HASH_BULK_AHEAD];                                      \
+    unsigned _hit = 0u;                                                       \
+    for (unsigned _i = 0u; _i < n + _a; _i += _a) {                           \
+        if (_i < n)                                                           \
+            name##_hash_key_n(&_ctx[_i % (2u * _a)],                          \
+                              (int)((n - _i < _a) ? n - _i : _a),             \
+                              head, buckets, keys + _i);                      \
+        if (_i >= _a) {                                                       \
+            unsigned _p = _i - _a;                                            \
+            for (unsigned _j = _p; _j < _p + _a && _j < n; _j++) {            \
+                ctxt *_c = &_ctx[_j % (2u * _a)];                             \
+                vt *_v;                                                       \
+                name##_scan_bk(_c, head, buckets);                            \
+                _v = name##_get(_c);                                          \
+                vals[_j] = _v ? *_v : miss;                                   \
+                _hit += (_v != NULL);                                         \
+            }                                                                 \
+        }                                                                     \
+    }                                                                         \
+    return _hit;                                                              \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_find_empty(const bkt *_bk)                                             \
+{                                                                             \
+    u32 _m = rix_hash_arch->ffn(_bk->key, (kt)(invalid_key));                 \
+    return _m ? (int)__builtin_ctz(_m) : -1;                                  \
+}                                                                             \
+                                                                              \
+/* Shortest cuckoo path (see rix_hash_common.h); entries are moved as */      \
+/* (key, val) pairs.  Returns the freed slot in *bk_out, or -1.       */      \
+static RIX_UNUSED int                                                         \
+name##_kickout_bfs(bkt *buckets,                                              \
+                   unsigned mask,                                             \
+                   unsigned bk0,                                              \
+                   unsigned bk1,                                              \
+                   unsigned *bk_out)                                          \
+{                                                                             \
+    struct rix_hash_bfs_s _q[RIX_HASH_BFS_QUEUE];                             \
+    union rix_hash_hash_u _sh[RIX_HASH_BUCKET_ENTRY_SZ];                      \
+    unsigned _head = 0u, _tail = 0u;                                          \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk0, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk1, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    while (_head < _tail) {                                                   \
+        unsigned _qi = _head++;                                               \
+        unsigned _b  = _q[_qi].bk;                                            \
+        if (_q[_qi].depth != 0u) {                                            \
+            int _es = name##_find_empty(buckets + _b);                        \
+            if (_es >= 0) {                                                   \
+                unsigned _cs = (unsigned)_es;                                 \
+                while (_q[_qi].parent != RIX_HASH_BFS_ROOT) {                 \
+                    bkt *_src = buckets + _q[_q[_qi].parent].bk;              \
+                    bkt *_dst = buckets + _q[_qi].bk;                         \
+                    unsigned _ps = _q[_qi].slot;                              \
+                    _dst->key[_cs] = _src->key[_ps];                          \
+                    _dst->val[_cs] = _src->val[_ps];                          \
+                    _src->key[_ps] = (kt)(invalid_key);                       \
+                    _cs = _ps;                                                \
+                    _qi = _q[_qi].parent;                                     \
+                }                                                             \
+                *bk_out = _q[_qi].bk;                                         \
+                return (int)_cs;                                              \
+            }                                                                 \
+        }                                                                     \
+        if (_q[_qi].depth >= RIX_HASH_FOLLOW_DEPTH)                           \
+            continue;                                                         \
+        /* all occupants hashed in one batch call */                          \
+        rix_hash_arch->hnfn(buckets[_b].key, RIX_HASH_BUCKET_ENTRY_SZ,        \
+                            mask, _sh);                                       \
+        for (unsigned _n = 0, _fan = _rix_hash_bfs_fanout(_q, _qi);           \
+             _n < RIX_HASH_BUCKET_ENTRY_SZ && _fan != 0u; _n++) {             \
+            unsigned _s = _rix_hash_bfs_slot(_qi, _n,                         \
+                                             RIX_HASH_BUCKET_ENTRY_SZ);       \
+            unsigned _sb0, _ab;                                               \
+            if (_tail >= RIX_HASH_BFS_QUEUE)                                  \
+                break;                                                        \
+            _sb0 = _sh[_s].val32[0] & mask;                                   \
+            _ab  = (_b == _sb0) ? (_sh[_s].val32[1] & mask) : _sb0;           \
+            if (_rix_hash_bfs_on_path(_q, _qi, _ab))                          \
+                continue;                                                     \
+            __builtin_prefetch(&buckets[_ab].key[0], 0, 1);                   \
+            _q[_tail++] = (struct rix_hash_bfs_s){                            \
+                _ab, (u16)_qi, (u8)_s, (u8)(_q[_qi].depth + 1u) };            \
+            _fan--;                                                           \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+/* Returns 0 (inserted), 1 (key present, value unchanged) or -1       */      \
+/* (no cuckoo path: table full, unchanged).                           */      \
+attr int                                                                      \
+name##_insert(struct name *head,                                              \
+              bkt *buckets,                                                   \
+              kt key,                                                         \
+              vt val)                                                         \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h = rix_hash_arch->hfn(key, mask);                 \
+    unsigned _bki[2] = { _h.val32[0] & mask, _h.val32[1] & mask };            \
+    int _slot = -1;                                                           \
+    unsigned _b = _bki[0];                                                    \
+    RIX_ASSERT(key != (kt)(invalid_key));                                     \
+    for (int _i = 0; _i < 2; _i++)                                            \
+        if (rix_hash_arch->ffn(buckets[_bki[_i]].key, key))                   \
+            return 1;                                                         \
+    for (int _i = 0; _i < 2 && _slot < 0; _i++) {                             \
+        _b    = _bki[_i];                                                     \
+        _slot = name##_find_empty(buckets + _b);                              \
+    }                                                                         \
+    if (_slot < 0)                                                            \
+        _slot = name##_kickout_bfs(buckets, mask, _bki[0], _bki[1], &_b);     \
+    if (_slot < 0)                                                            \
+        return -1;                                                            \
+    buckets[_b].key[_slot] = key;                                             \
+    buckets[_b].val[_slot] = val;                                             \
+    head->rhh_nb++;                                                           \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+/* Returns 0 (removed) or -1 (key not present, or invalid_key).      */      \
+attr int                                                                      \
+name##_remove(struct name *head,                                              \
+              bkt *buckets,                                                   \
+              kt key)                                                         \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h;                                                 \
+    if (RIX_UNLIKELY(key == (kt)(invalid_key)))                               \
+        return -1;                                                            \
+    _h = rix_hash_arch->hfn(key, mask);                                       \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        bkt *_bk = buckets + (_h.val32[_i] & mask);                           \
+        u32 _hits = rix_hash_arch->ffn(_bk->key, key);                        \
+        if (_hits) {                                                          \
+            _bk->key[__builtin_ctz(_hits)] = (kt)(invalid_key);               \
+            head->rhh_nb--;                                                   \
+            return 0;                                                         \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+/* cb(key, &val, arg): return 0 to continue, non-zero to stop.        */      \
+/* walk_range covers buckets [bk_begin, bk_end) (see name_walk_range). */     \
+attr int                                                                      \
+name##_walk_range(struct name *head,                                          \
+                  bkt *buckets,                                               \
+                  unsigned bk_begin,                                          \
+                  unsigned bk_end,                                            \
+                  int (*cb)(kt, vt *, void *),                                \
+                  void *arg)                                                  \
+{                                                                             \
+    if (bk_end > head->rhh_mask + 1u)                                         \
+        bk_end = head->rhh_mask + 1u;                                         \
+    for (unsigned _b = bk_begin; _b < bk_end; _b++) {                         \
+        bkt *_bk = buckets + _b;                                              \
+        for (unsigned _s = 0u; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {         \
+            int _r;                                                           \
+            if (_bk->key[_s] == (kt)(invalid_key))                            \
+                continue;                                                     \
+            _r = cb(_bk->key[_s], &_bk->val[_s], arg);                        \
+            if (_r)                                                           \
+                return _r;                                                    \
+        }                                                                     \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_walk(struct name *head,                                                \
+            bkt *buckets,                                                     \
+            int (*cb)(kt, vt *, void *),                                      \
+            void *arg)                                                        \
+{                                                                             \
+    return name##_walk_range(head, buckets, 0u, head->rhh_mask + 1u,          \
+                             cb, arg);                                        \
+}                                                                             \
+                                                                              \
+/* name_walk_step (see "Resumable walk") with (key, val) pairs as the   */    \
+/* output; max_out must be at least RIX_HASH_BUCKET_ENTRY_SZ.           */    \
+attr unsigned                                                                 \
+name##_walk_step(struct name *head,                                           \
+                 bkt *buckets,                                                \
+                 unsigned cursor,                                             \
+                 unsigned budget,                                             \
+                 kt *keys_out,                                                \
+                 vt *vals_out,                                                \
+                 unsigned max_out,                                            \
+                 unsigned *n_out)                                             \
+{                                                                             \
+    unsigned _nb = head->rhh_mask + 1u;                                       \
+    unsigned _end, _b, _n = 0u;                                               \
+    RIX_ASSERT(budget != 0u && max_out >= RIX_HASH_BUCKET_ENTRY_SZ);          \
+    if (cursor >= _nb) {                                                      \
+        *n_out = 0u;                                                          \
+        return 0u;                                                            \
+    }                                                                         \
+    _end = (budget < _nb - cursor) ? cursor + budget : _nb;                   \
+    for (_b = cursor; _b < _end && _b < cursor + RIX_HASH_BULK_AHEAD; _b++)   \
+        for (unsigned _l = 0; _l < sizeof(bkt); _l += 64u)                    \
+            __builtin_prefetch((const char *)(buckets + _b) + _l, 0, 1);      \
+    for (_b = cursor; _b < _end; _b++) {                                      \
+        const bkt *_bk = buckets + _b;                                        \
+        u32 _used;                                                            \
+        if (_b + RIX_HASH_BULK_AHEAD < _end)                                  \
+            for (unsigned _l = 0; _l < sizeof(bkt); _l += 64u)                \
+                __builtin_prefetch((const char *)(_bk + RIX_HASH_BULK_AHEAD)  \
+                                   + _l, 0, 1);                               \
+        _used = ~rix_hash_arch->ffn(_bk->key, (kt)(invalid_key)) & 0xffffu;   \
+        if ((unsigned)__builtin_popcount(_used) > max_out - _n)               \
+            break;                                                            \
+        while (_used) {                                                       \
+            unsigned _s = (unsigned)__builtin_ctz(_used);                     \
+            _used &= _used - 1u;                                              \
+            keys_out[_n] = _bk->key[_s];                                      \
+            vals_out[_n] = _bk->val[_s];                                      \
+            _n++;                                                             \
+        }                                                                     \
+    }                                                                         \
+    *n_out = _n;                                                              \
+    return (_b < _nb) ? _b : 0u;                                              \
+}
+
 /*===========================================================================
  * Sizing helper
  *
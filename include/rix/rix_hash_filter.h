@@ -0,0 +1,460 @@
+/*-
+ * SPDX-License-Identifier: BSD 3-Clause License
+ *
+ * Copyright (c) 2026 deadcafe.beef@gmail.com
+ * All rights reserved.
+ */
+
+/*
+ * rix_hash_filter.h - cuckoo filter (approximate set membership).
+ *
+ * Requires: rix_hash_common.h
+ *
+ * The bucket holds fingerprints only: no idx[], no node pool, no key.
+ * contains() answers "definitely absent" (0) or "maybe present" (1), so a
+ * filter in front of a full table rejects most misses with one or two
+ * small bucket reads and never touches the table.
+ *
+ * Bucket layouts (16 lanes, 0 marks an empty lane):
+ *
+ *   struct rix_hash_filter8_bucket_s    u8  fp[16]   16 bytes  (8-bit)
+ *   struct rix_hash_filter16_bucket_s   u16 fp[16]   32 bytes  (12/16-bit)
+ *
+ * A 12-bit fingerprint is stored in a 16-bit lane: there is no 12-bit
+ * compare, and a packed lane would cost a shift/mask per slot.  Lanes are
+ * scanned with find_u8x16 / find_u16x16 (SSE / AVX2 dispatch).
+ *
+ * Candidate buckets (partial-key cuckoo, as in rix_hash_tag.h):
+ *
+ *   fp  = val32[1] >> (32 - bits)   (0 remapped to 1)
+ *   bk0 = val32[0] & mask
+ *   bk1 = bk0 ^ rix_hash_filter_alt(fp)  (masked)
+ *
+ * The alternate bucket of a stored fingerprint depends only on its current
+ * bucket and its value, so the kickout (breadth-first, see
+ * rix_hash_common.h) relocates fingerprints without the original key.
+ * nb_bk must be a power of 2 and at least 2.
+ *
+ * False positives: a miss compares against the 2 * 16 lanes of its two
+ * buckets, so at full load the rate is about 32 / (2^bits - 1):
+ *
+ *   8-bit  ~12.5%    12-bit  ~0.8%    16-bit  ~0.05%
+ *
+ * and proportionally less at lower load.  There are no false negatives.
+ *
+ * Semantics follow the usual cuckoo filter: insert always adds one
+ * fingerprint copy (inserting a key twice stores it twice, and at most
+ * 32 copies fit), and remove clears one copy.  Only remove keys that were
+ * inserted: removing a never-inserted key may clear the fingerprint of an
+ * aliasing key and introduce a false negative.
+ *
+ * Generated functions:
+ *   init, hash, insert, insert_hashed, contains, contains_hashed,
+ *   remove, remove_hashed, contains_bulk, contains_bulk_hashed
+ *
+ * Keys are byte strings hashed with rix_hash_arch->hash_bytes.  The
+ * _hashed forms take that hash directly, so a caller that already hashed
+ * the key for the full table (same key bytes) can reuse it; only
+ * val32[0] and the top bits of val32[1] are used.
+ *
+ * The head is RIX_HASH_HEAD(name); rhh_nb counts stored fingerprints.
+ */
+
+#ifndef _RIX_HASH_FILTER_H_
+#  define _RIX_HASH_FILTER_H_
+
+#  include "rix_hash_common.h"
+
+/*===========================================================================
+ * Filter bucket layouts
+ *===========================================================================*/
+struct rix_hash_filter8_bucket_s {
+    u8  fp[RIX_HASH_BUCKET_ENTRY_SZ];   /* 16 bytes: 8-bit fingerprints */
+} __attribute__((aligned(16)));
+
+struct rix_hash_filter16_bucket_s {
+    u16 fp[RIX_HASH_BUCKET_ENTRY_SZ];   /* 32 bytes: 12/16-bit fps      */
+} __attribute__((aligned(32)));
+
+RIX_STATIC_ASSERT(sizeof(struct rix_hash_filter8_bucket_s) == 16,
+                  "filter8 bucket must be 16 bytes");
+RIX_STATIC_ASSERT(sizeof(struct rix_hash_filter16_bucket_s) == 32,
+                  "filter16 bucket must be 32 bytes");
+
+/*===========================================================================
+ * Filter helpers
+ *===========================================================================*/
+
+/* Non-zero bits-wide fingerprint of a hash. */
+static RIX_FORCE_INLINE u32
+rix_hash_filter_fp(const union rix_hash_hash_u h, unsigned bits)
+{
+    u32 fp = h.val32[1] >> (32u - bits);
+
+    return fp + (fp == 0u);
+}
+
+/* XOR distance between the two candidate buckets of fp (always odd). */
+static RIX_FORCE_INLINE u32
+rix_hash_filter_alt(u32 fp)
+{
+    u32 x = fp * 0x5bd1e995u;
+
+    x ^= x >> 15;
+    return x | 1u;
+}
+
+/*===========================================================================
+ * Sizing helper
+ *
+ * rix_hash_filter_nb_bk_hint - nb_bk for max_entries at <= ~87% lane fill
+ * (ceil(max_entries / 14), rounded up to a power of 2, minimum 2).  Cuckoo
+ * filters stay insertable well above 90% with 16-lane buckets, but the
+ * kickout path grows quickly near the end.
+ *===========================================================================*/
+static inline unsigned
+rix_hash_filter_nb_bk_hint(unsigned max_entries)
+{
+    unsigned n = (max_entries + 13u) / 14u;
+
+    if (n < 2u)
+        n = 2u;
+    n--;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    return n + 1u;
+}
+
+/*===========================================================================
+ * Shared body of the three widths: bkt is the bucket type, lt its lane
+ * type, bits the fingerprint width and ffn the rix_hash_arch lane search.
+ *===========================================================================*/
+#  define _RIX_HASH_GENERATE_FILTER(name, bkt, lt, bits, ffn, attr) \
+attr void                                                                     \
+name##_init(struct name *head,                                                \
+            bkt *buckets,                                                     \
+            unsigned nb_bk)                                                   \
+{                                                                             \
+    head->rhh_mask = nb_bk - 1u;                                              \
+    head->rhh_nb   = 0u;                                                      \
+    memset(buckets, 0, (size_t)nb_bk * sizeof(bkt));                          \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE union rix_hash_hash_u                      \
+name##_hash(const struct name *head,                                          \
+            const void *key,                                                  \
+            size_t key_bytes)                                                 \
+{                                                                             \
+    return rix_hash_arch->hash_bytes(key, key_bytes, head->rhh_mask);         \
+}                                                                             \
+                                                                              \
+/* Both candidate buckets and the fingerprint of h. */                        \
+static RIX_UNUSED RIX_FORCE_INLINE lt                                         \
+name##_buckets(const struct name *head,                                       \
+               union rix_hash_hash_u _h,                                      \
+               unsigned *bk0,                                                 \
+               unsigned *bk1)                                                 \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    u32 _fp = rix_hash_filter_fp(_h, (bits));                                 \
+    *bk0 = _h.val32[0] & mask;                                                \
+    *bk1 = (*bk0 ^ rix_hash_filter_alt(_fp)) & mask;                          \
+    return (lt)_fp;                                                           \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_find_empty(const bkt *_bk)                                             \
+{                                                                             \
+    u32 _m = rix_hash_arch->ffn(_bk->fp, (lt)0);                              \
+    return _m ? (int)__builtin_ctz(_m) : -1;                                  \
+}                                                                             \
+                                                                              \
+/* Shortest cuckoo path (see rix_hash_common.h); a fingerprint moves to */    \
+/* bk ^ alt(fp).  Returns the freed slot in *bk_out, or -1.            */     \
+static RIX_UNUSED int                                                         \
+name##_kickout_bfs(bkt *buckets,                                              \
+                   unsigned mask,                                             \
+                   unsigned bk0,                                              \
+                   unsigned bk1,                                              \
+                   unsigned *bk_out)                                          \
+{                                                                             \
+    struct rix_hash_bfs_s _q[RIX_HASH_BFS_QUEUE];                             \
+    unsigned _head = 0u, _tail = 0u;                                          \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk0, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk1, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    while (_head < _tail) {                                                   \
+        unsigned _qi = _head++;                                               \
+        unsigned _b  = _q[_qi].bk;                                            \
+        if (_q[_qi].depth != 0u) {                                            \
+            int _es = name##_find_empty(buckets + _b);                        \
+            if (_es >= 0) {                                                   \
+                unsigned _cs = (unsigned)_es;                                 \
+                while (_q[_qi].parent != RIX_HASH_BFS_ROOT) {                 \
+                    bkt *_src = buckets + _q[_q[_qi].parent].bk;              \
+                    bkt *_dst = buckets + _q[_qi].bk;                         \
+                    unsigned _ps = _q[_qi].slot;                              \
+                    _dst->fp[_cs] = _src->fp[_ps];                            \
+                    _src->fp[_ps] = (lt)0;                                    \
+                    _cs = _ps;                                                \
+                    _qi = _q[_qi].parent;                                     \
+                }                                                             \
+                *bk_out = _q[_qi].bk;                                         \
+                return (int)_cs;                                              \
+            }                                                                 \
+        }                                                                     \
+        if (_q[_qi].depth >= RIX_HASH_FOLLOW_DEPTH)                           \
+            continue;                                                         \
+        for (unsigned _n = 0, _fan = _rix_hash_bfs_fanout(_q, _qi);           \
+             _n < RIX_HASH_BUCKET_ENTRY_SZ && _fan != 0u; _n++) {             \
+            unsigned _s = _rix_hash_bfs_slot(_qi, _n,                         \
+                                             RIX_HASH_BUCKET_ENTRY_SZ);       \
+            unsigned _ab;                                                     \
+            if (_tail >= RIX_HASH_BFS_QUEUE)                                  \
+                break;                                                        \
+            _ab = (_b ^ rix_hash_filter_alt(buckets[_b].fp[_s])) & mask;      \
+            if (_rix_hash_bfs_on_path(_q, _qi, _ab))                          \
+                continue;                                                     \
+            __builtin_prefetch(&buckets[_ab], 0, 1);                          \
+            _q[_tail++] = (struct rix_hash_bfs_s){                            \
+                _ab, (u16)_qi, (u8)_s, (u8)(_q[_qi].depth + 1u) };            \
+            _fan--;                                                           \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+/* Returns 0 (inserted) or -1 (no cuckoo path: filter full, unchanged). */    \
+attr int                                                                      \
+name##_insert_hashed(struct name *head,                                       \
+                     bkt *buckets,                                            \
+                     union rix_hash_hash_u h)                                 \
+{                                                                             \
+    unsigned _bki[2];                                                         \
+    lt _fp = name##_buckets(head, h, &_bki[0], &_bki[1]);                     \
+    int _slot = -1;                                                           \
+    unsigned _b = _bki[0];                                                    \
+    for (int _i = 0; _i < 2 && _slot < 0; _i++) {                             \
+        _b    = _bki[_i];                                                     \
+        _slot = name##_find_empty(buckets + _b);                              \
+    }                                                                         \
+    if (_slot < 0)                                                            \
+        _slot = name##_kickout_bfs(buckets, head->rhh_mask,                   \
+                                   _bki[0], _bki[1], &_b);                    \
+    if (_slot < 0)                                                            \
+        return -1;                                                            \
+    buckets[_b].fp[_slot] = _fp;                                              \
+    head->rhh_nb++;                                                           \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_insert(struct name *head,                                              \
+              bkt *buckets,                                                   \
+              const void *key,                                                \
+              size_t key_bytes)                                               \
+{                                                                             \
+    return name##_insert_hashed(head, buckets,                                \
+                                name##_hash(head, key, key_bytes));           \
+}                                                                             \
+                                                                              \
+/* Returns 0 (definitely absent) or 1 (maybe present).                */      \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_contains_hashed(const struct name *head,                               \
+                       const bkt *buckets,                                    \
+                       union rix_hash_hash_u h)                               \
+{                                                                             \
+    unsigned _b0, _b1;                                                        \
+    lt _fp = name##_buckets(head, h, &_b0, &_b1);                             \
+    return (rix_hash_arch->ffn(buckets[_b0].fp, _fp) |                        \
+            rix_hash_arch->ffn(buckets[_b1].fp, _fp)) != 0u;                  \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_contains(const struct name *head,                                      \
+                const bkt *buckets,                                           \
+                const void *key,                                              \
+                size_t key_bytes)                                             \
+{                                                                             \
+    return name##_contains_hashed(head, buckets,                              \
+                                  name##_hash(head, key, key_bytes));         \
+}                                                                             \
+                                                                              \
+/* Clears one copy.  Returns 0 (removed) or -1 (no matching lane).    */      \
+attr int                                                                      \
+name##_remove_hashed(struct name *head,                                       \
+                     bkt *buckets,                                            \
+                     union rix_hash_hash_u h)                                 \
+{                                                                             \
+    unsigned _bki[2];                                                         \
+    lt _fp = name##_buckets(head, h, &_bki[0], &_bki[1]);                     \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        bkt *_bk = buckets + _bki[_i];                                        \
+        u32 _hits = rix_hash_arch->ffn(_bk->fp, _fp);                         \
+        if (_hits) {                                                          \
+            _bk->fp[__builtin_ctz(_hits)] = (lt)0;                            \
+            head->rhh_nb--;                                                   \
+            return 0;                                                         \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_remove(struct name *head,                                              \
+              bkt *buckets,                                                   \
+              const void *key,                                                \
+              size_t key_bytes)                                               \
+{                                                                             \
+    return name##_remove_hashed(head, buckets,                                \
+                                name##_hash(head, key, key_bytes));           \
+}                                                                             \
+                                                                              \
+/* maybe[i] = contains(hs[i]); both buckets are prefetched            */      \
+/* RIX_HASH_BULK_AHEAD queries ahead.  Returns the number of maybes.  */      \
+attr unsigned                                                                 \
+name##_contains_bulk_hashed(const struct name *head,                          \
+                            const bkt *buckets,                               \
+                            const union rix_hash_hash_u *hs,                  \
+                            unsigned n,                                       \
+                            u8 *maybe)                                        \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + _a; _t++) {                               \
+        if (_t < n) {                                                         \
+            unsigned _b0, _b1;                                                \
+            (void)name##_buckets(head, hs[_t], &_b0, &_b1);                   \
+            __builtin_prefetch(&buckets[_b0], 0, 1);                          \
+            __builtin_prefetch(&buckets[_b1], 0, 1);                          \
+        }                                                                     \
+        if (_t >= _a) {                                                       \
+            unsigned _j = _t - _a;                                            \
+            maybe[_j] = (u8)name##_contains_hashed(head, buckets, hs[_j]);    \
+            _ok += maybe[_j];                                                 \
+        }                                                                     \
+    }                                                                         \
+    return _ok;                                                               \
+}                                                                             \
+                                                                              \
+/* Same, hashing n key_bytes-long keys with hash_bytes_n per block.   */      \
+attr unsigned                                                                 \
+name##_contains_bulk(const struct name *head,                                 \
+                     const bkt *buckets,                                      \
+                     const void * const *keys,                                \
+                     size_t key_bytes,                                        \
+                     unsigned n,                                              \
+                     u8 *maybe)                                               \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _h[2u * RIX_HASH_BULK_AHEAD];                       \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _i = 0u; _i < n + _a; _i += _a) {                           \
+        if (_i < n) {                                                         \
+            union rix_hash_hash_u *_o = &_h[_i % (2u * _a)];                  \
+            unsigned _m = (n - _i < _a) ? n - _i : _a;                        \
+            rix_hash_arch->hash_bytes_n(keys + _i, key_bytes, _m,             \
+                                        head->rhh_mask, _o);                  \
+            for (unsigned _j = 0u; _j < _m; _j++) {                           \
+                unsigned _b0, _b1;                                            \
+                (void)name##_buckets(head, _o[_j], &_b0, &_b1);               \
+                __builtin_prefetch(&buckets[_b0], 0, 1);                      \
+                __builtin_prefetch(&buckets[_b1], 0, 1);                      \
+            }                                                                 \
+        }                                                                     \
+        if (_i >= _a) {                                                       \
+            unsigned _p = _i - _a;                                            \
+            for (unsigned _j = _p; _j < _p + _a && _j < n; _j++) {            \
+                maybe[_j] = (u8)name##_contains_hashed(                       \
+                    head, buckets, _h[_j % (2u * _a)]);                       \
+                _ok += maybe[_j];                                             \
+            }                                                                 \
+        }                                                                     \
+    }                                                                         \
+    return _ok;                                                               \
+}
+
+/*===========================================================================
+ * RIX_HASH_GENERATE_FILTER8 / 12 / 16(name)
+ *
+ * Cuckoo filter with 8-, 12- or 16-bit fingerprints.  The head is
+ * RIX_HASH_HEAD(name); buckets are struct rix_hash_filter8_bucket_s
+ * (FILTER8) or struct rix_hash_filter16_bucket_s (FILTER12 / FILTER16).
+ *
+ * Generated functions:
+ *   void     name_init    (head, buckets, nb_bk)
+ *   union rix_hash_hash_u name_hash(head, key, key_bytes)
+ *   int      name_insert  (head, buckets, key, key_bytes)  0 / -1 full
+ *   int      name_contains(head, buckets, key, key_bytes)  0 absent / 1 maybe
+ *   int      name_remove  (head, buckets, key, key_bytes)  0 / -1 no match
+ *   unsigned name_contains_bulk(head, buckets, keys, key_bytes, n, maybe)
+ *            maybe[i] = contains(keys[i]); returns the number of maybes
+ *
+ *   name_insert_hashed / name_contains_hashed / name_remove_hashed (h) and
+ *   name_contains_bulk_hashed(head, buckets, hs, n, maybe) take the hash.
+ *===========================================================================*/
+#  define RIX_HASH_PROTOTYPE_FILTER_INTERNAL(name, bkt, attr) \
+    attr void name##_init(struct name *head, bkt *buckets,                    \
+                          unsigned nb_bk);                                    \
+    attr int name##_insert_hashed(struct name *head, bkt *buckets,            \
+                                  union rix_hash_hash_u h);                   \
+    attr int name##_remove_hashed(struct name *head, bkt *buckets,            \
+                                  union rix_hash_hash_u h);                   \
+    attr unsigned name##_contains_bulk_hashed(                                \
+        const struct name *head, const bkt *buckets,                          \
+        const union rix_hash_hash_u *hs, unsigned n, u8 *maybe);              \
+    attr unsigned name##_contains_bulk(const struct name *head,               \
+                                       const bkt *buckets,                    \
+                                       const void * const *keys,              \
+                                       size_t key_bytes,                      \
+                                       unsigned n, u8 *maybe);
+
+#  define RIX_HASH_PROTOTYPE_FILTER8(name) \
+    RIX_HASH_PROTOTYPE_FILTER_INTERNAL(name,                                  \
+        struct rix_hash_filter8_bucket_s, )
+
+#  define RIX_HASH_PROTOTYPE_FILTER12(name) \
+    RIX_HASH_PROTOTYPE_FILTER_INTERNAL(name,                                  \
+        struct rix_hash_filter16_bucket_s, )
+
+#  define RIX_HASH_PROTOTYPE_FILTER16(name) \
+    RIX_HASH_PROTOTYPE_FILTER_INTERNAL(name,                                  \
+        struct rix_hash_filter16_bucket_s, )
+
+#  define RIX_HASH_GENERATE_FILTER8(name) \
+    RIX_HASH_GENERATE_FILTER_INTERNAL(name, 8, )
+
+#  define RIX_HASH_GENERATE_FILTER12(name) \
+    RIX_HASH_GENERATE_FILTER_INTERNAL(name, 12, )
+
+#  define RIX_HASH_GENERATE_FILTER16(name) \
+    RIX_HASH_GENERATE_FILTER_INTERNAL(name, 16, )
+
+#  define RIX_HASH_GENERATE_STATIC_FILTER8(name) \
+    RIX_HASH_GENERATE_FILTER_INTERNAL(name, 8, RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_STATIC_FILTER12(name) \
+    RIX_HASH_GENERATE_FILTER_INTERNAL(name, 12, RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_STATIC_FILTER16(name) \
+    RIX_HASH_GENERATE_FILTER_INTERNAL(name, 16, RIX_UNUSED static)
+
+/* bits <= 8 uses u8 lanes, wider fingerprints u16 lanes. */
+#  define RIX_HASH_GENERATE_FILTER_INTERNAL(name, bits, attr) \
+    _RIX_HASH_GENERATE_FILTER_##bits(name, attr)
+
+#  define _RIX_HASH_GENERATE_FILTER_8(name, attr) \
+    _RIX_HASH_GENERATE_FILTER(name, struct rix_hash_filter8_bucket_s,         \
+                              u8, 8u, find_u8x16, attr)
+
+#  define _RIX_HASH_GENERATE_FILTER_12(name, attr) \
+    _RIX_HASH_GENERATE_FILTER(name, struct rix_hash_filter16_bucket_s,        \
+                              u16, 12u, find_u16x16, attr)
+
+#  define _RIX_HASH_GENERATE_FILTER_16(name, attr) \
+    _RIX_HASH_GENERATE_FILTER(name, struct rix_hash_filter16_bucket_s,        \
+                              u16, 16u, find_u16x16, attr)
+
+#endif /* _RIX_HASH_FILTER_H_ */
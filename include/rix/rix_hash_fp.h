@@ -11,7 +11,9 @@
  * Requires: rix_hash_common.h
  *
  * Generated functions (section order):
- *   init, staged find (x1, xN), find, insert, remove, remove_at, walk
+ *   init, staged find (x1, xN), find, insert, remove, remove_at, walk,
+ *   walk_range, walk_step, insert_bulk, remove_bulk,
+ *   build_bk, build_range, build_finish
  */
 
 #ifndef _RIX_HASH_FP_H_
@@ -33,9 +35,11 @@
 
 
 #  define RIX_HASH_GENERATE_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
     RIX_HASH_GENERATE_INTERNAL(name, type, key_field, hash_field, cmp_fn, hash_fn, )
 
 #  define RIX_HASH_GENERATE_STATIC_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
     RIX_HASH_GENERATE_INTERNAL(name, type, key_field, hash_field, cmp_fn, hash_fn, RIX_UNUSED static)
 
 #  define RIX_HASH_GENERATE(name, type, key_field, hash_field, cmp_fn)         \
@@ -81,14 +85,13 @@ name##_hptr(struct type *base, unsigned i) {                                  \
 /* Stage 1: compute hash, resolve bucket pointers, issue prefetches. */       \
 /* Must be called before name_scan_bk.                               */       \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
-name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
-                struct name *head,                                            \
-                struct rix_hash_bucket_s *buckets,                            \
-                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+name##_hash_key_hashed(struct rix_hash_find_ctx_s *ctx,                       \
+                       struct name *head,                                     \
+                       struct rix_hash_bucket_s *buckets,                     \
+                       const _RIX_HASH_KEY_TYPE(type, key_field) *key,        \
+                       union rix_hash_hash_u _h)                              \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        hash_fn(key, mask);                                                   \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
@@ -101,6 +104,16 @@ name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
     /* bk_1 not prefetched: bk_0 miss path fetches it lazily in cmp_key. */   \
 }                                                                             \
                                                                               \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
+                struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+{                                                                             \
+    name##_hash_key_hashed(ctx, head, buckets, key,                           \
+                           hash_fn(key, head->rhh_mask));                     \
+}                                                                             \
+                                                                              \
 /* Stage 2: scan bk_0 fingerprints only; produce fp_hits[0] bitmask.  */      \
 /* fp != 0 (XOR-based), no _nilm filter needed; fp_hits[1] = 0 here.  */      \
 /* Call prefetch_node to hide node-fetch latency before cmp_key.      */      \
@@ -254,8 +267,15 @@ name##_hash_key_n(struct rix_hash_find_ctx_s *ctx,                            \
                   struct rix_hash_bucket_s *buckets,                          \
                   const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys)    \
 {                                                                             \
-    for (int _j = 0; _j < n; _j++)                                            \
-        name##_hash_key(&ctx[_j], head, buckets, keys[_j]);                   \
+    union rix_hash_hash_u _h[RIX_HASH_N_LANES];                               \
+    for (int _b = 0; _b < n; _b += (int)RIX_HASH_N_LANES) {                   \
+        unsigned _m = (unsigned)(n - _b) < RIX_HASH_N_LANES ?                 \
+                      (unsigned)(n - _b) : RIX_HASH_N_LANES;                  \
+        name##_hash_n(keys + _b, _m, head->rhh_mask, _h);                     \
+        for (unsigned _j = 0; _j < _m; _j++)                                  \
+            name##_hash_key_hashed(&ctx[_b + _j], head, buckets,              \
+                                   keys[_b + _j], _h[_j]);                    \
+    }                                                                         \
 }                                                                             \
                                                                               \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
@@ -404,8 +424,6 @@ name##_insert_hashed(struct name *head,                                       \
     u32 _hits_fp[2];                                                     \
     u32 _hits_zero[2];                                                   \
     _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
-    /* Store h.val32[0] in hash_field initially; updated later if bk1 chosen */\
-    elm->hash_field = _h.val32[0];                                            \
     _rix_hash_prefetch_bucket(buckets + _bk0);                                \
     if (_bk1 != _bk0)                                                         \
         _rix_hash_prefetch_bucket(buckets + _bk1);                            \
@@ -447,8 +465,9 @@ name##_insert_hashed(struct name *head,                                       \
             unsigned _slot   = (unsigned)__builtin_ctz(_nilm);                \
             _bk->hash[_slot] = _fp;                                           \
             _bk->idx [_slot] = name##_hidx(base, elm);                        \
-            /* update hash_field: store the hash of the chosen bucket */      \
-            if (_i == 1) elm->hash_field = _h.val32[1];                       \
+            /* hash_field is written only once elm is placed, so a  */        \
+            /* duplicate insert of a present node leaves it intact. */        \
+            elm->hash_field = _h.val32[_i];                                   \
             head->rhh_nb++;                                                   \
             return NULL; /* success */                                        \
         }                                                                     \
@@ -463,6 +482,7 @@ name##_insert_hashed(struct name *head,                                       \
                               RIX_HASH_FOLLOW_DEPTH);                         \
         if (_pos >= 0) {                                                      \
             _bki = _bk0;                                                      \
+            elm->hash_field = _h.val32[0];                                    \
         } else {                                                              \
             _pos = name##_kickout(buckets, base, mask, _bk1,                  \
                                   RIX_HASH_FOLLOW_DEPTH);                     \
@@ -562,6 +582,10 @@ name##_remove_at(struct name *head,                                           \
 /* Returns 0 when all entries are visited, or the first non-zero cb   */      \
 /* return value.                                                      */      \
 /* ================================================================== */      \
+_RIX_HASH_GENERATE_WALK_RANGE(name, walk_range, struct rix_hash_bucket_s,     \
+                              struct type, RIX_HASH_BUCKET_ENTRY_SZ,          \
+                              head->rhh_mask + 1u, 0, attr)                   \
+                                                                              \
 attr int                                                                      \
 name##_walk(struct name *head,                                                \
             struct rix_hash_bucket_s *buckets,                                \
@@ -569,21 +593,32 @@ name##_walk(struct name *head,                                                \
             int (*cb)(struct type *, void *),                                 \
             void *arg)                                                        \
 {                                                                             \
-    unsigned _nb_bk = head->rhh_mask + 1u;                                    \
-    for (unsigned _b = 0u; _b < _nb_bk; _b++) {                               \
-        struct rix_hash_bucket_s *_bk = buckets + _b;                         \
-        for (unsigned _s = 0u; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {         \
-            unsigned     _nidx = _bk->idx[_s];                                \
-            if (_nidx == (unsigned)RIX_NIL)                                   \
-                continue;                                                     \
-            struct type *_node = name##_hptr(base, _nidx);                    \
-            int   _r    = cb(_node, arg);                                     \
-            if (_r)                                                           \
-                return _r;                                                    \
-        }                                                                     \
-    }                                                                         \
-    return 0;                                                                 \
-}
+    return name##_walk_range(head, buckets, base, 0u, head->rhh_mask + 1u,    \
+                             cb, arg);                                        \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_STEP(name, walk_step, struct rix_hash_bucket_s,       \
+                             RIX_HASH_BUCKET_ENTRY_SZ,                        \
+                             head->rhh_mask + 1u, 0, attr)                    \
+                                                                              \
+/* ================================================================== */      \
+/* Bulk insert / remove (pipelined; see rix_hash_common.h)            */      \
+/* ================================================================== */      \
+_RIX_HASH_GENERATE_INSERT_BULK(name, type, key_field, hash_fn, attr)          \
+_RIX_HASH_GENERATE_REMOVE_BULK(name, type, hash_field, attr)                  \
+                                                                              \
+/* ================================================================== */      \
+/* Parallel bulk build (see rix_hash_common.h)                        */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_build_place(struct type *elm, u32 hv, unsigned slot)                   \
+{                                                                             \
+    (void)slot;                                                               \
+    elm->hash_field = hv;                                                     \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_BUILD(name, type, key_field, cmp_fn, name##_build_place,   \
+                         attr)
 
 
 #endif /* _RIX_HASH_FP_H_ */
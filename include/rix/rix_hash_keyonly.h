@@ -14,7 +14,9 @@
  * the key to find the bucket (no O(1) shortcut via hash_field).
  *
  * Generated functions (section order):
- *   init, staged find (x1, xN), find, insert, remove, remove_at, walk
+ *   init, staged find (x1, xN), find, insert, remove, remove_at, walk,
+ *   walk_range, walk_step, insert_bulk, remove_bulk,
+ *   build_bk, build_range, build_finish
  */
 
 #ifndef _RIX_HASH_KEYONLY_H_
@@ -51,7 +53,46 @@
                          struct rix_hash_bucket_s *buckets,                   \
                          struct type *base,                                   \
                          int (*cb)(struct type *, void *),                    \
-                         void *arg);
+                         void *arg);                                          \
+    attr int name##_walk_range(struct name *head,                             \
+                               struct rix_hash_bucket_s *buckets,             \
+                               struct type *base,                             \
+                               unsigned bk_begin, unsigned bk_end,            \
+                               int (*cb)(struct type *, void *),              \
+                               void *arg);                                    \
+    attr unsigned name##_walk_step(struct name *head,                         \
+                                   struct rix_hash_bucket_s *buckets,         \
+                                   unsigned cursor, unsigned budget,          \
+                                   u32 *idx_out, unsigned max_out,            \
+                                   unsigned *n_out);                          \
+    attr unsigned name##_insert_bulk(struct name *head,                       \
+                                     struct rix_hash_bucket_s *buckets,       \
+                                     struct type *base,                       \
+                                     struct type * const *elms,               \
+                                     unsigned n,                              \
+                                     struct type **results);                  \
+    attr unsigned name##_remove_bulk(struct name *head,                       \
+                                     struct rix_hash_bucket_s *buckets,       \
+                                     struct type *base,                       \
+                                     struct type * const *elms,               \
+                                     unsigned n);                             \
+    attr unsigned name##_build_bk(struct name *head,                          \
+                                  const struct type *elm);                    \
+    attr unsigned name##_build_range(struct name *head,                       \
+                                     struct rix_hash_bucket_s *buckets,       \
+                                     struct type *base,                       \
+                                     struct type * const *elms,               \
+                                     unsigned n,                              \
+                                     unsigned bk_begin, unsigned bk_end,      \
+                                     struct type **spill,                     \
+                                     unsigned *nb_spill);                     \
+    attr unsigned name##_build_finish(struct name *head,                      \
+                                      struct rix_hash_bucket_s *buckets,      \
+                                      struct type *base,                      \
+                                      unsigned nb_placed,                     \
+                                      struct type * const *spill,             \
+                                      unsigned nb_spill,                      \
+                                      struct type **results);
 
 #  define RIX_HASH_KEYONLY_PROTOTYPE_EX(name, type, key_field, cmp_fn, hash_fn) \
     RIX_HASH_KEYONLY_PROTOTYPE_INTERNAL(name, type, key_field, cmp_fn, )
@@ -66,9 +107,11 @@
     RIX_HASH_KEYONLY_PROTOTYPE_INTERNAL(name, type, key_field, cmp_fn, RIX_UNUSED static)
 
 #  define RIX_HASH_GENERATE_KEYONLY_EX(name, type, key_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
     RIX_HASH_GENERATE_KEYONLY_INTERNAL(name, type, key_field, cmp_fn, hash_fn, )
 
 #  define RIX_HASH_GENERATE_KEYONLY_STATIC_EX(name, type, key_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
     RIX_HASH_GENERATE_KEYONLY_INTERNAL(name, type, key_field, cmp_fn, hash_fn, RIX_UNUSED static)
 
 #  define RIX_HASH_GENERATE_KEYONLY(name, type, key_field, cmp_fn)               \
@@ -114,14 +157,13 @@ name##_hptr(struct type *base, unsigned i) {                                  \
 /* Stage 1: compute hash, resolve bucket pointers, issue prefetches. */       \
 /* Must be called before name_scan_bk.                               */       \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
-name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
-                struct name *head,                                            \
-                struct rix_hash_bucket_s *buckets,                            \
-                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+name##_hash_key_hashed(struct rix_hash_find_ctx_s *ctx,                       \
+                       struct name *head,                                     \
+                       struct rix_hash_bucket_s *buckets,                     \
+                       const _RIX_HASH_KEY_TYPE(type, key_field) *key,        \
+                       union rix_hash_hash_u _h)                              \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        hash_fn(key, mask);                                                   \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
@@ -133,6 +175,16 @@ name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
     _rix_hash_prefetch_bucket(ctx->bk[0]);                                    \
 }                                                                             \
                                                                               \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
+                struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+{                                                                             \
+    name##_hash_key_hashed(ctx, head, buckets, key,                           \
+                           hash_fn(key, head->rhh_mask));                     \
+}                                                                             \
+                                                                              \
 /* Stage 2: scan bk_0 fingerprints only; produce fp_hits[0] bitmask.  */      \
 /* fp != 0 (XOR-based), no _nilm filter needed; fp_hits[1] = 0 here.  */      \
 /* Call prefetch_node to hide node-fetch latency before cmp_key.      */      \
@@ -204,8 +256,15 @@ name##_hash_key_n(struct rix_hash_find_ctx_s *ctx,                            \
                   struct rix_hash_bucket_s *buckets,                          \
                   const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys)    \
 {                                                                             \
-    for (int _j = 0; _j < n; _j++)                                            \
-        name##_hash_key(&ctx[_j], head, buckets, keys[_j]);                   \
+    union rix_hash_hash_u _h[RIX_HASH_N_LANES];                               \
+    for (int _b = 0; _b < n; _b += (int)RIX_HASH_N_LANES) {                   \
+        unsigned _m = (unsigned)(n - _b) < RIX_HASH_N_LANES ?                 \
+                      (unsigned)(n - _b) : RIX_HASH_N_LANES;                  \
+        name##_hash_n(keys + _b, _m, head->rhh_mask, _h);                     \
+        for (unsigned _j = 0; _j < _m; _j++)                                  \
+            name##_hash_key_hashed(&ctx[_b + _j], head, buckets,              \
+                                   keys[_b + _j], _h[_j]);                    \
+    }                                                                         \
 }                                                                             \
                                                                               \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
@@ -358,16 +417,14 @@ name##_kickout(struct rix_hash_bucket_s *buckets,                             \
 /*   elm      - table full (kickout exhausted)                        */      \
 /*   other    - duplicate found, returns the existing node            */      \
 /* ================================================================== */      \
-attr struct type *                                                            \
-name##_insert(struct name *head,                                              \
-              struct rix_hash_bucket_s *buckets,                              \
-              struct type *base,                                              \
-              struct type *elm)                                               \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_insert_hashed(struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     struct type *base,                                       \
+                     struct type *elm,                                        \
+                     union rix_hash_hash_u _h)                                \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
-                mask);                                                        \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     u32 _hits_fp[2];                                                     \
@@ -420,6 +477,19 @@ name##_insert(struct name *head,                                              \
     }                                                               \
 }                                                                             \
                                                                               \
+attr struct type *                                                            \
+name##_insert(struct name *head,                                              \
+              struct rix_hash_bucket_s *buckets,                              \
+              struct type *base,                                              \
+              struct type *elm)                                               \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h =                                                \
+        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
+                mask);                                                        \
+    return name##_insert_hashed(head, buckets, base, elm, _h);                \
+}                                                                             \
+                                                                              \
 /* ================================================================== */      \
 /* Remove (re-hash key; scan bk_0 then bk_1)                          */      \
 /* ================================================================== */      \
@@ -429,17 +499,15 @@ name##_remove_at(struct name *head,                                           \
                  unsigned bk,                                                 \
                  unsigned slot);                                              \
                                                                               \
-attr struct type *                                                            \
-name##_remove(struct name *head,                                              \
-              struct rix_hash_bucket_s *buckets,                              \
-              struct type *base,                                              \
-              struct type *elm)                                               \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_remove_hashed(struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     struct type *base,                                       \
+                     struct type *elm,                                        \
+                     union rix_hash_hash_u _h)                                \
 {                                                                             \
     unsigned node_idx = name##_hidx(base, elm);                               \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
-                mask);                                                        \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
@@ -456,6 +524,17 @@ name##_remove(struct name *head,                                              \
         }                                                                     \
     }                                                                         \
     return NULL;                                                              \
+}                                                                             \
+attr struct type *                                                            \
+name##_remove(struct name *head,                                              \
+              struct rix_hash_bucket_s *buckets,                              \
+              struct type *base,                                              \
+              struct type *elm)                                               \
+{                                                                             \
+    union rix_hash_hash_u _h =                                                \
+        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
+                head->rhh_mask);                                              \
+    return name##_remove_hashed(head, buckets, base, elm, _h);                \
 }                                                                             \
                                                                               \
 attr unsigned                                                                 \
@@ -481,6 +560,10 @@ name##_remove_at(struct name *head,                                           \
 /* ================================================================== */      \
 /* Walk                                                               */      \
 /* ================================================================== */      \
+_RIX_HASH_GENERATE_WALK_RANGE(name, walk_range, struct rix_hash_bucket_s,     \
+                              struct type, RIX_HASH_BUCKET_ENTRY_SZ,          \
+                              head->rhh_mask + 1u, 0, attr)                   \
+                                                                              \
 attr int                                                                      \
 name##_walk(struct name *head,                                                \
             struct rix_hash_bucket_s *buckets,                                \
@@ -488,21 +571,68 @@ name##_walk(struct name *head,                                                \
             int (*cb)(struct type *, void *),                                 \
             void *arg)                                                        \
 {                                                                             \
-    unsigned _nb_bk = head->rhh_mask + 1u;                                    \
-    for (unsigned _b = 0u; _b < _nb_bk; _b++) {                               \
-        struct rix_hash_bucket_s *_bk = buckets + _b;                         \
-        for (unsigned _s = 0u; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {         \
-            unsigned     _nidx = _bk->idx[_s];                                \
-            if (_nidx == (unsigned)RIX_NIL)                                   \
-                continue;                                                     \
-            struct type *_node = name##_hptr(base, _nidx);                    \
-            int   _r    = cb(_node, arg);                                     \
-            if (_r)                                                           \
-                return _r;                                                    \
+    return name##_walk_range(head, buckets, base, 0u, head->rhh_mask + 1u,    \
+                             cb, arg);                                        \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_STEP(name, walk_step, struct rix_hash_bucket_s,       \
+                             RIX_HASH_BUCKET_ENTRY_SZ,                        \
+                             head->rhh_mask + 1u, 0, attr)                    \
+                                                                              \
+/* ================================================================== */      \
+/* Bulk insert / remove (pipelined; see rix_hash_common.h)            */      \
+/* Remove re-hashes in stage 1, so both candidate buckets are warm    */      \
+/* by the time remove_hashed scans them.                              */      \
+/* ================================================================== */      \
+_RIX_HASH_GENERATE_INSERT_BULK(name, type, key_field, hash_fn, attr)          \
+attr unsigned                                                                 \
+name##_remove_bulk(struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   struct type *base,                                         \
+                   struct type * const *elms,                                 \
+                   unsigned n)                                                \
+{                                                                             \
+    const unsigned _a = RIX_HASH_BULK_AHEAD;                                  \
+    union rix_hash_hash_u _hs[_RIX_HASH_BULK_RING];                           \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _ok = 0u;                                                        \
+    for (unsigned _t = 0u; _t < n + 2u * _a; _t++) {                          \
+        /* Stage 2: commit */                                                 \
+        if (_t >= 2u * _a) {                                                  \
+            unsigned _i = _t - 2u * _a;                                       \
+            if (name##_remove_hashed(head, buckets, base, elms[_i],           \
+                                     _hs[_i % _RIX_HASH_BULK_RING]) != NULL)  \
+                _ok++;                                                        \
         }                                                                     \
+        /* Stage 1: batch re-hash a block, prefetch candidate buckets */      \
+        if (_t >= _a && _t - _a < n && (_t - _a) % _a == 0u) {                \
+            unsigned _i = _t - _a;                                            \
+            name##_bulk_hash_blk(buckets, mask, elms + _i,                    \
+                                 (n - _i < _a) ? n - _i : _a,                 \
+                                 &_hs[_i % _RIX_HASH_BULK_RING]);             \
+        }                                                                     \
+        /* Stage 0: prefetch a block of nodes (key) */                        \
+        if (_t < n && _t % _a == 0u)                                          \
+            for (unsigned _j = _t; _j < n && _j < _t + _a; _j++)              \
+                _rix_hash_prefetch_entry(elms[_j]);                           \
     }                                                                         \
-    return 0;                                                                 \
-}
+    return _ok;                                                               \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Parallel bulk build (see rix_hash_common.h); the node records      */      \
+/* nothing, so placing writes the bucket entry only.                  */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_build_place(struct type *elm, u32 hv, unsigned slot)                   \
+{                                                                             \
+    (void)elm;                                                                \
+    (void)hv;                                                                 \
+    (void)slot;                                                               \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_BUILD(name, type, key_field, cmp_fn, name##_build_place,   \
+                         attr)
 
 
 #endif /* _RIX_HASH_KEYONLY_H_ */
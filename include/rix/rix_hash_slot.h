@@ -11,7 +11,64 @@
  * Requires: rix_hash_common.h
  *
  * Generated functions (section order):
- *   init, staged find (x1, xN), find, insert, remove, remove_at, walk
+ *   init, staged find (x1, xN), find, insert, remove, remove_at,
+ *   relocate, swap, promote, promote_hashed, walk, walk_range, walk_step,
+ *   insert_bulk, remove_bulk, build_bk, build_range, build_finish,
+ *   seqlock single-writer / multi-reader forms (name_seq_*);
+ *   RIX_HASH_GENERATE_SLOT_RESIZE adds online doubling (name_rs_*);
+ *   RIX_HASH_GENERATE_SLOT_STASH adds an overflow stash (name_st_*);
+ *   RIX_HASH_GENERATE_SLOT_SEED adds a keyed hash with online reseed
+ *   (name_sd_*)
+ *
+ * Single-writer / multi-reader mode:
+ *   All name_seq_* functions take an extra  u32 *seq  argument, an array of
+ *   nb_bk per-bucket sequence counters owned by the caller (zeroed before
+ *   first use; see rix_hash_common.h).  One writer thread uses
+ *   name_seq_insert / name_seq_remove / name_seq_remove_at; any number of
+ *   reader threads use name_seq_find or the staged pipeline
+ *
+ *     name_seq_hash_key -> name_seq_scan_bk -> name_prefetch_node
+ *                       -> name_seq_cmp_key
+ *
+ *   Readers retry only when a counter of one of their two candidate buckets
+ *   changed, so a cuckoo displacement in flight is never observed as a miss.
+ *   Mixing the plain writer ops with concurrent readers is not supported.
+ *
+ * Pool compaction:
+ *   hash_field and slot_field locate the one bucket idx[] entry that refers
+ *   to a node, so a node can change its pool index in O(1):
+ *
+ *     name_relocate(head, buckets, base, src, dst)
+ *         copy *src to the unused node dst and repoint its bucket entry;
+ *         src is left intact for the caller to release.  Returns dst.
+ *     name_swap(head, buckets, base, a, b)
+ *         exchange two live nodes and repoint both bucket entries.
+ *
+ *   Both verify the bucket entry first and return NULL / -1 for a node
+ *   that is not in a bucket (free, stash-resident, or mid-split in a
+ *   resizing table).  The name_seq_* forms bump the touched buckets'
+ *   counters.  Any index the caller cached for a moved node is stale.
+ *
+ * Bucket promotion:
+ *   A node placed in its bk_1 by a cuckoo kick costs every lookup a second
+ *   bucket scan.  name_promote(head, buckets, base, elm) moves it back:
+ *
+ *     - elm already in bk_0                 -> 0
+ *     - bk_0 has a free slot                -> elm moved there, 1
+ *     - bk_0 full: one occupant that is itself displaced (its own bk_0 is
+ *       elsewhere) is flipped to its alternate bucket first, then elm
+ *       takes its slot                      -> 1
+ *     - no room without demoting a primary  -> -1
+ *
+ *   Moves use the XOR alternate-bucket trick and the lowest free slot.
+ *   Full-bucket cases rehash each bk_0 occupant, so this is meant for a
+ *   maintenance pass over entries known to be hot, not the lookup path.
+ *
+ *   A table filled through insert_hashed() with rix_hash_hash_from_u32()
+ *   hashes uses name_promote_hashed(head, buckets, base, elm) instead:
+ *   same results, but bk_0 is told from hash_field and the bucket
+ *   fingerprint, so nothing is hashed.  name_promote() would hash the
+ *   keys with hash_fn and look in other buckets.
  */
 
 #ifndef _RIX_HASH_SLOT_H_
@@ -19,23 +76,88 @@
 
 #  include "rix_hash_common.h"
 
+#  define RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr)      \
+    attr struct type *name##_seq_find(struct name *head,                             \
+                                      struct rix_hash_bucket_s *buckets,             \
+                                      const u32 *seq,                                \
+                                      struct type *base,                             \
+                                      const _RIX_HASH_KEY_TYPE(type, key_field) *key); \
+    attr struct type *name##_seq_insert(struct name *head,                           \
+                                        struct rix_hash_bucket_s *buckets,           \
+                                        u32 *seq,                                    \
+                                        struct type *base,                           \
+                                        struct type *elm);                           \
+    attr unsigned name##_seq_remove_at(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       u32 *seq,                                     \
+                                       unsigned bk,                                  \
+                                       unsigned slot);                               \
+    attr struct type *name##_seq_remove(struct name *head,                           \
+                                        struct rix_hash_bucket_s *buckets,           \
+                                        u32 *seq,                                    \
+                                        struct type *base,                           \
+                                        struct type *elm);                           \
+    attr struct type *name##_relocate(struct name *head,                             \
+                                      struct rix_hash_bucket_s *buckets,             \
+                                      struct type *base,                             \
+                                      struct type *src,                              \
+                                      struct type *dst);                             \
+    attr struct type *name##_seq_relocate(struct name *head,                         \
+                                          struct rix_hash_bucket_s *buckets,         \
+                                          u32 *seq,                                  \
+                                          struct type *base,                         \
+                                          struct type *src,                          \
+                                          struct type *dst);                         \
+    attr int name##_swap(struct name *head,                                          \
+                         struct rix_hash_bucket_s *buckets,                          \
+                         struct type *base,                                          \
+                         struct type *a,                                             \
+                         struct type *b);                                            \
+    attr int name##_seq_swap(struct name *head,                                      \
+                             struct rix_hash_bucket_s *buckets,                      \
+                             u32 *seq,                                               \
+                             struct type *base,                                      \
+                             struct type *a,                                         \
+                             struct type *b);                                        \
+    attr int name##_promote(struct name *head,                                       \
+                            struct rix_hash_bucket_s *buckets,                       \
+                            struct type *base,                                       \
+                            struct type *elm);                                       \
+    attr int name##_seq_promote(struct name *head,                                   \
+                                struct rix_hash_bucket_s *buckets,                   \
+                                u32 *seq,                                            \
+                                struct type *base,                                   \
+                                struct type *elm);                                   \
+    attr int name##_promote_hashed(struct name *head,                                \
+                                   struct rix_hash_bucket_s *buckets,                \
+                                   struct type *base,                                \
+                                   struct type *elm);                                \
+    attr int name##_seq_promote_hashed(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       u32 *seq,                                     \
+                                       struct type *base,                            \
+                                       struct type *elm);
+
 #  define RIX_HASH_PROTOTYPE_SLOT_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
 
 #  define RIX_HASH_PROTOTYPE_SLOT(name, type, key_field, hash_field, slot_field, cmp_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
 
 #  define RIX_HASH_PROTOTYPE_STATIC_SLOT_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
 
 #  define RIX_HASH_PROTOTYPE_STATIC_SLOT(name, type, key_field, hash_field, slot_field, cmp_fn) \
-    RIX_HASH_PROTOTYPE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
 
 #  define RIX_HASH_GENERATE_SLOT_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
     RIX_HASH_GENERATE_SLOT_INTERNAL(name, type, key_field, hash_field,         \
                                     slot_field, cmp_fn, hash_fn, )
 
 #  define RIX_HASH_GENERATE_STATIC_SLOT_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
     RIX_HASH_GENERATE_SLOT_INTERNAL(name, type, key_field, hash_field,         \
                                     slot_field, cmp_fn, hash_fn,               \
                                     RIX_UNUSED static)
@@ -82,14 +204,13 @@ name##_hptr(struct type *base, unsigned i) {                                  \
 /* Staged find - x1                                                   */      \
 /* ================================================================== */      \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
-name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
-                struct name *head,                                            \
-                struct rix_hash_bucket_s *buckets,                            \
-                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+name##_hash_key_hashed(struct rix_hash_find_ctx_s *ctx,                       \
+                       struct name *head,                                     \
+                       struct rix_hash_bucket_s *buckets,                     \
+                       const _RIX_HASH_KEY_TYPE(type, key_field) *key,        \
+                       union rix_hash_hash_u _h)                              \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        hash_fn(key, mask);                                                   \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
@@ -102,6 +223,16 @@ name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
 }                                                                             \
                                                                               \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key(struct rix_hash_find_ctx_s *ctx,                              \
+                struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+{                                                                             \
+    name##_hash_key_hashed(ctx, head, buckets, key,                           \
+                           hash_fn(key, head->rhh_mask));                     \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
 name##_scan_bk(struct rix_hash_find_ctx_s *ctx,                               \
                struct name *head __attribute__((unused)),                     \
                struct rix_hash_bucket_s *buckets __attribute__((unused)))     \
@@ -157,16 +288,15 @@ name##_cmp_key(struct rix_hash_find_ctx_s *ctx,                               \
 /* Use when miss -> insert is the expected follow-up path.             */      \
 /* ================================================================== */      \
                                                                               \
-/* Stage 1: like hash_key but prefetches both bk_0 and bk_1.         */      \
+/* Stage 1: like hash_key_hashed but prefetches both bk_0 and bk_1.  */      \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
-name##_hash_key_2bk(struct rix_hash_find_ctx_s *ctx,                          \
-                    struct name *head,                                        \
-                    struct rix_hash_bucket_s *buckets,                        \
-                    const _RIX_HASH_KEY_TYPE(type, key_field) *key)           \
+name##_hash_key_2bk_hashed(struct rix_hash_find_ctx_s *ctx,                   \
+                           struct name *head,                                 \
+                           struct rix_hash_bucket_s *buckets,                 \
+                           const _RIX_HASH_KEY_TYPE(type, key_field) *key,    \
+                           union rix_hash_hash_u _h)                          \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
-    union rix_hash_hash_u _h =                                                \
-        hash_fn(key, mask);                                                   \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
@@ -179,6 +309,17 @@ name##_hash_key_2bk(struct rix_hash_find_ctx_s *ctx,                          \
     _rix_hash_prefetch_bucket(ctx->bk[1]);                                    \
 }                                                                             \
                                                                               \
+/* Stage 1: like hash_key but prefetches both bk_0 and bk_1.         */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key_2bk(struct rix_hash_find_ctx_s *ctx,                          \
+                    struct name *head,                                        \
+                    struct rix_hash_bucket_s *buckets,                        \
+                    const _RIX_HASH_KEY_TYPE(type, key_field) *key)           \
+{                                                                             \
+    name##_hash_key_2bk_hashed(ctx, head, buckets, key,                       \
+                               hash_fn(key, head->rhh_mask));                 \
+}                                                                             \
+                                                                              \
 /* Stage 2: scan bk_0 for fp matches AND empty slots in one pass.     */      \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
 name##_scan_bk_empties(struct rix_hash_find_ctx_s *ctx,                       \
@@ -236,8 +377,14 @@ name##_hash_key_n(struct rix_hash_find_ctx_s *ctx,                            \
                   struct rix_hash_bucket_s *buckets,                          \
                   const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys)    \
 {                                                                             \
-    for (unsigned i = 0; i < n; i++)                                          \
-        name##_hash_key(&ctx[i], head, buckets, keys[i]);                     \
+    union rix_hash_hash_u _h[RIX_HASH_N_LANES];                               \
+    for (unsigned _b = 0; _b < n; _b += RIX_HASH_N_LANES) {                   \
+        unsigned _m = (n - _b < RIX_HASH_N_LANES) ? n - _b : RIX_HASH_N_LANES; \
+        name##_hash_n(keys + _b, _m, head->rhh_mask, _h);                     \
+        for (unsigned _j = 0; _j < _m; _j++)                                  \
+            name##_hash_key_hashed(&ctx[_b + _j], head, buckets,              \
+                                   keys[_b + _j], _h[_j]);                    \
+    }                                                                         \
 }                                                                             \
                                                                               \
 static RIX_UNUSED RIX_FORCE_INLINE void                                       \
@@ -282,6 +429,106 @@ name##_find(struct name *head,                                                \
 }                                                                             \
                                                                               \
 /* ================================================================== */      \
+/* Staged find - seqlock readers (single-writer / multi-reader)       */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_seq_hash_key(struct rix_hash_find_ctx_s *ctx,                          \
+                    struct name *head,                                        \
+                    struct rix_hash_bucket_s *buckets,                        \
+                    const u32 *seq,                                           \
+                    const _RIX_HASH_KEY_TYPE(type, key_field) *key)           \
+{                                                                             \
+    name##_hash_key(ctx, head, buckets, key);                                 \
+    __builtin_prefetch(&seq[ctx->bk[0] - buckets], 0, 1);                     \
+    __builtin_prefetch(&seq[ctx->bk[1] - buckets], 0, 1);                     \
+}                                                                             \
+                                                                              \
+/* Snapshot both bucket counters before any bucket data is read.      */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_seq_scan_bk(struct rix_hash_find_ctx_s *ctx,                           \
+                   struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   const u32 *seq)                                            \
+{                                                                             \
+    ctx->seq[0] = rix_hash_seq_snapshot(seq,                                  \
+                                        (unsigned)(ctx->bk[0] - buckets));    \
+    ctx->seq[1] = rix_hash_seq_snapshot(seq,                                  \
+                                        (unsigned)(ctx->bk[1] - buckets));    \
+    name##_scan_bk(ctx, head, buckets);                                       \
+}                                                                             \
+                                                                              \
+/* Compare, then validate the snapshots; rescan only if they moved.   */      \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_seq_cmp_key(struct rix_hash_find_ctx_s *ctx,                           \
+                   struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   const u32 *seq,                                            \
+                   struct type *base)                                         \
+{                                                                             \
+    unsigned _b0 = (unsigned)(ctx->bk[0] - buckets);                          \
+    unsigned _b1 = (unsigned)(ctx->bk[1] - buckets);                          \
+    struct type *_node = name##_cmp_key(ctx, base);                           \
+    while (RIX_UNLIKELY(rix_hash_seq_read_retry2(seq, _b0, ctx->seq[0],       \
+                                                 _b1, ctx->seq[1]))) {        \
+        ctx->seq[0] = rix_hash_seq_read_begin(seq, _b0);                      \
+        ctx->seq[1] = rix_hash_seq_read_begin(seq, _b1);                      \
+        name##_scan_bk(ctx, head, buckets);                                   \
+        _node = name##_cmp_key(ctx, base);                                    \
+    }                                                                         \
+    return _node;                                                             \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_seq_hash_key_n(struct rix_hash_find_ctx_s *ctx,                        \
+                      unsigned n,                                             \
+                      struct name *head,                                      \
+                      struct rix_hash_bucket_s *buckets,                      \
+                      const u32 *seq,                                         \
+                      const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys) \
+{                                                                             \
+    for (unsigned i = 0; i < n; i++)                                          \
+        name##_seq_hash_key(&ctx[i], head, buckets, seq, keys[i]);            \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_seq_scan_bk_n(struct rix_hash_find_ctx_s *ctx,                         \
+                     unsigned n,                                              \
+                     struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     const u32 *seq)                                          \
+{                                                                             \
+    for (unsigned i = 0; i < n; i++)                                          \
+        name##_seq_scan_bk(&ctx[i], head, buckets, seq);                      \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_seq_cmp_key_n(struct rix_hash_find_ctx_s *ctx,                         \
+                     unsigned n,                                              \
+                     struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     const u32 *seq,                                          \
+                     struct type *base,                                       \
+                     struct type **results)                                   \
+{                                                                             \
+    for (unsigned i = 0; i < n; i++)                                          \
+        results[i] = name##_seq_cmp_key(&ctx[i], head, buckets, seq, base);   \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_seq_find(struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                const u32 *seq,                                               \
+                struct type *base,                                            \
+                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+{                                                                             \
+    struct rix_hash_find_ctx_s _ctx;                                          \
+    name##_seq_hash_key(&_ctx, head, buckets, seq, key);                      \
+    name##_seq_scan_bk(&_ctx, head, buckets, seq);                            \
+    return name##_seq_cmp_key(&_ctx, head, buckets, seq, base);               \
+}                                                                             \
+                                                                              \
+                                                                              \
+/* ================================================================== */      \
 /* find_empty / flipflop / kickout (slot variant)                      */      \
 /* ================================================================== */      \
 static RIX_UNUSED int                                                         \
@@ -295,8 +542,10 @@ name##_find_empty(struct rix_hash_bucket_s *buckets,                          \
                                                                               \
 static RIX_UNUSED int                                                         \
 name##_flipflop(struct rix_hash_bucket_s *buckets,                            \
+                u32 *seq,                                                     \
                 struct type *base,                                            \
                 unsigned mask,                                                \
+                const struct rix_hash_resize_s *rs,                           \
                 unsigned bk_idx,                                              \
                 unsigned slot)                                                \
 {                                                                             \
@@ -306,23 +555,30 @@ name##_flipflop(struct rix_hash_bucket_s *buckets,                            \
     struct type *_nd  = name##_hptr(base, _idx);                              \
     if (!_nd) return -1;                                                      \
     u32 _h  = _nd->hash_field;                                            \
-    unsigned _ab = (_fp ^ _h) & mask;                                          \
+    unsigned _ab = _rix_hash_rs_bucket(_fp ^ _h, mask, rs);                   \
     int _slot = name##_find_empty(buckets, _ab);                              \
     if (_slot < 0) return -1;                                                 \
     struct rix_hash_bucket_s *_alt = buckets + _ab;                           \
-    _alt->hash[_slot] = _fp;                                                   \
-    _alt->idx [_slot] = _idx;                                                  \
-    _nd->hash_field = _fp ^ _h;                                                \
+    /* Both buckets are odd while the entry is in flight. */                  \
+    _rix_hash_seq_write_begin(seq, bk_idx);                                   \
+    _rix_hash_seq_write_begin(seq, _ab);                                      \
+    _alt->hash[_slot] = _fp;                                                  \
+    _alt->idx [_slot] = _idx;                                                 \
+    _nd->hash_field = _fp ^ _h;                                               \
     _nd->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))_slot;           \
-    _bk->hash[slot] = 0u;                                                      \
-    _bk->idx [slot] = (u32)RIX_NIL;                                      \
-    return (int)slot;                                                          \
+    _bk->hash[slot] = 0u;                                                     \
+    _bk->idx [slot] = (u32)RIX_NIL;                                           \
+    _rix_hash_seq_write_end(seq, _ab);                                        \
+    _rix_hash_seq_write_end(seq, bk_idx);                                     \
+    return (int)slot;                                                         \
 }                                                                             \
                                                                               \
 static RIX_UNUSED int                                                         \
 name##_kickout(struct rix_hash_bucket_s *buckets,                             \
+               u32 *seq,                                                      \
                struct type *base,                                             \
                unsigned mask,                                                 \
+               const struct rix_hash_resize_s *rs,                            \
                unsigned bk_idx,                                               \
                int depth)                                                     \
 {                                                                             \
@@ -330,7 +586,7 @@ name##_kickout(struct rix_hash_bucket_s *buckets,                             \
     struct rix_hash_bucket_s *_bk = buckets + bk_idx;                         \
                                                                               \
     for (unsigned _s = 0; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {             \
-        if (name##_flipflop(buckets, base, mask, bk_idx, _s) >= 0)           \
+        if (name##_flipflop(buckets, seq, base, mask, rs, bk_idx, _s) >= 0)   \
             return (int)_s;                                                   \
     }                                                                         \
     for (unsigned _s = 0; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {             \
@@ -339,34 +595,130 @@ name##_kickout(struct rix_hash_bucket_s *buckets,                             \
         struct type *_sn = name##_hptr(base, _si);                            \
         if (!_sn) continue;                                                   \
         u32 _sh = _sn->hash_field;                                        \
-        unsigned _ab = (_fp ^ _sh) & mask;                                     \
-        if (name##_kickout(buckets, base, mask, _ab, depth - 1) >= 0) {       \
+        unsigned _ab = _rix_hash_rs_bucket(_fp ^ _sh, mask, rs);              \
+        if (name##_kickout(buckets, seq, base, mask, rs, _ab,                 \
+                           depth - 1) >= 0) {                                 \
             if (_bk->hash[_s] != _fp || _bk->idx[_s] != _si) {              \
                 int _fs = name##_find_empty(buckets, bk_idx);                \
                 if (_fs >= 0) return _fs;                                    \
                 continue;                                                    \
             }                                                                \
-            name##_flipflop(buckets, base, mask, bk_idx, _s);                \
+            name##_flipflop(buckets, seq, base, mask, rs, bk_idx, _s);        \
             return (int)_s;                                                   \
         }                                                                     \
     }                                                                         \
     return -1;                                                                \
 }                                                                             \
                                                                               \
+/* Move the occupant of (src, s) into free slot d of its alt bucket dst. */   \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_bfs_move(struct rix_hash_bucket_s *buckets,                            \
+                u32 *seq,                                                     \
+                struct type *base,                                            \
+                unsigned src,                                                 \
+                unsigned s,                                                   \
+                unsigned dst,                                                 \
+                unsigned d)                                                   \
+{                                                                             \
+    struct rix_hash_bucket_s *_sb = buckets + src;                            \
+    struct rix_hash_bucket_s *_db = buckets + dst;                            \
+    u32 _fp = _sb->hash[s];                                                   \
+    unsigned _idx = _sb->idx[s];                                              \
+    struct type *_nd = name##_hptr(base, _idx);                               \
+    RIX_ASSUME_NONNULL(_nd);                                                  \
+    _rix_hash_seq_write_begin(seq, src);                                      \
+    _rix_hash_seq_write_begin(seq, dst);                                      \
+    _db->hash[d] = _fp;                                                       \
+    _db->idx [d] = _idx;                                                      \
+    _nd->hash_field ^= _fp;                                                   \
+    _nd->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))d;               \
+    _sb->hash[s] = 0u;                                                        \
+    _sb->idx [s] = (u32)RIX_NIL;                                              \
+    _rix_hash_seq_write_end(seq, dst);                                        \
+    _rix_hash_seq_write_end(seq, src);                                        \
+}                                                                             \
+                                                                              \
+/* Breadth-first kickout (see rix_hash_common.h).  On success returns */      \
+/* the freed slot and stores its bucket (bk0 or bk1) in *bk_out.      */      \
+static RIX_UNUSED int                                                         \
+name##_kickout_bfs(struct rix_hash_bucket_s *buckets,                         \
+                   u32 *seq,                                                  \
+                   struct type *base,                                         \
+                   unsigned mask,                                             \
+                   const struct rix_hash_resize_s *rs,                        \
+                   unsigned bk0,                                              \
+                   unsigned bk1,                                              \
+                   unsigned *bk_out)                                          \
+{                                                                             \
+    struct rix_hash_bfs_s _q[RIX_HASH_BFS_QUEUE];                             \
+    unsigned _head = 0u, _tail = 0u;                                          \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk0, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    if (bk1 != bk0)                                                           \
+        _q[_tail++] = (struct rix_hash_bfs_s){ bk1, RIX_HASH_BFS_ROOT,        \
+                                               0u, 0u };                      \
+    while (_head < _tail) {                                                   \
+        unsigned _qi = _head++;                                               \
+        unsigned _b  = _q[_qi].bk;                                            \
+        struct rix_hash_bucket_s *_bk = buckets + _b;                         \
+        if (_q[_qi].depth != 0u) {                                            \
+            int _es = name##_find_empty(buckets, _b);                         \
+            if (_es >= 0) {                                                   \
+                unsigned _cs = (unsigned)_es;                                 \
+                while (_q[_qi].parent != RIX_HASH_BFS_ROOT) {                 \
+                    unsigned _pi = _q[_qi].parent;                            \
+                    name##_bfs_move(buckets, seq, base, _q[_pi].bk,           \
+                                    _q[_qi].slot, _q[_qi].bk, _cs);           \
+                    _cs = _q[_qi].slot;                                       \
+                    _qi = _pi;                                                \
+                }                                                             \
+                *bk_out = _q[_qi].bk;                                         \
+                return (int)_cs;                                              \
+            }                                                                 \
+        }                                                                     \
+        if (_q[_qi].depth >= RIX_HASH_FOLLOW_DEPTH)                           \
+            continue;                                                         \
+        for (unsigned _s = 0; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++)            \
+            _rix_hash_prefetch_entry(name##_hptr(base, _bk->idx[_s]));        \
+        for (unsigned _n = 0, _fan = _rix_hash_bfs_fanout(_q, _qi);           \
+             _n < RIX_HASH_BUCKET_ENTRY_SZ && _fan != 0u; _n++) {             \
+            unsigned _s = _rix_hash_bfs_slot(_qi, _n,                         \
+                                             RIX_HASH_BUCKET_ENTRY_SZ);       \
+            struct type *_nd = name##_hptr(base, _bk->idx[_s]);               \
+            unsigned _ab;                                                     \
+            if (_tail >= RIX_HASH_BFS_QUEUE)                                  \
+                break;                                                        \
+            if (!_nd) continue;                                               \
+            _ab = _rix_hash_rs_bucket(_bk->hash[_s] ^ _nd->hash_field,        \
+                                      mask, rs);                              \
+            if (_rix_hash_bfs_on_path(_q, _qi, _ab))                          \
+                continue;                                                     \
+            _rix_hash_prefetch_bucket(buckets + _ab);                         \
+            _q[_tail++] = (struct rix_hash_bfs_s){                            \
+                _ab, (u16)_qi, (u8)_s, (u8)(_q[_qi].depth + 1u) };            \
+            _fan--;                                                           \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+/* seq == NULL: single-thread mode (bracketing compiles away).       */       \
+/* rs  == NULL: fixed-size table (no split-parent test).             */       \
 static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
-name##_insert_hashed(struct name *head,                                       \
-                     struct rix_hash_bucket_s *buckets,                       \
-                     struct type *base,                                       \
-                     struct type *elm,                                        \
-                     union rix_hash_hash_u _h)                                \
+name##_insert_hashed_internal(struct name *head,                              \
+                              struct rix_hash_bucket_s *buckets,              \
+                              u32 *seq,                                       \
+                              const struct rix_hash_resize_s *rs,             \
+                              struct type *base,                              \
+                              struct type *elm,                               \
+                              union rix_hash_hash_u _h)                       \
 {                                                                             \
     unsigned mask = head->rhh_mask;                                           \
     unsigned _bk0, _bk1;                                                      \
     u32 _fp;                                                             \
     u32 _hits_fp[2];                                                     \
     u32 _hits_zero[2];                                                   \
-    _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
-    elm->hash_field = _h.val32[0];                                            \
+    _bk0 = _rix_hash_rs_bucket(_h.val32[0], mask, rs);                        \
+    _bk1 = _rix_hash_rs_bucket(_h.val32[1], mask, rs);                        \
+    _fp  = _h.val32[0] ^ _h.val32[1];                                         \
     _rix_hash_prefetch_bucket(buckets + _bk0);                                \
     if (_bk1 != _bk0)                                                         \
         _rix_hash_prefetch_bucket(buckets + _bk1);                            \
@@ -396,11 +748,12 @@ name##_insert_hashed(struct name *head,                                       \
         u32 _nilm = _hits_zero[_i];                                      \
         if (_nilm) {                                                          \
             unsigned _slot = (unsigned)__builtin_ctz(_nilm);                  \
+            elm->hash_field = _h.val32[_i];                                   \
+            elm->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))_slot;   \
+            _rix_hash_seq_write_begin(seq, _bki);                             \
             _bk->hash[_slot] = _fp;                                           \
             _bk->idx[_slot]  = name##_hidx(base, elm);                        \
-            if (_i == 1)                                                      \
-                elm->hash_field = _h.val32[1];                                \
-            elm->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))_slot;   \
+            _rix_hash_seq_write_end(seq, _bki);                               \
             head->rhh_nb++;                                                   \
             return NULL;                                                      \
         }                                                                     \
@@ -409,28 +762,56 @@ name##_insert_hashed(struct name *head,                                       \
     /* Slow path: kickout */                                                  \
     {                                                                         \
         int _pos;                                                             \
-        unsigned _bki;                                                        \
-        _pos = name##_kickout(buckets, base, mask, _bk0,                      \
-                              RIX_HASH_FOLLOW_DEPTH);                         \
-        if (_pos >= 0) {                                                      \
-            _bki = _bk0;                                                      \
+        unsigned _bki = _bk0;                                                 \
+        if (RIX_HASH_KICKOUT_BFS) {                                           \
+            _pos = name##_kickout_bfs(buckets, seq, base, mask, rs,           \
+                                      _bk0, _bk1, &_bki);                     \
         } else {                                                              \
-            _pos = name##_kickout(buckets, base, mask, _bk1,                  \
+            _pos = name##_kickout(buckets, seq, base, mask, rs, _bk0,         \
                                   RIX_HASH_FOLLOW_DEPTH);                     \
-            if (_pos < 0)                                                     \
-                return elm;                                                   \
-            _bki = _bk1;                                                      \
-            elm->hash_field = _h.val32[1];                                    \
+            if (_pos < 0) {                                                   \
+                _bki = _bk1;                                                  \
+                _pos = name##_kickout(buckets, seq, base, mask, rs, _bk1,     \
+                                      RIX_HASH_FOLLOW_DEPTH);                 \
+            }                                                                 \
         }                                                                     \
+        if (_pos < 0)                                                         \
+            return elm;                                                       \
+        elm->hash_field = _h.val32[_bki == _bk0 ? 0 : 1];                     \
         struct rix_hash_bucket_s *_bk = buckets + _bki;                       \
-        _bk->hash[_pos] = _fp;                                                \
-        _bk->idx [_pos] = name##_hidx(base, elm);                            \
         elm->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))_pos;        \
+        _rix_hash_seq_write_begin(seq, _bki);                                 \
+        _bk->hash[_pos] = _fp;                                                \
+        _bk->idx [_pos] = name##_hidx(base, elm);                             \
+        _rix_hash_seq_write_end(seq, _bki);                                   \
         head->rhh_nb++;                                                       \
         return NULL;                                                          \
     }                                                                         \
 }                                                                             \
                                                                               \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_seq_insert_hashed(struct name *head,                                   \
+                         struct rix_hash_bucket_s *buckets,                   \
+                         u32 *seq,                                            \
+                         struct type *base,                                   \
+                         struct type *elm,                                    \
+                         union rix_hash_hash_u _h)                            \
+{                                                                             \
+    return name##_insert_hashed_internal(head, buckets, seq, NULL, base,      \
+                                         elm, _h);                            \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_insert_hashed(struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     struct type *base,                                       \
+                     struct type *elm,                                        \
+                     union rix_hash_hash_u _h)                                \
+{                                                                             \
+    return name##_seq_insert_hashed(head, buckets, NULL, base, elm, _h);      \
+}                                                                             \
+                                                                              \
+                                                                              \
 attr struct type *                                                            \
 name##_insert(struct name *head,                                              \
               struct rix_hash_bucket_s *buckets,                              \
@@ -444,53 +825,298 @@ name##_insert(struct name *head,                                              \
     return name##_insert_hashed(head, buckets, base, elm, _h);                \
 }                                                                             \
                                                                               \
+attr struct type *                                                            \
+name##_seq_insert(struct name *head,                                          \
+                  struct rix_hash_bucket_s *buckets,                          \
+                  u32 *seq,                                                   \
+                  struct type *base,                                          \
+                  struct type *elm)                                           \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h =                                                \
+        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
+                mask);                                                        \
+    return name##_seq_insert_hashed(head, buckets, seq, base, elm, _h);       \
+}                                                                             \
+                                                                              \
+                                                                              \
 attr unsigned                                                                 \
-name##_remove_at(struct name *head,                                           \
-                 struct rix_hash_bucket_s *buckets,                           \
-                 unsigned bk,                                                 \
-                 unsigned slot);                                              \
+name##_seq_remove_at(struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     u32 *seq,                                                \
+                     unsigned bk,                                             \
+                     unsigned slot)                                           \
+{                                                                             \
+    struct rix_hash_bucket_s *_b = buckets + bk;                              \
+    unsigned _idx;                                                            \
+    RIX_ASSERT(slot < RIX_HASH_BUCKET_ENTRY_SZ);                              \
+    if (slot >= RIX_HASH_BUCKET_ENTRY_SZ)                                     \
+        return (unsigned)RIX_NIL;                                             \
+    _idx = _b->idx[slot];                                                     \
+    if (_idx == (unsigned)RIX_NIL)                                            \
+        return (unsigned)RIX_NIL;                                             \
+    _rix_hash_seq_write_begin(seq, bk);                                       \
+    _b->hash[slot] = 0u;                                                      \
+    _b->idx [slot] = (u32)RIX_NIL;                                            \
+    _rix_hash_seq_write_end(seq, bk);                                         \
+    head->rhh_nb--;                                                           \
+    return _idx;                                                              \
+}                                                                             \
                                                                               \
-attr struct type *                                                            \
-name##_remove(struct name *head,                                              \
-              struct rix_hash_bucket_s *buckets,                              \
-              struct type *base,                                              \
-              struct type *elm)                                               \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_remove_internal(struct name *head,                                     \
+                       struct rix_hash_bucket_s *buckets,                     \
+                       u32 *seq,                                              \
+                       const struct rix_hash_resize_s *rs,                    \
+                       struct type *base,                                     \
+                       struct type *elm)                                      \
 {                                                                             \
     unsigned node_idx = name##_hidx(base, elm);                               \
-    unsigned _bk = (unsigned)(elm->hash_field & head->rhh_mask);              \
+    unsigned _bk = _rix_hash_rs_bucket(elm->hash_field, head->rhh_mask, rs);  \
     unsigned _slot = (unsigned)elm->slot_field;                               \
     struct rix_hash_bucket_s *_b = buckets + _bk;                             \
     RIX_ASSERT(_slot < RIX_HASH_BUCKET_ENTRY_SZ);                             \
     if (_slot >= RIX_HASH_BUCKET_ENTRY_SZ)                                    \
         return NULL;                                                          \
-    if (_b->idx[_slot] != (u32)node_idx)                                 \
+    if (_b->idx[_slot] != (u32)node_idx)                                      \
         return NULL;                                                          \
-    if (name##_remove_at(head, buckets, _bk, _slot) !=                        \
+    if (name##_seq_remove_at(head, buckets, seq, _bk, _slot) !=               \
         (unsigned)RIX_NIL)                                                    \
         return elm;                                                           \
     return NULL;                                                              \
 }                                                                             \
                                                                               \
+attr struct type *                                                            \
+name##_seq_remove(struct name *head,                                          \
+                  struct rix_hash_bucket_s *buckets,                          \
+                  u32 *seq,                                                   \
+                  struct type *base,                                          \
+                  struct type *elm)                                           \
+{                                                                             \
+    return name##_remove_internal(head, buckets, seq, NULL, base, elm);       \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_remove(struct name *head,                                              \
+              struct rix_hash_bucket_s *buckets,                              \
+              struct type *base,                                              \
+              struct type *elm)                                               \
+{                                                                             \
+    return name##_seq_remove(head, buckets, NULL, base, elm);                 \
+}                                                                             \
+                                                                              \
 attr unsigned                                                                 \
 name##_remove_at(struct name *head,                                           \
                  struct rix_hash_bucket_s *buckets,                           \
                  unsigned bk,                                                 \
                  unsigned slot)                                               \
 {                                                                             \
-    struct rix_hash_bucket_s *_b = buckets + bk;                              \
-    unsigned _idx;                                                            \
-    RIX_ASSERT(slot < RIX_HASH_BUCKET_ENTRY_SZ);                              \
-    if (slot >= RIX_HASH_BUCKET_ENTRY_SZ)                                     \
-        return (unsigned)RIX_NIL;                                             \
-    _idx = _b->idx[slot];                                                     \
-    if (_idx == (unsigned)RIX_NIL)                                            \
-        return (unsigned)RIX_NIL;                                             \
-    _b->hash[slot] = 0u;                                                      \
-    _b->idx [slot] = (u32)RIX_NIL;                                       \
-    head->rhh_nb--;                                                           \
-    return _idx;                                                              \
+    return name##_seq_remove_at(head, buckets, NULL, bk, slot);               \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Relocate / swap - move nodes inside base, one bucket ref rewritten */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE u32 *                                      \
+name##_ref(struct name *head,                                                 \
+           struct rix_hash_bucket_s *buckets,                                 \
+           struct type *base,                                                 \
+           const struct type *elm,                                            \
+           unsigned *bkp)                                                     \
+{                                                                             \
+    unsigned _bk = elm->hash_field & head->rhh_mask;                          \
+    unsigned _slot = (unsigned)elm->slot_field;                               \
+    if (_slot >= RIX_HASH_BUCKET_ENTRY_SZ ||                                  \
+        buckets[_bk].idx[_slot] != (u32)name##_hidx(base, elm))               \
+        return NULL; /* not in a bucket */                                    \
+    *bkp = _bk;                                                               \
+    return &buckets[_bk].idx[_slot];                                          \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_seq_relocate(struct name *head,                                        \
+                    struct rix_hash_bucket_s *buckets,                        \
+                    u32 *seq,                                                 \
+                    struct type *base,                                        \
+                    struct type *src,                                         \
+                    struct type *dst)                                         \
+{                                                                             \
+    unsigned _bk;                                                             \
+    u32 *_ref = name##_ref(head, buckets, base, src, &_bk);                   \
+    if (_ref == NULL)                                                         \
+        return NULL;                                                          \
+    if (dst == src)                                                           \
+        return dst;                                                           \
+    _rix_hash_seq_write_begin(seq, _bk);                                      \
+    *dst = *src;                                                              \
+    *_ref = (u32)name##_hidx(base, dst);                                      \
+    _rix_hash_seq_write_end(seq, _bk);                                        \
+    return dst;                                                               \
 }                                                                             \
                                                                               \
+attr struct type *                                                            \
+name##_relocate(struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                struct type *base,                                            \
+                struct type *src,                                             \
+                struct type *dst)                                             \
+{                                                                             \
+    return name##_seq_relocate(head, buckets, NULL, base, src, dst);          \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_seq_swap(struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                u32 *seq,                                                     \
+                struct type *base,                                            \
+                struct type *a,                                               \
+                struct type *b)                                               \
+{                                                                             \
+    unsigned _bka, _bkb;                                                      \
+    u32 *_ra = name##_ref(head, buckets, base, a, &_bka);                     \
+    u32 *_rb = name##_ref(head, buckets, base, b, &_bkb);                     \
+    struct type _tmp;                                                         \
+    if (_ra == NULL || _rb == NULL)                                           \
+        return -1;                                                            \
+    if (a == b)                                                               \
+        return 0;                                                             \
+    _rix_hash_seq_write_begin(seq, _bka);                                     \
+    if (_bkb != _bka)                                                         \
+        _rix_hash_seq_write_begin(seq, _bkb);                                 \
+    _tmp = *a;                                                                \
+    *a = *b;                                                                  \
+    *b = _tmp;                                                                \
+    *_ra = (u32)name##_hidx(base, b);                                         \
+    *_rb = (u32)name##_hidx(base, a);                                         \
+    if (_bkb != _bka)                                                         \
+        _rix_hash_seq_write_end(seq, _bkb);                                   \
+    _rix_hash_seq_write_end(seq, _bka);                                       \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_swap(struct name *head,                                                \
+            struct rix_hash_bucket_s *buckets,                                \
+            struct type *base,                                                \
+            struct type *a,                                                   \
+            struct type *b)                                                   \
+{                                                                             \
+    return name##_seq_swap(head, buckets, NULL, base, a, b);                  \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Promote - move a node living in its bk_1 back into bk_0            */      \
+/* ================================================================== */      \
+/* elm sits in _bk, its bk_0 is _bk0 != _bk.  hashed: the table holds   */    \
+/* rix_hash_hash_from_u32() hashes, whose bk_0 follows from hash_field  */    \
+/* and the fingerprint; otherwise occupants are rehashed with hash_fn.  */    \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_promote_to_bk0(struct name *head,                                      \
+                      struct rix_hash_bucket_s *buckets,                      \
+                      u32 *seq,                                               \
+                      struct type *base,                                      \
+                      struct type *elm,                                       \
+                      unsigned _bk,                                           \
+                      unsigned _bk0,                                          \
+                      int hashed)                                             \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    int _slot = name##_find_empty(buckets, _bk0);                             \
+    /* bk_0 full: send home an occupant that is itself in its bk_1 */         \
+    for (unsigned _s = 0; _slot < 0 && _s < RIX_HASH_BUCKET_ENTRY_SZ;         \
+         _s++) {                                                              \
+        struct type *_v = name##_hptr(base, buckets[_bk0].idx[_s]);           \
+        if (_v == NULL)                                                       \
+            continue;                                                         \
+        if (hashed) {                                                         \
+            u32 _vc = _v->hash_field;                                         \
+            if (!rix_hash_from_u32_is_bk1(_vc,                                \
+                                          buckets[_bk0].hash[_s] ^ _vc,       \
+                                          mask))                              \
+                continue;                                                     \
+        } else {                                                              \
+            union rix_hash_hash_u _vh;                                        \
+            _vh = hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)       \
+                          &_v->key_field, mask);                              \
+            if ((_vh.val32[0] & mask) == _bk0)                                \
+                continue;                                                     \
+        }                                                                     \
+        if (name##_flipflop(buckets, seq, base, mask, NULL, _bk0, _s) >= 0)   \
+            _slot = (int)_s;                                                  \
+    }                                                                         \
+    if (_slot < 0)                                                            \
+        return -1;                                                            \
+    /* elm's alternate bucket is _bk0, which now has a free slot */           \
+    if (name##_flipflop(buckets, seq, base, mask, NULL, _bk,                  \
+                        (unsigned)elm->slot_field) < 0)                       \
+        return -1;                                                            \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_seq_promote(struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   u32 *seq,                                                  \
+                   struct type *base,                                         \
+                   struct type *elm)                                          \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _bk, _bk0, _bk1;                                                 \
+    u32 _fp;                                                                  \
+    union rix_hash_hash_u _h;                                                 \
+    if (name##_ref(head, buckets, base, elm, &_bk) == NULL)                   \
+        return -1;                                                            \
+    _h = hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)                \
+                 &elm->key_field, mask);                                      \
+    _rix_hash_buckets(_h, mask, &_bk0, &_bk1, &_fp);                          \
+    if (_bk == _bk0)                                                          \
+        return 0;                                                             \
+    return name##_promote_to_bk0(head, buckets, seq, base, elm,               \
+                                 _bk, _bk0, 0);                               \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_promote(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               struct type *elm)                                              \
+{                                                                             \
+    return name##_seq_promote(head, buckets, NULL, base, elm);                \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_seq_promote_hashed(struct name *head,                                  \
+                          struct rix_hash_bucket_s *buckets,                  \
+                          u32 *seq,                                           \
+                          struct type *base,                                  \
+                          struct type *elm)                                   \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _bk;                                                             \
+    u32 _cur, _alt;                                                           \
+    if (name##_ref(head, buckets, base, elm, &_bk) == NULL)                   \
+        return -1;                                                            \
+    _cur = elm->hash_field;                                                   \
+    _alt = buckets[_bk].hash[elm->slot_field] ^ _cur;                         \
+    if (!rix_hash_from_u32_is_bk1(_cur, _alt, mask))                          \
+        return 0;                                                             \
+    return name##_promote_to_bk0(head, buckets, seq, base, elm,               \
+                                 _bk, _alt & mask, 1);                        \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_promote_hashed(struct name *head,                                      \
+                      struct rix_hash_bucket_s *buckets,                      \
+                      struct type *base,                                      \
+                      struct type *elm)                                       \
+{                                                                             \
+    return name##_seq_promote_hashed(head, buckets, NULL, base, elm);         \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_RANGE(name, walk_range, struct rix_hash_bucket_s,     \
+                              struct type, RIX_HASH_BUCKET_ENTRY_SZ,          \
+                              head->rhh_mask + 1u, 0, attr)                   \
+                                                                              \
 attr int                                                                      \
 name##_walk(struct name *head,                                                \
             struct rix_hash_bucket_s *buckets,                                \
@@ -498,18 +1124,1068 @@ name##_walk(struct name *head,                                                \
             int (*cb)(struct type *, void *),                                 \
             void *arg)                                                        \
 {                                                                             \
-    for (unsigned _b = 0; _b <= head->rhh_mask; _b++) {                      \
-        struct rix_hash_bucket_s *_bk = buckets + _b;                         \
-        for (unsigned _s = 0; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {          \
-            unsigned _idx = _bk->idx[_s];                                     \
-            if (_idx == (unsigned)RIX_NIL) continue;                          \
-            struct type *_node = name##_hptr(base, _idx);                     \
-            int _rc = cb(_node, arg);                                         \
-            if (_rc) return _rc;                                              \
-        }                                                                     \
-    }                                                                         \
-    return 0;                                                                 \
-}
-
+    return name##_walk_range(head, buckets, base, 0u, head->rhh_mask + 1u,    \
+                             cb, arg);                                        \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_STEP(name, walk_step, struct rix_hash_bucket_s,       \
+                             RIX_HASH_BUCKET_ENTRY_SZ,                        \
+                             head->rhh_mask + 1u, 0, attr)                    \
+                                                                              \
+/* ================================================================== */      \
+/* Bulk insert / remove (pipelined; see rix_hash_common.h)            */      \
+/* ================================================================== */      \
+_RIX_HASH_GENERATE_INSERT_BULK(name, type, key_field, hash_fn, attr)          \
+_RIX_HASH_GENERATE_REMOVE_BULK(name, type, hash_field, attr)                  \
+                                                                              \
+/* ================================================================== */      \
+/* Parallel bulk build (see rix_hash_common.h); the build takes no    */      \
+/* seq lock, so no reader may run until name_build_finish returns.    */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_build_place(struct type *elm, u32 hv, unsigned slot)                   \
+{                                                                             \
+    elm->hash_field = hv;                                                     \
+    elm->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))slot;            \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_BUILD(name, type, key_field, cmp_fn, name##_build_place,   \
+                         attr)
+
+/*===========================================================================
+ * RIX_HASH_GENERATE_SLOT_RESIZE(name, type, key_field, hash_field,
+ *                               slot_field, cmp_fn)
+ * RIX_HASH_GENERATE_SLOT_RESIZE_EX(..., cmp_fn, hash_fn)
+ *
+ * Same table as RIX_HASH_GENERATE_SLOT plus name_rs_* ops that can double
+ * the bucket count online.  The head must be declared with
+ * RIX_HASH_RESIZE_HEAD(name); see rix_hash_common.h for the layout rules.
+ *
+ *   name_rs_grow_begin(head) switches the table to the doubled mask and
+ *   returns immediately; nothing is moved.  The bucket array must already
+ *   hold 2 * nb_bk buckets (the new half need not be initialised).
+ *
+ *   name_rs_grow_step(head, buckets, base, max_bk) splits at most max_bk
+ *   old buckets: bucket b keeps the entries whose hash_field has the new
+ *   bit clear and hands the others to b | old_nb at the same slot, so
+ *   slot_field stays valid.  No hashing, no kickout.  Returns the number
+ *   of old buckets still to split (0 = grow finished).
+ *
+ * Every name_rs_* op may be called between steps.  Lookups resolve each
+ * candidate bucket against the split cursor (new mask if the parent was
+ * already split, old mask otherwise), so the staged pipeline
+ *
+ *   name_rs_hash_key -> name_scan_bk -> name_prefetch_node -> name_cmp_key
+ *
+ * keeps working unchanged: only stage 1 knows about the migration.
+ *
+ * A resizable table must be used only through the name_rs_* ops (plus
+ * name_remove_at, which is geometry-free): keys are hashed against
+ * RIX_HASH_RESIZE_HASH_MASK, not rhh_mask.
+ *
+ * Generated functions (in addition to RIX_HASH_GENERATE_SLOT):
+ *   void         name_rs_init       (head, nb_bk)
+ *   int          name_rs_resizing   (head)
+ *   int          name_rs_grow_begin (head)
+ *   unsigned     name_rs_grow_step  (head, buckets, base, max_bk)
+ *   struct type *name_rs_find       (head, buckets, base, key)
+ *   struct type *name_rs_insert     (head, buckets, base, elm)
+ *   struct type *name_rs_remove     (head, buckets, base, elm)
+ *   int          name_rs_walk       (head, buckets, base, cb, arg)
+ *   int          name_rs_walk_range (head, buckets, base, bk_begin, bk_end,
+ *                                    cb, arg)
+ *   unsigned     name_rs_walk_step  (head, buckets, cursor, budget,
+ *                                    idx_out, max_out, n_out)
+ *   void         name_rs_hash_key   (ctx, head, buckets, key)  (+ _n form)
+ *===========================================================================*/
+#  define RIX_HASH_PROTOTYPE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    attr void name##_rs_init(struct name *head, unsigned nb_bk);                     \
+    attr int name##_rs_grow_begin(struct name *head);                                \
+    attr unsigned name##_rs_grow_step(struct name *head,                             \
+                                      struct rix_hash_bucket_s *buckets,             \
+                                      struct type *base,                             \
+                                      unsigned max_bk);                              \
+    attr struct type *name##_rs_find(struct name *head,                              \
+                                     struct rix_hash_bucket_s *buckets,              \
+                                     struct type *base,                              \
+                                     const _RIX_HASH_KEY_TYPE(type, key_field) *key); \
+    attr struct type *name##_rs_insert(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       struct type *base,                            \
+                                       struct type *elm);                            \
+    attr struct type *name##_rs_remove(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       struct type *base,                            \
+                                       struct type *elm);                            \
+    attr int name##_rs_walk(struct name *head,                                       \
+                            struct rix_hash_bucket_s *buckets,                       \
+                            struct type *base,                                       \
+                            int (*cb)(struct type *, void *),                        \
+                            void *arg);                                              \
+    attr int name##_rs_walk_range(struct name *head,                                 \
+                                  struct rix_hash_bucket_s *buckets,                 \
+                                  struct type *base,                                 \
+                                  unsigned bk_begin, unsigned bk_end,                \
+                                  int (*cb)(struct type *, void *),                  \
+                                  void *arg);                                        \
+    attr unsigned name##_rs_walk_step(struct name *head,                             \
+                                      struct rix_hash_bucket_s *buckets,             \
+                                      unsigned cursor, unsigned budget,              \
+                                      u32 *idx_out, unsigned max_out,                \
+                                      unsigned *n_out);
+
+#  define RIX_HASH_PROTOTYPE_SLOT_RESIZE(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_SLOT_RESIZE_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_RESIZE(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_RESIZE_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_RESIZE_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
+    RIX_HASH_GENERATE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field,  \
+                                           slot_field, cmp_fn, hash_fn, )
+
+#  define RIX_HASH_GENERATE_STATIC_SLOT_RESIZE_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
+    RIX_HASH_GENERATE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field,  \
+                                           slot_field, cmp_fn, hash_fn,        \
+                                           RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_RESIZE(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    _RIX_HASH_DEFINE_DEFAULT_HASH_FN(name, type, key_field)                    \
+    RIX_HASH_GENERATE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field,  \
+                                           slot_field, cmp_fn,                 \
+                                           _RIX_HASH_DEFAULT_HASH_FN_NAME(name), )
+
+#  define RIX_HASH_GENERATE_STATIC_SLOT_RESIZE(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    _RIX_HASH_DEFINE_DEFAULT_HASH_FN(name, type, key_field)                    \
+    RIX_HASH_GENERATE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field,  \
+                                           slot_field, cmp_fn,                 \
+                                           _RIX_HASH_DEFAULT_HASH_FN_NAME(name), \
+                                           RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_RESIZE_INTERNAL(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn, attr) \
+    RIX_HASH_GENERATE_SLOT_INTERNAL(name, type, key_field, hash_field,        \
+                                    slot_field, cmp_fn, hash_fn, attr)        \
+                                                                              \
+/* ================================================================== */      \
+/* Online resize                                                      */      \
+/* ================================================================== */      \
+attr void                                                                     \
+name##_rs_init(struct name *head,                                             \
+               unsigned nb_bk)                                                \
+{                                                                             \
+    name##_init(head, nb_bk);                                                 \
+    head->rhh_rs.old_mask = head->rhh_mask;                                   \
+    head->rhh_rs.split    = nb_bk;                                            \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_rs_resizing(const struct name *head)                                   \
+{                                                                             \
+    return head->rhh_rs.old_mask != head->rhh_mask;                           \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_rs_hash_key(struct rix_hash_find_ctx_s *ctx,                           \
+                   struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   const _RIX_HASH_KEY_TYPE(type, key_field) *key)            \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h = hash_fn(key, RIX_HASH_RESIZE_HASH_MASK);       \
+    ctx->hash  = _h;                                                          \
+    ctx->fp    = _h.val32[0] ^ _h.val32[1];                                   \
+    ctx->key   = (const void *)key;                                           \
+    ctx->bk[0] = buckets +                                                    \
+        _rix_hash_rs_bucket(_h.val32[0], mask, &head->rhh_rs);                \
+    ctx->bk[1] = buckets +                                                    \
+        _rix_hash_rs_bucket(_h.val32[1], mask, &head->rhh_rs);                \
+    _rix_hash_prefetch_bucket(ctx->bk[0]);                                    \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_rs_hash_key_n(struct rix_hash_find_ctx_s *ctx,                         \
+                     unsigned n,                                              \
+                     struct name *head,                                       \
+                     struct rix_hash_bucket_s *buckets,                       \
+                     const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys) \
+{                                                                             \
+    for (unsigned i = 0; i < n; i++)                                          \
+        name##_rs_hash_key(&ctx[i], head, buckets, keys[i]);                  \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_rs_find(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               const _RIX_HASH_KEY_TYPE(type, key_field) *key)                \
+{                                                                             \
+    struct rix_hash_find_ctx_s _ctx;                                          \
+    name##_rs_hash_key(&_ctx, head, buckets, key);                            \
+    name##_scan_bk(&_ctx, head, buckets);                                     \
+    return name##_cmp_key(&_ctx, base);                                       \
+}                                                                             \
+                                                                              \
+/* _h must come from hash_fn(key, RIX_HASH_RESIZE_HASH_MASK).         */      \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_rs_insert_hashed(struct name *head,                                    \
+                        struct rix_hash_bucket_s *buckets,                    \
+                        struct type *base,                                    \
+                        struct type *elm,                                     \
+                        union rix_hash_hash_u _h)                             \
+{                                                                             \
+    return name##_insert_hashed_internal(head, buckets, NULL, &head->rhh_rs,  \
+                                         base, elm, _h);                      \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_rs_insert(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 struct type *elm)                                            \
+{                                                                             \
+    union rix_hash_hash_u _h =                                                \
+        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
+                RIX_HASH_RESIZE_HASH_MASK);                                   \
+    return name##_rs_insert_hashed(head, buckets, base, elm, _h);             \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_rs_remove(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 struct type *elm)                                            \
+{                                                                             \
+    return name##_remove_internal(head, buckets, NULL, &head->rhh_rs,         \
+                                  base, elm);                                 \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_RANGE(name, rs_walk_range, struct rix_hash_bucket_s,  \
+                              struct type, RIX_HASH_BUCKET_ENTRY_SZ,          \
+                              head->rhh_mask + 1u,                            \
+                              _b > head->rhh_rs.old_mask &&                   \
+                              (_b & head->rhh_rs.old_mask) >=                 \
+                              head->rhh_rs.split,                             \
+                              attr)                                           \
+                                                                              \
+attr int                                                                      \
+name##_rs_walk(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               int (*cb)(struct type *, void *),                              \
+               void *arg)                                                     \
+{                                                                             \
+    return name##_rs_walk_range(head, buckets, base, 0u, head->rhh_mask + 1u, \
+                                cb, arg);                                     \
+}                                                                             \
+                                                                              \
+/* Buckets of the upper half not split yet are skipped, as in rs_walk. */     \
+_RIX_HASH_GENERATE_WALK_STEP(name, rs_walk_step, struct rix_hash_bucket_s,    \
+                             RIX_HASH_BUCKET_ENTRY_SZ,                        \
+                             head->rhh_mask + 1u,                             \
+                             _b > head->rhh_rs.old_mask &&                    \
+                             (_b & head->rhh_rs.old_mask) >=                  \
+                             head->rhh_rs.split,                              \
+                             attr)                                            \
+                                                                              \
+attr int                                                                      \
+name##_rs_grow_begin(struct name *head)                                       \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    if (name##_rs_resizing(head) || mask >= 0x7fffffffu)                      \
+        return -1;                                                            \
+    head->rhh_rs.old_mask = mask;                                             \
+    head->rhh_rs.split    = 0u;                                               \
+    head->rhh_mask        = (mask << 1) | 1u;                                 \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_rs_grow_step(struct name *head,                                        \
+                    struct rix_hash_bucket_s *buckets,                        \
+                    struct type *base,                                        \
+                    unsigned max_bk)                                          \
+{                                                                             \
+    unsigned _om  = head->rhh_rs.old_mask;                                    \
+    unsigned _onb = _om + 1u;                                                 \
+    unsigned _b   = head->rhh_rs.split;                                       \
+    unsigned _end;                                                            \
+    if (!name##_rs_resizing(head))                                            \
+        return 0u;                                                            \
+    _end = (max_bk < _onb - _b) ? _b + max_bk : _onb;                         \
+    for (; _b < _end; _b++) {                                                 \
+        struct rix_hash_bucket_s *_lo = buckets + _b;                         \
+        struct rix_hash_bucket_s *_hi = buckets + (_b | _onb);                \
+        if (_b + 1u < _end)                                                   \
+            _rix_hash_prefetch_bucket(_lo + 1);                               \
+        memset(_hi, 0, sizeof(*_hi));                                         \
+        for (unsigned _s = 0; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {          \
+            unsigned _idx = _lo->idx[_s];                                     \
+            if (_idx == (unsigned)RIX_NIL) continue;                          \
+            struct type *_node = name##_hptr(base, _idx);                     \
+            if (!(_node->hash_field & _onb)) continue;                        \
+            _hi->hash[_s] = _lo->hash[_s];                                    \
+            _hi->idx [_s] = _idx;                                             \
+            _lo->hash[_s] = 0u;                                               \
+            _lo->idx [_s] = (u32)RIX_NIL;                                     \
+        }                                                                     \
+    }                                                                         \
+    if (_b == _onb) {                                                         \
+        head->rhh_rs.old_mask = head->rhh_mask;                               \
+        head->rhh_rs.split    = head->rhh_mask + 1u;                          \
+        return 0u;                                                            \
+    }                                                                         \
+    head->rhh_rs.split = _b;                                                  \
+    return _onb - _b;                                                         \
+}
+
+
+/*===========================================================================
+ * RIX_HASH_GENERATE_SLOT_STASH(name, type, key_field, hash_field,
+ *                              slot_field, cmp_fn)
+ * RIX_HASH_GENERATE_SLOT_STASH_EX(..., cmp_fn, hash_fn)
+ *
+ * Same table as RIX_HASH_GENERATE_SLOT plus name_st_* ops that park the
+ * inserts the kickout search cannot place in a small overflow stash.  The
+ * head must be declared with RIX_HASH_STASH_HEAD(name) and the bucket
+ * array must hold nb_bk + st_nb_bk buckets, all zeroed; see
+ * rix_hash_common.h for the layout.
+ *
+ *   name_st_insert fails (returns elm) only when the main table and the
+ *   stash are both full.  A key is never in both places: the stash is
+ *   checked for a duplicate first, but only while it is non-empty.
+ *
+ *   name_st_remove of a main-table entry refills the freed slot from the
+ *   stash when a stashed entry has that bucket as a candidate.
+ *
+ *   name_st_drain re-inserts every stashed entry with the full kickout
+ *   search; call it after slots were freed behind the table's back
+ *   (name_remove_at) or periodically.  Returns the entries left stashed.
+ *
+ * A stash table must be modified only through the name_st_* ops (plus
+ * name_remove_at on main buckets).  Lookups may use the plain staged
+ * pipeline with name_st_cmp_key as the last stage:
+ *
+ *   name_hash_key -> name_scan_bk -> name_prefetch_node -> name_st_cmp_key
+ *
+ * Generated functions (in addition to RIX_HASH_GENERATE_SLOT):
+ *   void         name_st_init    (head, nb_bk, st_nb_bk)
+ *   struct type *name_st_find    (head, buckets, base, key)
+ *   struct type *name_st_insert  (head, buckets, base, elm)
+ *   struct type *name_st_remove  (head, buckets, base, elm)
+ *   unsigned     name_st_drain   (head, buckets, base)
+ *   int          name_st_walk    (head, buckets, base, cb, arg)
+ *   int          name_st_walk_range(head, buckets, base, bk_begin, bk_end,
+ *                                   cb, arg)
+ *   unsigned     name_st_walk_step(head, buckets, cursor, budget,
+ *                                  idx_out, max_out, n_out)
+ *   struct type *name_st_cmp_key (ctx, head, buckets, base)
+ *===========================================================================*/
+#  define RIX_HASH_PROTOTYPE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    attr void name##_st_init(struct name *head, unsigned nb_bk,                       \
+                             unsigned st_nb_bk);                                      \
+    attr struct type *name##_st_find(struct name *head,                              \
+                                     struct rix_hash_bucket_s *buckets,              \
+                                     struct type *base,                              \
+                                     const _RIX_HASH_KEY_TYPE(type, key_field) *key); \
+    attr struct type *name##_st_insert(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       struct type *base,                            \
+                                       struct type *elm);                            \
+    attr struct type *name##_st_remove(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       struct type *base,                            \
+                                       struct type *elm);                            \
+    attr unsigned name##_st_drain(struct name *head,                                 \
+                                  struct rix_hash_bucket_s *buckets,                 \
+                                  struct type *base);                                \
+    attr int name##_st_walk(struct name *head,                                       \
+                            struct rix_hash_bucket_s *buckets,                       \
+                            struct type *base,                                       \
+                            int (*cb)(struct type *, void *),                        \
+                            void *arg);                                              \
+    attr int name##_st_walk_range(struct name *head,                                 \
+                                  struct rix_hash_bucket_s *buckets,                 \
+                                  struct type *base,                                 \
+                                  unsigned bk_begin, unsigned bk_end,                \
+                                  int (*cb)(struct type *, void *),                  \
+                                  void *arg);                                        \
+    attr unsigned name##_st_walk_step(struct name *head,                             \
+                                      struct rix_hash_bucket_s *buckets,             \
+                                      unsigned cursor, unsigned budget,              \
+                                      u32 *idx_out, unsigned max_out,                \
+                                      unsigned *n_out);
+
+#  define RIX_HASH_PROTOTYPE_SLOT_STASH(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_SLOT_STASH_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_STASH(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_STASH_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_STASH_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
+    RIX_HASH_GENERATE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field,   \
+                                          slot_field, cmp_fn, hash_fn, )
+
+#  define RIX_HASH_GENERATE_STATIC_SLOT_STASH_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_HASH_N(name, type, key_field, hash_fn)                   \
+    RIX_HASH_GENERATE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field,   \
+                                          slot_field, cmp_fn, hash_fn,         \
+                                          RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_STASH(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    _RIX_HASH_DEFINE_DEFAULT_HASH_FN(name, type, key_field)                    \
+    RIX_HASH_GENERATE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field,   \
+                                          slot_field, cmp_fn,                  \
+                                          _RIX_HASH_DEFAULT_HASH_FN_NAME(name), )
+
+#  define RIX_HASH_GENERATE_STATIC_SLOT_STASH(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    _RIX_HASH_DEFINE_DEFAULT_HASH_FN(name, type, key_field)                    \
+    RIX_HASH_GENERATE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field,   \
+                                          slot_field, cmp_fn,                  \
+                                          _RIX_HASH_DEFAULT_HASH_FN_NAME(name), \
+                                          RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_STASH_INTERNAL(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn, attr) \
+    RIX_HASH_GENERATE_SLOT_INTERNAL(name, type, key_field, hash_field,        \
+                                    slot_field, cmp_fn, hash_fn, attr)        \
+                                                                              \
+/* ================================================================== */      \
+/* Overflow stash                                                     */      \
+/* ================================================================== */      \
+attr void                                                                     \
+name##_st_init(struct name *head,                                             \
+               unsigned nb_bk,                                                \
+               unsigned st_nb_bk)                                             \
+{                                                                             \
+    RIX_ASSERT(st_nb_bk >= 1u && st_nb_bk <= RIX_HASH_STASH_MAX_BK);          \
+    if (st_nb_bk > RIX_HASH_STASH_MAX_BK)                                     \
+        st_nb_bk = RIX_HASH_STASH_MAX_BK;                                     \
+    name##_init(head, nb_bk);                                                 \
+    head->rhh_st.nb    = 0u;                                                  \
+    head->rhh_st.nb_bk = st_nb_bk;                                            \
+    memset(head->rhh_st.filter, 0, sizeof(head->rhh_st.filter));              \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE struct rix_hash_bucket_s *                 \
+name##_st_bk(const struct name *head,                                         \
+             struct rix_hash_bucket_s *buckets)                               \
+{                                                                             \
+    return buckets + head->rhh_mask + 1u;                                     \
+}                                                                             \
+                                                                              \
+/* Caller checks rhh_st.nb != 0 first; the filter skips most misses. */       \
+static RIX_UNUSED struct type *                                               \
+name##_st_scan(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               const _RIX_HASH_KEY_TYPE(type, key_field) *key,                \
+               u32 fp)                                                        \
+{                                                                             \
+    struct rix_hash_bucket_s *_sb = name##_st_bk(head, buckets);              \
+    if (!rix_hash_stash_filter_test(&head->rhh_st, fp))                       \
+        return NULL;                                                          \
+    for (unsigned _j = 0; _j < head->rhh_st.nb_bk; _j++) {                    \
+        u32 _hits = _RIX_HASH_FIND_U32X16(_sb[_j].hash, fp);                  \
+        while (_hits) {                                                       \
+            unsigned _bit = (unsigned)__builtin_ctz(_hits);                   \
+            _hits &= _hits - 1u;                                              \
+            struct type *_node = name##_hptr(base, _sb[_j].idx[_bit]);        \
+            RIX_ASSUME_NONNULL(_node);                                        \
+            if (cmp_fn(&_node->key_field, key) == 0)                          \
+                return _node;                                                 \
+        }                                                                     \
+    }                                                                         \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+/* Stage 4 of the staged find: main buckets, then the stash on a miss. */     \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_st_cmp_key(struct rix_hash_find_ctx_s *ctx,                            \
+                  struct name *head,                                          \
+                  struct rix_hash_bucket_s *buckets,                          \
+                  struct type *base)                                          \
+{                                                                             \
+    struct type *_node = name##_cmp_key(ctx, base);                           \
+    if (_node == NULL && head->rhh_st.nb)                                     \
+        _node = name##_st_scan(head, buckets, base,                           \
+                               (const _RIX_HASH_KEY_TYPE(type, key_field) *)  \
+                               ctx->key, ctx->fp);                            \
+    return _node;                                                             \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_st_find(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               const _RIX_HASH_KEY_TYPE(type, key_field) *key)                \
+{                                                                             \
+    struct rix_hash_find_ctx_s _ctx;                                          \
+    name##_hash_key(&_ctx, head, buckets, key);                               \
+    name##_scan_bk(&_ctx, head, buckets);                                     \
+    return name##_st_cmp_key(&_ctx, head, buckets, base);                     \
+}                                                                             \
+                                                                              \
+/* Put elm in the first free stash slot; elm when the stash is full. */       \
+static RIX_UNUSED struct type *                                               \
+name##_st_push(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               struct type *elm,                                              \
+               union rix_hash_hash_u _h)                                      \
+{                                                                             \
+    struct rix_hash_bucket_s *_sb = name##_st_bk(head, buckets);              \
+    if (head->rhh_st.nb >= head->rhh_st.nb_bk * RIX_HASH_BUCKET_ENTRY_SZ)     \
+        return elm;                                                           \
+    for (unsigned _j = 0; _j < head->rhh_st.nb_bk; _j++) {                    \
+        u32 _nilm = _RIX_HASH_FIND_U32X16(_sb[_j].hash, 0u);                  \
+        if (_nilm == 0u)                                                      \
+            continue;                                                         \
+        unsigned _s = (unsigned)__builtin_ctz(_nilm);                         \
+        elm->hash_field = _h.val32[0];                                        \
+        elm->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))             \
+            (RIX_HASH_BUCKET_ENTRY_SZ + _j * RIX_HASH_BUCKET_ENTRY_SZ + _s);  \
+        _sb[_j].hash[_s] = _h.val32[0] ^ _h.val32[1];                         \
+        _sb[_j].idx [_s] = name##_hidx(base, elm);                            \
+        rix_hash_stash_filter_set(&head->rhh_st, _sb[_j].hash[_s]);           \
+        head->rhh_st.nb++;                                                    \
+        head->rhh_nb++;                                                       \
+        return NULL;                                                          \
+    }                                                                         \
+    return elm;                                                               \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_st_insert_hashed(struct name *head,                                    \
+                        struct rix_hash_bucket_s *buckets,                    \
+                        struct type *base,                                    \
+                        struct type *elm,                                     \
+                        union rix_hash_hash_u _h)                             \
+{                                                                             \
+    struct type *_ret;                                                        \
+    if (head->rhh_st.nb) {                                                    \
+        _ret = name##_st_scan(head, buckets, base,                            \
+                              (const _RIX_HASH_KEY_TYPE(type, key_field) *)   \
+                              &elm->key_field,                                \
+                              _h.val32[0] ^ _h.val32[1]);                     \
+        if (_ret)                                                             \
+            return _ret;                                                      \
+    }                                                                         \
+    _ret = name##_insert_hashed(head, buckets, base, elm, _h);                \
+    if (_ret != elm)                                                          \
+        return _ret;                                                          \
+    /* elm itself: either already in the main table or the kickout failed */  \
+    if ((unsigned)elm->slot_field < RIX_HASH_BUCKET_ENTRY_SZ &&               \
+        buckets[elm->hash_field & head->rhh_mask].idx[elm->slot_field] ==     \
+        (u32)name##_hidx(base, elm))                                          \
+        return elm;                                                           \
+    return name##_st_push(head, buckets, base, elm, _h);                      \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_st_insert(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 struct type *elm)                                            \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h =                                                \
+        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
+                mask);                                                        \
+    return name##_st_insert_hashed(head, buckets, base, elm, _h);             \
+}                                                                             \
+                                                                              \
+/* Clear stash position pos; returns its node index.  The filter bit  */      \
+/* of its fingerprint is dropped unless another stashed entry has it. */      \
+static RIX_UNUSED unsigned                                                    \
+name##_st_take(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               unsigned pos)                                                  \
+{                                                                             \
+    struct rix_hash_bucket_s *_sb = name##_st_bk(head, buckets);              \
+    struct rix_hash_bucket_s *_b = _sb + pos / RIX_HASH_BUCKET_ENTRY_SZ;      \
+    unsigned _s = pos % RIX_HASH_BUCKET_ENTRY_SZ;                             \
+    unsigned _idx = _b->idx[_s];                                              \
+    u32 _fp = _b->hash[_s];                                                   \
+    _b->hash[_s] = 0u;                                                        \
+    _b->idx [_s] = (u32)RIX_NIL;                                              \
+    head->rhh_st.nb--;                                                        \
+    head->rhh_nb--;                                                           \
+    for (unsigned _j = 0; _j < head->rhh_st.nb_bk; _j++) {                    \
+        for (unsigned _k = 0; _k < RIX_HASH_BUCKET_ENTRY_SZ; _k++) {          \
+            if (_sb[_j].idx[_k] != (u32)RIX_NIL &&                            \
+                (_sb[_j].hash[_k] >> 24) == (_fp >> 24))                      \
+                return _idx;                                                  \
+        }                                                                     \
+    }                                                                         \
+    rix_hash_stash_filter_clear(&head->rhh_st, _fp);                          \
+    return _idx;                                                              \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ * A slot of bucket bk was freed: move the first stashed entry that has bk    \
+ * as a candidate bucket into it.  No hashing, no kickout.                    \
+ */                                                                           \
+static RIX_UNUSED void                                                        \
+name##_st_refill(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 unsigned bk)                                                 \
+{                                                                             \
+    struct rix_hash_bucket_s *_sb = name##_st_bk(head, buckets);              \
+    struct rix_hash_bucket_s *_b = buckets + bk;                              \
+    unsigned mask = head->rhh_mask;                                           \
+    u32 _nilm = _RIX_HASH_FIND_U32X16(_b->hash, 0u);                          \
+    if (_nilm == 0u)                                                          \
+        return;                                                               \
+    for (unsigned _p = 0;                                                     \
+         _p < head->rhh_st.nb_bk * RIX_HASH_BUCKET_ENTRY_SZ; _p++) {          \
+        unsigned _j = _p / RIX_HASH_BUCKET_ENTRY_SZ;                          \
+        unsigned _s = _p % RIX_HASH_BUCKET_ENTRY_SZ;                          \
+        unsigned _idx = _sb[_j].idx[_s];                                      \
+        if (_idx == (unsigned)RIX_NIL)                                        \
+            continue;                                                         \
+        struct type *_node = name##_hptr(base, _idx);                         \
+        u32 _fp = _sb[_j].hash[_s];                                           \
+        u32 _h  = _node->hash_field;                                          \
+        if ((_h & mask) != bk) {                                              \
+            _h ^= _fp;                                                        \
+            if ((_h & mask) != bk)                                            \
+                continue;                                                     \
+        }                                                                     \
+        unsigned _slot = (unsigned)__builtin_ctz(_nilm);                      \
+        name##_st_take(head, buckets, _p);                                    \
+        _node->hash_field = _h;                                               \
+        _node->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))_slot;     \
+        _b->hash[_slot] = _fp;                                                \
+        _b->idx [_slot] = (u32)_idx;                                          \
+        head->rhh_nb++;                                                       \
+        return;                                                               \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_st_remove(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 struct type *elm)                                            \
+{                                                                             \
+    unsigned _slot = (unsigned)elm->slot_field;                               \
+    if (_slot >= RIX_HASH_BUCKET_ENTRY_SZ) {                                  \
+        unsigned _pos = _slot - RIX_HASH_BUCKET_ENTRY_SZ;                     \
+        if (_pos >= head->rhh_st.nb_bk * RIX_HASH_BUCKET_ENTRY_SZ ||          \
+            name##_st_bk(head, buckets)[_pos / RIX_HASH_BUCKET_ENTRY_SZ]      \
+                .idx[_pos % RIX_HASH_BUCKET_ENTRY_SZ] !=                      \
+            (u32)name##_hidx(base, elm))                                      \
+            return NULL;                                                      \
+        name##_st_take(head, buckets, _pos);                                  \
+        return elm;                                                           \
+    }                                                                         \
+    unsigned _bk = elm->hash_field & head->rhh_mask;                          \
+    if (name##_remove(head, buckets, base, elm) == NULL)                      \
+        return NULL;                                                          \
+    if (head->rhh_st.nb)                                                      \
+        name##_st_refill(head, buckets, base, _bk);                           \
+    return elm;                                                               \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_st_drain(struct name *head,                                            \
+                struct rix_hash_bucket_s *buckets,                            \
+                struct type *base)                                            \
+{                                                                             \
+    struct rix_hash_bucket_s *_sb = name##_st_bk(head, buckets);              \
+    for (unsigned _p = 0;                                                     \
+         head->rhh_st.nb &&                                                   \
+         _p < head->rhh_st.nb_bk * RIX_HASH_BUCKET_ENTRY_SZ; _p++) {          \
+        unsigned _j = _p / RIX_HASH_BUCKET_ENTRY_SZ;                          \
+        unsigned _s = _p % RIX_HASH_BUCKET_ENTRY_SZ;                          \
+        if (_sb[_j].idx[_s] == (u32)RIX_NIL)                                  \
+            continue;                                                         \
+        u32 _fp = _sb[_j].hash[_s];                                           \
+        struct type *_node = name##_hptr(base, _sb[_j].idx[_s]);              \
+        union rix_hash_hash_u _h;                                             \
+        _h.val32[0] = _node->hash_field;                                      \
+        _h.val32[1] = _node->hash_field ^ _fp;                                \
+        name##_st_take(head, buckets, _p);                                    \
+        if (name##_insert_hashed(head, buckets, base, _node, _h) == NULL)     \
+            continue;                                                         \
+        /* still no room: back to the same position */                        \
+        _node->hash_field = _h.val32[0];                                      \
+        _node->slot_field = (_RIX_HASH_SLOT_TYPE(type, slot_field))           \
+            (RIX_HASH_BUCKET_ENTRY_SZ + _p);                                  \
+        _sb[_j].hash[_s] = _fp;                                               \
+        _sb[_j].idx [_s] = name##_hidx(base, _node);                          \
+        rix_hash_stash_filter_set(&head->rhh_st, _fp);                        \
+        head->rhh_st.nb++;                                                    \
+        head->rhh_nb++;                                                       \
+    }                                                                         \
+    return head->rhh_st.nb;                                                   \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_RANGE(name, st_walk_range, struct rix_hash_bucket_s,  \
+                              struct type, RIX_HASH_BUCKET_ENTRY_SZ,          \
+                              head->rhh_mask + 1u + head->rhh_st.nb_bk, 0,    \
+                              attr)                                           \
+                                                                              \
+attr int                                                                      \
+name##_st_walk(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               int (*cb)(struct type *, void *),                              \
+               void *arg)                                                     \
+{                                                                             \
+    return name##_st_walk_range(head, buckets, base, 0u,                      \
+                                head->rhh_mask + 1u + head->rhh_st.nb_bk,     \
+                                cb, arg);                                     \
+}                                                                             \
+                                                                              \
+/* Main buckets, then the stash buckets behind them. */                       \
+_RIX_HASH_GENERATE_WALK_STEP(name, st_walk_step, struct rix_hash_bucket_s,    \
+                             RIX_HASH_BUCKET_ENTRY_SZ,                        \
+                             head->rhh_mask + 1u + head->rhh_st.nb_bk, 0,     \
+                             attr)
+
+
+/*===========================================================================
+ * RIX_HASH_GENERATE_SLOT_SEED(name, type, key_field, hash_field,
+ *                             slot_field, cmp_fn)
+ * RIX_HASH_GENERATE_SLOT_SEED_EX(..., cmp_fn, hash_fn)
+ *
+ * Same table as RIX_HASH_GENERATE_SLOT, hashed with a per-table seed kept
+ * in the head (declare it with RIX_HASH_SEED_HEAD(name); see
+ * rix_hash_common.h).  hash_fn(key, mask, seed) defaults to
+ * rix_hash_hash_bytes_keyed().  Seed the table from a real random source.
+ *
+ *   name_sd_need_reseed is true once the share of inserts that found both
+ *   candidate buckets full exceeds RIX_HASH_SEED_KICK_PCT (after at least
+ *   RIX_HASH_SEED_WINDOW / 2 inserts): the symptom of keys aimed at a few
+ *   bucket pairs.  The policy is the caller's; a table that is simply very
+ *   full also kicks out a lot, and a reseed does not help it.
+ *
+ *   name_sd_reseed_start switches to a new seed (fails if one is running);
+ *   name_sd_reseed_step then re-places the entries of up to nb buckets,
+ *   and returns 0 once every entry is placed for the new seed.  An entry
+ *   the new seed cannot place (table too full) stays under the old seed
+ *   and is retried in the next pass.  A whole pass that places no entry
+ *   rolls the reseed back: the seeds swap, the sweep returns the moved
+ *   entries to the old seed, and reseed_step returns 0 with
+ *   head->rhh_sd.rollback set and rhh_sd.seed unchanged from before
+ *   reseed_start.
+ *
+ * A seeded table must be modified only through the name_sd_* ops (plus
+ * name_remove / name_remove_at, which do not hash).  The plain name_find /
+ * name_insert / name_hash_key hash with seed 0 and must not be used.
+ * Lookups may use the staged pipeline with the sd_ first and last stages:
+ *
+ *   name_sd_hash_key -> name_scan_bk -> name_prefetch_node -> name_sd_cmp_key
+ *
+ * Generated functions (in addition to RIX_HASH_GENERATE_SLOT):
+ *   void         name_sd_init         (head, nb_bk, seed)
+ *   void         name_sd_hash_key     (ctx, head, buckets, key)
+ *   struct type *name_sd_cmp_key      (ctx, head, buckets, base)
+ *   struct type *name_sd_find         (head, buckets, base, key)
+ *   struct type *name_sd_insert       (head, buckets, base, elm)
+ *   struct type *name_sd_remove       (head, buckets, base, elm)
+ *   int          name_sd_need_reseed  (head)
+ *   int          name_sd_reseed_start (head, seed)
+ *   unsigned     name_sd_reseed_step  (head, buckets, base, nb)
+ *===========================================================================*/
+#  define RIX_HASH_PROTOTYPE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    RIX_HASH_PROTOTYPE_SLOT_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    attr void name##_sd_init(struct name *head, unsigned nb_bk, u64 seed);           \
+    attr struct type *name##_sd_find(struct name *head,                              \
+                                     struct rix_hash_bucket_s *buckets,              \
+                                     struct type *base,                              \
+                                     const _RIX_HASH_KEY_TYPE(type, key_field) *key); \
+    attr struct type *name##_sd_insert(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       struct type *base,                            \
+                                       struct type *elm);                            \
+    attr struct type *name##_sd_remove(struct name *head,                            \
+                                       struct rix_hash_bucket_s *buckets,            \
+                                       struct type *base,                            \
+                                       struct type *elm);                            \
+    attr int name##_sd_reseed_start(struct name *head, u64 seed);                    \
+    attr unsigned name##_sd_reseed_step(struct name *head,                           \
+                                        struct rix_hash_bucket_s *buckets,           \
+                                        struct type *base,                           \
+                                        unsigned nb);
+
+#  define RIX_HASH_PROTOTYPE_SLOT_SEED(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_SLOT_SEED_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_SEED(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_PROTOTYPE_STATIC_SLOT_SEED_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_SEED_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_SEED0_HASH_FN(name, type, key_field, hash_fn)             \
+    RIX_HASH_GENERATE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field,    \
+                                         slot_field, cmp_fn, hash_fn, )
+
+#  define RIX_HASH_GENERATE_STATIC_SLOT_SEED_EX(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn) \
+    _RIX_HASH_DEFINE_SEED0_HASH_FN(name, type, key_field, hash_fn)             \
+    RIX_HASH_GENERATE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field,    \
+                                         slot_field, cmp_fn, hash_fn,          \
+                                         RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_SLOT_SEED(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    _RIX_HASH_DEFINE_KEYED_HASH_FN(name, type, key_field)                      \
+    RIX_HASH_GENERATE_SLOT_SEED_EX(name, type, key_field, hash_field,          \
+                                   slot_field, cmp_fn,                         \
+                                   _RIX_HASH_KEYED_HASH_FN_NAME(name))
+
+#  define RIX_HASH_GENERATE_STATIC_SLOT_SEED(name, type, key_field, hash_field, slot_field, cmp_fn) \
+    _RIX_HASH_DEFINE_KEYED_HASH_FN(name, type, key_field)                      \
+    RIX_HASH_GENERATE_STATIC_SLOT_SEED_EX(name, type, key_field, hash_field,   \
+                                          slot_field, cmp_fn,                  \
+                                          _RIX_HASH_KEYED_HASH_FN_NAME(name))
+
+#  define RIX_HASH_GENERATE_SLOT_SEED_INTERNAL(name, type, key_field, hash_field, slot_field, cmp_fn, hash_fn, attr) \
+    RIX_HASH_GENERATE_SLOT_INTERNAL(name, type, key_field, hash_field,        \
+                                    slot_field, cmp_fn, name##_seed0_hash,    \
+                                    attr)                                     \
+                                                                              \
+/* ================================================================== */      \
+/* Keyed hash with online reseed                                      */      \
+/* ================================================================== */      \
+attr void                                                                     \
+name##_sd_init(struct name *head,                                             \
+               unsigned nb_bk,                                                \
+               u64 seed)                                                      \
+{                                                                             \
+    name##_init(head, nb_bk);                                                 \
+    memset(&head->rhh_sd, 0, sizeof(head->rhh_sd));                           \
+    head->rhh_sd.seed = seed;                                                 \
+    head->rhh_sd.old  = seed;                                                 \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE union rix_hash_hash_u                      \
+name##_sd_hash(const struct name *head,                                       \
+               const _RIX_HASH_KEY_TYPE(type, key_field) *key,                \
+               u64 seed)                                                      \
+{                                                                             \
+    return hash_fn(key, head->rhh_mask, seed);                                \
+}                                                                             \
+                                                                              \
+/* Stage 1 under the current seed. */                                         \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_sd_hash_key(struct rix_hash_find_ctx_s *ctx,                           \
+                   struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   const _RIX_HASH_KEY_TYPE(type, key_field) *key)            \
+{                                                                             \
+    name##_hash_key_hashed(ctx, head, buckets, key,                           \
+                           name##_sd_hash(head, key, head->rhh_sd.seed));     \
+}                                                                             \
+                                                                              \
+/* Find key under the old seed (reseed running). */                           \
+static RIX_UNUSED struct type *                                               \
+name##_sd_find_old(struct name *head,                                         \
+                   struct rix_hash_bucket_s *buckets,                         \
+                   struct type *base,                                         \
+                   const _RIX_HASH_KEY_TYPE(type, key_field) *key)            \
+{                                                                             \
+    struct rix_hash_find_ctx_s _c;                                            \
+    name##_hash_key_hashed(&_c, head, buckets, key,                           \
+                           name##_sd_hash(head, key, head->rhh_sd.old));      \
+    name##_scan_bk(&_c, head, buckets);                                       \
+    return name##_cmp_key(&_c, base);                                         \
+}                                                                             \
+                                                                              \
+/* Last stage: on a miss while a reseed runs, retry under the old seed. */    \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_sd_cmp_key(struct rix_hash_find_ctx_s *ctx,                            \
+                  struct name *head,                                          \
+                  struct rix_hash_bucket_s *buckets,                          \
+                  struct type *base)                                          \
+{                                                                             \
+    struct type *_node = name##_cmp_key(ctx, base);                           \
+    if (_node == NULL && head->rhh_sd.busy)                                   \
+        _node = name##_sd_find_old(head, buckets, base,                       \
+                                   (const _RIX_HASH_KEY_TYPE(type, key_field) *) \
+                                   ctx->key);                                 \
+    return _node;                                                             \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_sd_find(struct name *head,                                             \
+               struct rix_hash_bucket_s *buckets,                             \
+               struct type *base,                                             \
+               const _RIX_HASH_KEY_TYPE(type, key_field) *key)                \
+{                                                                             \
+    struct rix_hash_find_ctx_s _ctx;                                          \
+    name##_sd_hash_key(&_ctx, head, buckets, key);                            \
+    name##_scan_bk(&_ctx, head, buckets);                                     \
+    return name##_sd_cmp_key(&_ctx, head, buckets, base);                     \
+}                                                                             \
+                                                                              \
+/* elm sits where the hash _h puts it: bucket and fp both match. */           \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_sd_is_placed(const struct name *head,                                  \
+                    const struct rix_hash_bucket_s *buckets,                  \
+                    const struct type *elm,                                   \
+                    union rix_hash_hash_u _h)                                 \
+{                                                                             \
+    unsigned _s = (unsigned)elm->slot_field;                                  \
+    if (elm->hash_field != _h.val32[0] && elm->hash_field != _h.val32[1])     \
+        return 0;                                                             \
+    return _s < RIX_HASH_BUCKET_ENTRY_SZ &&                                   \
+           buckets[elm->hash_field & head->rhh_mask].hash[_s] ==              \
+           (_h.val32[0] ^ _h.val32[1]);                                       \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_sd_insert(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 struct type *elm)                                            \
+{                                                                             \
+    const _RIX_HASH_KEY_TYPE(type, key_field) *_key =                         \
+        (const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field;         \
+    struct rix_hash_seed_s *_sd = &head->rhh_sd;                              \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h = name##_sd_hash(head, _key, _sd->seed);         \
+    struct type *_ret;                                                        \
+    unsigned _full;                                                           \
+    if (_sd->busy) {                                                          \
+        /* a key not yet moved off the old seed is a duplicate too */         \
+        _ret = name##_sd_find_old(head, buckets, base, _key);                 \
+        if (_ret)                                                             \
+            return _ret;                                                      \
+    }                                                                         \
+    _full = (_RIX_HASH_FIND_U32X16(buckets[_h.val32[0] & mask].hash, 0u) |    \
+             _RIX_HASH_FIND_U32X16(buckets[_h.val32[1] & mask].hash, 0u))     \
+            == 0u;                                                            \
+    _ret = name##_insert_hashed(head, buckets, base, elm, _h);                \
+    if (_ret == NULL || _ret == elm) {                                        \
+        _sd->nb_kick += _full;                                                \
+        if (++_sd->nb_ins >= RIX_HASH_SEED_WINDOW) {                          \
+            _sd->nb_ins  /= 2u;                                               \
+            _sd->nb_kick /= 2u;                                               \
+        }                                                                     \
+    }                                                                         \
+    return _ret;                                                              \
+}                                                                             \
+                                                                              \
+attr struct type *                                                            \
+name##_sd_remove(struct name *head,                                           \
+                 struct rix_hash_bucket_s *buckets,                           \
+                 struct type *base,                                           \
+                 struct type *elm)                                            \
+{                                                                             \
+    return name##_remove(head, buckets, base, elm);                           \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE int                                        \
+name##_sd_need_reseed(const struct name *head)                                \
+{                                                                             \
+    const struct rix_hash_seed_s *_sd = &head->rhh_sd;                        \
+    return !_sd->busy && _sd->nb_ins >= RIX_HASH_SEED_WINDOW / 2u &&          \
+           _sd->nb_kick * 100u > _sd->nb_ins * RIX_HASH_SEED_KICK_PCT;        \
+}                                                                             \
+                                                                              \
+attr int                                                                      \
+name##_sd_reseed_start(struct name *head,                                     \
+                       u64 seed)                                              \
+{                                                                             \
+    struct rix_hash_seed_s *_sd = &head->rhh_sd;                              \
+    if (_sd->busy || seed == _sd->seed)                                       \
+        return -1;                                                            \
+    _sd->old     = _sd->seed;                                                 \
+    _sd->seed    = seed;                                                      \
+    _sd->busy    = 1u;                                                        \
+    _sd->cursor  = 0u;                                                        \
+    _sd->stale   = 0u;                                                        \
+    _sd->moved   = 0u;                                                        \
+    _sd->rollback = 0u;                                                       \
+    _sd->nb_ins  = 0u;                                                        \
+    _sd->nb_kick = 0u;                                                        \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ * Re-place the old-seed entries of the next nb buckets.  Kickouts may move   \
+ * an old entry behind the cursor, so the sweep makes passes until one finds  \
+ * no old entry.  A pass that finds old entries but places none of them      \
+ * (the new seed piles them on full bucket pairs) swaps the seeds once, so    \
+ * the sweep moves everything back and busy can clear.  Returns 0 when the    \
+ * reseed is done or rolled back, else the buckets left in the current pass.  \
+ */                                                                           \
+attr unsigned                                                                 \
+name##_sd_reseed_step(struct name *head,                                      \
+                      struct rix_hash_bucket_s *buckets,                      \
+                      struct type *base,                                      \
+                      unsigned nb)                                            \
+{                                                                             \
+    struct rix_hash_seed_s *_sd = &head->rhh_sd;                              \
+    unsigned mask = head->rhh_mask;                                           \
+    if (!_sd->busy)                                                           \
+        return 0u;                                                            \
+    while (nb--) {                                                            \
+        unsigned _b = _sd->cursor;                                            \
+        struct rix_hash_bucket_s *_bk = buckets + _b;                         \
+        for (unsigned _s = 0; _s < RIX_HASH_BUCKET_ENTRY_SZ; _s++) {          \
+            unsigned _idx = _bk->idx[_s];                                     \
+            if (_idx == (unsigned)RIX_NIL) continue;                          \
+            struct type *_node = name##_hptr(base, _idx);                     \
+            const _RIX_HASH_KEY_TYPE(type, key_field) *_key =                 \
+                (const _RIX_HASH_KEY_TYPE(type, key_field) *)                 \
+                &_node->key_field;                                            \
+            union rix_hash_hash_u _h = name##_sd_hash(head, _key, _sd->seed); \
+            if (name##_sd_is_placed(head, buckets, _node, _h))                \
+                continue;                                                     \
+            _sd->stale++;                                                     \
+            name##_remove_at(head, buckets, _b, _s);                          \
+            if (name##_insert_hashed(head, buckets, base, _node, _h) != NULL) { \
+                /* no room under the new seed: the freed slot takes it back */ \
+                struct type *_r = name##_insert_hashed(head, buckets, base,   \
+                    _node, name##_sd_hash(head, _key, _sd->old));             \
+                RIX_ASSERT(_r == NULL);                                       \
+                (void)_r;                                                     \
+            } else {                                                          \
+                _sd->moved++;                                                 \
+            }                                                                 \
+        }                                                                     \
+        if (++_sd->cursor > mask) {                                           \
+            _sd->cursor = 0u;                                                 \
+            if (_sd->stale == 0u) {                                           \
+                _sd->busy = 0u;                                               \
+                _sd->old  = _sd->seed;                                        \
+                return 0u;                                                    \
+            }                                                                 \
+            if (_sd->moved == 0u && !_sd->rollback) {                         \
+                u64 _seed = _sd->seed;                                        \
+                _sd->seed     = _sd->old;                                     \
+                _sd->old      = _seed;                                        \
+                _sd->rollback = 1u;                                           \
+            }                                                                 \
+            _sd->stale = 0u;                                                  \
+            _sd->moved = 0u;                                                  \
+        }                                                                     \
+    }                                                                         \
+    return mask + 1u - _sd->cursor;                                           \
+}
 
 #endif /* _RIX_HASH_SLOT_H_ */
@@ -0,0 +1,688 @@
+/*-
+ * SPDX-License-Identifier: BSD 3-Clause License
+ *
+ * Copyright (c) 2026 deadcafe.beef@gmail.com
+ * All rights reserved.
+ */
+
+/*
+ * rix_hash_tag.h - single-cache-line tag variant (hash_field in node).
+ *
+ * Requires: rix_hash_common.h
+ *
+ * Bucket layout (64 bytes = 1 cache line, aligned to 64 bytes):
+ *
+ *   u16 tag[12]   24 bytes: 16-bit tags, tag[10..11] always 0 (padding)
+ *   u32 idx[10]   40 bytes: 1-origin node idx
+ *
+ * The fingerprint variant keeps hash[16] and idx[16] on two lines, so a
+ * hit touches both.  Here the tag scan and the idx load share one line:
+ * a lookup costs one bucket fetch plus the node.  The price is 10 slots
+ * per bucket instead of 16 and a 16-bit tag instead of a 32-bit
+ * fingerprint (about 10 / 65536 false tag hits per bucket scan, each
+ * resolved by the key compare).
+ *
+ * Candidate buckets (partial-key cuckoo):
+ *
+ *   tag = val32[1] >> 16           (0 remapped to 1; 0 marks an empty slot)
+ *   bk0 = val32[0] & mask
+ *   bk1 = (val32[0] ^ rix_hash_tag_alt(tag)) & mask
+ *
+ * rix_hash_tag_alt() is odd, so bk0 != bk1 whenever nb_bk >= 2, and the
+ * alternate bucket of any occupant is  (bk ^ rix_hash_tag_alt(tag)) & mask:
+ * a kickout finds it from the bucket line alone, without touching the
+ * node.  node->hash_field keeps the fingerprint-variant invariant
+ *   node->hash_field & mask == current_bucket_index
+ * (val32[0] in bk0, val32[0] ^ rix_hash_tag_alt(tag) in bk1), so remove is
+ * still O(1) without re-hashing the key.
+ *
+ * Generated functions (section order):
+ *   init, staged find (x1, xN), find, insert, remove, remove_at, walk,
+ *   walk_range, walk_step
+ *
+ * The bucket array type is struct rix_hash_tag_bucket_s and the staged find
+ * context is struct rix_hash_tag_find_ctx_s; otherwise the API matches
+ * RIX_HASH_GENERATE (rix_hash_fp.h).
+ */
+
+#ifndef _RIX_HASH_TAG_H_
+#  define _RIX_HASH_TAG_H_
+
+#  include "rix_hash_common.h"
+
+#  ifndef _RIX_HASH_FIND_U16X12
+#    define _RIX_HASH_FIND_U16X12(arr, val) \
+        rix_hash_arch->find_u16x12((arr), (val))
+#  endif
+
+#  define RIX_HASH_TAG_BUCKET_ENTRY_SZ 10u
+#  define RIX_HASH_TAG_SLOT_MASK       ((1u << RIX_HASH_TAG_BUCKET_ENTRY_SZ) - 1u)
+
+/*===========================================================================
+ * Tag-variant bucket layout
+ * 64 bytes = 1 cache line, aligned to 64 bytes.
+ *===========================================================================*/
+struct rix_hash_tag_bucket_s {
+    u16 tag[12];                           /* 24 bytes: 16-bit tags      */
+    u32 idx[RIX_HASH_TAG_BUCKET_ENTRY_SZ]; /* 40 bytes: 1-origin node idx */
+} __attribute__((aligned(64)));
+
+RIX_STATIC_ASSERT(sizeof(struct rix_hash_tag_bucket_s) == 64,
+                  "tag bucket must be one cache line");
+
+/*===========================================================================
+ * Find context (staged pipeline)
+ *===========================================================================*/
+struct rix_hash_tag_find_ctx_s {
+    union rix_hash_hash_u         hash;        /*  8B  offset  0 */
+    struct rix_hash_tag_bucket_s *bk[2];       /* 16B  offset  8 */
+    const void                   *key;         /*  8B  offset 24 */
+    u32                           tag;         /*  4B  offset 32 */
+    u32                           tag_hits[2]; /*  8B  offset 36 */
+    /* 44B + 4B tail padding = 48B */
+};
+
+/*===========================================================================
+ * Tag helpers
+ *===========================================================================*/
+
+/* XOR distance between the two candidate buckets of a tag (always odd). */
+static RIX_FORCE_INLINE u32
+rix_hash_tag_alt(u32 tag)
+{
+    return (tag * 0x9E3779B1u) | 1u;
+}
+
+/* Derive bk0 / bk1 and the non-zero 16-bit tag from a hash. */
+static RIX_FORCE_INLINE void
+rix_hash_tag_buckets(const union rix_hash_hash_u h, unsigned mask,
+                     unsigned *bk0_out, unsigned *bk1_out, u32 *tag_out)
+{
+    u32 tag = h.val32[1] >> 16;
+
+    if (tag == 0u)
+        tag = 1u;
+    *bk0_out = h.val32[0] & mask;
+    *bk1_out = (h.val32[0] ^ rix_hash_tag_alt(tag)) & mask;
+    *tag_out = tag;
+}
+
+/* Bitmask of slots in bucket whose tag equals tag (0 = empty slots). */
+static RIX_FORCE_INLINE u32
+rix_hash_tag_find(const struct rix_hash_tag_bucket_s *bucket, u32 tag)
+{
+    return _RIX_HASH_FIND_U16X12(bucket->tag, (u16)tag) &
+           RIX_HASH_TAG_SLOT_MASK;
+}
+
+/* The whole bucket is one line: tags and idx[] arrive together. */
+static RIX_FORCE_INLINE void
+rix_hash_prefetch_tag_bucket(const struct rix_hash_tag_bucket_s *bucket)
+{
+    __builtin_prefetch(bucket, 0, 1);
+}
+
+/*---------------------------------------------------------------------------
+ * rix_hash_tag_nb_bk_hint - recommended nb_bk for a target ~50% slot fill
+ * (10 slots per bucket: nb_bk = ceil(max_entries / 5), power of 2, >= 2).
+ *---------------------------------------------------------------------------*/
+static inline unsigned
+rix_hash_tag_nb_bk_hint(unsigned max_entries)
+{
+    unsigned n = (max_entries + 4u) / 5u;   /* ceil(max_entries / 5) */
+    if (n < 2u)
+        n = 2u;
+    /* round up to next power of 2 */
+    n--;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    return n + 1u;
+}
+
+#  define RIX_HASH_PROTOTYPE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, attr) \
+    attr void name##_init(struct name *head, unsigned nb_bk);                        \
+    attr struct type *name##_insert(struct name *head,                               \
+                                    struct rix_hash_tag_bucket_s *buckets,           \
+                                    struct type *base,                               \
+                                    struct type *elm);                               \
+    attr unsigned name##_remove_at(struct name *head,                                \
+                                   struct rix_hash_tag_bucket_s *buckets,            \
+                                   unsigned bk,                                      \
+                                   unsigned slot);                                   \
+    attr struct type *name##_remove(struct name *head,                               \
+                                    struct rix_hash_tag_bucket_s *buckets,           \
+                                    struct type *base,                               \
+                                    struct type *elm);                               \
+    attr int name##_walk(struct name *head,                                          \
+                         struct rix_hash_tag_bucket_s *buckets,                      \
+                         struct type *base,                                          \
+                         int (*cb)(struct type *, void *),                           \
+                         void *arg);                                                 \
+    attr int name##_walk_range(struct name *head,                                    \
+                               struct rix_hash_tag_bucket_s *buckets,                \
+                               struct type *base,                                    \
+                               unsigned bk_begin, unsigned bk_end,                   \
+                               int (*cb)(struct type *, void *),                     \
+                               void *arg);                                           \
+    attr unsigned name##_walk_step(struct name *head,                                \
+                                   struct rix_hash_tag_bucket_s *buckets,            \
+                                   unsigned cursor, unsigned budget,                 \
+                                   u32 *idx_out, unsigned max_out,                   \
+                                   unsigned *n_out);
+
+#  define RIX_HASH_PROTOTYPE_TAG_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_TAG(name, type, key_field, hash_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, )
+
+#  define RIX_HASH_PROTOTYPE_STATIC_TAG_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
+    RIX_HASH_PROTOTYPE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_PROTOTYPE_STATIC_TAG(name, type, key_field, hash_field, cmp_fn) \
+    RIX_HASH_PROTOTYPE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_TAG_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
+    RIX_HASH_GENERATE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, hash_fn, )
+
+#  define RIX_HASH_GENERATE_STATIC_TAG_EX(name, type, key_field, hash_field, cmp_fn, hash_fn) \
+    RIX_HASH_GENERATE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, hash_fn, \
+                                   RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_TAG(name, type, key_field, hash_field, cmp_fn)     \
+    _RIX_HASH_DEFINE_DEFAULT_HASH_FN(name, type, key_field)                    \
+    RIX_HASH_GENERATE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn,  \
+                                   _RIX_HASH_DEFAULT_HASH_FN_NAME(name), )
+
+#  define RIX_HASH_GENERATE_STATIC_TAG(name, type, key_field, hash_field, cmp_fn) \
+    _RIX_HASH_DEFINE_DEFAULT_HASH_FN(name, type, key_field)                    \
+    RIX_HASH_GENERATE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn,  \
+                                   _RIX_HASH_DEFAULT_HASH_FN_NAME(name),       \
+                                   RIX_UNUSED static)
+
+#  define RIX_HASH_GENERATE_TAG_INTERNAL(name, type, key_field, hash_field, cmp_fn, hash_fn, attr) \
+                                                                              \
+/* ================================================================== */      \
+/* Init                                                               */      \
+/* ================================================================== */      \
+attr void                                                                     \
+name##_init(struct name *head,                                                \
+            unsigned nb_bk)                                                   \
+{                                                                             \
+    head->rhh_mask = nb_bk - 1u;                                              \
+    head->rhh_nb   = 0u;                                                      \
+}                                                                             \
+                                                                              \
+/* ------------------------------------------------------------------ */      \
+/* Internal helpers: 1-origin index <-> pointer                       */      \
+/* ------------------------------------------------------------------ */      \
+static RIX_UNUSED RIX_FORCE_INLINE unsigned                                   \
+name##_hidx(struct type *base, const struct type *p) {                        \
+    return RIX_IDX_FROM_PTR(base, (struct type *)(uintptr_t)p);               \
+}                                                                             \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_hptr(struct type *base, unsigned i) {                                  \
+    return RIX_PTR_FROM_IDX(base, i);                                         \
+}                                                                             \
+                                                                              \
+/* Compare key against the tag hits of one bucket. */                         \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_cmp_bk(const struct rix_hash_tag_bucket_s *bk,                         \
+              u32 hits,                                                       \
+              struct type *base,                                              \
+              const _RIX_HASH_KEY_TYPE(type, key_field) *key)                 \
+{                                                                             \
+    while (hits) {                                                            \
+        unsigned      _bit  = (unsigned)__builtin_ctz(hits);                  \
+        hits &= hits - 1u;                                                    \
+        unsigned      _nidx = bk->idx[_bit];                                  \
+        if (_nidx == (unsigned)RIX_NIL) continue; /* removed slot */          \
+        struct type  *_node = name##_hptr(base, _nidx);                       \
+        if (cmp_fn(key, &_node->key_field) == 0)                              \
+            return _node;                                                     \
+    }                                                                         \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Staged find - x1                                                   */      \
+/* ================================================================== */      \
+                                                                              \
+/* Stage 1: compute hash and tag, resolve buckets, prefetch bk_0 line. */     \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key(struct rix_hash_tag_find_ctx_s *ctx,                          \
+                struct name *head,                                            \
+                struct rix_hash_tag_bucket_s *buckets,                        \
+                const _RIX_HASH_KEY_TYPE(type, key_field) *key)               \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h = hash_fn(key, mask);                            \
+    unsigned _bk0, _bk1;                                                      \
+    u32 _tag;                                                                 \
+    rix_hash_tag_buckets(_h, mask, &_bk0, &_bk1, &_tag);                      \
+    ctx->hash  = _h;                                                          \
+    ctx->tag   = _tag;                                                        \
+    ctx->key   = (const void *)key;                                           \
+    ctx->bk[0] = buckets + _bk0;                                              \
+    ctx->bk[1] = buckets + _bk1;                                              \
+    rix_hash_prefetch_tag_bucket(ctx->bk[0]);                                 \
+    /* bk_1 not prefetched: bk_0 miss path fetches it lazily in cmp_key. */   \
+}                                                                             \
+                                                                              \
+/* Stage 2: scan bk_0 tags; tag != 0, so empty slots never match.     */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_scan_bk(struct rix_hash_tag_find_ctx_s *ctx,                           \
+               struct name *head __attribute__((unused)),                     \
+               struct rix_hash_tag_bucket_s *buckets __attribute__((unused))) \
+{                                                                             \
+    ctx->tag_hits[0] = rix_hash_tag_find(ctx->bk[0], ctx->tag);               \
+    ctx->tag_hits[1] = 0u; /* bk_1 deferred to cmp_key on bk_0 miss */        \
+}                                                                             \
+                                                                              \
+/* Stage 3: prefetch node data for all tag_hits positions.  idx[] is   */     \
+/* on the line scan_bk already loaded.                                 */     \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_prefetch_node(struct rix_hash_tag_find_ctx_s *ctx,                     \
+                     struct type *base)                                       \
+{                                                                             \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        u32 _hits = ctx->tag_hits[_i];                                        \
+        while (_hits) {                                                       \
+            unsigned _bit = (unsigned)__builtin_ctz(_hits);                   \
+            _hits &= _hits - 1u;                                              \
+            _rix_hash_prefetch_entry(                                         \
+                name##_hptr(base, ctx->bk[_i]->idx[_bit]));                   \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/* Stage 4: compare keys for bk_0 hits; lazily scan bk_1 on bk_0 miss. */     \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_cmp_key(struct rix_hash_tag_find_ctx_s *ctx,                           \
+               struct type *base)                                             \
+{                                                                             \
+    const _RIX_HASH_KEY_TYPE(type, key_field) *_key =                         \
+        (const _RIX_HASH_KEY_TYPE(type, key_field) *)ctx->key;                \
+    struct type *_node =                                                      \
+        name##_cmp_bk(ctx->bk[0], ctx->tag_hits[0], base, _key);              \
+    if (_node)                                                                \
+        return _node;                                                         \
+    return name##_cmp_bk(ctx->bk[1], rix_hash_tag_find(ctx->bk[1], ctx->tag), \
+                         base, _key);                                         \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Staged find - xN bulk                                              */      \
+/* FORCE_INLINE + constant n -> compiler unrolls identically to xN.   */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_hash_key_n(struct rix_hash_tag_find_ctx_s *ctx,                        \
+                  int n,                                                      \
+                  struct name *head,                                          \
+                  struct rix_hash_tag_bucket_s *buckets,                      \
+                  const _RIX_HASH_KEY_TYPE(type, key_field) * const *keys)    \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        name##_hash_key(&ctx[_j], head, buckets, keys[_j]);                   \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_scan_bk_n(struct rix_hash_tag_find_ctx_s *ctx,                         \
+                 int n,                                                       \
+                 struct name *head,                                           \
+                 struct rix_hash_tag_bucket_s *buckets)                       \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        name##_scan_bk(&ctx[_j], head, buckets);                              \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_prefetch_node_n(struct rix_hash_tag_find_ctx_s *ctx,                   \
+                       int n,                                                 \
+                       struct type *base)                                     \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        name##_prefetch_node(&ctx[_j], base);                                 \
+}                                                                             \
+                                                                              \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_cmp_key_n(struct rix_hash_tag_find_ctx_s *ctx,                         \
+                 int n,                                                       \
+                 struct type *base,                                           \
+                 struct type **results)                                       \
+{                                                                             \
+    for (int _j = 0; _j < n; _j++)                                            \
+        results[_j] = name##_cmp_key(&ctx[_j], base);                         \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Single-shot find  = hash_key + scan_bk + cmp_key                   */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_find(struct name *head,                                                \
+            struct rix_hash_tag_bucket_s *buckets,                            \
+            struct type *base,                                                \
+            const _RIX_HASH_KEY_TYPE(type, key_field) *key)                   \
+{                                                                             \
+    struct rix_hash_tag_find_ctx_s _ctx;                                      \
+    name##_hash_key(&_ctx, head, buckets, key);                               \
+    name##_scan_bk (&_ctx, head, buckets);                                    \
+    return name##_cmp_key(&_ctx, base);                                       \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* find_empty: return any free slot in bucket, or -1                   */     \
+/* ================================================================== */      \
+static RIX_UNUSED int                                                         \
+name##_find_empty(struct rix_hash_tag_bucket_s *buckets,                      \
+                  unsigned bk_idx)                                            \
+{                                                                             \
+    u32 _nilm = rix_hash_tag_find(buckets + bk_idx, 0u);                      \
+    if (!_nilm) return -1;                                                    \
+    return (int)__builtin_ctz(_nilm);                                         \
+}                                                                             \
+                                                                              \
+/* Move the occupant of (src, s) into free slot d of its alt bucket dst. */   \
+static RIX_UNUSED RIX_FORCE_INLINE void                                       \
+name##_move(struct rix_hash_tag_bucket_s *buckets,                            \
+            struct type *base,                                                \
+            unsigned src,                                                     \
+            unsigned s,                                                       \
+            unsigned dst,                                                     \
+            unsigned d)                                                       \
+{                                                                             \
+    struct rix_hash_tag_bucket_s *_sb = buckets + src;                        \
+    struct rix_hash_tag_bucket_s *_db = buckets + dst;                        \
+    u16 _tag = _sb->tag[s];                                                   \
+    unsigned _idx = _sb->idx[s];                                              \
+    struct type *_nd = name##_hptr(base, _idx);                               \
+    RIX_ASSUME_NONNULL(_nd);                                                  \
+    _db->tag[d] = _tag;                                                       \
+    _db->idx[d] = _idx;                                                       \
+    _nd->hash_field ^= rix_hash_tag_alt(_tag);                                \
+    _sb->tag[s] = 0u;                                                         \
+    _sb->idx[s] = (u32)RIX_NIL;                                               \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* kickout (DFS, RIX_HASH_KICKOUT_BFS=0): make a free slot in bk.      */     \
+/* The alt bucket comes from bk_idx and the tag; nodes are only        */     \
+/* touched when an entry actually moves.                               */     \
+/* Returns freed slot index, or -1 (table untouched on failure).       */     \
+/* ================================================================== */      \
+static RIX_UNUSED int                                                         \
+name##_kickout(struct rix_hash_tag_bucket_s *buckets,                         \
+               struct type *base,                                             \
+               unsigned mask,                                                 \
+               unsigned bk_idx,                                               \
+               int depth)                                                     \
+{                                                                             \
+    if (depth <= 0) return -1;                                                \
+    struct rix_hash_tag_bucket_s *_bk = buckets + bk_idx;                     \
+                                                                              \
+    for (unsigned _s = 0; _s < RIX_HASH_TAG_BUCKET_ENTRY_SZ; _s++) {          \
+        unsigned _ab = (bk_idx ^ rix_hash_tag_alt(_bk->tag[_s])) & mask;      \
+        int _d = name##_find_empty(buckets, _ab);                             \
+        if (_d < 0) continue;                                                 \
+        name##_move(buckets, base, bk_idx, _s, _ab, (unsigned)_d);            \
+        return (int)_s;                                                       \
+    }                                                                         \
+                                                                              \
+    for (unsigned _s = 0; _s < RIX_HASH_TAG_BUCKET_ENTRY_SZ; _s++) {          \
+        u16      _tag = _bk->tag[_s];                                         \
+        unsigned _si  = _bk->idx[_s];                                         \
+        unsigned _ab  = (bk_idx ^ rix_hash_tag_alt(_tag)) & mask;             \
+        int      _d   = name##_kickout(buckets, base, mask, _ab, depth - 1);  \
+        if (_d >= 0) {                                                        \
+            /* Re-check: recursive chain may have relocated bk[_s] */         \
+            if (_bk->tag[_s] != _tag || _bk->idx[_s] != _si) {                \
+                int _fs = name##_find_empty(buckets, bk_idx);                 \
+                if (_fs >= 0) return _fs;                                     \
+                continue;                                                     \
+            }                                                                 \
+            name##_move(buckets, base, bk_idx, _s, _ab, (unsigned)_d);        \
+            return (int)_s;                                                   \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+/* Breadth-first kickout (see rix_hash_common.h).  On success returns */      \
+/* the freed slot and stores its bucket (bk0 or bk1) in *bk_out.      */      \
+/* Only bucket lines are visited while searching: alt buckets come   */       \
+/* from the tag, so no node is prefetched until the path is known.    */      \
+static RIX_UNUSED int                                                         \
+name##_kickout_bfs(struct rix_hash_tag_bucket_s *buckets,                     \
+                   struct type *base,                                         \
+                   unsigned mask,                                             \
+                   unsigned bk0,                                              \
+                   unsigned bk1,                                              \
+                   unsigned *bk_out)                                          \
+{                                                                             \
+    struct rix_hash_bfs_s _q[RIX_HASH_BFS_QUEUE];                             \
+    unsigned _head = 0u, _tail = 0u;                                          \
+    _q[_tail++] = (struct rix_hash_bfs_s){ bk0, RIX_HASH_BFS_ROOT, 0u, 0u };  \
+    if (bk1 != bk0)                                                           \
+        _q[_tail++] = (struct rix_hash_bfs_s){ bk1, RIX_HASH_BFS_ROOT,        \
+                                               0u, 0u };                      \
+    while (_head < _tail) {                                                   \
+        unsigned _qi = _head++;                                               \
+        unsigned _b  = _q[_qi].bk;                                            \
+        struct rix_hash_tag_bucket_s *_bk = buckets + _b;                     \
+        if (_q[_qi].depth != 0u) {                                            \
+            int _es = name##_find_empty(buckets, _b);                         \
+            if (_es >= 0) {                                                   \
+                unsigned _cs = (unsigned)_es;                                 \
+                while (_q[_qi].parent != RIX_HASH_BFS_ROOT) {                 \
+                    unsigned _pi = _q[_qi].parent;                            \
+                    name##_move(buckets, base, _q[_pi].bk,                    \
+                                _q[_qi].slot, _q[_qi].bk, _cs);               \
+                    _cs = _q[_qi].slot;                                       \
+                    _qi = _pi;                                                \
+                }                                                             \
+                *bk_out = _q[_qi].bk;                                         \
+                return (int)_cs;                                              \
+            }                                                                 \
+        }                                                                     \
+        if (_q[_qi].depth >= RIX_HASH_FOLLOW_DEPTH)                           \
+            continue;                                                         \
+        for (unsigned _n = 0, _fan = _rix_hash_bfs_fanout(_q, _qi);           \
+             _n < RIX_HASH_TAG_BUCKET_ENTRY_SZ && _fan != 0u; _n++) {         \
+            unsigned _s = _rix_hash_bfs_slot(_qi, _n,                         \
+                                             RIX_HASH_TAG_BUCKET_ENTRY_SZ);   \
+            unsigned _ab;                                                     \
+            if (_tail >= RIX_HASH_BFS_QUEUE)                                  \
+                break;                                                        \
+            _ab = (_b ^ rix_hash_tag_alt(_bk->tag[_s])) & mask;               \
+            if (_rix_hash_bfs_on_path(_q, _qi, _ab))                          \
+                continue;                                                     \
+            rix_hash_prefetch_tag_bucket(buckets + _ab);                      \
+            _q[_tail++] = (struct rix_hash_bfs_s){                            \
+                _ab, (u16)_qi, (u8)_s, (u8)(_q[_qi].depth + 1u) };            \
+            _fan--;                                                           \
+        }                                                                     \
+    }                                                                         \
+    return -1;                                                                \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Internal insert helper with precomputed hash                       */      \
+/* ================================================================== */      \
+static RIX_UNUSED RIX_FORCE_INLINE struct type *                              \
+name##_insert_hashed(struct name *head,                                       \
+                     struct rix_hash_tag_bucket_s *buckets,                   \
+                     struct type *base,                                       \
+                     struct type *elm,                                        \
+                     union rix_hash_hash_u _h)                                \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    unsigned _bk0, _bk1;                                                      \
+    u32 _tag;                                                                 \
+    u32 _hits_zero[2];                                                        \
+    rix_hash_tag_buckets(_h, mask, &_bk0, &_bk1, &_tag);                      \
+    rix_hash_prefetch_tag_bucket(buckets + _bk0);                             \
+    rix_hash_prefetch_tag_bucket(buckets + _bk1);                             \
+                                                                              \
+    /* Duplicate check in both candidate buckets before inserting.      */    \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        struct rix_hash_tag_bucket_s *_bk =                                   \
+            buckets + (_i == 0 ? _bk0 : _bk1);                                \
+        struct type *_node =                                                  \
+            name##_cmp_bk(_bk, rix_hash_tag_find(_bk, _tag), base,            \
+                          &elm->key_field);                                   \
+        if (_node)                                                            \
+            return _node; /* duplicate */                                     \
+        _hits_zero[_i] = rix_hash_tag_find(_bk, 0u);                          \
+    }                                                                         \
+                                                                              \
+    /* Fast path: empty slot in bk0 then bk1.  hash_field records the   */    \
+    /* bucket actually used (see the invariant in the header comment).  */    \
+    for (int _i = 0; _i < 2; _i++) {                                          \
+        u32 _nilm = _hits_zero[_i];                                           \
+        if (_nilm) {                                                          \
+            struct rix_hash_tag_bucket_s *_bk =                               \
+                buckets + (_i == 0 ? _bk0 : _bk1);                            \
+            unsigned _slot  = (unsigned)__builtin_ctz(_nilm);                 \
+            _bk->tag[_slot] = (u16)_tag;                                      \
+            _bk->idx[_slot] = name##_hidx(base, elm);                         \
+            elm->hash_field = _i == 0 ? _h.val32[0] :                         \
+                              _h.val32[0] ^ rix_hash_tag_alt(_tag);           \
+            head->rhh_nb++;                                                   \
+            return NULL; /* success */                                        \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    /* Slow path: kickout - make room in bk0 or bk1.                     */   \
+    /* On failure, table is untouched.                                   */   \
+    {                                                                         \
+        int _pos;                                                             \
+        unsigned _bki;                                                        \
+        if (RIX_HASH_KICKOUT_BFS) {                                           \
+            _pos = name##_kickout_bfs(buckets, base, mask, _bk0, _bk1,        \
+                                      &_bki);                                 \
+            if (_pos < 0)                                                     \
+                return elm; /* table full - no modification */                \
+        } else {                                                              \
+            _bki = _bk0;                                                      \
+            _pos = name##_kickout(buckets, base, mask, _bk0,                  \
+                                  RIX_HASH_FOLLOW_DEPTH);                     \
+            if (_pos < 0) {                                                   \
+                _bki = _bk1;                                                  \
+                _pos = name##_kickout(buckets, base, mask, _bk1,              \
+                                      RIX_HASH_FOLLOW_DEPTH);                 \
+                if (_pos < 0)                                                 \
+                    return elm; /* table full - no modification */            \
+            }                                                                 \
+        }                                                                     \
+        struct rix_hash_tag_bucket_s *_bk = buckets + _bki;                   \
+        _bk->tag[_pos] = (u16)_tag;                                           \
+        _bk->idx[_pos] = name##_hidx(base, elm);                              \
+        elm->hash_field = _bki == _bk0 ? _h.val32[0] :                        \
+                          _h.val32[0] ^ rix_hash_tag_alt(_tag);               \
+        head->rhh_nb++;                                                       \
+        return NULL; /* success */                                            \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Insert with cuckoo kickout                                         */      \
+/*                                                                    */      \
+/* Returns:                                                           */      \
+/*   NULL     - inserted successfully                                 */      \
+/*   elm      - table full (kickout exhausted)                        */      \
+/*   other    - duplicate found, returns the existing node            */      \
+/* ================================================================== */      \
+attr struct type *                                                            \
+name##_insert(struct name *head,                                              \
+              struct rix_hash_tag_bucket_s *buckets,                          \
+              struct type *base,                                              \
+              struct type *elm)                                               \
+{                                                                             \
+    unsigned mask = head->rhh_mask;                                           \
+    union rix_hash_hash_u _h =                                                \
+        hash_fn((const _RIX_HASH_KEY_TYPE(type, key_field) *)&elm->key_field, \
+                mask);                                                        \
+    return name##_insert_hashed(head, buckets, base, elm, _h);                \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Remove - evict a known node from the table                         */      \
+/*                                                                    */      \
+/* elm->hash_field & mask gives the current bucket; the slot is found */      \
+/* by scanning its idx[] (same cache line as the tags).               */      \
+/* Returns elm on success, NULL if elm is not currently in the table. */      \
+/* ================================================================== */      \
+attr unsigned                                                                 \
+name##_remove_at(struct name *head,                                           \
+                 struct rix_hash_tag_bucket_s *buckets,                       \
+                 unsigned bk,                                                 \
+                 unsigned slot);                                              \
+                                                                              \
+attr struct type *                                                            \
+name##_remove(struct name *head,                                              \
+              struct rix_hash_tag_bucket_s *buckets,                          \
+              struct type *base,                                              \
+              struct type *elm)                                               \
+{                                                                             \
+    unsigned node_idx = name##_hidx(base, elm);                               \
+    unsigned _bk = (unsigned)(elm->hash_field & head->rhh_mask);              \
+    struct rix_hash_tag_bucket_s *_b = buckets + _bk;                         \
+    for (unsigned _s = 0u; _s < RIX_HASH_TAG_BUCKET_ENTRY_SZ; _s++) {         \
+        if (_b->idx[_s] == node_idx) {                                        \
+            name##_remove_at(head, buckets, _bk, _s);                         \
+            return elm;                                                       \
+        }                                                                     \
+    }                                                                         \
+    return NULL; /* not in table */                                           \
+}                                                                             \
+                                                                              \
+attr unsigned                                                                 \
+name##_remove_at(struct name *head,                                           \
+                 struct rix_hash_tag_bucket_s *buckets,                       \
+                 unsigned bk,                                                 \
+                 unsigned slot)                                               \
+{                                                                             \
+    struct rix_hash_tag_bucket_s *_b = buckets + bk;                          \
+    unsigned _idx;                                                            \
+    RIX_ASSERT(slot < RIX_HASH_TAG_BUCKET_ENTRY_SZ);                          \
+    if (slot >= RIX_HASH_TAG_BUCKET_ENTRY_SZ)                                 \
+        return (unsigned)RIX_NIL;                                             \
+    _idx = _b->idx[slot];                                                     \
+    if (_idx == (unsigned)RIX_NIL)                                            \
+        return (unsigned)RIX_NIL;                                             \
+    _b->tag[slot] = 0u;                                                       \
+    _b->idx[slot] = (u32)RIX_NIL;                                             \
+    head->rhh_nb--;                                                           \
+    return _idx;                                                              \
+}                                                                             \
+                                                                              \
+/* ================================================================== */      \
+/* Walk - iterate over all occupied slots                             */      \
+/*                                                                    */      \
+/* cb(node, arg): return 0 to continue, non-zero to stop.             */      \
+/* Returns 0 when all entries are visited, or the first non-zero cb   */      \
+/* return value.                                                      */      \
+/* ================================================================== */      \
+_RIX_HASH_GENERATE_WALK_RANGE(name, walk_range, struct rix_hash_tag_bucket_s, \
+                              struct type, RIX_HASH_TAG_BUCKET_ENTRY_SZ,      \
+                              head->rhh_mask + 1u, 0, attr)                   \
+                                                                              \
+attr int                                                                      \
+name##_walk(struct name *head,                                                \
+            struct rix_hash_tag_bucket_s *buckets,                            \
+            struct type *base,                                                \
+            int (*cb)(struct type *, void *),                                 \
+            void *arg)                                                        \
+{                                                                             \
+    return name##_walk_range(head, buckets, base, 0u, head->rhh_mask + 1u,    \
+                             cb, arg);                                        \
+}                                                                             \
+                                                                              \
+_RIX_HASH_GENERATE_WALK_STEP(name, walk_step, struct rix_hash_tag_bucket_s,   \
+                             RIX_HASH_TAG_BUCKET_ENTRY_SZ,                    \
+                             head->rhh_mask + 1u, 0, attr)
+
+#endif /* _RIX_HASH_TAG_H_ */
@@ -0,0 +1,444 @@
+/*-
+ * SPDX-License-Identifier: BSD 3-Clause License
+ *
+ * Copyright (c) 2026 deadcafe.beef@gmail.com
+ * All rights reserved.
+ */
+
+/*
+ * rix_ring.h - bounded lock-free ring of u32 indices.
+ *
+ * The ring carries RIX indices (or any u32 token) between pipeline stages
+ * -- e.g. entry_idx batches from rx to classify to export -- so entries
+ * themselves are never copied.  Like the other rix structures it holds no
+ * pointers: the header and the slot array are one contiguous block of
+ * fixed-width u32 words, valid at any mapping address and identical for
+ * 32-bit and 64-bit processes sharing it.
+ *
+ * Layout (one block, 64-byte aligned):
+ *
+ *   line 0   size, mask, flags                 (read-only after init)
+ *   line 1   prod_head, prod_tail              (producers only)
+ *   line 2   cons_head, cons_tail              (consumers only)
+ *   line 3+  u32 slot[size]
+ *
+ * Producer and consumer state live on separate cache lines, so an
+ * enqueue and a dequeue running on different cores only share the line
+ * of the opposite tail they read.
+ *
+ * Head / tail are free-running u32 counters; the slot of counter c is
+ * slot[c & mask].  entries = prod_tail - cons_tail and free = size -
+ * (prod_head - cons_tail), both correct across u32 wrap, so all size
+ * slots are usable (no "one empty slot" rule).
+ *
+ * Producer / consumer modes:
+ *
+ *   sp / sc   single producer / single consumer: head moves with a plain
+ *             store.  Only one thread may use that side.
+ *   mp / mc   multi producer / multi consumer: a thread reserves n slots
+ *             by CAS on the head, fills (drains) them, then waits until
+ *             earlier reservations have been published and advances the
+ *             tail.  A preempted thread between reserve and publish
+ *             stalls the same side of the ring (not the other side).
+ *
+ * The mode may be chosen per call (rix_ring_{sp,mp}_enqueue_*,
+ * rix_ring_{sc,mc}_dequeue_*) or once at init with RIX_RING_F_SP_ENQ /
+ * RIX_RING_F_SC_DEQ and the generic rix_ring_{enqueue,dequeue}_* forms.
+ *
+ * Bulk vs burst:
+ *
+ *   *_bulk    all-or-nothing: returns n or 0.
+ *   *_burst   as many as possible: returns 0..n.
+ *
+ * Every enqueue/dequeue optionally reports the free space / remaining
+ * entries seen by that call through *free_space / *available (may be
+ * NULL).
+ *
+ * Usage:
+ *
+ *   struct rix_ring_s *r = shm_alloc(rix_ring_memsize(1024));
+ *   rix_ring_init(r, 1024, 0);                    // MPMC
+ *
+ *   // rx stage
+ *   n = rix_ring_mp_enqueue_burst(r, entry_idx, nb, NULL);
+ *
+ *   // classify stage
+ *   n = rix_ring_mc_dequeue_burst(r, entry_idx, 32, NULL);
+ */
+
+#ifndef _RIX_RING_H_
+#  define _RIX_RING_H_
+
+#  include "rix_defs_private.h"
+
+#  define RIX_RING_CACHE_LINE   64u
+#  define RIX_RING_SZ_MAX       (1u << 31)   /* counters compare mod 2^32 */
+
+#  define RIX_RING_F_SP_ENQ     0x0001u      /* default enqueue is sp */
+#  define RIX_RING_F_SC_DEQ     0x0002u      /* default dequeue is sc */
+
+/*===========================================================================
+ * Ring header
+ *===========================================================================*/
+struct rix_ring_s {
+    /* line 0: configuration (read-only after init) */
+    u32 size;                   /* number of slots, power of 2 */
+    u32 mask;                   /* size - 1 */
+    u32 flags;                  /* RIX_RING_F_* */
+    u32 _rsv0[13];
+    /* line 1: producer */
+    u32 prod_head;
+    u32 prod_tail;
+    u32 _rsv1[14];
+    /* line 2: consumer */
+    u32 cons_head;
+    u32 cons_tail;
+    u32 _rsv2[14];
+    /* line 3+: slots */
+    u32 slot[];
+} __attribute__((aligned(64)));
+
+RIX_STATIC_ASSERT(offsetof(struct rix_ring_s, prod_head) ==
+                  RIX_RING_CACHE_LINE,
+                  "rix_ring: producer state must start line 1");
+RIX_STATIC_ASSERT(offsetof(struct rix_ring_s, cons_head) ==
+                  2u * RIX_RING_CACHE_LINE,
+                  "rix_ring: consumer state must start line 2");
+RIX_STATIC_ASSERT(sizeof(struct rix_ring_s) == 3u * RIX_RING_CACHE_LINE,
+                  "rix_ring: header must be 3 cache lines");
+
+/*===========================================================================
+ * Setup
+ *===========================================================================*/
+/* Bytes needed for a ring of count slots (count: power of 2). */
+static inline size_t
+rix_ring_memsize(unsigned count)
+{
+    return sizeof(struct rix_ring_s) + (size_t)count * sizeof(u32);
+}
+
+/*
+ * Initialize an empty ring in a rix_ring_memsize(count) byte block.
+ * Returns 0, or -1 if count is 0, not a power of 2, or > RIX_RING_SZ_MAX.
+ * Must not race with any enqueue / dequeue.
+ */
+static inline int
+rix_ring_init(struct rix_ring_s *r, unsigned count, unsigned flags)
+{
+    if (count == 0u || (count & (count - 1u)) != 0u ||
+        count > RIX_RING_SZ_MAX)
+        return -1;
+    r->size  = count;
+    r->mask  = count - 1u;
+    r->flags = flags;
+    r->prod_head = r->prod_tail = 0u;
+    r->cons_head = r->cons_tail = 0u;
+    return 0;
+}
+
+/*===========================================================================
+ * Internal helpers
+ *===========================================================================*/
+static RIX_FORCE_INLINE void
+_rix_ring_cpu_relax(void)
+{
+#  if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#  elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#  else
+    __asm__ __volatile__("" ::: "memory");
+#  endif
+}
+
+/*
+ * Reserve up to n slots on one side.  head is this side's head, opp_tail
+ * the other side's tail, capacity is size for producers and 0 for
+ * consumers.  Returns the count reserved (0 when fixed and n does not
+ * fit) and sets *old_head and *room (slots that could be taken).
+ */
+static RIX_FORCE_INLINE unsigned
+_rix_ring_move_head(u32 *head, const u32 *opp_tail, u32 capacity,
+                    unsigned n, int fixed, int single,
+                    u32 *old_head, unsigned *room)
+{
+    /* acquire keeps the opp_tail load below from being satisfied
+     * before this one (and before a CAS reload of the head); a stale
+     * opp_tail against a newer head would wrap room to a huge value */
+    u32 old = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    unsigned take;
+
+    for (;;) {
+        /* pairs with the release store of the opposite tail */
+        u32 opp = __atomic_load_n(opp_tail, __ATOMIC_ACQUIRE);
+
+        /* producer: capacity = size,  room = size - (head - cons_tail)
+         * consumer: capacity = 0,     room = prod_tail - head          */
+        *room = (unsigned)(capacity + opp - old);
+        take = n;
+        if (RIX_UNLIKELY(take > *room))
+            take = fixed ? 0u : *room;
+        if (take == 0u)
+            break;
+        if (single) {
+            __atomic_store_n(head, old + take, __ATOMIC_RELAXED);
+            break;
+        }
+        if (__atomic_compare_exchange_n(head, &old, old + take, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+            break;
+        /* old reloaded by the failed CAS, ordered as above */
+    }
+    *old_head = old;
+    return take;
+}
+
+/*
+ * Publish [old, old + n) on one side.  Multi-thread callers wait for
+ * earlier reservations to publish first so the tail only moves over
+ * filled (drained) slots.
+ */
+static RIX_FORCE_INLINE void
+_rix_ring_update_tail(u32 *tail, u32 old, unsigned n, int single)
+{
+    if (!single) {
+        while (__atomic_load_n(tail, __ATOMIC_ACQUIRE) != old)
+            _rix_ring_cpu_relax();
+    }
+    __atomic_store_n(tail, old + n, __ATOMIC_RELEASE);
+}
+
+static RIX_FORCE_INLINE void
+_rix_ring_copy_in(struct rix_ring_s *r, u32 head,
+                  const u32 *idx, unsigned n)
+{
+    unsigned pos = head & r->mask;
+    unsigned first = r->size - pos;
+    unsigned i;
+
+    if (RIX_LIKELY(n <= first)) {
+        for (i = 0; i < n; i++)
+            r->slot[pos + i] = idx[i];
+    } else {
+        for (i = 0; i < first; i++)
+            r->slot[pos + i] = idx[i];
+        for (; i < n; i++)
+            r->slot[i - first] = idx[i];
+    }
+}
+
+static RIX_FORCE_INLINE void
+_rix_ring_copy_out(const struct rix_ring_s *r, u32 head,
+                   u32 *idx, unsigned n)
+{
+    unsigned pos = head & r->mask;
+    unsigned first = r->size - pos;
+    unsigned i;
+
+    if (RIX_LIKELY(n <= first)) {
+        for (i = 0; i < n; i++)
+            idx[i] = r->slot[pos + i];
+    } else {
+        for (i = 0; i < first; i++)
+            idx[i] = r->slot[pos + i];
+        for (; i < n; i++)
+            idx[i] = r->slot[i - first];
+    }
+}
+
+static RIX_FORCE_INLINE unsigned
+_rix_ring_enqueue(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                  int fixed, int single, unsigned *free_space)
+{
+    u32 head;
+    unsigned room;
+
+    n = _rix_ring_move_head(&r->prod_head, &r->cons_tail, r->size,
+                            n, fixed, single, &head, &room);
+    if (n != 0u) {
+        _rix_ring_copy_in(r, head, idx, n);
+        _rix_ring_update_tail(&r->prod_tail, head, n, single);
+    }
+    if (free_space != NULL)
+        *free_space = room - n;
+    return n;
+}
+
+static RIX_FORCE_INLINE unsigned
+_rix_ring_dequeue(struct rix_ring_s *r, u32 *idx, unsigned n,
+                  int fixed, int single, unsigned *available)
+{
+    u32 head;
+    unsigned room;
+
+    n = _rix_ring_move_head(&r->cons_head, &r->prod_tail, 0u,
+                            n, fixed, single, &head, &room);
+    if (n != 0u) {
+        _rix_ring_copy_out(r, head, idx, n);
+        _rix_ring_update_tail(&r->cons_tail, head, n, single);
+    }
+    if (available != NULL)
+        *available = room - n;
+    return n;
+}
+
+/*===========================================================================
+ * Enqueue
+ *===========================================================================*/
+static inline unsigned
+rix_ring_sp_enqueue_bulk(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                         unsigned *free_space)
+{
+    return _rix_ring_enqueue(r, idx, n, 1, 1, free_space);
+}
+
+static inline unsigned
+rix_ring_mp_enqueue_bulk(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                         unsigned *free_space)
+{
+    return _rix_ring_enqueue(r, idx, n, 1, 0, free_space);
+}
+
+static inline unsigned
+rix_ring_sp_enqueue_burst(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                          unsigned *free_space)
+{
+    return _rix_ring_enqueue(r, idx, n, 0, 1, free_space);
+}
+
+static inline unsigned
+rix_ring_mp_enqueue_burst(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                          unsigned *free_space)
+{
+    return _rix_ring_enqueue(r, idx, n, 0, 0, free_space);
+}
+
+/* Mode from RIX_RING_F_SP_ENQ. */
+static inline unsigned
+rix_ring_enqueue_bulk(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                      unsigned *free_space)
+{
+    return _rix_ring_enqueue(r, idx, n, 1,
+                             (r->flags & RIX_RING_F_SP_ENQ) != 0u,
+                             free_space);
+}
+
+static inline unsigned
+rix_ring_enqueue_burst(struct rix_ring_s *r, const u32 *idx, unsigned n,
+                       unsigned *free_space)
+{
+    return _rix_ring_enqueue(r, idx, n, 0,
+                             (r->flags & RIX_RING_F_SP_ENQ) != 0u,
+                             free_space);
+}
+
+static inline int
+rix_ring_enqueue(struct rix_ring_s *r, u32 idx)
+{
+    return rix_ring_enqueue_bulk(r, &idx, 1u, NULL) ? 0 : -1;
+}
+
+/*===========================================================================
+ * Dequeue
+ *===========================================================================*/
+static inline unsigned
+rix_ring_sc_dequeue_bulk(struct rix_ring_s *r, u32 *idx, unsigned n,
+                         unsigned *available)
+{
+    return _rix_ring_dequeue(r, idx, n, 1, 1, available);
+}
+
+static inline unsigned
+rix_ring_mc_dequeue_bulk(struct rix_ring_s *r, u32 *idx, unsigned n,
+                         unsigned *available)
+{
+    return _rix_ring_dequeue(r, idx, n, 1, 0, available);
+}
+
+static inline unsigned
+rix_ring_sc_dequeue_burst(struct rix_ring_s *r, u32 *idx, unsigned n,
+                          unsigned *available)
+{
+    return _rix_ring_dequeue(r, idx, n, 0, 1, available);
+}
+
+static inline unsigned
+rix_ring_mc_dequeue_burst(struct rix_ring_s *r, u32 *idx, unsigned n,
+                          unsigned *available)
+{
+    return _rix_ring_dequeue(r, idx, n, 0, 0, available);
+}
+
+/* Mode from RIX_RING_F_SC_DEQ. */
+static inline unsigned
+rix_ring_dequeue_bulk(struct rix_ring_s *r, u32 *idx, unsigned n,
+                      unsigned *available)
+{
+    return _rix_ring_dequeue(r, idx, n, 1,
+                             (r->flags & RIX_RING_F_SC_DEQ) != 0u,
+                             available);
+}
+
+static inline unsigned
+rix_ring_dequeue_burst(struct rix_ring_s *r, u32 *idx, unsigned n,
+                       unsigned *available)
+{
+    return _rix_ring_dequeue(r, idx, n, 0,
+                             (r->flags & RIX_RING_F_SC_DEQ) != 0u,
+                             available);
+}
+
+static inline int
+rix_ring_dequeue(struct rix_ring_s *r, u32 *idx)
+{
+    return rix_ring_dequeue_bulk(r, idx, 1u, NULL) ? 0 : -1;
+}
+
+/*===========================================================================
+ * State (a snapshot; may be stale by the time it is used)
+ *===========================================================================*/
+static inline unsigned
+rix_ring_count(const struct rix_ring_s *r)
+{
+    u32 ct = __atomic_load_n(&r->cons_tail, __ATOMIC_ACQUIRE);
+    u32 pt = __atomic_load_n(&r->prod_tail, __ATOMIC_ACQUIRE);
+    u32 n = pt - ct;
+
+    /* tails read at different instants; clamp a torn view */
+    return (unsigned)(n > r->size ? r->size : n);
+}
+
+static inline unsigned
+rix_ring_free_count(const struct rix_ring_s *r)
+{
+    return r->size - rix_ring_count(r);
+}
+
+static inline unsigned
+rix_ring_capacity(const struct rix_ring_s *r)
+{
+    return r->size;
+}
+
+static inline int
+rix_ring_empty(const struct rix_ring_s *r)
+{
+    return rix_ring_count(r) == 0u;
+}
+
+static inline int
+rix_ring_full(const struct rix_ring_s *r)
+{
+    return rix_ring_count(r) == r->size;
+}
+
+#endif /* _RIX_RING_H_ */
+
+/*
+ * Local Variables:
+ * c-file-style: "bsd"
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * tab-width: 4
+ * End:
+ */
@@ -13,6 +13,9 @@
 # For example, SIMD=avx512 with rix_hash_arch_init(RIX_HASH_ARCH_AVX2)
 # compiles AVX-512 but caps runtime selection at AVX2.
 #
+# FC_HASH=aes adds -maes, as samples/fcache does, so the AES-round hash
+# runs on AES-NI; the binary then needs an AES-NI CPU for that path.
+#
 
 SIMD ?= avx2
 
@@ -25,3 +28,7 @@ else ifeq ($(SIMD),avx512)
 else
   $(error Unknown SIMD='$(SIMD)'. Valid values: gen  avx2  avx512)
 endif
+
+ifeq ($(FC_HASH),aes)
+  SIMD_FLAGS += -maes
+endif
@@ -47,6 +47,20 @@
 /** @brief Cache-line size used for entry alignment. */
 #define FC_CACHE_LINE_SIZE 64u
 
+/** @brief fc_flow4_cache_compact_step() flag: after packing, renumber
+ *  live entries in bucket order so entries sharing a bucket share pages. */
+#define FC_COMPACT_BUCKET_ORDER 1u
+
+#ifndef FC_LOOKUP_MAX_KEYS
+/** @brief Most keys one fc_flow4_cache_lookup_issue() call can carry.
+ *  Sizes struct fc_flow4_lookup: the library and its callers must agree. */
+#define FC_LOOKUP_MAX_KEYS 256u
+#endif
+
+/** @brief fc_flow4_cache_lookup_issue() flag: insert misses on complete
+ *  (findadd_bulk semantics).  Without it, complete is a find_bulk. */
+#define FC_LOOKUP_ADD 1u
+
 #ifndef FC_FLOW4_DEFAULT_PRESSURE_EMPTY_SLOTS
 /** @brief Default insert-pressure threshold (empty slots per bucket). */
 #define FC_FLOW4_DEFAULT_PRESSURE_EMPTY_SLOTS 1u
@@ -101,7 +115,8 @@ struct fc_flow4_entry {
     uint64_t               last_ts;      /**< Last-access TSC; 0 = free. */
     RIX_SLIST_ENTRY(struct fc_flow4_entry) free_link;
     uint16_t               slot;         /**< Slot within current bucket. */
-    uint16_t               reserved1;
+    uint16_t               bk1_hits;     /**< Hits while in alternate bucket
+                                             (saturating; see promote). */
     uint8_t                reserved0[16];
 } __attribute__((aligned(FC_CACHE_LINE_SIZE)));
 
@@ -131,6 +146,17 @@ struct fc_flow4_config {
                                          0 = nb_bk (full sweep). */
     unsigned maint_fill_threshold;  /**< Fill count increase that triggers
                                          GC scale-up.  0 = disabled. */
+    unsigned promote_hits;          /**< Maintenance moves an entry back to
+                                         its primary bucket once it has
+                                         been hit this many times in its
+                                         alternate one.  0 = disabled. */
+    uint32_t *free_idx;             /**< Optional free-index array,
+                                         max_entries elements, caller-
+                                         provided.  Entries are then
+                                         allocated from this dense array
+                                         instead of the list linked
+                                         through each free entry.  NULL =
+                                         linked free list. */
 };
 
 /**
@@ -155,6 +181,16 @@ struct fc_flow4_stats {
     uint64_t maint_evictions;       /**< Entries evicted by maintain. */
     uint64_t maint_step_calls;      /**< Times maintain_step was called. */
     uint64_t maint_step_skipped_bks;/**< Buckets skipped by SIMD empty check. */
+    uint64_t compact_passes;        /**< Compaction passes started. */
+    uint64_t compact_moves;         /**< Entries moved by compaction. */
+    uint64_t hits_bk1;              /**< Hits on entries in their alternate
+                                         bucket (second bucket scanned). */
+    uint64_t promotions;            /**< Entries moved back to bk0. */
+    uint64_t promote_fails;         /**< Promotions with bk0 kept full. */
+    uint64_t coalesced;             /**< findadd_bulk keys served by an
+                                         identical earlier key. */
+    uint64_t hint_hits;             /**< find_by_hint_bulk keys served by
+                                         their hint (no bucket fetch). */
 };
 
 /**
@@ -189,10 +225,39 @@ struct fc_flow4_cache {
     unsigned                   maint_fill_threshold;
     unsigned                   last_maint_start_bk;  /**< Start bk of last sweep. */
     unsigned                   last_maint_sweep_bk;   /**< Buckets swept last time. */
+    unsigned                   compact_phase;   /**< 0 = no pass running. */
+    unsigned                   compact_flags;   /**< FC_COMPACT_* of the pass. */
+    unsigned                   compact_hi;      /**< Highest idx still to move. */
+    unsigned                   compact_anchor;  /**< Tail of the sorted free list. */
+    unsigned                   compact_bk;      /**< Next bucket to renumber. */
+    unsigned                   compact_pos;     /**< Positions renumbered so far. */
+    unsigned                   promote_hits;    /**< cfg->promote_hits. */
+    uint32_t                  *free_idx;        /**< cfg->free_idx, or NULL. */
+    unsigned                   free_lo;         /**< free_idx: bottom slot. */
+    unsigned                   free_nb;         /**< free_idx: free entries. */
+    unsigned                   hashed;          /**< Filled through _hashed calls. */
     struct fc_flow4_free_head free_head;
     struct fc_flow4_stats     stats;
 };
 
+/**
+ * @brief Split-phase lookup handle.
+ *
+ * Caller-provided, like all fcache storage.  Filled by
+ * fc_flow4_cache_lookup_issue(), consumed by
+ * fc_flow4_cache_lookup_complete().  About 17 KB: keep one per table
+ * per in-flight vector, not on a small stack.
+ */
+struct fc_flow4_lookup {
+    const struct fc_flow4_key  *keys;   /**< Keys passed to issue. */
+    unsigned                   nb_keys; /**< Number of keys accepted. */
+    unsigned                   flags;   /**< FC_LOOKUP_* flags. */
+    uint32_t                   lead[FC_LOOKUP_MAX_KEYS];
+                                        /**< 1 + earlier identical key. */
+    struct rix_hash_find_ctx_s ctx[FC_LOOKUP_MAX_KEYS];
+                                        /**< Per-key hash and buckets. */
+};
+
 /**
  * @brief Initialize a flow cache.
  *
@@ -261,6 +326,11 @@ void fc_flow4_cache_find_bulk(struct fc_flow4_cache *fc,
  * inserted inline (hash reused, no rehash).  On return,
  * @c results[i].entry_idx is non-zero unless the cache is full.
  *
+ * A key identical to one of the last 16 distinct flows of the batch
+ * skips the pipeline and copies that flow's result (@c stats.coalesced),
+ * so bursts of one flow cost a single lookup or insert.  Build with
+ * -DFLOW_CACHE_COALESCE=0 to disable.
+ *
  * @param[in,out] fc        Cache instance.
  * @param[in]     keys      Array of @p nb_keys lookup keys.
  * @param[in]     nb_keys   Number of keys.
@@ -272,6 +342,172 @@ void fc_flow4_cache_findadd_bulk(struct fc_flow4_cache *fc,
                                   unsigned nb_keys, uint64_t now,
                                   struct fc_flow4_result *results);
 
+/**
+ * @brief fc_flow4_cache_find_bulk() with caller-supplied hashes.
+ *
+ * Skips key hashing: @p hashes[i] (typically the NIC RSS hash from the
+ * Rx descriptor) is mixed and expanded into the two candidate buckets
+ * by rix_hash_hash_from_u32(), so the key is only read by the compare.
+ * rix_hash_toeplitz() computes the same value in software for keys
+ * that arrive without one.
+ *
+ * Entries are placed by the hash they were inserted with.  A cache fed
+ * through the _hashed calls must be probed through them as well; the
+ * keyed find / findadd / add / del calls would look in other buckets.
+ * del_idx, maintenance and compact only use the hash stored in the
+ * entry and work on either kind of cache.  Promote needs each entry's
+ * primary bucket: once a _hashed call has inserted, the cache reads it
+ * off the stored hash and bucket fingerprint instead of rehashing keys,
+ * until the next flush.
+ *
+ * @param[in,out] fc        Cache instance.
+ * @param[in]     keys      Array of @p nb_keys lookup keys.
+ * @param[in]     hashes    One 32-bit hash per key.
+ * @param[in]     nb_keys   Number of keys.
+ * @param[in]     now       Current TSC; 0 = no timestamp update.
+ * @param[out]    results   Per-key results.
+ */
+void fc_flow4_cache_find_bulk_hashed(struct fc_flow4_cache *fc,
+                                     const struct fc_flow4_key *keys,
+                                     const uint32_t *hashes,
+                                     unsigned nb_keys, uint64_t now,
+                                     struct fc_flow4_result *results);
+
+/**
+ * @brief fc_flow4_cache_findadd_bulk() with caller-supplied hashes.
+ *
+ * Misses are inserted under the supplied hash; see
+ * fc_flow4_cache_find_bulk_hashed() for the rules.
+ *
+ * @param[in,out] fc        Cache instance.
+ * @param[in]     keys      Array of @p nb_keys lookup keys.
+ * @param[in]     hashes    One 32-bit hash per key.
+ * @param[in]     nb_keys   Number of keys.
+ * @param[in]     now       Current TSC timestamp.
+ * @param[out]    results   Per-key results.
+ */
+void fc_flow4_cache_findadd_bulk_hashed(struct fc_flow4_cache *fc,
+                                        const struct fc_flow4_key *keys,
+                                        const uint32_t *hashes,
+                                        unsigned nb_keys, uint64_t now,
+                                        struct fc_flow4_result *results);
+
+/**
+ * @brief Batch lookup that tries an entry_idx hint before hashing.
+ *
+ * @p hints[i] is a guess of the key's @c entry_idx, typically the flow
+ * mark a NIC rule stamps on the packets of an offloaded flow.  The hinted
+ * entry is prefetched and accepted if it is live and holds the key: one
+ * entry line instead of two bucket lines plus the entry.  Keys whose
+ * hint is 0, out of range, free or reused for another flow go through
+ * the fc_flow4_cache_find_bulk() pipeline.  Results are the same as
+ * fc_flow4_cache_find_bulk(); a result differing from its hint (the
+ * entry was evicted, re-added or moved by compaction) tells the caller
+ * to update or drop the NIC rule.  Hint hits do not count towards
+ * promote.
+ *
+ * @param[in,out] fc        Cache instance.
+ * @param[in]     keys      Array of @p nb_keys lookup keys.
+ * @param[in]     hints     One entry_idx hint per key; 0 = none.
+ * @param[in]     nb_keys   Number of keys.
+ * @param[in]     now       Current TSC; 0 = no timestamp update.
+ * @param[out]    results   Per-key results.
+ */
+void fc_flow4_cache_find_by_hint_bulk(struct fc_flow4_cache *fc,
+                                      const struct fc_flow4_key *keys,
+                                      const uint32_t *hints,
+                                      unsigned nb_keys, uint64_t now,
+                                      struct fc_flow4_result *results);
+
+/**
+ * @brief fc_flow4_cache_find_by_hint_bulk() with caller-supplied hashes.
+ *
+ * Keys whose hint fails are looked up as fc_flow4_cache_find_bulk_hashed()
+ * does, so hints work on a cache fed through the _hashed calls.
+ *
+ * @param[in,out] fc        Cache instance.
+ * @param[in]     keys      Array of @p nb_keys lookup keys.
+ * @param[in]     hashes    One 32-bit hash per key.
+ * @param[in]     hints     One entry_idx hint per key; 0 = none.
+ * @param[in]     nb_keys   Number of keys.
+ * @param[in]     now       Current TSC; 0 = no timestamp update.
+ * @param[out]    results   Per-key results.
+ */
+void fc_flow4_cache_find_by_hint_bulk_hashed(struct fc_flow4_cache *fc,
+                                             const struct fc_flow4_key *keys,
+                                             const uint32_t *hashes,
+                                             const uint32_t *hints,
+                                             unsigned nb_keys, uint64_t now,
+                                             struct fc_flow4_result *results);
+
+/**
+ * @brief Split-phase lookup, first half: hash and prefetch.
+ *
+ * Hashes every key and prefetches both candidate buckets, then returns
+ * without touching them.  The caller does other work while the lines
+ * arrive (header parsing, issuing the lookup on another table) and then
+ * calls fc_flow4_cache_lookup_complete().  With @c FC_LOOKUP_ADD the
+ * next free entries are prefetched too and duplicate keys are
+ * coalesced as in fc_flow4_cache_findadd_bulk().
+ *
+ * Until the matching complete, @p keys must stay valid and @p fc must
+ * not be modified.  Every bucket line of the batch is requested at
+ * once, so batches much larger than L1 trade pipelining for overlap.
+ *
+ * @param[in]  fc       Cache instance.
+ * @param[out] lk       Handle to fill.
+ * @param[in]  keys     Array of @p nb_keys keys.
+ * @param[in]  nb_keys  Number of keys.  Only the first
+ *                      FC_LOOKUP_MAX_KEYS are taken; lk->nb_keys tells
+ *                      how many, and the rest go in another batch.
+ * @param[in]  flags    0 or FC_LOOKUP_ADD.
+ * @return @p lk.
+ */
+struct fc_flow4_lookup *
+fc_flow4_cache_lookup_issue(struct fc_flow4_cache *fc,
+                            struct fc_flow4_lookup *lk,
+                            const struct fc_flow4_key *keys,
+                            unsigned nb_keys, unsigned flags);
+
+/**
+ * @brief fc_flow4_cache_lookup_issue() with caller-supplied hashes.
+ *
+ * Stage 1 expands @p hashes[i] as fc_flow4_cache_find_bulk_hashed()
+ * does; finish with fc_flow4_cache_lookup_complete().  With
+ * @c FC_LOOKUP_ADD, misses are inserted under the supplied hash.
+ *
+ * @param[in]  fc       Cache instance.
+ * @param[out] lk       Handle to fill.
+ * @param[in]  keys     Array of @p nb_keys keys.
+ * @param[in]  hashes   One 32-bit hash per key.
+ * @param[in]  nb_keys  Number of keys; see fc_flow4_cache_lookup_issue().
+ * @param[in]  flags    0 or FC_LOOKUP_ADD.
+ * @return @p lk.
+ */
+struct fc_flow4_lookup *
+fc_flow4_cache_lookup_issue_hashed(struct fc_flow4_cache *fc,
+                                   struct fc_flow4_lookup *lk,
+                                   const struct fc_flow4_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, unsigned flags);
+
+/**
+ * @brief Split-phase lookup, second half: scan, compare, insert.
+ *
+ * Finishes the lookup started by fc_flow4_cache_lookup_issue() with the
+ * results and statistics of fc_flow4_cache_find_bulk(), or of
+ * fc_flow4_cache_findadd_bulk() when issued with @c FC_LOOKUP_ADD.
+ *
+ * @param[in,out] fc       Cache instance passed to issue.
+ * @param[in,out] lk       Handle filled by issue.
+ * @param[in]     now      Current TSC timestamp.
+ * @param[out]    results  Per-key results, lk->nb_keys elements.
+ */
+void fc_flow4_cache_lookup_complete(struct fc_flow4_cache *fc,
+                                    struct fc_flow4_lookup *lk,
+                                    uint64_t now,
+                                    struct fc_flow4_result *results);
+
 /**
  * @brief Pipelined batch insert (no duplicate check).
  *
@@ -445,6 +681,76 @@ int fc_flow4_cache_walk(struct fc_flow4_cache *fc,
                          int (*cb)(uint32_t entry_idx, void *arg),
                          void *arg);
 
+/**
+ * @brief Incrementally compact the entry pool.
+ *
+ * After long churn the live entries are scattered over the whole pool
+ * and the LIFO free list keeps them there.  A compaction pass moves the
+ * highest-indexed live entries into the lowest free ones until the live
+ * set occupies the dense prefix [1, nb_entries], rewriting the single
+ * bucket reference of each moved entry in O(1) through @c cur_hash and
+ * @c slot.  With @c FC_COMPACT_BUCKET_ORDER the pass then walks the
+ * buckets and swaps entries into bucket order, so entries that share a
+ * bucket also share a page.
+ *
+ * Each call does about @p budget units of work (one per entry moved or
+ * visited; a bucket is never split across calls) and may be interleaved
+ * with any other operation.  The first call of a pass re-sorts the free
+ * list into index order (one sweep of the pool), so new entries are
+ * allocated from the low end while the pass runs and after it ends.
+ * Entries freed or inserted between calls only make the result less
+ * dense; they never break the cache.
+ *
+ * A moved entry changes its entry_idx.  For every move @p moved (if not
+ * NULL) is called with the old and new index: the entry at @c from_idx
+ * now lives at @c to_idx, and whatever was at @c to_idx (a free entry or
+ * another live entry) now lives at @c from_idx.  Callers that keep
+ * per-entry state outside the pool swap it here.
+ *
+ * @param[in,out] fc      Cache instance.
+ * @param[in]     budget  Work units for this call.
+ * @param[in]     flags   0 or FC_COMPACT_BUCKET_ORDER; latched by the
+ *                        call that starts a pass.
+ * @param[in]     moved   Index-exchange callback, or NULL.
+ * @param[in]     arg     Opaque argument forwarded to @p moved.
+ * @return 1 while the pass is still running, 0 once it has finished
+ *         (the next call starts a new pass).
+ */
+int fc_flow4_cache_compact_step(struct fc_flow4_cache *fc,
+                                 unsigned budget, unsigned flags,
+                                 void (*moved)(uint32_t from_idx,
+                                               uint32_t to_idx, void *arg),
+                                 void *arg);
+
+/**
+ * @brief Move hot entries back into their primary bucket.
+ *
+ * An entry that a cuckoo kick left in its alternate bucket costs every
+ * hit a second bucket scan; such hits are counted in @c stats.hits_bk1
+ * and in the entry's saturating @c bk1_hits.  For each entry of the
+ * @p bucket_count buckets starting at @p start_bk (wrapping) whose
+ * @c bk1_hits has reached @p min_hits, this moves it to its primary
+ * bucket through the XOR alternate-bucket relation.  A full primary
+ * bucket first sends one of its own displaced occupants home; an entry
+ * that would have to demote a primary one stays put
+ * (@c stats.promote_fails).  @c bk1_hits restarts from 0 either way.
+ *
+ * Entries keep their entry_idx.  With @c cfg->promote_hits set,
+ * fc_flow4_cache_maintain() and the maintain_step functions do the same
+ * for every bucket they reclaim, while its entries are still in cache.
+ *
+ * @param[in,out] fc            Cache instance.
+ * @param[in]     start_bk      First bucket index (masked internally).
+ * @param[in]     bucket_count  Number of buckets to visit.
+ * @param[in]     min_hits      Alternate-bucket hits needed; 0 = any
+ *                              entry living in its alternate bucket.
+ * @return Number of entries moved to their primary bucket.
+ */
+unsigned fc_flow4_cache_promote(struct fc_flow4_cache *fc,
+                                 unsigned start_bk,
+                                 unsigned bucket_count,
+                                 unsigned min_hits);
+
 #endif /* _FLOW4_CACHE_H_ */
 
 /*
@@ -21,6 +21,15 @@
 #ifndef FC_CACHE_LINE_SIZE
 #define FC_CACHE_LINE_SIZE 64u
 #endif
+#ifndef FC_COMPACT_BUCKET_ORDER
+#define FC_COMPACT_BUCKET_ORDER 1u
+#endif
+#ifndef FC_LOOKUP_MAX_KEYS
+#define FC_LOOKUP_MAX_KEYS 256u
+#endif
+#ifndef FC_LOOKUP_ADD
+#define FC_LOOKUP_ADD 1u
+#endif
 #ifndef FC_FLOWU_DEFAULT_PRESSURE_EMPTY_SLOTS
 #define FC_FLOWU_DEFAULT_PRESSURE_EMPTY_SLOTS 1u
 #endif
@@ -95,7 +104,7 @@ struct fc_flowu_entry {
     uint64_t               last_ts;      /* 0 = free / invalid */
     RIX_SLIST_ENTRY(struct fc_flowu_entry) free_link;
     uint16_t               slot;         /* slot in current bucket */
-    uint16_t               reserved1;
+    uint16_t               bk1_hits;     /* hits while in alternate bucket */
 } __attribute__((aligned(FC_CACHE_LINE_SIZE)));
 
 RIX_STATIC_ASSERT(sizeof(struct fc_flowu_entry) == FC_CACHE_LINE_SIZE,
@@ -110,6 +119,8 @@ struct fc_flowu_config {
     uint64_t maint_interval_tsc;
     unsigned maint_base_bk;
     unsigned maint_fill_threshold;
+    unsigned promote_hits;
+    uint32_t *free_idx;
 };
 
 struct fc_flowu_stats {
@@ -128,6 +139,13 @@ struct fc_flowu_stats {
     uint64_t maint_evictions;
     uint64_t maint_step_calls;
     uint64_t maint_step_skipped_bks;
+    uint64_t compact_passes;
+    uint64_t compact_moves;
+    uint64_t hits_bk1;
+    uint64_t promotions;
+    uint64_t promote_fails;
+    uint64_t coalesced;
+    uint64_t hint_hits;
 };
 
 struct fc_flowu_cache {
@@ -155,10 +173,30 @@ struct fc_flowu_cache {
     unsigned                   maint_fill_threshold;
     unsigned                   last_maint_start_bk;
     unsigned                   last_maint_sweep_bk;
+    unsigned                   compact_phase;
+    unsigned                   compact_flags;
+    unsigned                   compact_hi;
+    unsigned                   compact_anchor;
+    unsigned                   compact_bk;
+    unsigned                   compact_pos;
+    unsigned                   promote_hits;
+    uint32_t                  *free_idx;
+    unsigned                   free_lo;
+    unsigned                   free_nb;
+    unsigned                   hashed;
     struct fc_flowu_free_head free_head;
     struct fc_flowu_stats     stats;
 };
 
+/* split-phase lookup handle (see struct fc_flow4_lookup) */
+struct fc_flowu_lookup {
+    const struct fc_flowu_key  *keys;
+    unsigned                   nb_keys;
+    unsigned                   flags;
+    uint32_t                   lead[FC_LOOKUP_MAX_KEYS];
+    struct rix_hash_find_ctx_s ctx[FC_LOOKUP_MAX_KEYS];
+};
+
 void fc_flowu_cache_init(struct fc_flowu_cache *fc,
                           struct rix_hash_bucket_s *buckets,
                           unsigned nb_bk,
@@ -176,6 +214,45 @@ void fc_flowu_cache_findadd_bulk(struct fc_flowu_cache *fc,
                                   const struct fc_flowu_key *keys,
                                   unsigned nb_keys, uint64_t now,
                                   struct fc_flowu_result *results);
+/* caller-supplied hashes (see fc_flow4_cache_find_bulk_hashed) */
+void fc_flowu_cache_find_bulk_hashed(struct fc_flowu_cache *fc,
+                                     const struct fc_flowu_key *keys,
+                                     const uint32_t *hashes,
+                                     unsigned nb_keys, uint64_t now,
+                                     struct fc_flowu_result *results);
+void fc_flowu_cache_findadd_bulk_hashed(struct fc_flowu_cache *fc,
+                                        const struct fc_flowu_key *keys,
+                                        const uint32_t *hashes,
+                                        unsigned nb_keys, uint64_t now,
+                                        struct fc_flowu_result *results);
+/* entry_idx hint first (see fc_flow4_cache_find_by_hint_bulk) */
+void fc_flowu_cache_find_by_hint_bulk(struct fc_flowu_cache *fc,
+                                      const struct fc_flowu_key *keys,
+                                      const uint32_t *hints,
+                                      unsigned nb_keys, uint64_t now,
+                                      struct fc_flowu_result *results);
+void fc_flowu_cache_find_by_hint_bulk_hashed(struct fc_flowu_cache *fc,
+                                             const struct fc_flowu_key *keys,
+                                             const uint32_t *hashes,
+                                             const uint32_t *hints,
+                                             unsigned nb_keys, uint64_t now,
+                                             struct fc_flowu_result *results);
+/* split-phase lookup (see fc_flow4_cache_lookup_issue) */
+struct fc_flowu_lookup *
+fc_flowu_cache_lookup_issue(struct fc_flowu_cache *fc,
+                            struct fc_flowu_lookup *lk,
+                            const struct fc_flowu_key *keys,
+                            unsigned nb_keys, unsigned flags);
+struct fc_flowu_lookup *
+fc_flowu_cache_lookup_issue_hashed(struct fc_flowu_cache *fc,
+                                   struct fc_flowu_lookup *lk,
+                                   const struct fc_flowu_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, unsigned flags);
+void fc_flowu_cache_lookup_complete(struct fc_flowu_cache *fc,
+                                    struct fc_flowu_lookup *lk,
+                                    uint64_t now,
+                                    struct fc_flowu_result *results);
 void fc_flowu_cache_add_bulk(struct fc_flowu_cache *fc,
                               const struct fc_flowu_key *keys,
                               unsigned nb_keys, uint64_t now,
@@ -217,6 +294,19 @@ int fc_flowu_cache_walk(struct fc_flowu_cache *fc,
                          int (*cb)(uint32_t entry_idx, void *arg),
                          void *arg);
 
+/* pool compaction (see fc_flow4_cache_compact_step) */
+int fc_flowu_cache_compact_step(struct fc_flowu_cache *fc,
+                                 unsigned budget, unsigned flags,
+                                 void (*moved)(uint32_t from_idx,
+                                               uint32_t to_idx, void *arg),
+                                 void *arg);
+
+/* hot-entry promotion (see fc_flow4_cache_promote) */
+unsigned fc_flowu_cache_promote(struct fc_flowu_cache *fc,
+                                 unsigned start_bk,
+                                 unsigned bucket_count,
+                                 unsigned min_hits);
+
 #endif /* _FLOWU_CACHE_H_ */
 
 /*
@@ -17,9 +17,15 @@
  *   static inline union rix_hash_hash_u
  *   fc_flow4_hash_fn(const struct fc_flow4_key *key,
  *                     uint32_t mask) { ... }
+ *   static inline void
+ *   fc_flow4_hash_n_fn(const void * const *keys, unsigned n,
+ *                      uint32_t mask, union rix_hash_hash_u *out) { ... }
  *
  *   FC_CACHE_GENERATE(flow4, FC_FLOW4_DEFAULT_PRESSURE_EMPTY_SLOTS,
- *                      fc_flow4_hash_fn, fc_flow4_cmp)
+ *                      fc_flow4_hash_fn, fc_flow4_hash_n_fn, fc_flow4_cmp)
+ *
+ * hash_n_fn is the batch form of hash_fn (out[i] == hash_fn(keys[i]));
+ * the bulk pipelines hash one step of keys with it.
  */
 
 #ifndef _FC_CACHE_GENERATE_H_
@@ -49,18 +55,7 @@
 #define _FCG_CACHE_T(p)     struct _FCG_CAT(fc_, _FCG_CAT(p, _cache))
 #define _FCG_CONFIG_T(p)    struct _FCG_CAT(fc_, _FCG_CAT(p, _config))
 #define _FCG_STATS_T(p)     struct _FCG_CAT(fc_, _FCG_CAT(p, _stats))
-
-/*===========================================================================
- * AVX2 direct-bind (file scope, applied to all GENERATE expansions)
- *===========================================================================*/
-#if defined(__AVX2__)
-#undef _RIX_HASH_FIND_U32X16
-#undef _RIX_HASH_FIND_U32X16_2
-#define _RIX_HASH_FIND_U32X16(arr, val) \
-    _rix_hash_find_u32x16_AVX2((arr), (val))
-#define _RIX_HASH_FIND_U32X16_2(arr, val0, val1, mask0, mask1) \
-    _rix_hash_find_u32x16_2_AVX2((arr), (val0), (val1), (mask0), (mask1))
-#endif
+#define _FCG_LOOKUP_T(p)    struct _FCG_CAT(fc_, _FCG_CAT(p, _lookup))
 
 /*===========================================================================
  * Pipeline geometry defaults
@@ -77,6 +72,18 @@
     (FLOW_CACHE_LOOKUP_STEP_KEYS * FLOW_CACHE_LOOKUP_AHEAD_STEPS)
 #endif
 
+/* Free entries prefetched ahead of allocation (free_idx mode) */
+#ifndef FLOW_CACHE_FREE_AHEAD
+#define FLOW_CACHE_FREE_AHEAD FLOW_CACHE_LOOKUP_STEP_KEYS
+#endif
+
+/* findadd_bulk duplicate-key coalescing (0 = off).  The window of recent */
+/* distinct keys is one find_u32x16 compare wide. */
+#ifndef FLOW_CACHE_COALESCE
+#define FLOW_CACHE_COALESCE 1
+#endif
+#define _FC_COALESCE_FLOWS 16u
+
 #ifndef _FC_RELIEF_STAGE_SLOTS
 #define _FC_RELIEF_STAGE_SLOTS 4u
 #endif
@@ -87,6 +94,11 @@
 #define _FC_MAINT_STEP_MAX_BKS 256u
 #endif
 
+/* compact_step pass phases (fc->compact_phase). */
+#define _FC_COMPACT_IDLE   0u
+#define _FC_COMPACT_DENSE  1u
+#define _FC_COMPACT_ORDER  2u
+
 /*===========================================================================
  * Sub-macro 1: Hash-table GENERATE
  *===========================================================================*/
@@ -198,22 +210,135 @@ _FCG_INT(p, relief_empty_slots)(const _FCG_CACHE_T(p) *fc)              \
     return empty_slots;                                                    \
 }                                                                          \
                                                                            \
+/* ----- free entries -------------------------------------------------- */\
+/* Default: LIFO list linked through entry->free_link.  With             */\
+/* cfg->free_idx: a dense deque of free indices, top at                  */\
+/* free_idx[(free_lo + free_nb - 1) % max_entries].  A pop then reads    */\
+/* no entry, so the entries to be handed out next can be prefetched,     */\
+/* and compaction can park entries at the bottom.                        */\
+static inline unsigned                                                     \
+_FCG_INT(p, free_slot)(const _FCG_CACHE_T(p) *fc, unsigned pos)            \
+{                                                                          \
+    pos += fc->free_lo;                                                    \
+    return (pos >= fc->max_entries) ? pos - fc->max_entries : pos;         \
+}                                                                          \
+                                                                           \
+static inline void                                                         \
+_FCG_INT(p, free_clear)(_FCG_CACHE_T(p) *fc)                               \
+{                                                                          \
+    RIX_SLIST_INIT(&fc->free_head);                                        \
+    fc->free_lo = 0u;                                                      \
+    fc->free_nb = 0u;                                                      \
+}                                                                          \
+                                                                           \
 static inline _FCG_ENTRY_T(p) *                                          \
 _FCG_INT(p, alloc_entry)(_FCG_CACHE_T(p) *fc)                           \
 {                                                                          \
-    _FCG_ENTRY_T(p) *entry =                                             \
-        RIX_SLIST_FIRST(&fc->free_head, fc->pool);                        \
+    _FCG_ENTRY_T(p) *entry;                                                \
+    if (fc->free_idx != NULL) {                                            \
+        if (RIX_UNLIKELY(fc->free_nb == 0u))                               \
+            return NULL;                                                   \
+        fc->free_nb--;                                                     \
+        return &fc->pool[fc->free_idx[_FCG_INT(p, free_slot)(              \
+            fc, fc->free_nb)] - 1u];                                       \
+    }                                                                      \
+    entry = RIX_SLIST_FIRST(&fc->free_head, fc->pool);                     \
     if (RIX_LIKELY(entry != NULL))                                         \
         RIX_SLIST_REMOVE_HEAD(&fc->free_head, fc->pool, free_link);       \
     return entry;                                                          \
 }                                                                          \
                                                                            \
+/* Pop up to n entries, in the order alloc_entry would return them.      */\
+static inline unsigned                                                     \
+_FCG_INT(p, alloc_bulk)(_FCG_CACHE_T(p) *fc, _FCG_ENTRY_T(p) **entries,    \
+                        unsigned n)                                        \
+{                                                                          \
+    unsigned k;                                                            \
+    if (fc->free_idx != NULL) {                                            \
+        if (n > fc->free_nb)                                               \
+            n = fc->free_nb;                                               \
+        for (k = 0; k < n; k++)                                            \
+            entries[k] = &fc->pool[fc->free_idx[_FCG_INT(p, free_slot)(    \
+                fc, fc->free_nb - 1u - k)] - 1u];                          \
+        fc->free_nb -= n;                                                  \
+        return n;                                                          \
+    }                                                                      \
+    for (k = 0; k < n; k++) {                                              \
+        entries[k] = _FCG_INT(p, alloc_entry)(fc);                         \
+        if (entries[k] == NULL)                                            \
+            break;                                                         \
+    }                                                                      \
+    return k;                                                              \
+}                                                                          \
+                                                                           \
+/* Push on top without touching the entry's fields.                      */\
+static inline void                                                         \
+_FCG_INT(p, free_push)(_FCG_CACHE_T(p) *fc, _FCG_ENTRY_T(p) *entry)        \
+{                                                                          \
+    if (fc->free_idx != NULL) {                                            \
+        fc->free_idx[_FCG_INT(p, free_slot)(fc, fc->free_nb)] =            \
+            RIX_IDX_FROM_PTR(fc->pool, entry);                             \
+        fc->free_nb++;                                                     \
+        return;                                                            \
+    }                                                                      \
+    RIX_SLIST_INSERT_HEAD(&fc->free_head, fc->pool, entry, free_link);     \
+}                                                                          \
+                                                                           \
 static inline void                                                         \
 _FCG_INT(p, free_entry)(_FCG_CACHE_T(p) *fc,                            \
                          _FCG_ENTRY_T(p) *entry)                          \
 {                                                                          \
     entry->last_ts = 0u;                                                   \
-    RIX_SLIST_INSERT_HEAD(&fc->free_head, fc->pool, entry, free_link);    \
+    entry->bk1_hits = 0u;                                                  \
+    _FCG_INT(p, free_push)(fc, entry);                                     \
+}                                                                          \
+                                                                           \
+/* Prefetch the entry alloc_entry returns after k more pops.  The        */\
+/* linked list only knows its head, so k is ignored there.               */\
+static inline void                                                         \
+_FCG_INT(p, free_prefetch)(const _FCG_CACHE_T(p) *fc, unsigned k)          \
+{                                                                          \
+    _FCG_ENTRY_T(p) *entry;                                                \
+    if (fc->free_idx != NULL) {                                            \
+        if (k >= fc->free_nb)                                              \
+            return;                                                        \
+        entry = &fc->pool[fc->free_idx[_FCG_INT(p, free_slot)(             \
+            fc, fc->free_nb - 1u - k)] - 1u];                              \
+    } else {                                                               \
+        entry = RIX_SLIST_FIRST(&fc->free_head, fc->pool);                 \
+        if (entry == NULL)                                                 \
+            return;                                                        \
+    }                                                                      \
+    rix_hash_prefetch_entry(entry);                                        \
+}                                                                          \
+                                                                           \
+/* Prefetch the next FLOW_CACHE_FREE_AHEAD entries to be handed out.     */\
+static inline void                                                         \
+_FCG_INT(p, free_prefetch_ahead)(const _FCG_CACHE_T(p) *fc)                \
+{                                                                          \
+    unsigned n = (fc->free_idx != NULL) ? FLOW_CACHE_FREE_AHEAD : 1u;      \
+    for (unsigned k = 0; k < n; k++)                                       \
+        _FCG_INT(p, free_prefetch)(fc, k);                                 \
+}                                                                          \
+                                                                           \
+/* Give back reserved entry resv[idx] after a failed insert.  The list   */\
+/* would hand it to the next key, so do the same: it takes slot idx+1    */\
+/* and the last reservation returns to the top of the array.             */\
+static inline void                                                         \
+_FCG_INT(p, unreserve)(_FCG_CACHE_T(p) *fc, _FCG_ENTRY_T(p) **resv,        \
+                       unsigned nb_resv, unsigned idx,                     \
+                       _FCG_ENTRY_T(p) *entry)                             \
+{                                                                          \
+    if (idx + 1u >= nb_resv) {                                             \
+        _FCG_INT(p, free_entry)(fc, entry);                                \
+        return;                                                            \
+    }                                                                      \
+    entry->last_ts = 0u;                                                   \
+    entry->bk1_hits = 0u;                                                  \
+    _FCG_INT(p, free_push)(fc, resv[nb_resv - 1u]);                        \
+    for (unsigned k = nb_resv - 1u; k > idx + 1u; k--)                     \
+        resv[k] = resv[k - 1u];                                            \
+    resv[idx + 1u] = entry;                                                \
 }                                                                          \
                                                                            \
 static unsigned                                                            \
@@ -329,6 +454,53 @@ _FCG_INT(p, reclaim_bucket_all)(_FCG_CACHE_T(p) *fc,                    \
     return evicted;                                                        \
 }                                                                          \
                                                                            \
+static inline unsigned                                                     \
+_FCG_INT(p, hit_bk1)(_FCG_CACHE_T(p) *fc,                                  \
+                     _FCG_ENTRY_T(p) *entry,                               \
+                     const struct rix_hash_find_ctx_s *ctx,                \
+                     uint64_t now)                                         \
+{                                                                          \
+    /* entry line is hot from cmp_key; cur_hash names its bucket */        \
+    if (RIX_LIKELY(fc->buckets + (entry->cur_hash & fc->ht_head.rhh_mask)  \
+                   == ctx->bk[0]))                                         \
+        return 0u;                                                         \
+    if (now && entry->bk1_hits != UINT16_MAX)                              \
+        entry->bk1_hits++;                                                 \
+    return 1u;                                                             \
+}                                                                          \
+                                                                           \
+static unsigned                                                            \
+_FCG_INT(p, promote_bucket)(_FCG_CACHE_T(p) *fc,                           \
+                            unsigned bk_idx,                               \
+                            unsigned min_hits)                             \
+{                                                                          \
+    struct rix_hash_bucket_s *bk = &fc->buckets[bk_idx];                   \
+    unsigned moved = 0u;                                                   \
+    for (unsigned s = 0; s < RIX_HASH_BUCKET_ENTRY_SZ; s++) {              \
+        _FCG_ENTRY_T(p) *entry;                                            \
+        int rc;                                                            \
+        if (bk->idx[s] == (u32)RIX_NIL)                                    \
+            continue;                                                      \
+        entry = _FCG_HT(p, hptr)(fc->pool, bk->idx[s]);                    \
+        RIX_ASSERT(entry != NULL);                                         \
+        if (entry->bk1_hits < min_hits)                                    \
+            continue;                                                      \
+        rc = fc->hashed ?                                                  \
+            _FCG_HT(p, promote_hashed)(&fc->ht_head, fc->buckets,          \
+                                       fc->pool, entry) :                  \
+            _FCG_HT(p, promote)(&fc->ht_head, fc->buckets,                 \
+                                fc->pool, entry);                          \
+        if (rc > 0) {                                                      \
+            fc->stats.promotions++;                                        \
+            moved++;                                                       \
+        } else if (rc < 0) {                                               \
+            fc->stats.promote_fails++;                                     \
+        }                                                                  \
+        entry->bk1_hits = 0u;                                              \
+    }                                                                      \
+    return moved;                                                          \
+}                                                                          \
+                                                                           \
 static unsigned                                                            \
 _FCG_INT(p, maintain_grouped)(_FCG_CACHE_T(p) *fc,                   \
                                   unsigned start_bk,                       \
@@ -354,6 +526,8 @@ _FCG_INT(p, maintain_grouped)(_FCG_CACHE_T(p) *fc,                   \
         fc->stats.maint_bucket_checks++;                                   \
         reclaimed = _FCG_INT(p, reclaim_bucket_all)(fc, cur_bk,           \
                                                      expire_before);       \
+        if (fc->promote_hits != 0u)                                        \
+            _FCG_INT(p, promote_bucket)(fc, cur_bk, fc->promote_hits);     \
         fc->stats.maint_evictions += reclaimed;                            \
         evicted += reclaimed;                                              \
     }                                                                      \
@@ -405,6 +579,8 @@ _FCG_INT(p, maintain_step_filter_reclaim)(                                 \
             rix_hash_prefetch_bucket(&fc->buckets[work[i + PF_AHEAD]]);   \
         reclaimed = _FCG_INT(p, reclaim_bucket_all)(fc, work[i],           \
                                                      expire_before);       \
+        if (fc->promote_hits != 0u)                                        \
+            _FCG_INT(p, promote_bucket)(fc, work[i], fc->promote_hits);    \
         fc->stats.maint_evictions += reclaimed;                            \
         evicted += reclaimed;                                              \
     }                                                                      \
@@ -484,6 +660,152 @@ _FCG_INT(p, insert_relief_hashed)(_FCG_CACHE_T(p) *fc,                  \
             fc->stats.relief_bk1_evictions++;                              \
         }                                                                  \
     }                                                                      \
+}                                                                          \
+                                                                           \
+/* ----- compact: begin a pass (one sweep: free list in index order) -- */ \
+static void                                                                \
+_FCG_INT(p, compact_begin)(_FCG_CACHE_T(p) *fc, unsigned flags)            \
+{                                                                          \
+    _FCG_INT(p, free_clear)(fc);                                           \
+    fc->compact_anchor = 0u;                                               \
+    for (unsigned i = fc->max_entries; i-- > 0u;) {                        \
+        if (fc->pool[i].last_ts != 0u)                                     \
+            continue;                                                      \
+        if (fc->compact_anchor == 0u)                                      \
+            fc->compact_anchor = i + 1u;                                   \
+        _FCG_INT(p, free_push)(fc, &fc->pool[i]);                          \
+    }                                                                      \
+    fc->compact_flags = flags;                                             \
+    fc->compact_hi = fc->max_entries;                                      \
+    fc->compact_bk = 0u;                                                   \
+    fc->compact_pos = 0u;                                                  \
+    fc->compact_phase = _FC_COMPACT_DENSE;                                 \
+    fc->stats.compact_passes++;                                            \
+}                                                                          \
+                                                                           \
+/* Park a free entry behind the anchor, past every hole still to fill. */  \
+static inline void                                                         \
+_FCG_INT(p, compact_park)(_FCG_CACHE_T(p) *fc, _FCG_ENTRY_T(p) *entry)     \
+{                                                                          \
+    _FCG_ENTRY_T(p) *anchor =                                              \
+        RIX_PTR_FROM_IDX(fc->pool, fc->compact_anchor);                    \
+    if (anchor != NULL && anchor->last_ts == 0u && anchor != entry) {      \
+        if (fc->free_idx != NULL) {                                        \
+            /* below the anchor sit only parked entries: the bottom */     \
+            fc->free_lo = (fc->free_lo != 0u ? fc->free_lo :               \
+                           fc->max_entries) - 1u;                          \
+            fc->free_idx[fc->free_lo] = RIX_IDX_FROM_PTR(fc->pool, entry); \
+            fc->free_nb++;                                                 \
+        } else {                                                           \
+            RIX_SLIST_INSERT_AFTER(fc->pool, anchor, entry, free_link);    \
+        }                                                                  \
+    } else {                                                               \
+        fc->compact_anchor = RIX_IDX_FROM_PTR(fc->pool, entry);            \
+        _FCG_INT(p, free_push)(fc, entry);                                 \
+    }                                                                      \
+}                                                                          \
+                                                                           \
+/* ----- compact: dense phase ------------------------------------------ */\
+/* Fill the lowest hole (free-list head) from the highest live entry.    */\
+/* Returns 1 while live entries remain above the dense prefix.           */\
+static int                                                                 \
+_FCG_INT(p, compact_dense)(_FCG_CACHE_T(p) *fc, unsigned budget,           \
+                           unsigned *work,                                 \
+                           void (*moved)(uint32_t, uint32_t, void *),      \
+                           void *arg)                                      \
+{                                                                          \
+    while (*work < budget) {                                               \
+        _FCG_ENTRY_T(p) *hole;                                             \
+        _FCG_ENTRY_T(p) *src;                                              \
+        uint32_t hole_idx;                                                 \
+        while (fc->compact_hi > 0u &&                                      \
+               fc->pool[fc->compact_hi - 1u].last_ts == 0u) {              \
+            fc->compact_hi--;                                              \
+            (*work)++;                                                     \
+        }                                                                  \
+        if (fc->compact_hi <= fc->ht_head.rhh_nb)                          \
+            return 0; /* [1, rhh_nb] all live */                           \
+        hole = _FCG_INT(p, alloc_entry)(fc);                               \
+        if (hole == NULL)                                                  \
+            return 0;                                                      \
+        hole_idx = RIX_IDX_FROM_PTR(fc->pool, hole);                       \
+        (*work)++;                                                         \
+        if (hole_idx > fc->compact_hi) {                                   \
+            /* freed above the source since the pass began */              \
+            if (hole_idx == fc->compact_anchor) {                          \
+                _FCG_INT(p, free_push)(fc, hole);                          \
+                return 0;                                                  \
+            }                                                              \
+            _FCG_INT(p, compact_park)(fc, hole);                           \
+            continue;                                                      \
+        }                                                                  \
+        src = &fc->pool[fc->compact_hi - 1u];                              \
+        if (RIX_UNLIKELY(_FCG_HT(p, relocate)(&fc->ht_head, fc->buckets,   \
+                                               fc->pool, src,              \
+                                               hole) == NULL)) {           \
+            /* live by last_ts but not in the table: leave it */           \
+            _FCG_INT(p, free_push)(fc, hole);                              \
+            fc->compact_hi--;                                              \
+            continue;                                                      \
+        }                                                                  \
+        src->last_ts = 0u;                                                 \
+        _FCG_INT(p, compact_park)(fc, src);                                \
+        fc->compact_hi--;                                                  \
+        fc->stats.compact_moves++;                                         \
+        if (moved != NULL)                                                 \
+            moved(fc->compact_hi + 1u, hole_idx, arg);                     \
+    }                                                                      \
+    return 1;                                                              \
+}                                                                          \
+                                                                           \
+/* ----- compact: bucket-order phase ----------------------------------- */\
+/* Renumber live entries in bucket-walk order by swapping each one into  */\
+/* the next target position.  Holes left by churn are stepped over.      */\
+/* Returns 1 while buckets remain.                                       */\
+static int                                                                 \
+_FCG_INT(p, compact_order)(_FCG_CACHE_T(p) *fc, unsigned budget,           \
+                           unsigned *work,                                 \
+                           void (*moved)(uint32_t, uint32_t, void *),      \
+                           void *arg)                                      \
+{                                                                          \
+    while (*work < budget) {                                               \
+        struct rix_hash_bucket_s *bk;                                      \
+        if (fc->compact_bk >= fc->nb_bk)                                   \
+            return 0;                                                      \
+        bk = fc->buckets + fc->compact_bk;                                 \
+        if (fc->compact_bk + 1u < fc->nb_bk)                               \
+            rix_hash_prefetch_bucket(bk + 1);                              \
+        for (unsigned s = 0; s < RIX_HASH_BUCKET_ENTRY_SZ; s++) {          \
+            uint32_t idx = bk->idx[s];                                     \
+            uint32_t pos;                                                  \
+            if (idx == (uint32_t)RIX_NIL)                                  \
+                continue;                                                  \
+            while (fc->compact_pos + 1u < idx &&                           \
+                   fc->pool[fc->compact_pos].last_ts == 0u) {              \
+                fc->compact_pos++;                                         \
+                (*work)++;                                                 \
+            }                                                              \
+            pos = fc->compact_pos + 1u;                                    \
+            if (idx < pos)                                                 \
+                continue; /* moved here from a placed bucket */            \
+            fc->compact_pos++;                                             \
+            if (idx == pos)                                                \
+                continue;                                                  \
+            if (_FCG_HT(p, swap)(&fc->ht_head, fc->buckets, fc->pool,      \
+                                  &fc->pool[pos - 1u],                     \
+                                  &fc->pool[idx - 1u]) != 0) {             \
+                fc->compact_pos--;                                         \
+                continue;                                                  \
+            }                                                              \
+            (*work)++;                                                     \
+            fc->stats.compact_moves++;                                     \
+            if (moved != NULL)                                             \
+                moved(idx, pos, arg);                                      \
+        }                                                                  \
+        fc->compact_bk++;                                                  \
+        (*work)++;                                                         \
+    }                                                                      \
+    return 1;                                                              \
 }
 
 /*===========================================================================
@@ -507,6 +829,25 @@ static void _FCG_API(p, find_bulk)(_FCG_CACHE_T(p) *,                    \
 static void _FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *,                 \
     const _FCG_KEY_T(p) *, unsigned, uint64_t,                             \
     _FCG_RESULT_T(p) *);                                                  \
+static void _FCG_API(p, find_bulk_hashed)(_FCG_CACHE_T(p) *,               \
+    const _FCG_KEY_T(p) *, const uint32_t *, unsigned, uint64_t,           \
+    _FCG_RESULT_T(p) *);                                                   \
+static void _FCG_API(p, findadd_bulk_hashed)(_FCG_CACHE_T(p) *,            \
+    const _FCG_KEY_T(p) *, const uint32_t *, unsigned, uint64_t,           \
+    _FCG_RESULT_T(p) *);                                                   \
+static void _FCG_API(p, find_by_hint_bulk)(_FCG_CACHE_T(p) *,              \
+    const _FCG_KEY_T(p) *, const uint32_t *, unsigned, uint64_t,           \
+    _FCG_RESULT_T(p) *);                                                   \
+static void _FCG_API(p, find_by_hint_bulk_hashed)(_FCG_CACHE_T(p) *,       \
+    const _FCG_KEY_T(p) *, const uint32_t *, const uint32_t *, unsigned,   \
+    uint64_t, _FCG_RESULT_T(p) *);                                         \
+static _FCG_LOOKUP_T(p) *_FCG_API(p, lookup_issue)(_FCG_CACHE_T(p) *,     \
+    _FCG_LOOKUP_T(p) *, const _FCG_KEY_T(p) *, unsigned, unsigned);         \
+static _FCG_LOOKUP_T(p) *_FCG_API(p, lookup_issue_hashed)(                 \
+    _FCG_CACHE_T(p) *, _FCG_LOOKUP_T(p) *, const _FCG_KEY_T(p) *,          \
+    const uint32_t *, unsigned, unsigned);                                 \
+static void _FCG_API(p, lookup_complete)(_FCG_CACHE_T(p) *,                \
+    _FCG_LOOKUP_T(p) *, uint64_t, _FCG_RESULT_T(p) *);                      \
 static void _FCG_API(p, add_bulk)(_FCG_CACHE_T(p) *,                     \
     const _FCG_KEY_T(p) *, unsigned, uint64_t,                             \
     _FCG_RESULT_T(p) *);                                                  \
@@ -523,7 +864,11 @@ static unsigned _FCG_API(p, maintain_step)(_FCG_CACHE_T(p) *,             \
 static int _FCG_API(p, remove_idx)(_FCG_CACHE_T(p) *, uint32_t);         \
 static void _FCG_API(p, stats)(const _FCG_CACHE_T(p) *, _FCG_STATS_T(p) *); \
 static int _FCG_API(p, walk)(_FCG_CACHE_T(p) *,                          \
-    int (*)(uint32_t, void *), void *);
+    int (*)(uint32_t, void *), void *);                                    \
+static int _FCG_API(p, compact_step)(_FCG_CACHE_T(p) *, unsigned,          \
+    unsigned, void (*)(uint32_t, uint32_t, void *), void *);               \
+static unsigned _FCG_API(p, promote)(_FCG_CACHE_T(p) *,                    \
+    unsigned, unsigned, unsigned);
 #else
 #define _FC_GENERATE_API_DECLS(p) /* prototypes in variant header */
 #endif
@@ -531,7 +876,7 @@ static int _FCG_API(p, walk)(_FCG_CACHE_T(p) *,                          \
 /*===========================================================================
  * Sub-macro 3: Public API functions
  *===========================================================================*/
-#define _FC_GENERATE_API(p, pressure, hash_fn)                             \
+#define _FC_GENERATE_API(p, pressure, hash_fn, hash_n_fn, cmp_fn)          \
 _FC_GENERATE_API_DECLS(p)                                                  \
                                                                            \
 static void                                                                \
@@ -563,26 +908,28 @@ _FCG_API(p, init)(_FCG_CACHE_T(p) *fc,                                  \
     fc->maint_interval_tsc = cfg->maint_interval_tsc;                      \
     fc->maint_base_bk = cfg->maint_base_bk ? cfg->maint_base_bk : nb_bk;  \
     fc->maint_fill_threshold = cfg->maint_fill_threshold;                  \
+    fc->promote_hits = cfg->promote_hits;                                  \
     fc->last_maint_tsc = 0u;                                               \
     fc->last_maint_fills = 0u;                                             \
     _FCG_INT(p, init_thresholds)(fc);                                     \
-    RIX_SLIST_INIT(&fc->free_head);                                        \
+    fc->free_idx = cfg->free_idx;                                          \
+    _FCG_INT(p, free_clear)(fc);                                           \
     _FCG_HT(p, init)(&fc->ht_head, nb_bk);                               \
     for (unsigned i = 0; i < max_entries; i++)                              \
-        RIX_SLIST_INSERT_HEAD(&fc->free_head, fc->pool,                    \
-                              &fc->pool[i], free_link);                    \
+        _FCG_INT(p, free_push)(fc, &fc->pool[i]);                          \
 }                                                                          \
                                                                            \
 static void                                                                \
 _FCG_API(p, flush)(_FCG_CACHE_T(p) *fc)                                 \
 {                                                                          \
     memset(fc->buckets, 0, (size_t)fc->nb_bk * sizeof(*fc->buckets));      \
-    RIX_SLIST_INIT(&fc->free_head);                                        \
+    _FCG_INT(p, free_clear)(fc);                                           \
+    fc->compact_phase = _FC_COMPACT_IDLE;                                  \
+    fc->hashed = 0u;                                                       \
     _FCG_HT(p, init)(&fc->ht_head, fc->nb_bk);                           \
     for (unsigned i = 0; i < fc->max_entries; i++) {                        \
         fc->pool[i].last_ts = 0u;                                         \
-        RIX_SLIST_INSERT_HEAD(&fc->free_head, fc->pool,                    \
-                              &fc->pool[i], free_link);                    \
+        _FCG_INT(p, free_push)(fc, &fc->pool[i]);                          \
     }                                                                      \
 }                                                                          \
                                                                            \
@@ -592,16 +939,67 @@ _FCG_API(p, nb_entries)(const _FCG_CACHE_T(p) *fc)                      \
     return fc->ht_head.rhh_nb;                                             \
 }                                                                          \
                                                                            \
+/* ----- stage 1: hash the key, or expand a caller-supplied hash ------- */\
+static RIX_FORCE_INLINE void                                               \
+_FCG_INT(p, hash_key)(_FCG_CACHE_T(p) *fc, struct rix_hash_find_ctx_s *ctx,\
+                      const _FCG_KEY_T(p) *key, const uint32_t *hashes,    \
+                      unsigned idx)                                        \
+{                                                                          \
+    if (hashes != NULL)                                                    \
+        _FCG_HT(p, hash_key_2bk_hashed)(ctx, &fc->ht_head, fc->buckets,    \
+            key, rix_hash_hash_from_u32(hashes[idx],                       \
+                                        fc->ht_head.rhh_mask));            \
+    else                                                                   \
+        _FCG_HT(p, hash_key_2bk)(ctx, &fc->ht_head, fc->buckets, key);     \
+}                                                                          \
+                                                                           \
+/* Stage 1 for keys[base .. base + n): hash_n_fn runs the hash chains   */ \
+/* of a step of keys interleaved instead of one key after another.    */   \
+/* pos != NULL: ctx[i] is for keys[pos[i]] (and hashes[pos[i]]).        */ \
+static RIX_FORCE_INLINE void                                               \
+_FCG_INT(p, hash_keys)(_FCG_CACHE_T(p) *fc, struct rix_hash_find_ctx_s *ctx,\
+                       const _FCG_KEY_T(p) *keys, const uint32_t *hashes,  \
+                       const uint32_t *pos, unsigned base, unsigned n)     \
+{                                                                          \
+    const void *kp[FLOW_CACHE_LOOKUP_STEP_KEYS];                           \
+    union rix_hash_hash_u h[FLOW_CACHE_LOOKUP_STEP_KEYS];                  \
+    if (hashes != NULL) {                                                  \
+        for (unsigned j = 0; j < n; j++) {                                 \
+            unsigned k = pos ? pos[base + j] : base + j;                   \
+            _FCG_INT(p, hash_key)(fc, &ctx[base + j], &keys[k],            \
+                                  hashes, k);                              \
+        }                                                                  \
+        return;                                                            \
+    }                                                                      \
+    for (unsigned b = 0; b < n; b += FLOW_CACHE_LOOKUP_STEP_KEYS) {        \
+        unsigned nl = (n - b < FLOW_CACHE_LOOKUP_STEP_KEYS) ?              \
+            (n - b) : FLOW_CACHE_LOOKUP_STEP_KEYS;                         \
+        for (unsigned j = 0; j < nl; j++)                                  \
+            kp[j] = &keys[pos ? pos[base + b + j] : base + b + j];         \
+        hash_n_fn(kp, nl, fc->ht_head.rhh_mask, h);                        \
+        for (unsigned j = 0; j < nl; j++)                                  \
+            _FCG_HT(p, hash_key_2bk_hashed)(&ctx[base + b + j],            \
+                &fc->ht_head, fc->buckets,                                 \
+                &keys[pos ? pos[base + b + j] : base + b + j], h[j]);      \
+    }                                                                      \
+}                                                                          \
+                                                                           \
 /* ----- find_bulk: search only, no insert ----------------------------- */\
-static void                                                                \
-_FCG_API(p, find_bulk)(_FCG_CACHE_T(p) *fc,                              \
-                        const _FCG_KEY_T(p) *keys,                        \
-                        unsigned nb_keys,                                  \
-                        uint64_t now,                                      \
-                        _FCG_RESULT_T(p) *results)                        \
+/* hashes == NULL: hash the keys; else one caller hash per key.         */ \
+/* pos == NULL: all nb_keys keys; else only keys[pos[0 .. nb_keys)],    */ \
+/* with their results stored at results[pos[i]].                        */ \
+static RIX_FORCE_INLINE void                                               \
+_FCG_INT(p, find_bulk)(_FCG_CACHE_T(p) *fc,                                \
+                       const _FCG_KEY_T(p) *keys,                          \
+                       const uint32_t *hashes,                             \
+                       const uint32_t *pos,                                \
+                       unsigned nb_keys,                                   \
+                       uint64_t now,                                       \
+                       _FCG_RESULT_T(p) *results)                          \
 {                                                                          \
     struct rix_hash_find_ctx_s ctx[nb_keys];                               \
     uint64_t hit_count = 0u;                                               \
+    uint64_t bk1_count = 0u;                                               \
     uint64_t miss_count = 0u;                                              \
     const unsigned ahead_keys = FLOW_CACHE_LOOKUP_AHEAD_KEYS;              \
     const unsigned step_keys = FLOW_CACHE_LOOKUP_STEP_KEYS;                \
@@ -611,9 +1009,7 @@ _FCG_API(p, find_bulk)(_FCG_CACHE_T(p) *fc,                              \
         if (i < nb_keys) {                                                 \
             unsigned n = (i + step_keys <= nb_keys) ?                      \
                 step_keys : (nb_keys - i);                                 \
-            for (unsigned j = 0; j < n; j++)                               \
-                _FCG_HT(p, hash_key_2bk)(&ctx[i + j], &fc->ht_head,     \
-                                           fc->buckets, &keys[i + j]);    \
+            _FCG_INT(p, hash_keys)(fc, ctx, keys, hashes, pos, i, n);      \
         }                                                                  \
         /* Stage 2: scan_bk (no empty tracking needed) */                   \
         if (i >= ahead_keys && i - ahead_keys < nb_keys) {                \
@@ -641,17 +1037,20 @@ _FCG_API(p, find_bulk)(_FCG_CACHE_T(p) *fc,                              \
                 step_keys : (nb_keys - base);                              \
             for (unsigned j = 0; j < n; j++) {                             \
                 unsigned idx = base + j;                                   \
+                _FCG_RESULT_T(p) *res = &results[pos ? pos[idx] : idx];    \
                 _FCG_ENTRY_T(p) *entry;                                   \
                 entry = _FCG_HT(p, cmp_key)(&ctx[idx],                   \
                                               fc->pool);                   \
                 if (RIX_LIKELY(entry != NULL)) {                           \
                     if (now)                                                \
                         entry->last_ts = now;                              \
-                    _FCG_INT(p, result_set_hit)(&results[idx],            \
+                    bk1_count += _FCG_INT(p, hit_bk1)(fc, entry,           \
+                                                      &ctx[idx], now);     \
+                    _FCG_INT(p, result_set_hit)(res,                       \
                         RIX_IDX_FROM_PTR(fc->pool, entry));                \
                     hit_count++;                                           \
                 } else {                                                   \
-                    _FCG_INT(p, result_set_miss)(&results[idx]);          \
+                    _FCG_INT(p, result_set_miss)(res);                     \
                     miss_count++;                                          \
                 }                                                          \
             }                                                              \
@@ -659,39 +1058,160 @@ _FCG_API(p, find_bulk)(_FCG_CACHE_T(p) *fc,                              \
     }                                                                      \
     fc->stats.lookups += nb_keys;                                          \
     fc->stats.hits += hit_count;                                           \
+    fc->stats.hits_bk1 += bk1_count;                                       \
     fc->stats.misses += miss_count;                                        \
 }                                                                          \
                                                                            \
-/* ----- findadd_bulk: search + insert on miss ------------------------- */\
 static void                                                                \
-_FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                          \
-                           const _FCG_KEY_T(p) *keys,                     \
-                           unsigned nb_keys,                               \
-                           uint64_t now,                                   \
-                           _FCG_RESULT_T(p) *results)                     \
+_FCG_API(p, find_bulk)(_FCG_CACHE_T(p) *fc,                                \
+                       const _FCG_KEY_T(p) *keys,                          \
+                       unsigned nb_keys,                                   \
+                       uint64_t now,                                       \
+                       _FCG_RESULT_T(p) *results)                          \
+{                                                                          \
+    _FCG_INT(p, find_bulk)(fc, keys, NULL, NULL, nb_keys, now, results);   \
+}                                                                          \
+                                                                           \
+static void                                                                \
+_FCG_API(p, find_bulk_hashed)(_FCG_CACHE_T(p) *fc,                         \
+                              const _FCG_KEY_T(p) *keys,                   \
+                              const uint32_t *hashes,                      \
+                              unsigned nb_keys,                            \
+                              uint64_t now,                                \
+                              _FCG_RESULT_T(p) *results)                   \
+{                                                                          \
+    _FCG_INT(p, find_bulk)(fc, keys, hashes, NULL, nb_keys, now, results); \
+}                                                                          \
+                                                                           \
+/* ----- findadd_bulk: search + insert on miss ------------------------- */\
+/* Duplicate coalescing: win_hash/win_idx remember the batch's last      */\
+/* _FC_COALESCE_FLOWS distinct keys (win_live: valid lanes).  Returns    */\
+/* 1 + the index of an identical earlier key, or 0 after entering key    */\
+/* idx as a new flow.                                                    */\
+static inline unsigned                                                     \
+_FCG_INT(p, coalesce)(const _FCG_KEY_T(p) *keys, unsigned idx,             \
+                      uint32_t h, uint32_t *win_hash, uint32_t *win_idx,   \
+                      uint32_t *win_live, unsigned *win_pos)               \
+{                                                                          \
+    uint32_t m = rix_hash_arch->find_u32x16(win_hash, h) & *win_live;      \
+    while (m != 0u) {                                                      \
+        unsigned s = (unsigned)__builtin_ctz(m);                           \
+        if (cmp_fn(&keys[win_idx[s]], &keys[idx]) == 0)                    \
+            return win_idx[s] + 1u;                                        \
+        m &= m - 1u;                                                       \
+    }                                                                      \
+    win_hash[*win_pos] = h;                                                \
+    win_idx[*win_pos] = idx;                                               \
+    *win_live |= 1u << *win_pos;                                           \
+    *win_pos = (*win_pos + 1u) & (_FC_COALESCE_FLOWS - 1u);                \
+    return 0u;                                                             \
+}                                                                          \
+                                                                           \
+/* Miss in findadd: relief on a dense bk[0]/bk[1] (empties[] popcount,   */\
+/* no re-scan), then alloc and insert with the hash kept in ctx.         */\
+static inline void                                                         \
+_FCG_INT(p, findadd_miss)(_FCG_CACHE_T(p) *fc,                             \
+                          const struct rix_hash_find_ctx_s *ctx,           \
+                          const _FCG_KEY_T(p) *key, uint64_t now,          \
+                          _FCG_RESULT_T(p) *result)                        \
+{                                                                          \
+    _FCG_ENTRY_T(p) *entry;                                                \
+    _FCG_ENTRY_T(p) *_ret;                                                 \
+    if (fc->total_slots != 0u) {                                           \
+        unsigned _pe = _FCG_INT(p, relief_empty_slots)(fc);                \
+        unsigned _bk0i = (unsigned)(ctx->bk[0] - fc->buckets);             \
+        fc->stats.relief_calls++;                                          \
+        fc->stats.relief_bucket_checks++;                                  \
+        if ((unsigned)__builtin_popcount(ctx->empties[0]) <= _pe) {        \
+            _FCG_INT(p, update_eff_timeout)(fc);                           \
+            uint64_t _eb = (now > fc->eff_timeout_tsc) ?                   \
+                (now - fc->eff_timeout_tsc) : 0u;                          \
+            if (_FCG_INT(p, reclaim_bucket)(fc, _bk0i, _eb)) {             \
+                fc->stats.relief_evictions++;                              \
+                fc->stats.relief_bk0_evictions++;                          \
+            } else {                                                       \
+                unsigned _bk1i = (unsigned)(ctx->bk[1] - fc->buckets);     \
+                fc->stats.relief_bucket_checks++;                          \
+                if ((unsigned)__builtin_popcount(ctx->empties[1]) <= _pe &&\
+                    _bk1i != _bk0i &&                                      \
+                    _FCG_INT(p, reclaim_bucket)(fc, _bk1i, _eb)) {         \
+                    fc->stats.relief_evictions++;                          \
+                    fc->stats.relief_bk1_evictions++;                      \
+                }                                                          \
+            }                                                              \
+        }                                                                  \
+    }                                                                      \
+    /* Alloc from free list (head already prefetched) */                   \
+    entry = _FCG_INT(p, alloc_entry)(fc);                                  \
+    if (RIX_UNLIKELY(entry == NULL)) {                                     \
+        fc->stats.fill_full++;                                             \
+        _FCG_INT(p, result_set_miss)(result);                              \
+        return;                                                            \
+    }                                                                      \
+    entry->key = *key;                                                     \
+    entry->last_ts = now;                                                  \
+    /* insert_hashed: buckets in L1 from cmp_key, dup-safe */              \
+    _ret = _FCG_HT(p, insert_hashed)(&fc->ht_head, fc->buckets, fc->pool,  \
+                                     entry, ctx->hash);                    \
+    if (RIX_LIKELY(_ret == NULL)) {                                        \
+        fc->stats.fills++;                                                 \
+        _FCG_INT(p, result_set_filled)(result,                             \
+            RIX_IDX_FROM_PTR(fc->pool, entry));                            \
+    } else {                                                               \
+        _FCG_INT(p, free_entry)(fc, entry);                                \
+        if (_ret != entry) {                                               \
+            /* duplicate found */                                          \
+            _ret->last_ts = now;                                           \
+            _FCG_INT(p, result_set_filled)(result,                         \
+                RIX_IDX_FROM_PTR(fc->pool, _ret));                         \
+        } else {                                                           \
+            /* table full */                                               \
+            fc->stats.fill_full++;                                         \
+            _FCG_INT(p, result_set_miss)(result);                          \
+        }                                                                  \
+    }                                                                      \
+    /* Keep FLOW_CACHE_FREE_AHEAD free entries in flight */                \
+    _FCG_INT(p, free_prefetch)(fc, FLOW_CACHE_FREE_AHEAD - 1u);            \
+}                                                                          \
+                                                                           \
+static RIX_FORCE_INLINE void                                               \
+_FCG_INT(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                             \
+                          const _FCG_KEY_T(p) *keys,                       \
+                          const uint32_t *hashes,                          \
+                          unsigned nb_keys,                                \
+                          uint64_t now,                                    \
+                          _FCG_RESULT_T(p) *results)                       \
 {                                                                          \
     struct rix_hash_find_ctx_s ctx[nb_keys];                               \
+    uint32_t lead[nb_keys]; /* 1 + identical earlier key, 0 = none */      \
+    uint32_t win_hash[_FC_COALESCE_FLOWS] = { 0u };                        \
+    uint32_t win_idx[_FC_COALESCE_FLOWS];                                  \
+    uint32_t win_live = 0u;                                                \
+    unsigned win_pos = 0u;                                                 \
     uint64_t hit_count = 0u;                                               \
+    uint64_t bk1_count = 0u;                                               \
     uint64_t miss_count = 0u;                                              \
+    uint64_t dup_count = 0u;                                               \
     const unsigned ahead_keys = FLOW_CACHE_LOOKUP_AHEAD_KEYS;              \
     const unsigned step_keys = FLOW_CACHE_LOOKUP_STEP_KEYS;                \
     const unsigned total = nb_keys + 3u * ahead_keys;                      \
-    /* Prefetch free list head so first miss insert is warm */              \
-    {                                                                      \
-        _FCG_ENTRY_T(p) *_fh =                                           \
-            RIX_SLIST_FIRST(&fc->free_head, fc->pool);                    \
-        if (_fh != NULL)                                                   \
-            rix_hash_prefetch_entry(_fh);                                 \
-    }                                                                      \
+    /* Prefetch the next free entries so the first miss inserts are warm */\
+    _FCG_INT(p, free_prefetch_ahead)(fc);                                  \
     /* 4-stage N-ahead pipeline: lookup + inline insert on miss */         \
     for (unsigned i = 0; i < total; i += step_keys) {                      \
         /* Stage 1: hash_key_2bk (prefetch both bk[0] and bk[1]) */       \
         if (i < nb_keys) {                                                 \
             unsigned n = (i + step_keys <= nb_keys) ?                      \
                 step_keys : (nb_keys - i);                                 \
-            for (unsigned j = 0; j < n; j++)                               \
-                _FCG_HT(p, hash_key_2bk)(&ctx[i + j], &fc->ht_head,     \
-                                           fc->buckets, &keys[i + j]);    \
+            _FCG_INT(p, hash_keys)(fc, ctx, keys, hashes, NULL, i, n);     \
+            for (unsigned j = 0; j < n; j++) {                             \
+                unsigned idx = i + j;                                      \
+                lead[idx] = FLOW_CACHE_COALESCE ?                          \
+                    _FCG_INT(p, coalesce)(keys, idx,                       \
+                                          ctx[idx].hash.val32[0],          \
+                                          win_hash, win_idx,               \
+                                          &win_live, &win_pos) : 0u;       \
+            }                                                              \
         }                                                                  \
         /* Stage 2: scan_bk_empties (bk[0] fp + empty scan) */            \
         if (i >= ahead_keys && i - ahead_keys < nb_keys) {                \
@@ -699,8 +1219,10 @@ _FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                          \
             unsigned n = (base + step_keys <= nb_keys) ?                   \
                 step_keys : (nb_keys - base);                              \
             for (unsigned j = 0; j < n; j++)                               \
-                _FCG_HT(p, scan_bk_empties)(&ctx[base + j],              \
-                                              &fc->ht_head, fc->buckets); \
+                if (lead[base + j] == 0u)                                  \
+                    _FCG_HT(p, scan_bk_empties)(&ctx[base + j],            \
+                                                  &fc->ht_head,            \
+                                                  fc->buckets);            \
         }                                                                  \
         /* Stage 3: prefetch_node */                                       \
         if (i >= 2u * ahead_keys &&                                        \
@@ -709,7 +1231,8 @@ _FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                          \
             unsigned n = (base + step_keys <= nb_keys) ?                   \
                 step_keys : (nb_keys - base);                              \
             for (unsigned j = 0; j < n; j++)                               \
-                _FCG_HT(p, prefetch_node)(&ctx[base + j], fc->pool);     \
+                if (lead[base + j] == 0u)                                  \
+                    _FCG_HT(p, prefetch_node)(&ctx[base + j], fc->pool);   \
         }                                                                  \
         /* Stage 4: cmp_key_empties + inline insert on miss */             \
         if (i >= 3u * ahead_keys &&                                        \
@@ -720,11 +1243,23 @@ _FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                          \
             for (unsigned j = 0; j < n; j++) {                             \
                 unsigned idx = base + j;                                   \
                 _FCG_ENTRY_T(p) *entry;                                   \
+                if (lead[idx] != 0u) {                                     \
+                    /* --- DUP: the earlier key's result is final --- */   \
+                    results[idx] = results[lead[idx] - 1u];                \
+                    if (results[idx].entry_idx != 0u)                      \
+                        hit_count++;                                       \
+                    else                                                   \
+                        miss_count++;                                      \
+                    dup_count++;                                           \
+                    continue;                                              \
+                }                                                          \
                 entry = _FCG_HT(p, cmp_key_empties)(&ctx[idx],           \
                                                       fc->pool);          \
                 if (RIX_LIKELY(entry != NULL)) {                           \
                     /* --- HIT --- */                                      \
                     entry->last_ts = now;                                  \
+                    bk1_count += _FCG_INT(p, hit_bk1)(fc, entry,           \
+                                                      &ctx[idx], now);     \
                     _FCG_INT(p, result_set_hit)(&results[idx],            \
                         RIX_IDX_FROM_PTR(fc->pool, entry));                \
                     hit_count++;                                           \
@@ -732,87 +1267,267 @@ _FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                          \
                 }                                                          \
                 /* --- MISS: inline insert --- */                          \
                 miss_count++;                                              \
-                /* Relief: use empties[] popcount (no re-scan) */          \
-                if (fc->total_slots != 0u) {                               \
-                    unsigned _pe =                                         \
-                        _FCG_INT(p, relief_empty_slots)(fc);              \
-                    unsigned _bk0i =                                       \
-                        (unsigned)(ctx[idx].bk[0] - fc->buckets);          \
-                    fc->stats.relief_calls++;                              \
-                    fc->stats.relief_bucket_checks++;                      \
-                    if ((unsigned)__builtin_popcount(                       \
-                            ctx[idx].empties[0]) <= _pe) {            \
-                        _FCG_INT(p, update_eff_timeout)(fc);              \
-                        uint64_t _eb = (now > fc->eff_timeout_tsc) ?       \
-                            (now - fc->eff_timeout_tsc) : 0u;             \
-                        if (_FCG_INT(p, reclaim_bucket)(               \
-                                fc, _bk0i, _eb)) {                        \
-                            fc->stats.relief_evictions++;                  \
-                            fc->stats.relief_bk0_evictions++;              \
-                        } else {                                           \
-                            unsigned _bk1i = (unsigned)(                   \
-                                ctx[idx].bk[1] - fc->buckets);             \
-                            fc->stats.relief_bucket_checks++;              \
-                            if ((unsigned)__builtin_popcount(               \
-                                    ctx[idx].empties[1]) <= _pe &&    \
-                                _bk1i != _bk0i &&                          \
-                                _FCG_INT(p, reclaim_bucket)(           \
-                                    fc, _bk1i, _eb)) {                     \
-                                fc->stats.relief_evictions++;              \
-                                fc->stats.relief_bk1_evictions++;          \
-                            }                                              \
-                        }                                                  \
+                _FCG_INT(p, findadd_miss)(fc, &ctx[idx], &keys[idx], now,  \
+                                          &results[idx]);                  \
+            }                                                              \
+        }                                                                  \
+    }                                                                      \
+    fc->stats.lookups += nb_keys;                                          \
+    fc->stats.hits += hit_count;                                           \
+    fc->stats.hits_bk1 += bk1_count;                                       \
+    fc->stats.misses += miss_count;                                        \
+    fc->stats.coalesced += dup_count;                                      \
+}                                                                          \
+                                                                           \
+static void                                                                \
+_FCG_API(p, findadd_bulk)(_FCG_CACHE_T(p) *fc,                             \
+                          const _FCG_KEY_T(p) *keys,                       \
+                          unsigned nb_keys,                                \
+                          uint64_t now,                                    \
+                          _FCG_RESULT_T(p) *results)                       \
+{                                                                          \
+    _FCG_INT(p, findadd_bulk)(fc, keys, NULL, nb_keys, now, results);      \
+}                                                                          \
+                                                                           \
+static void                                                                \
+_FCG_API(p, findadd_bulk_hashed)(_FCG_CACHE_T(p) *fc,                      \
+                                 const _FCG_KEY_T(p) *keys,                \
+                                 const uint32_t *hashes,                   \
+                                 unsigned nb_keys,                         \
+                                 uint64_t now,                             \
+                                 _FCG_RESULT_T(p) *results)                \
+{                                                                          \
+    fc->hashed = 1u;                                                       \
+    _FCG_INT(p, findadd_bulk)(fc, keys, hashes, nb_keys, now, results);    \
+}                                                                          \
+                                                                           \
+/* ----- find_by_hint_bulk: try the entry_idx hint first --------------- */\
+/* A hint is taken only if its entry is live and holds the key; all     */ \
+/* other keys go through the find_bulk pipeline by position, with     */  \
+/* their hashes when the caller has them.                               */ \
+static RIX_FORCE_INLINE void                                               \
+_FCG_INT(p, find_by_hint_bulk)(_FCG_CACHE_T(p) *fc,                        \
+                               const _FCG_KEY_T(p) *keys,                  \
+                               const uint32_t *hashes,                     \
+                               const uint32_t *hints,                      \
+                               unsigned nb_keys,                           \
+                               uint64_t now,                               \
+                               _FCG_RESULT_T(p) *results)                  \
+{                                                                          \
+    uint32_t miss_pos[nb_keys];                                            \
+    unsigned nb_miss = 0u;                                                 \
+    uint64_t hint_count = 0u;                                              \
+    const unsigned ahead_keys = FLOW_CACHE_LOOKUP_AHEAD_KEYS;              \
+    const unsigned step_keys = FLOW_CACHE_LOOKUP_STEP_KEYS;                \
+    const unsigned total = nb_keys + ahead_keys;                           \
+    /* 2-stage pipeline: prefetch the hinted entry, then verify it */      \
+    for (unsigned i = 0; i < total; i += step_keys) {                      \
+        /* Stage 1: prefetch pool[hint] (one line, no bucket) */           \
+        if (i < nb_keys) {                                                 \
+            unsigned n = (i + step_keys <= nb_keys) ?                      \
+                step_keys : (nb_keys - i);                                 \
+            for (unsigned j = 0; j < n; j++) {                             \
+                uint32_t hint = hints[i + j];                              \
+                if (hint != 0u && hint <= fc->max_entries)                 \
+                    rix_hash_prefetch_entry(                               \
+                        RIX_PTR_FROM_IDX(fc->pool, hint));                 \
+            }                                                              \
+        }                                                                  \
+        /* Stage 2: live and same key -> hit, else queue for fallback */   \
+        if (i >= ahead_keys && i - ahead_keys < nb_keys) {                 \
+            unsigned base = i - ahead_keys;                                \
+            unsigned n = (base + step_keys <= nb_keys) ?                   \
+                step_keys : (nb_keys - base);                              \
+            for (unsigned j = 0; j < n; j++) {                             \
+                unsigned idx = base + j;                                   \
+                uint32_t hint = hints[idx];                                \
+                if (hint != 0u && hint <= fc->max_entries) {               \
+                    _FCG_ENTRY_T(p) *entry =                               \
+                        RIX_PTR_FROM_IDX(fc->pool, hint);                  \
+                    if (entry->last_ts != 0u &&                            \
+                        cmp_fn(&entry->key, &keys[idx]) == 0) {            \
+                        if (now)                                           \
+                            entry->last_ts = now;                          \
+                        _FCG_INT(p, result_set_hit)(&results[idx], hint);  \
+                        hint_count++;                                      \
+                        continue;                                          \
                     }                                                      \
                 }                                                          \
-                /* Alloc from free list (head already prefetched) */       \
-                entry = _FCG_INT(p, alloc_entry)(fc);                     \
-                if (RIX_UNLIKELY(entry == NULL)) {                         \
-                    fc->stats.fill_full++;                                 \
-                    _FCG_INT(p, result_set_miss)(&results[idx]);          \
+                miss_pos[nb_miss++] = idx;                                 \
+            }                                                              \
+        }                                                                  \
+    }                                                                      \
+    if (nb_miss != 0u)                                                     \
+        _FCG_INT(p, find_bulk)(fc, keys, hashes, miss_pos, nb_miss, now,   \
+                               results);                                   \
+    fc->stats.lookups += hint_count;                                       \
+    fc->stats.hits += hint_count;                                          \
+    fc->stats.hint_hits += hint_count;                                     \
+}                                                                          \
+                                                                           \
+static void                                                                \
+_FCG_API(p, find_by_hint_bulk)(_FCG_CACHE_T(p) *fc,                        \
+                               const _FCG_KEY_T(p) *keys,                  \
+                               const uint32_t *hints,                      \
+                               unsigned nb_keys,                           \
+                               uint64_t now,                               \
+                               _FCG_RESULT_T(p) *results)                  \
+{                                                                          \
+    _FCG_INT(p, find_by_hint_bulk)(fc, keys, NULL, hints, nb_keys, now,    \
+                                   results);                               \
+}                                                                          \
+                                                                           \
+static void                                                                \
+_FCG_API(p, find_by_hint_bulk_hashed)(_FCG_CACHE_T(p) *fc,                 \
+                                      const _FCG_KEY_T(p) *keys,           \
+                                      const uint32_t *hashes,              \
+                                      const uint32_t *hints,               \
+                                      unsigned nb_keys,                    \
+                                      uint64_t now,                        \
+                                      _FCG_RESULT_T(p) *results)           \
+{                                                                          \
+    _FCG_INT(p, find_by_hint_bulk)(fc, keys, hashes, hints, nb_keys, now,  \
+                                   results);                               \
+}                                                                          \
+                                                                           \
+/* ----- lookup_issue / lookup_complete: split-phase find(add) --------- */\
+/* hashes == NULL: hash the keys; else one caller hash per key.         */ \
+static RIX_FORCE_INLINE _FCG_LOOKUP_T(p) *                                 \
+_FCG_INT(p, lookup_issue)(_FCG_CACHE_T(p) *fc, _FCG_LOOKUP_T(p) *lk,       \
+                          const _FCG_KEY_T(p) *keys,                       \
+                          const uint32_t *hashes, unsigned nb_keys,        \
+                          unsigned flags)                                  \
+{                                                                          \
+    uint32_t win_hash[_FC_COALESCE_FLOWS] = { 0u };                        \
+    uint32_t win_idx[_FC_COALESCE_FLOWS];                                  \
+    uint32_t win_live = 0u;                                                \
+    unsigned win_pos = 0u;                                                 \
+    const int coalesce = FLOW_CACHE_COALESCE && (flags & FC_LOOKUP_ADD);   \
+    if (nb_keys > FC_LOOKUP_MAX_KEYS)                                      \
+        nb_keys = FC_LOOKUP_MAX_KEYS;                                      \
+    lk->keys = keys;                                                       \
+    lk->nb_keys = nb_keys;                                                 \
+    lk->flags = flags;                                                     \
+    /* Stage 1 for the whole batch: both buckets of every key in flight */ \
+    _FCG_INT(p, hash_keys)(fc, lk->ctx, keys, hashes, NULL, 0u, nb_keys);  \
+    for (unsigned i = 0; i < nb_keys; i++) {                               \
+        lk->lead[i] = coalesce ?                                           \
+            _FCG_INT(p, coalesce)(keys, i, lk->ctx[i].hash.val32[0],       \
+                                  win_hash, win_idx, &win_live,            \
+                                  &win_pos) : 0u;                          \
+    }                                                                      \
+    if (flags & FC_LOOKUP_ADD)                                             \
+        _FCG_INT(p, free_prefetch_ahead)(fc);                              \
+    return lk;                                                             \
+}                                                                          \
+                                                                           \
+static _FCG_LOOKUP_T(p) *                                                  \
+_FCG_API(p, lookup_issue)(_FCG_CACHE_T(p) *fc, _FCG_LOOKUP_T(p) *lk,       \
+                          const _FCG_KEY_T(p) *keys, unsigned nb_keys,     \
+                          unsigned flags)                                  \
+{                                                                          \
+    return _FCG_INT(p, lookup_issue)(fc, lk, keys, NULL, nb_keys, flags);  \
+}                                                                          \
+                                                                           \
+static _FCG_LOOKUP_T(p) *                                                  \
+_FCG_API(p, lookup_issue_hashed)(_FCG_CACHE_T(p) *fc,                      \
+                                 _FCG_LOOKUP_T(p) *lk,                     \
+                                 const _FCG_KEY_T(p) *keys,                \
+                                 const uint32_t *hashes,                   \
+                                 unsigned nb_keys, unsigned flags)         \
+{                                                                          \
+    if (flags & FC_LOOKUP_ADD)                                             \
+        fc->hashed = 1u;                                                   \
+    return _FCG_INT(p, lookup_issue)(fc, lk, keys, hashes, nb_keys,        \
+                                     flags);                               \
+}                                                                          \
+                                                                           \
+static void                                                                \
+_FCG_API(p, lookup_complete)(_FCG_CACHE_T(p) *fc, _FCG_LOOKUP_T(p) *lk,    \
+                             uint64_t now, _FCG_RESULT_T(p) *results)      \
+{                                                                          \
+    struct rix_hash_find_ctx_s *ctx = lk->ctx;                             \
+    const _FCG_KEY_T(p) *keys = lk->keys;                                  \
+    const unsigned nb_keys = lk->nb_keys;                                  \
+    const int add = (lk->flags & FC_LOOKUP_ADD) != 0;                      \
+    uint64_t hit_count = 0u;                                               \
+    uint64_t bk1_count = 0u;                                               \
+    uint64_t miss_count = 0u;                                              \
+    uint64_t dup_count = 0u;                                               \
+    const unsigned ahead_keys = FLOW_CACHE_LOOKUP_AHEAD_KEYS;              \
+    const unsigned step_keys = FLOW_CACHE_LOOKUP_STEP_KEYS;                \
+    const unsigned total = nb_keys + 2u * ahead_keys;                      \
+    /* Buckets are on their way since issue: the pipeline starts at scan */\
+    for (unsigned i = 0; i < total; i += step_keys) {                      \
+        /* Stage 2: scan_bk / scan_bk_empties */                           \
+        if (i < nb_keys) {                                                 \
+            unsigned n = (i + step_keys <= nb_keys) ?                      \
+                step_keys : (nb_keys - i);                                 \
+            for (unsigned j = 0; j < n; j++) {                             \
+                unsigned idx = i + j;                                      \
+                if (lk->lead[idx] != 0u)                                   \
+                    continue;                                              \
+                if (add)                                                   \
+                    _FCG_HT(p, scan_bk_empties)(&ctx[idx], &fc->ht_head,   \
+                                                fc->buckets);              \
+                else                                                       \
+                    _FCG_HT(p, scan_bk)(&ctx[idx], &fc->ht_head,           \
+                                        fc->buckets);                      \
+            }                                                              \
+        }                                                                  \
+        /* Stage 3: prefetch_node */                                       \
+        if (i >= ahead_keys && i - ahead_keys < nb_keys) {                 \
+            unsigned base = i - ahead_keys;                                \
+            unsigned n = (base + step_keys <= nb_keys) ?                   \
+                step_keys : (nb_keys - base);                              \
+            for (unsigned j = 0; j < n; j++)                               \
+                if (lk->lead[base + j] == 0u)                              \
+                    _FCG_HT(p, prefetch_node)(&ctx[base + j], fc->pool);   \
+        }                                                                  \
+        /* Stage 4: cmp_key, insert on miss with FC_LOOKUP_ADD */          \
+        if (i >= 2u * ahead_keys && i - 2u * ahead_keys < nb_keys) {       \
+            unsigned base = i - 2u * ahead_keys;                           \
+            unsigned n = (base + step_keys <= nb_keys) ?                   \
+                step_keys : (nb_keys - base);                              \
+            for (unsigned j = 0; j < n; j++) {                             \
+                unsigned idx = base + j;                                   \
+                _FCG_ENTRY_T(p) *entry;                                    \
+                if (lk->lead[idx] != 0u) {                                 \
+                    results[idx] = results[lk->lead[idx] - 1u];            \
+                    if (results[idx].entry_idx != 0u)                      \
+                        hit_count++;                                       \
+                    else                                                   \
+                        miss_count++;                                      \
+                    dup_count++;                                           \
                     continue;                                              \
                 }                                                          \
-                entry->key = keys[idx];                                    \
-                entry->last_ts = now;                                      \
-                /* insert_hashed: buckets in L1 from cmp_key,      */     \
-                /* hash reused from ctx (no rehash), dup-safe.     */     \
-                {                                                          \
-                    _FCG_ENTRY_T(p) *_ret;                                \
-                    _ret = _FCG_HT(p, insert_hashed)(                     \
-                        &fc->ht_head, fc->buckets, fc->pool,              \
-                        entry, ctx[idx].hash);                             \
-                    if (RIX_LIKELY(_ret == NULL)) {                        \
-                        fc->stats.fills++;                                 \
-                        _FCG_INT(p, result_set_filled)(&results[idx],     \
-                            RIX_IDX_FROM_PTR(fc->pool, entry));            \
-                    } else {                                               \
-                        _FCG_INT(p, free_entry)(fc, entry);               \
-                        if (_ret != entry) {                               \
-                            /* duplicate found */                          \
-                            _ret->last_ts = now;                           \
-                            _FCG_INT(p, result_set_filled)(               \
-                                &results[idx],                              \
-                                RIX_IDX_FROM_PTR(fc->pool, _ret));         \
-                        } else {                                           \
-                            /* table full */                               \
-                            fc->stats.fill_full++;                         \
-                            _FCG_INT(p, result_set_miss)(                 \
-                                &results[idx]);                             \
-                        }                                                  \
-                    }                                                      \
-                }                                                          \
-                /* Prefetch next free list head for future miss */         \
-                {                                                          \
-                    _FCG_ENTRY_T(p) *_nf =                                \
-                        RIX_SLIST_FIRST(&fc->free_head, fc->pool);        \
-                    if (_nf != NULL)                                       \
-                        rix_hash_prefetch_entry(_nf);                     \
+                entry = add ?                                              \
+                    _FCG_HT(p, cmp_key_empties)(&ctx[idx], fc->pool) :     \
+                    _FCG_HT(p, cmp_key)(&ctx[idx], fc->pool);              \
+                if (RIX_LIKELY(entry != NULL)) {                           \
+                    if (now)                                               \
+                        entry->last_ts = now;                              \
+                    bk1_count += _FCG_INT(p, hit_bk1)(fc, entry,           \
+                                                      &ctx[idx], now);     \
+                    _FCG_INT(p, result_set_hit)(&results[idx],             \
+                        RIX_IDX_FROM_PTR(fc->pool, entry));                \
+                    hit_count++;                                           \
+                    continue;                                              \
                 }                                                          \
+                miss_count++;                                              \
+                if (add)                                                   \
+                    _FCG_INT(p, findadd_miss)(fc, &ctx[idx], &keys[idx],   \
+                                              now, &results[idx]);         \
+                else                                                       \
+                    _FCG_INT(p, result_set_miss)(&results[idx]);           \
             }                                                              \
         }                                                                  \
     }                                                                      \
     fc->stats.lookups += nb_keys;                                          \
     fc->stats.hits += hit_count;                                           \
+    fc->stats.hits_bk1 += bk1_count;                                       \
     fc->stats.misses += miss_count;                                        \
+    fc->stats.coalesced += dup_count;                                      \
 }                                                                          \
                                                                            \
 static unsigned                                                            \
@@ -918,6 +1633,51 @@ _FCG_API(p, walk)(_FCG_CACHE_T(p) *fc,                                  \
     return 0;                                                              \
 }                                                                          \
                                                                            \
+/* ----- promote: move hot bk1 residents back to bk0 ------------------ */ \
+static unsigned                                                            \
+_FCG_API(p, promote)(_FCG_CACHE_T(p) *fc,                                  \
+                     unsigned start_bk,                                    \
+                     unsigned bucket_count,                                \
+                     unsigned min_hits)                                    \
+{                                                                          \
+    unsigned mask = fc->ht_head.rhh_mask;                                  \
+    unsigned bk = start_bk & mask;                                         \
+    unsigned moved = 0u;                                                   \
+    if (bucket_count > fc->nb_bk)                                          \
+        bucket_count = fc->nb_bk;                                          \
+    while (bucket_count-- != 0u) {                                         \
+        moved += _FCG_INT(p, promote_bucket)(fc, bk, min_hits);            \
+        bk = (bk + 1u) & mask;                                             \
+    }                                                                      \
+    return moved;                                                          \
+}                                                                          \
+                                                                           \
+/* ----- compact_step: incremental pool compaction --------------------- */\
+static int                                                                 \
+_FCG_API(p, compact_step)(_FCG_CACHE_T(p) *fc, unsigned budget,            \
+                          unsigned flags,                                  \
+                          void (*moved)(uint32_t from_idx,                 \
+                                        uint32_t to_idx, void *arg),       \
+                          void *arg)                                       \
+{                                                                          \
+    unsigned work = 0u;                                                    \
+    if (fc->compact_phase == _FC_COMPACT_IDLE)                             \
+        _FCG_INT(p, compact_begin)(fc, flags);                             \
+    if (fc->compact_phase == _FC_COMPACT_DENSE) {                          \
+        if (_FCG_INT(p, compact_dense)(fc, budget, &work, moved, arg))     \
+            return 1;                                                      \
+        if ((fc->compact_flags & FC_COMPACT_BUCKET_ORDER) == 0u) {         \
+            fc->compact_phase = _FC_COMPACT_IDLE;                          \
+            return 0;                                                      \
+        }                                                                  \
+        fc->compact_phase = _FC_COMPACT_ORDER;                             \
+    }                                                                      \
+    if (_FCG_INT(p, compact_order)(fc, budget, &work, moved, arg))         \
+        return 1;                                                          \
+    fc->compact_phase = _FC_COMPACT_IDLE;                                  \
+    return 0;                                                              \
+}                                                                          \
+                                                                           \
 /* ----- add_bulk: insert only (no prior search) ----------------------- */\
 static void                                                                \
 _FCG_API(p, add_bulk)(_FCG_CACHE_T(p) *fc,                              \
@@ -930,28 +1690,34 @@ _FCG_API(p, add_bulk)(_FCG_CACHE_T(p) *fc,                              \
     const unsigned step_keys = FLOW_CACHE_LOOKUP_STEP_KEYS;                \
     const unsigned total = nb_keys + ahead_keys;                           \
     union rix_hash_hash_u hashes[nb_keys];                                 \
-    /* Prefetch free list head */                                          \
-    {                                                                      \
-        _FCG_ENTRY_T(p) *_fh =                                           \
-            RIX_SLIST_FIRST(&fc->free_head, fc->pool);                    \
-        if (_fh != NULL)                                                   \
-            rix_hash_prefetch_entry(_fh);                                 \
-    }                                                                      \
+    _FCG_ENTRY_T(p) *resv[nb_keys];                                        \
+    unsigned nb_resv = 0u;                                                 \
+    /* free_idx: reserve the batch's entries up front (no entry reads), */ \
+    /* stage 1 prefetches them with the buckets.  Linked list: walking  */ \
+    /* it up front would serialize the loads, so keep popping per key.  */ \
+    if (fc->free_idx != NULL)                                              \
+        nb_resv = _FCG_INT(p, alloc_bulk)(fc, resv, nb_keys);              \
+    else                                                                   \
+        _FCG_INT(p, free_prefetch)(fc, 0u);                                \
     /* 2-stage pipeline: hash+prefetch bk, then alloc+insert */            \
     for (unsigned i = 0; i < total; i += step_keys) {                      \
         /* Stage 1: hash + prefetch buckets */                             \
         if (i < nb_keys) {                                                 \
             unsigned n = (i + step_keys <= nb_keys) ?                      \
                 step_keys : (nb_keys - i);                                 \
+            const void *kp[FLOW_CACHE_LOOKUP_STEP_KEYS];                   \
+            for (unsigned j = 0; j < n; j++)                               \
+                kp[j] = &keys[i + j];                                      \
+            hash_n_fn(kp, n, fc->ht_head.rhh_mask, &hashes[i]);            \
             for (unsigned j = 0; j < n; j++) {                             \
                 unsigned idx = i + j;                                      \
-                hashes[idx] = hash_fn(&keys[idx],                          \
-                    fc->ht_head.rhh_mask);                                 \
                 {                                                          \
                     unsigned _bk0 = hashes[idx].val32[0] &                \
                         fc->ht_head.rhh_mask;                              \
                     rix_hash_prefetch_bucket(&fc->buckets[_bk0]);         \
                 }                                                          \
+                if (idx < nb_resv)                                         \
+                    rix_hash_prefetch_entry(resv[idx]);                    \
             }                                                              \
         }                                                                  \
         /* Stage 2: alloc + insert */                                      \
@@ -961,7 +1727,7 @@ _FCG_API(p, add_bulk)(_FCG_CACHE_T(p) *fc,                              \
                 step_keys : (nb_keys - base);                              \
             for (unsigned j = 0; j < n; j++) {                             \
                 unsigned idx = base + j;                                   \
-                _FCG_ENTRY_T(p) *entry =                                  \
+                _FCG_ENTRY_T(p) *entry = (idx < nb_resv) ? resv[idx] :     \
                     _FCG_INT(p, alloc_entry)(fc);                          \
                 if (RIX_UNLIKELY(entry == NULL)) {                         \
                     fc->stats.fill_full++;                                 \
@@ -980,7 +1746,8 @@ _FCG_API(p, add_bulk)(_FCG_CACHE_T(p) *fc,                              \
                         _FCG_INT(p, result_set_filled)(&results[idx],     \
                             RIX_IDX_FROM_PTR(fc->pool, entry));            \
                     } else {                                               \
-                        _FCG_INT(p, free_entry)(fc, entry);               \
+                        _FCG_INT(p, unreserve)(fc, resv, nb_resv, idx,     \
+                                               entry);                     \
                         if (_ret != entry) {                               \
                             _ret->last_ts = now;                           \
                             _FCG_INT(p, result_set_filled)(               \
@@ -993,13 +1760,9 @@ _FCG_API(p, add_bulk)(_FCG_CACHE_T(p) *fc,                              \
                         }                                                  \
                     }                                                      \
                 }                                                          \
-                /* Prefetch next free list head */                         \
-                {                                                          \
-                    _FCG_ENTRY_T(p) *_nf =                                \
-                        RIX_SLIST_FIRST(&fc->free_head, fc->pool);        \
-                    if (_nf != NULL)                                       \
-                        rix_hash_prefetch_entry(_nf);                     \
-                }                                                          \
+                /* Prefetch next free list head (unreserved keys) */       \
+                if (idx + 1u >= nb_resv)                                   \
+                    _FCG_INT(p, free_prefetch)(fc, 0u);                    \
             }                                                              \
         }                                                                  \
     }                                                                      \
@@ -1021,9 +1784,7 @@ _FCG_API(p, del_bulk)(_FCG_CACHE_T(p) *fc,                              \
         if (i < nb_keys) {                                                 \
             unsigned n = (i + step_keys <= nb_keys) ?                      \
                 step_keys : (nb_keys - i);                                 \
-            for (unsigned j = 0; j < n; j++)                               \
-                _FCG_HT(p, hash_key_2bk)(&ctx[i + j], &fc->ht_head,     \
-                                           fc->buckets, &keys[i + j]);    \
+            _FCG_INT(p, hash_keys)(fc, ctx, keys, NULL, NULL, i, n);       \
         }                                                                  \
         /* Stage 2: scan_bk (no empty tracking needed) */                   \
         if (i >= ahead_keys && i - ahead_keys < nb_keys) {                \
@@ -1114,8 +1875,10 @@ _FCG_API(p, del_idx_bulk)(_FCG_CACHE_T(p) *fc,                          \
  * Without this, rix_hash_hash_bytes_fast() falls back to Generic
  * even when compiled with -mavx2.  The constructor runs once per
  * shared-library load (or at program start for static linking).
+ * Not needed with RIX_HASH_ARCH_DIRECT (the Makefile default), where
+ * rix_hash_arch is bound at compile time.
  *===========================================================================*/
-#ifdef FC_ARCH_SUFFIX
+#if defined(FC_ARCH_SUFFIX) && !defined(RIX_HASH_ARCH_DIRECT)
 #define _FC_RIX_ARCH_CTOR(prefix)                                         \
     __attribute__((constructor)) static void                               \
     _FCG_CAT(_fc_rix_arch_init_, prefix)(void)                            \
@@ -1123,17 +1886,17 @@ _FCG_API(p, del_idx_bulk)(_FCG_CACHE_T(p) *fc,                          \
         rix_hash_arch_init(RIX_HASH_ARCH_AUTO);                            \
     }
 #else
-#define _FC_RIX_ARCH_CTOR(prefix) /* no-op without FC_ARCH_SUFFIX */
+#define _FC_RIX_ARCH_CTOR(prefix) /* no-op */
 #endif
 
 /*===========================================================================
  * Top-level GENERATE macro
  *===========================================================================*/
-#define FC_CACHE_GENERATE(prefix, pressure, hash_fn, cmp_fn)              \
+#define FC_CACHE_GENERATE(prefix, pressure, hash_fn, hash_n_fn, cmp_fn)   \
     _FC_RIX_ARCH_CTOR(prefix)                                             \
     _FC_GENERATE_HT(prefix, hash_fn, cmp_fn)                              \
     _FC_GENERATE_INTERNAL(prefix)                                          \
-    _FC_GENERATE_API(prefix, pressure, hash_fn)
+    _FC_GENERATE_API(prefix, pressure, hash_fn, hash_n_fn, cmp_fn)
 
 /*===========================================================================
  * Ops table instance generation (for arch-specific builds)
@@ -1160,14 +1923,24 @@ const struct fc_##prefix##_ops _FC_OPS_TNAME(prefix, suffix) = {               \
     .remove_idx       = _FC_OPS_FNAME(prefix, remove_idx),                     \
     .stats            = _FC_OPS_FNAME(prefix, stats),                          \
     .walk             = _FC_OPS_FNAME(prefix, walk),                           \
+    .compact_step     = _FC_OPS_FNAME(prefix, compact_step),                   \
     .find_bulk        = _FC_OPS_FNAME(prefix, find_bulk),                      \
     .findadd_bulk     = _FC_OPS_FNAME(prefix, findadd_bulk),                   \
+    .find_bulk_hashed = _FC_OPS_FNAME(prefix, find_bulk_hashed),               \
+    .findadd_bulk_hashed = _FC_OPS_FNAME(prefix, findadd_bulk_hashed),         \
+    .find_by_hint_bulk = _FC_OPS_FNAME(prefix, find_by_hint_bulk),             \
+    .find_by_hint_bulk_hashed =                                                \
+        _FC_OPS_FNAME(prefix, find_by_hint_bulk_hashed),                       \
+    .lookup_issue     = _FC_OPS_FNAME(prefix, lookup_issue),                   \
+    .lookup_issue_hashed = _FC_OPS_FNAME(prefix, lookup_issue_hashed),         \
+    .lookup_complete  = _FC_OPS_FNAME(prefix, lookup_complete),                \
     .add_bulk         = _FC_OPS_FNAME(prefix, add_bulk),                       \
     .del_bulk         = _FC_OPS_FNAME(prefix, del_bulk),                       \
     .del_idx_bulk     = _FC_OPS_FNAME(prefix, del_idx_bulk),                   \
     .maintain         = _FC_OPS_FNAME(prefix, maintain),                       \
     .maintain_step_ex = _FC_OPS_FNAME(prefix, maintain_step_ex),               \
     .maintain_step    = _FC_OPS_FNAME(prefix, maintain_step),                  \
+    .promote          = _FC_OPS_FNAME(prefix, promote),                        \
 }
 
 #endif /* FC_ARCH_SUFFIX */
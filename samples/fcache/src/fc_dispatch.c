@@ -78,6 +78,16 @@ fc_flow4_cache_walk(struct fc_flow4_cache *fc,
     return fc_flow4_ops_gen.walk(fc, cb, arg);
 }
 
+int
+fc_flow4_cache_compact_step(struct fc_flow4_cache *fc, unsigned budget,
+                            unsigned flags,
+                            void (*moved)(uint32_t from_idx, uint32_t to_idx,
+                                          void *arg),
+                            void *arg)
+{
+    return fc_flow4_ops_gen.compact_step(fc, budget, flags, moved, arg);
+}
+
 /* flow6 cold-path */
 void
 fc_flow6_cache_init(struct fc_flow6_cache *fc,
@@ -116,6 +126,16 @@ fc_flow6_cache_walk(struct fc_flow6_cache *fc,
     return fc_flow6_ops_gen.walk(fc, cb, arg);
 }
 
+int
+fc_flow6_cache_compact_step(struct fc_flow6_cache *fc, unsigned budget,
+                            unsigned flags,
+                            void (*moved)(uint32_t from_idx, uint32_t to_idx,
+                                          void *arg),
+                            void *arg)
+{
+    return fc_flow6_ops_gen.compact_step(fc, budget, flags, moved, arg);
+}
+
 /* flowu cold-path */
 void
 fc_flowu_cache_init(struct fc_flowu_cache *fc,
@@ -154,6 +174,16 @@ fc_flowu_cache_walk(struct fc_flowu_cache *fc,
     return fc_flowu_ops_gen.walk(fc, cb, arg);
 }
 
+int
+fc_flowu_cache_compact_step(struct fc_flowu_cache *fc, unsigned budget,
+                            unsigned flags,
+                            void (*moved)(uint32_t from_idx, uint32_t to_idx,
+                                          void *arg),
+                            void *arg)
+{
+    return fc_flowu_ops_gen.compact_step(fc, budget, flags, moved, arg);
+}
+
 /*===========================================================================
  * Hot-path bulk wrappers -- dispatch through selected ops table
  *===========================================================================*/
@@ -177,6 +207,79 @@ fc_flow4_cache_findadd_bulk(struct fc_flow4_cache *fc,
     _fc_flow4_active->findadd_bulk(fc, keys, nb_keys, now, results);
 }
 
+void
+fc_flow4_cache_find_bulk_hashed(struct fc_flow4_cache *fc,
+                                const struct fc_flow4_key *keys,
+                                const uint32_t *hashes,
+                                unsigned nb_keys, uint64_t now,
+                                struct fc_flow4_result *results)
+{
+    _fc_flow4_active->find_bulk_hashed(fc, keys, hashes, nb_keys, now,
+                                       results);
+}
+
+void
+fc_flow4_cache_findadd_bulk_hashed(struct fc_flow4_cache *fc,
+                                   const struct fc_flow4_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, uint64_t now,
+                                   struct fc_flow4_result *results)
+{
+    _fc_flow4_active->findadd_bulk_hashed(fc, keys, hashes, nb_keys, now,
+                                          results);
+}
+
+void
+fc_flow4_cache_find_by_hint_bulk(struct fc_flow4_cache *fc,
+                                 const struct fc_flow4_key *keys,
+                                 const uint32_t *hints,
+                                 unsigned nb_keys, uint64_t now,
+                                 struct fc_flow4_result *results)
+{
+    _fc_flow4_active->find_by_hint_bulk(fc, keys, hints, nb_keys, now,
+                                        results);
+}
+
+void
+fc_flow4_cache_find_by_hint_bulk_hashed(struct fc_flow4_cache *fc,
+                                        const struct fc_flow4_key *keys,
+                                        const uint32_t *hashes,
+                                        const uint32_t *hints,
+                                        unsigned nb_keys, uint64_t now,
+                                        struct fc_flow4_result *results)
+{
+    _fc_flow4_active->find_by_hint_bulk_hashed(fc, keys, hashes, hints,
+                                               nb_keys, now, results);
+}
+
+struct fc_flow4_lookup *
+fc_flow4_cache_lookup_issue(struct fc_flow4_cache *fc,
+                            struct fc_flow4_lookup *lk,
+                            const struct fc_flow4_key *keys,
+                            unsigned nb_keys, unsigned flags)
+{
+    return _fc_flow4_active->lookup_issue(fc, lk, keys, nb_keys, flags);
+}
+
+struct fc_flow4_lookup *
+fc_flow4_cache_lookup_issue_hashed(struct fc_flow4_cache *fc,
+                                   struct fc_flow4_lookup *lk,
+                                   const struct fc_flow4_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, unsigned flags)
+{
+    return _fc_flow4_active->lookup_issue_hashed(fc, lk, keys, hashes, nb_keys,
+                                               flags);
+}
+
+void
+fc_flow4_cache_lookup_complete(struct fc_flow4_cache *fc,
+                               struct fc_flow4_lookup *lk, uint64_t now,
+                               struct fc_flow4_result *results)
+{
+    _fc_flow4_active->lookup_complete(fc, lk, now, results);
+}
+
 void
 fc_flow4_cache_add_bulk(struct fc_flow4_cache *fc,
                          const struct fc_flow4_key *keys,
@@ -225,6 +328,14 @@ fc_flow4_cache_maintain_step(struct fc_flow4_cache *fc,
     return _fc_flow4_active->maintain_step(fc, now, idle);
 }
 
+unsigned
+fc_flow4_cache_promote(struct fc_flow4_cache *fc,
+                       unsigned start_bk, unsigned bucket_count,
+                       unsigned min_hits)
+{
+    return _fc_flow4_active->promote(fc, start_bk, bucket_count, min_hits);
+}
+
 /*--- flow6 bulk ---*/
 void
 fc_flow6_cache_find_bulk(struct fc_flow6_cache *fc,
@@ -244,6 +355,79 @@ fc_flow6_cache_findadd_bulk(struct fc_flow6_cache *fc,
     _fc_flow6_active->findadd_bulk(fc, keys, nb_keys, now, results);
 }
 
+void
+fc_flow6_cache_find_bulk_hashed(struct fc_flow6_cache *fc,
+                                const struct fc_flow6_key *keys,
+                                const uint32_t *hashes,
+                                unsigned nb_keys, uint64_t now,
+                                struct fc_flow6_result *results)
+{
+    _fc_flow6_active->find_bulk_hashed(fc, keys, hashes, nb_keys, now,
+                                       results);
+}
+
+void
+fc_flow6_cache_findadd_bulk_hashed(struct fc_flow6_cache *fc,
+                                   const struct fc_flow6_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, uint64_t now,
+                                   struct fc_flow6_result *results)
+{
+    _fc_flow6_active->findadd_bulk_hashed(fc, keys, hashes, nb_keys, now,
+                                          results);
+}
+
+void
+fc_flow6_cache_find_by_hint_bulk(struct fc_flow6_cache *fc,
+                                 const struct fc_flow6_key *keys,
+                                 const uint32_t *hints,
+                                 unsigned nb_keys, uint64_t now,
+                                 struct fc_flow6_result *results)
+{
+    _fc_flow6_active->find_by_hint_bulk(fc, keys, hints, nb_keys, now,
+                                        results);
+}
+
+void
+fc_flow6_cache_find_by_hint_bulk_hashed(struct fc_flow6_cache *fc,
+                                        const struct fc_flow6_key *keys,
+                                        const uint32_t *hashes,
+                                        const uint32_t *hints,
+                                        unsigned nb_keys, uint64_t now,
+                                        struct fc_flow6_result *results)
+{
+    _fc_flow6_active->find_by_hint_bulk_hashed(fc, keys, hashes, hints,
+                                               nb_keys, now, results);
+}
+
+struct fc_flow6_lookup *
+fc_flow6_cache_lookup_issue(struct fc_flow6_cache *fc,
+                            struct fc_flow6_lookup *lk,
+                            const struct fc_flow6_key *keys,
+                            unsigned nb_keys, unsigned flags)
+{
+    return _fc_flow6_active->lookup_issue(fc, lk, keys, nb_keys, flags);
+}
+
+struct fc_flow6_lookup *
+fc_flow6_cache_lookup_issue_hashed(struct fc_flow6_cache *fc,
+                                   struct fc_flow6_lookup *lk,
+                                   const struct fc_flow6_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, unsigned flags)
+{
+    return _fc_flow6_active->lookup_issue_hashed(fc, lk, keys, hashes, nb_keys,
+                                               flags);
+}
+
+void
+fc_flow6_cache_lookup_complete(struct fc_flow6_cache *fc,
+                               struct fc_flow6_lookup *lk, uint64_t now,
+                               struct fc_flow6_result *results)
+{
+    _fc_flow6_active->lookup_complete(fc, lk, now, results);
+}
+
 void
 fc_flow6_cache_add_bulk(struct fc_flow6_cache *fc,
                          const struct fc_flow6_key *keys,
@@ -292,6 +476,14 @@ fc_flow6_cache_maintain_step(struct fc_flow6_cache *fc,
     return _fc_flow6_active->maintain_step(fc, now, idle);
 }
 
+unsigned
+fc_flow6_cache_promote(struct fc_flow6_cache *fc,
+                       unsigned start_bk, unsigned bucket_count,
+                       unsigned min_hits)
+{
+    return _fc_flow6_active->promote(fc, start_bk, bucket_count, min_hits);
+}
+
 /*--- flowu bulk ---*/
 void
 fc_flowu_cache_find_bulk(struct fc_flowu_cache *fc,
@@ -311,6 +503,79 @@ fc_flowu_cache_findadd_bulk(struct fc_flowu_cache *fc,
     _fc_flowu_active->findadd_bulk(fc, keys, nb_keys, now, results);
 }
 
+void
+fc_flowu_cache_find_bulk_hashed(struct fc_flowu_cache *fc,
+                                const struct fc_flowu_key *keys,
+                                const uint32_t *hashes,
+                                unsigned nb_keys, uint64_t now,
+                                struct fc_flowu_result *results)
+{
+    _fc_flowu_active->find_bulk_hashed(fc, keys, hashes, nb_keys, now,
+                                       results);
+}
+
+void
+fc_flowu_cache_findadd_bulk_hashed(struct fc_flowu_cache *fc,
+                                   const struct fc_flowu_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, uint64_t now,
+                                   struct fc_flowu_result *results)
+{
+    _fc_flowu_active->findadd_bulk_hashed(fc, keys, hashes, nb_keys, now,
+                                          results);
+}
+
+void
+fc_flowu_cache_find_by_hint_bulk(struct fc_flowu_cache *fc,
+                                 const struct fc_flowu_key *keys,
+                                 const uint32_t *hints,
+                                 unsigned nb_keys, uint64_t now,
+                                 struct fc_flowu_result *results)
+{
+    _fc_flowu_active->find_by_hint_bulk(fc, keys, hints, nb_keys, now,
+                                        results);
+}
+
+void
+fc_flowu_cache_find_by_hint_bulk_hashed(struct fc_flowu_cache *fc,
+                                        const struct fc_flowu_key *keys,
+                                        const uint32_t *hashes,
+                                        const uint32_t *hints,
+                                        unsigned nb_keys, uint64_t now,
+                                        struct fc_flowu_result *results)
+{
+    _fc_flowu_active->find_by_hint_bulk_hashed(fc, keys, hashes, hints,
+                                               nb_keys, now, results);
+}
+
+struct fc_flowu_lookup *
+fc_flowu_cache_lookup_issue(struct fc_flowu_cache *fc,
+                            struct fc_flowu_lookup *lk,
+                            const struct fc_flowu_key *keys,
+                            unsigned nb_keys, unsigned flags)
+{
+    return _fc_flowu_active->lookup_issue(fc, lk, keys, nb_keys, flags);
+}
+
+struct fc_flowu_lookup *
+fc_flowu_cache_lookup_issue_hashed(struct fc_flowu_cache *fc,
+                                   struct fc_flowu_lookup *lk,
+                                   const struct fc_flowu_key *keys,
+                                   const uint32_t *hashes,
+                                   unsigned nb_keys, unsigned flags)
+{
+    return _fc_flowu_active->lookup_issue_hashed(fc, lk, keys, hashes, nb_keys,
+                                               flags);
+}
+
+void
+fc_flowu_cache_lookup_complete(struct fc_flowu_cache *fc,
+                               struct fc_flowu_lookup *lk, uint64_t now,
+                               struct fc_flowu_result *results)
+{
+    _fc_flowu_active->lookup_complete(fc, lk, now, results);
+}
+
 void
 fc_flowu_cache_add_bulk(struct fc_flowu_cache *fc,
                          const struct fc_flowu_key *keys,
@@ -359,6 +624,14 @@ fc_flowu_cache_maintain_step(struct fc_flowu_cache *fc,
     return _fc_flowu_active->maintain_step(fc, now, idle);
 }
 
+unsigned
+fc_flowu_cache_promote(struct fc_flowu_cache *fc,
+                       unsigned start_bk, unsigned bucket_count,
+                       unsigned min_hits)
+{
+    return _fc_flowu_active->promote(fc, start_bk, bucket_count, min_hits);
+}
+
 /*===========================================================================
  * Single-key convenience wrappers -- call bulk(n=1)
  *===========================================================================*/
@@ -34,6 +34,11 @@ struct fc_##prefix##_ops {                                                     \
                   struct fc_##prefix##_stats *out);                            \
     int (*walk)(struct fc_##prefix##_cache *fc,                                \
                 int (*cb)(uint32_t entry_idx, void *arg), void *arg);          \
+    int (*compact_step)(struct fc_##prefix##_cache *fc, unsigned budget,       \
+                        unsigned flags,                                        \
+                        void (*moved)(uint32_t from_idx, uint32_t to_idx,      \
+                                      void *arg),                              \
+                        void *arg);                                            \
     /* hot-path */                                                             \
     void (*find_bulk)(struct fc_##prefix##_cache *fc,                           \
                       const struct fc_##prefix##_key *keys,                     \
@@ -43,6 +48,38 @@ struct fc_##prefix##_ops {                                                     \
                          const struct fc_##prefix##_key *keys,                  \
                          unsigned nb_keys, uint64_t now,                        \
                          struct fc_##prefix##_result *results);                 \
+    void (*find_bulk_hashed)(struct fc_##prefix##_cache *fc,                   \
+                             const struct fc_##prefix##_key *keys,             \
+                             const uint32_t *hashes,                           \
+                             unsigned nb_keys, uint64_t now,                   \
+                             struct fc_##prefix##_result *results);            \
+    void (*findadd_bulk_hashed)(struct fc_##prefix##_cache *fc,                \
+                                const struct fc_##prefix##_key *keys,          \
+                                const uint32_t *hashes,                        \
+                                unsigned nb_keys, uint64_t now,                \
+                                struct fc_##prefix##_result *results);         \
+    void (*find_by_hint_bulk)(struct fc_##prefix##_cache *fc,                  \
+                              const struct fc_##prefix##_key *keys,            \
+                              const uint32_t *hints,                           \
+                              unsigned nb_keys, uint64_t now,                  \
+                              struct fc_##prefix##_result *results);           \
+    void (*find_by_hint_bulk_hashed)(struct fc_##prefix##_cache *fc,           \
+                                     const struct fc_##prefix##_key *keys,     \
+                                     const uint32_t *hashes,                   \
+                                     const uint32_t *hints,                    \
+                                     unsigned nb_keys, uint64_t now,           \
+                                     struct fc_##prefix##_result *results);    \
+    struct fc_##prefix##_lookup *(*lookup_issue)(                              \
+        struct fc_##prefix##_cache *fc, struct fc_##prefix##_lookup *lk,       \
+        const struct fc_##prefix##_key *keys, unsigned nb_keys,                \
+        unsigned flags);                                                       \
+    struct fc_##prefix##_lookup *(*lookup_issue_hashed)(                       \
+        struct fc_##prefix##_cache *fc, struct fc_##prefix##_lookup *lk,       \
+        const struct fc_##prefix##_key *keys, const uint32_t *hashes,          \
+        unsigned nb_keys, unsigned flags);                                     \
+    void (*lookup_complete)(struct fc_##prefix##_cache *fc,                    \
+                            struct fc_##prefix##_lookup *lk, uint64_t now,     \
+                            struct fc_##prefix##_result *results);             \
     void (*add_bulk)(struct fc_##prefix##_cache *fc,                            \
                      const struct fc_##prefix##_key *keys,                      \
                      unsigned nb_keys, uint64_t now,                            \
@@ -60,6 +97,9 @@ struct fc_##prefix##_ops {                                                     \
                                  unsigned skip_threshold, uint64_t now);        \
     unsigned (*maintain_step)(struct fc_##prefix##_cache *fc,                   \
                               uint64_t now, int idle);                          \
+    unsigned (*promote)(struct fc_##prefix##_cache *fc,                         \
+                        unsigned start_bk, unsigned bucket_count,               \
+                        unsigned min_hits);                                     \
 }
 
 FC_OPS_DEFINE(flow4);
@@ -102,9 +142,18 @@ do {                                                                           \
 } while (0)
 
 #if defined(__x86_64__)
+/* FC_HASH_AES: the SIMD objects are built with -maes. */
+#if defined(FC_HASH_AES)
+#define _FC_OPS_HASH_OK()  __builtin_cpu_supports("aes")
+#else
+#define _FC_OPS_HASH_OK()  1
+#endif
+
 #define _FC_OPS_SELECT_BODY(prefix, arch_enable, out_ops)                      \
     __builtin_cpu_init();                                                      \
-    if (((arch_enable) & FC_ARCH_AVX512) &&                                    \
+    if (!_FC_OPS_HASH_OK()) {                                                  \
+        /* stay on _gen */                                                     \
+    } else if (((arch_enable) & FC_ARCH_AVX512) &&                             \
         __builtin_cpu_supports("avx512f")) {                                   \
         *(out_ops) = &fc_##prefix##_ops_avx512;                                \
     } else if (((arch_enable) & (FC_ARCH_AVX2 | FC_ARCH_AVX512)) &&            \
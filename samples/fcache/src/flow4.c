@@ -45,6 +45,23 @@ fc_flow4_hash_fn(const struct fc_flow4_key *key, uint32_t mask)
 #endif
 }
 
+/*
+ * Batch form of fc_flow4_hash_fn for the bulk pipelines: the same CRC32C
+ * hash with the crc32q chains of RIX_HASH_N_LANES keys interleaved.
+ */
+static inline void
+fc_flow4_hash_n_fn(const void * const *keys, unsigned n, uint32_t mask,
+                   union rix_hash_hash_u *out)
+{
+#if defined(__x86_64__) && defined(__SSE4_2__)
+    _rix_hash_hash_bytes_n_CRC32(keys, sizeof(struct fc_flow4_key), n, mask,
+                                 out);
+#else
+    rix_hash_hash_bytes_n_fast(keys, sizeof(struct fc_flow4_key), n, mask,
+                               out);
+#endif
+}
+
 /*
  * Inline 24B key comparison -- avoids function-pointer overhead.
  * 24B = 3 x uint64_t XOR-OR.
@@ -64,7 +81,7 @@ fc_flow4_cmp(const struct fc_flow4_key *a, const struct fc_flow4_key *b)
 }
 
 FC_CACHE_GENERATE(flow4, FC_FLOW4_DEFAULT_PRESSURE_EMPTY_SLOTS,
-                   fc_flow4_hash_fn, fc_flow4_cmp)
+                   fc_flow4_hash_fn, fc_flow4_hash_n_fn, fc_flow4_cmp)
 
 #ifdef FC_ARCH_SUFFIX
 #include "fc_ops.h"
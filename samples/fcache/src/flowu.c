@@ -11,10 +11,34 @@
 #include "flowu_cache.h"
 #include "fc_cache_generate.h"
 
+/*
+ * 44B key: FC_HASH_AES (make FC_HASH=aes) selects the AES-round dual hash,
+ * which produces both halves in one pass; default is CRC32C.
+ */
 static inline union rix_hash_hash_u
 fc_flowu_hash_fn(const struct fc_flowu_key *key, uint32_t mask)
 {
+#if defined(FC_HASH_AES)
+    return rix_hash_hash_bytes_aes(key, sizeof(*key), mask);
+#else
     return rix_hash_hash_bytes_fast(key, sizeof(*key), mask);
+#endif
+}
+
+/*
+ * Batch form of fc_flowu_hash_fn for the bulk pipelines; the hash chains of
+ * RIX_HASH_N_LANES keys run interleaved.
+ */
+static inline void
+fc_flowu_hash_n_fn(const void * const *keys, unsigned n, uint32_t mask,
+                   union rix_hash_hash_u *out)
+{
+#if defined(FC_HASH_AES)
+    rix_hash_hash_bytes_aes_n(keys, sizeof(struct fc_flowu_key), n, mask, out);
+#else
+    rix_hash_hash_bytes_n_fast(keys, sizeof(struct fc_flowu_key), n, mask,
+                               out);
+#endif
 }
 
 static inline int
@@ -24,7 +48,7 @@ fc_flowu_cmp(const struct fc_flowu_key *a, const struct fc_flowu_key *b)
 }
 
 FC_CACHE_GENERATE(flowu, FC_FLOWU_DEFAULT_PRESSURE_EMPTY_SLOTS,
-                   fc_flowu_hash_fn, fc_flowu_cmp)
+                   fc_flowu_hash_fn, fc_flowu_hash_n_fn, fc_flowu_cmp)
 
 #ifdef FC_ARCH_SUFFIX
 #include "fc_ops.h"
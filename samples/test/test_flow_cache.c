@@ -105,6 +105,17 @@ make_keyu_v6(unsigned i)
            if ((results)[_i].entry_idx != 0u) _hits++; \
        _hits; })
 
+/* compact_step callback: owner[] follows each index exchange. */
+static void
+compact_moved_cb(uint32_t from_idx, uint32_t to_idx, void *arg)
+{
+    uint32_t *owner = arg;
+    uint32_t tmp = owner[from_idx];
+
+    owner[from_idx] = owner[to_idx];
+    owner[to_idx] = tmp;
+}
+
 #define DEFINE_TESTS(PREFIX, KEY_T, RESULT_T, ENTRY_T, CACHE_T, CONFIG_T, STATS_T, MAKE_KEY) \
 \
 static void \
@@ -250,6 +261,435 @@ test_##PREFIX##_duplicate_miss_batch(void) \
               results[0].entry_idx, results[1].entry_idx); \
 } \
 \
+/* Repeated flows in one batch: one insert per flow, every duplicate gets \
+ * its flow's entry; beyond the coalescing window results stay exact. */ \
+static void \
+test_##PREFIX##_findadd_coalesce(void) \
+{ \
+    enum { NB_BK = 16u, MAX_ENTRIES = 128u, NB_KEYS = 64u, NB_FLOWS = 6u, \
+           NB_WIDE = 40u }; \
+    static struct rix_hash_bucket_s buckets[NB_BK]; \
+    static ENTRY_T pool[MAX_ENTRIES]; \
+    CACHE_T fc; \
+    STATS_T st; \
+    KEY_T keys[NB_KEYS + 2u * NB_WIDE]; \
+    RESULT_T results[NB_KEYS + 2u * NB_WIDE]; \
+    uint32_t flow_idx[NB_FLOWS]; \
+    unsigned flow_of[NB_KEYS]; \
+\
+    printf("[T] fc " #PREFIX " findadd_bulk coalesce\n"); \
+    fc_##PREFIX##_cache_init(&fc, buckets, NB_BK, pool, MAX_ENTRIES, NULL); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        flow_of[i] = (i * 5u + i / 3u) % NB_FLOWS; \
+        keys[i] = MAKE_KEY(5000u + flow_of[i]); \
+    } \
+    for (unsigned round = 0; round < 2u; round++) { \
+        fc_##PREFIX##_cache_findadd_bulk(&fc, keys, NB_KEYS, 1u + round, \
+                                         results); \
+        for (unsigned f = 0; f < NB_FLOWS; f++) \
+            flow_idx[f] = 0u; \
+        for (unsigned i = 0; i < NB_KEYS; i++) { \
+            unsigned f = flow_of[i]; \
+\
+            if (results[i].entry_idx == 0u) \
+                FAILF("round %u key %u: no entry", round, i); \
+            if (flow_idx[f] == 0u) \
+                flow_idx[f] = results[i].entry_idx; \
+            else if (results[i].entry_idx != flow_idx[f]) \
+                FAILF("round %u key %u: flow %u at %u and %u", round, i, \
+                      f, flow_idx[f], results[i].entry_idx); \
+        } \
+        fc_##PREFIX##_cache_stats(&fc, &st); \
+        if (fc_##PREFIX##_cache_nb_entries(&fc) != NB_FLOWS || \
+            st.fills != NB_FLOWS) \
+            FAILF("round %u: nb_entries %u fills %" PRIu64, round, \
+                  fc_##PREFIX##_cache_nb_entries(&fc), st.fills); \
+        if (st.coalesced != (round + 1u) * (NB_KEYS - NB_FLOWS)) \
+            FAILF("round %u: coalesced %" PRIu64, round, st.coalesced); \
+        if (st.misses != NB_FLOWS || st.hits + st.misses != st.lookups) \
+            FAILF("round %u: hits %" PRIu64 " misses %" PRIu64 \
+                  " lookups %" PRIu64, round, st.hits, st.misses, \
+                  st.lookups); \
+    } \
+\
+    /* NB_WIDE flows, twice: the repeats fall outside the window */ \
+    for (unsigned i = 0; i < 2u * NB_WIDE; i++) \
+        keys[i] = MAKE_KEY(6000u + i % NB_WIDE); \
+    fc_##PREFIX##_cache_findadd_bulk(&fc, keys, 2u * NB_WIDE, 3u, results); \
+    for (unsigned i = 0; i < NB_WIDE; i++) \
+        if (results[i].entry_idx == 0u || \
+            results[i].entry_idx != results[i + NB_WIDE].entry_idx) \
+            FAILF("wide key %u: %u and %u", i, results[i].entry_idx, \
+                  results[i + NB_WIDE].entry_idx); \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (fc_##PREFIX##_cache_nb_entries(&fc) != NB_FLOWS + NB_WIDE) \
+        FAILF("wide: nb_entries %u", fc_##PREFIX##_cache_nb_entries(&fc)); \
+    if (st.coalesced != 2u * (NB_KEYS - NB_FLOWS)) \
+        FAILF("wide: coalesced %" PRIu64, st.coalesced); \
+} \
+\
+/* Split-phase lookup: two caches interleaved issue/issue/complete/complete \
+ * give the same results as find_bulk / findadd_bulk on a twin cache. */ \
+static void \
+test_##PREFIX##_lookup_split(void) \
+{ \
+    enum { NB_BK = 32u, MAX_ENTRIES = 256u, NB_KEYS = 48u, NB_OLD = 24u }; \
+    static struct rix_hash_bucket_s bk_a[NB_BK], bk_b[NB_BK], bk_r[NB_BK]; \
+    static ENTRY_T pool_a[MAX_ENTRIES], pool_b[MAX_ENTRIES], \
+        pool_r[MAX_ENTRIES]; \
+    static struct fc_##PREFIX##_lookup lk_a, lk_b; \
+    CACHE_T fa, fb, fr; \
+    STATS_T sa, sr; \
+    KEY_T keys[NB_KEYS]; \
+    RESULT_T ra[NB_KEYS], rb[NB_KEYS], rr[NB_KEYS]; \
+\
+    printf("[T] fc " #PREFIX " lookup_issue/lookup_complete\n"); \
+    fc_##PREFIX##_cache_init(&fa, bk_a, NB_BK, pool_a, MAX_ENTRIES, NULL); \
+    fc_##PREFIX##_cache_init(&fb, bk_b, NB_BK, pool_b, MAX_ENTRIES, NULL); \
+    fc_##PREFIX##_cache_init(&fr, bk_r, NB_BK, pool_r, MAX_ENTRIES, NULL); \
+    for (unsigned i = 0; i < NB_OLD; i++) \
+        keys[i] = MAKE_KEY(7000u + i); \
+    fc_##PREFIX##_cache_findadd_bulk(&fa, keys, NB_OLD, 1u, ra); \
+    fc_##PREFIX##_cache_findadd_bulk(&fr, keys, NB_OLD, 1u, rr); \
+    /* half known, half new, one repeat */ \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        keys[i] = MAKE_KEY(7000u + NB_OLD / 2u + i); \
+    keys[NB_KEYS - 1u] = keys[NB_KEYS - 2u]; \
+\
+    /* no FC_LOOKUP_ADD: find_bulk semantics, nothing inserted */ \
+    fc_##PREFIX##_cache_lookup_issue(&fa, &lk_a, keys, NB_KEYS, 0u); \
+    fc_##PREFIX##_cache_lookup_issue(&fb, &lk_b, keys, NB_KEYS, 0u); \
+    fc_##PREFIX##_cache_lookup_complete(&fa, &lk_a, 2u, ra); \
+    fc_##PREFIX##_cache_lookup_complete(&fb, &lk_b, 2u, rb); \
+    fc_##PREFIX##_cache_find_bulk(&fr, keys, NB_KEYS, 2u, rr); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        if (ra[i].entry_idx != rr[i].entry_idx) \
+            FAILF("find key %u: %u vs %u", i, ra[i].entry_idx, \
+                  rr[i].entry_idx); \
+        if (rb[i].entry_idx != 0u) \
+            FAILF("find empty cache key %u: %u", i, rb[i].entry_idx); \
+    } \
+    if (fc_##PREFIX##_cache_nb_entries(&fa) != NB_OLD || \
+        fc_##PREFIX##_cache_nb_entries(&fb) != 0u) \
+        FAIL("find inserted entries"); \
+\
+    /* FC_LOOKUP_ADD: findadd_bulk semantics */ \
+    fc_##PREFIX##_cache_lookup_issue(&fa, &lk_a, keys, NB_KEYS, \
+                                     FC_LOOKUP_ADD); \
+    fc_##PREFIX##_cache_lookup_issue(&fb, &lk_b, keys, NB_KEYS, \
+                                     FC_LOOKUP_ADD); \
+    fc_##PREFIX##_cache_lookup_complete(&fa, &lk_a, 3u, ra); \
+    fc_##PREFIX##_cache_lookup_complete(&fb, &lk_b, 3u, rb); \
+    fc_##PREFIX##_cache_findadd_bulk(&fr, keys, NB_KEYS, 3u, rr); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        if (ra[i].entry_idx == 0u || ra[i].entry_idx != rr[i].entry_idx) \
+            FAILF("findadd key %u: %u vs %u", i, ra[i].entry_idx, \
+                  rr[i].entry_idx); \
+        if (rb[i].entry_idx == 0u) \
+            FAILF("findadd empty cache key %u: no entry", i); \
+    } \
+    if (ra[NB_KEYS - 1u].entry_idx != ra[NB_KEYS - 2u].entry_idx) \
+        FAIL("repeat key not coalesced"); \
+    if (fc_##PREFIX##_cache_nb_entries(&fa) != \
+        fc_##PREFIX##_cache_nb_entries(&fr) || \
+        fc_##PREFIX##_cache_nb_entries(&fb) != NB_KEYS - 1u) \
+        FAILF("nb_entries %u/%u/%u", fc_##PREFIX##_cache_nb_entries(&fa), \
+              fc_##PREFIX##_cache_nb_entries(&fb), \
+              fc_##PREFIX##_cache_nb_entries(&fr)); \
+\
+    fc_##PREFIX##_cache_stats(&fa, &sa); \
+    fc_##PREFIX##_cache_stats(&fr, &sr); \
+    if (sa.lookups != sr.lookups || sa.hits != sr.hits || \
+        sa.misses != sr.misses || sa.fills != sr.fills || \
+        sa.coalesced != sr.coalesced) \
+        FAILF("stats lookups %" PRIu64 "/%" PRIu64 " hits %" PRIu64 \
+              "/%" PRIu64 " fills %" PRIu64 "/%" PRIu64, sa.lookups, \
+              sr.lookups, sa.hits, sr.hits, sa.fills, sr.fills); \
+\
+    /* an oversized batch is cut at FC_LOOKUP_MAX_KEYS */ \
+    { \
+        static KEY_T big[FC_LOOKUP_MAX_KEYS + 8u]; \
+        static RESULT_T big_r[FC_LOOKUP_MAX_KEYS + 8u]; \
+\
+        for (unsigned i = 0; i < FC_LOOKUP_MAX_KEYS + 8u; i++) \
+            big[i] = MAKE_KEY(7000u + i); \
+        fc_##PREFIX##_cache_stats(&fa, &sa); \
+        fc_##PREFIX##_cache_lookup_issue(&fa, &lk_a, big, \
+                                         FC_LOOKUP_MAX_KEYS + 8u, 0u); \
+        if (lk_a.nb_keys != FC_LOOKUP_MAX_KEYS) \
+            FAILF("oversized issue took %u keys", lk_a.nb_keys); \
+        fc_##PREFIX##_cache_lookup_complete(&fa, &lk_a, 4u, big_r); \
+        fc_##PREFIX##_cache_stats(&fa, &sr); \
+        if (sr.lookups - sa.lookups != FC_LOOKUP_MAX_KEYS) \
+            FAILF("oversized issue counted %" PRIu64 " lookups", \
+                  sr.lookups - sa.lookups); \
+        if (big_r[0].entry_idx == 0u) \
+            FAIL("oversized issue missed a known key"); \
+    } \
+} \
+\
+/* Caller-supplied hashes: a software RSS hash of a per-key tuple stands \
+ * in for the NIC hash; two keys share one hash on purpose. */ \
+static void \
+test_##PREFIX##_hashed(void) \
+{ \
+    enum { NB_BK = 32u, MAX_ENTRIES = 256u, NB_KEYS = 40u }; \
+    static const uint8_t rss_key[RIX_HASH_RSS_KEY_LEN] = \
+        RIX_HASH_RSS_KEY_DEFAULT; \
+    static struct rix_hash_bucket_s buckets[NB_BK]; \
+    static ENTRY_T pool[MAX_ENTRIES]; \
+    CACHE_T fc; \
+    STATS_T st; \
+    KEY_T keys[NB_KEYS], other[NB_KEYS]; \
+    uint32_t hashes[NB_KEYS]; \
+    RESULT_T results[NB_KEYS], again[NB_KEYS]; \
+    uint32_t del[NB_KEYS / 2u]; \
+    uint32_t tuple[3] = { 0u, 0x0a000001u, 0x04d20050u }; \
+\
+    printf("[T] fc " #PREFIX " find(add)_bulk_hashed\n"); \
+    fc_##PREFIX##_cache_init(&fc, buckets, NB_BK, pool, MAX_ENTRIES, NULL); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        keys[i] = MAKE_KEY(8000u + i); \
+        other[i] = MAKE_KEY(9000u + i); \
+        tuple[0] = 8000u + i; \
+        hashes[i] = rix_hash_toeplitz(rss_key, tuple, sizeof(tuple)); \
+    } \
+    hashes[1] = hashes[0]; \
+    keys[NB_KEYS - 1u] = keys[NB_KEYS - 2u]; \
+    hashes[NB_KEYS - 1u] = hashes[NB_KEYS - 2u]; \
+\
+    fc_##PREFIX##_cache_findadd_bulk_hashed(&fc, keys, hashes, NB_KEYS, 1u, \
+                                            results); \
+    if (fc_##PREFIX##_cache_nb_entries(&fc) != NB_KEYS - 1u) \
+        FAILF("nb_entries %u", fc_##PREFIX##_cache_nb_entries(&fc)); \
+    if (results[0].entry_idx == results[1].entry_idx) \
+        FAIL("hash-sharing keys got one entry"); \
+    if (results[NB_KEYS - 1u].entry_idx != results[NB_KEYS - 2u].entry_idx) \
+        FAIL("repeat key got two entries"); \
+    fc_##PREFIX##_cache_findadd_bulk_hashed(&fc, keys, hashes, NB_KEYS, 2u, \
+                                            again); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (results[i].entry_idx == 0u || \
+            again[i].entry_idx != results[i].entry_idx) \
+            FAILF("findadd key %u: %u then %u", i, results[i].entry_idx, \
+                  again[i].entry_idx); \
+    fc_##PREFIX##_cache_find_bulk_hashed(&fc, keys, hashes, NB_KEYS, 3u, \
+                                         again); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (again[i].entry_idx != results[i].entry_idx) \
+            FAILF("find key %u: %u vs %u", i, again[i].entry_idx, \
+                  results[i].entry_idx); \
+    /* same hashes, other keys: the key compare rejects every one */ \
+    fc_##PREFIX##_cache_find_bulk_hashed(&fc, other, hashes, NB_KEYS, 3u, \
+                                         again); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (again[i].entry_idx != 0u) \
+            FAILF("other key %u hit %u", i, again[i].entry_idx); \
+\
+    /* removal by index only needs the hash kept in the entry */ \
+    for (unsigned i = 0; i < NB_KEYS / 2u; i++) \
+        del[i] = results[i].entry_idx; \
+    fc_##PREFIX##_cache_del_idx_bulk(&fc, del, NB_KEYS / 2u); \
+    fc_##PREFIX##_cache_find_bulk_hashed(&fc, keys, hashes, NB_KEYS, 4u, \
+                                         again); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (again[i].entry_idx != (i < NB_KEYS / 2u ? \
+                                   0u : results[i].entry_idx)) \
+            FAILF("after del key %u: %u", i, again[i].entry_idx); \
+\
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (st.lookups != 5u * NB_KEYS || st.hits + st.misses != st.lookups || \
+        st.coalesced != 2u) \
+        FAILF("stats lookups %" PRIu64 " hits %" PRIu64 " misses %" PRIu64 \
+              " coalesced %" PRIu64, st.lookups, st.hits, st.misses, \
+              st.coalesced); \
+} \
+\
+static int \
+test_##PREFIX##_in_bk0(const ENTRY_T *pool, uint32_t idx, uint32_t hash, \
+                       uint32_t mask) \
+{ \
+    union rix_hash_hash_u h = rix_hash_hash_from_u32(hash, mask); \
+\
+    return (pool[idx - 1u].cur_hash & mask) == (h.val32[0] & mask); \
+} \
+\
+/* A NIC-hashed cache: split-phase lookups take the hashes too, and \
+ * promote finds the primary bucket without rehashing any key. */ \
+static void \
+test_##PREFIX##_hashed_promote(void) \
+{ \
+    enum { NB_BK = 8u, MAX_ENTRIES = 128u, NB_KEYS = 112u }; \
+    static struct rix_hash_bucket_s buckets[NB_BK]; \
+    static ENTRY_T pool[MAX_ENTRIES]; \
+    static struct fc_##PREFIX##_lookup lk; \
+    CACHE_T fc; \
+    STATS_T st; \
+    KEY_T keys[NB_KEYS]; \
+    uint32_t hashes[NB_KEYS]; \
+    RESULT_T added[NB_KEYS], results[NB_KEYS]; \
+    uint64_t bk1_before, bk1_first; \
+    unsigned moved; \
+    int home[NB_KEYS]; \
+\
+    printf("[T] fc " #PREFIX " lookup_issue_hashed + promote\n"); \
+    fc_##PREFIX##_cache_init(&fc, buckets, NB_BK, pool, MAX_ENTRIES, NULL); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        keys[i] = MAKE_KEY(12000u + i); \
+        hashes[i] = (i + 1u) * 0x9E3779B1u; \
+    } \
+    /* half through findadd_bulk_hashed, half through the split phase */ \
+    fc_##PREFIX##_cache_findadd_bulk_hashed(&fc, keys, hashes, \
+                                            NB_KEYS / 2u, 1u, added); \
+    fc_##PREFIX##_cache_lookup_issue_hashed(&fc, &lk, keys, hashes, \
+                                            NB_KEYS, FC_LOOKUP_ADD); \
+    fc_##PREFIX##_cache_lookup_complete(&fc, &lk, 1u, results); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        if (results[i].entry_idx == 0u) \
+            FAILF("issue_hashed add key %u: no entry", i); \
+        if (i < NB_KEYS / 2u && results[i].entry_idx != added[i].entry_idx) \
+            FAILF("issue_hashed key %u: %u vs %u", i, \
+                  results[i].entry_idx, added[i].entry_idx); \
+        added[i] = results[i]; \
+    } \
+    fc_##PREFIX##_cache_lookup_issue_hashed(&fc, &lk, keys, hashes, \
+                                            NB_KEYS, 0u); \
+    fc_##PREFIX##_cache_lookup_complete(&fc, &lk, 2u, results); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (results[i].entry_idx != added[i].entry_idx) \
+            FAILF("issue_hashed find key %u: %u vs %u", i, \
+                  results[i].entry_idx, added[i].entry_idx); \
+\
+    /* count alternate-bucket hits, then send those entries home */ \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    bk1_before = st.hits_bk1; \
+    fc_##PREFIX##_cache_find_bulk_hashed(&fc, keys, hashes, NB_KEYS, 3u, \
+                                         results); \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    bk1_first = st.hits_bk1 - bk1_before; \
+    if (bk1_first == 0u) \
+        FAIL("88% fill left no entry in its alternate bucket"); \
+    /* make room in the primaries, keeping the displaced entries */ \
+    for (unsigned i = 0; i < NB_KEYS; i += 4u) { \
+        if (pool[added[i].entry_idx - 1u].bk1_hits != 0u) \
+            continue; \
+        if (!fc_##PREFIX##_cache_del_idx(&fc, added[i].entry_idx)) \
+            FAILF("del key %u failed", i); \
+        added[i].entry_idx = 0u; \
+    } \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        home[i] = added[i].entry_idx != 0u && \
+            test_##PREFIX##_in_bk0(pool, added[i].entry_idx, hashes[i], \
+                                   NB_BK - 1u); \
+    moved = fc_##PREFIX##_cache_promote(&fc, 0u, NB_BK, 1u); \
+    if (moved == 0u) \
+        FAILF("promote moved nothing (%" PRIu64 " bk1 hits)", bk1_first); \
+    /* nothing living in its primary bucket was pushed out */ \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (home[i] && \
+            !test_##PREFIX##_in_bk0(pool, added[i].entry_idx, hashes[i], \
+                                    NB_BK - 1u)) \
+            FAILF("promote demoted key %u", i); \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    bk1_before = st.hits_bk1; \
+    fc_##PREFIX##_cache_find_bulk_hashed(&fc, keys, hashes, NB_KEYS, 4u, \
+                                         results); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        if (results[i].entry_idx != added[i].entry_idx) \
+            FAILF("after promote key %u: %u vs %u", i, \
+                  results[i].entry_idx, added[i].entry_idx); \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (st.hits_bk1 - bk1_before >= bk1_first || st.promotions != moved) \
+        FAILF("bk1 hits %" PRIu64 " -> %" PRIu64 ", promotions %" PRIu64 \
+              " vs %u", bk1_first, st.hits_bk1 - bk1_before, \
+              st.promotions, moved); \
+} \
+\
+/* entry_idx hints: good hints skip the buckets, bad ones (none, out of \
+ * range, another flow's entry, a freed entry) fall back to find_bulk. */ \
+static void \
+test_##PREFIX##_find_by_hint(void) \
+{ \
+    enum { NB_BK = 16u, MAX_ENTRIES = 64u, NB_KEYS = 24u }; \
+    static struct rix_hash_bucket_s buckets[NB_BK]; \
+    static ENTRY_T pool[MAX_ENTRIES]; \
+    CACHE_T fc; \
+    STATS_T st; \
+    KEY_T keys[NB_KEYS]; \
+    uint32_t hints[NB_KEYS], gone; \
+    RESULT_T added[NB_KEYS], results[NB_KEYS]; \
+\
+    printf("[T] fc " #PREFIX " find_by_hint_bulk\n"); \
+    fc_##PREFIX##_cache_init(&fc, buckets, NB_BK, pool, MAX_ENTRIES, NULL); \
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        keys[i] = MAKE_KEY(10000u + i); \
+    fc_##PREFIX##_cache_findadd_bulk(&fc, keys, NB_KEYS, 1u, added); \
+\
+    for (unsigned i = 0; i < NB_KEYS; i++) \
+        hints[i] = added[i].entry_idx; \
+    fc_##PREFIX##_cache_find_by_hint_bulk(&fc, keys, hints, NB_KEYS, 2u, \
+                                          results); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        if (results[i].entry_idx != added[i].entry_idx) \
+            FAILF("good hint key %u: %u vs %u", i, results[i].entry_idx, \
+                  added[i].entry_idx); \
+        if (pool[added[i].entry_idx - 1u].last_ts != 2u) \
+            FAILF("good hint key %u: last_ts not updated", i); \
+    } \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (st.hint_hits != NB_KEYS || st.lookups != 2u * NB_KEYS || \
+        st.hits != NB_KEYS) \
+        FAILF("good hints: hint_hits %" PRIu64 " lookups %" PRIu64, \
+              st.hint_hits, st.lookups); \
+\
+    gone = added[5].entry_idx; \
+    fc_##PREFIX##_cache_del_idx_bulk(&fc, &gone, 1u); \
+    hints[0] = 0u; \
+    hints[1] = MAX_ENTRIES + 1u; \
+    hints[2] = added[3].entry_idx; \
+    hints[4] = gone; \
+    keys[6] = MAKE_KEY(20000u); \
+    hints[7] = gone; \
+    fc_##PREFIX##_cache_find_by_hint_bulk(&fc, keys, hints, NB_KEYS, 3u, \
+                                          results); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        uint32_t want = (i == 5u || i == 6u) ? 0u : added[i].entry_idx; \
+        if (results[i].entry_idx != want) \
+            FAILF("bad hint key %u: %u want %u", i, results[i].entry_idx, \
+                  want); \
+    } \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    /* keys 0-2 and 4-7 fall back; 5 and 6 miss (+ the initial fills) */ \
+    if (st.hint_hits != 2u * NB_KEYS - 7u || st.lookups != 3u * NB_KEYS || \
+        st.hits + st.misses != st.lookups || st.misses != NB_KEYS + 2u) \
+        FAILF("bad hints: hint_hits %" PRIu64 " misses %" PRIu64, \
+              st.hint_hits, st.misses); \
+\
+    /* a NIC-hashed cache: failed hints fall back with their hashes */ \
+    { \
+        uint32_t hashes[NB_KEYS]; \
+\
+        fc_##PREFIX##_cache_flush(&fc); \
+        for (unsigned i = 0; i < NB_KEYS; i++) { \
+            keys[i] = MAKE_KEY(11000u + i); \
+            hashes[i] = (i + 1u) * 0x9E3779B1u; \
+        } \
+        fc_##PREFIX##_cache_findadd_bulk_hashed(&fc, keys, hashes, \
+                                                NB_KEYS, 4u, added); \
+        for (unsigned i = 0; i < NB_KEYS; i++) \
+            hints[i] = (i % 3u == 0u) ? 0u : added[i].entry_idx; \
+        hints[1] = added[2].entry_idx; \
+        fc_##PREFIX##_cache_find_by_hint_bulk_hashed(&fc, keys, hashes, \
+                                                     hints, NB_KEYS, 5u, \
+                                                     results); \
+        for (unsigned i = 0; i < NB_KEYS; i++) \
+            if (added[i].entry_idx == 0u || \
+                results[i].entry_idx != added[i].entry_idx) \
+                FAILF("hashed hint key %u: %u vs %u", i, \
+                      results[i].entry_idx, added[i].entry_idx); \
+    } \
+} \
+\
 static void \
 test_##PREFIX##_flush_and_invalid_remove(void) \
 { \
@@ -946,6 +1386,354 @@ test_##PREFIX##_findadd_single(void) \
         FAILF("findadd single hit: idx=%u expected %u", idx2, idx1); \
     if (fc_##PREFIX##_cache_nb_entries(&fc) != 1u) \
         FAIL("findadd single hit: nb_entries should stay 1"); \
+} \
+\
+/*--- compact_step ---*/ \
+/* owner[idx] is the key number stored at idx (+1; 0 = none).  Every live \
+ * key must be found at the index owner[] says, inside [1, nb_entries]. */ \
+static void \
+test_##PREFIX##_compact_check(CACHE_T *fc, const uint32_t *owner, \
+                              unsigned max_entries, const char *tag) \
+{ \
+    unsigned nb = fc_##PREFIX##_cache_nb_entries(fc); \
+    unsigned live = 0u; \
+\
+    for (uint32_t idx = 1u; idx <= max_entries; idx++) { \
+        KEY_T key; \
+        uint32_t got; \
+\
+        if (owner[idx] == 0u) \
+            continue; \
+        live++; \
+        if (idx > nb) \
+            FAILF("%s: idx %u above nb_entries %u", tag, idx, nb); \
+        key = MAKE_KEY(owner[idx] - 1u); \
+        got = fc_##PREFIX##_cache_find(fc, &key, 0u); \
+        if (got != idx) \
+            FAILF("%s: key %u found at %u, owner says %u", \
+                  tag, owner[idx] - 1u, got, idx); \
+    } \
+    if (live != nb) \
+        FAILF("%s: %u owned entries, nb_entries %u", tag, live, nb); \
+} \
+\
+static void \
+test_##PREFIX##_compact(void) \
+{ \
+    enum { NB_BK = 256u, MAX_ENTRIES = 512u, NB_KEYS = 400u, \
+           KEY_BASE = 27000u }; \
+    static struct rix_hash_bucket_s buckets[NB_BK]; \
+    static ENTRY_T pool[MAX_ENTRIES]; \
+    static uint32_t owner[MAX_ENTRIES + 1u]; \
+    CACHE_T fc; \
+    STATS_T st; \
+    unsigned steps; \
+    uint32_t prev; \
+\
+    printf("[T] fc " #PREFIX " compact_step\n"); \
+    fc_##PREFIX##_cache_init(&fc, buckets, NB_BK, pool, MAX_ENTRIES, NULL); \
+    memset(owner, 0, sizeof(owner)); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        KEY_T key = MAKE_KEY(KEY_BASE + i); \
+        uint32_t idx = fc_##PREFIX##_cache_findadd(&fc, &key, 10u); \
+\
+        if (idx == 0u) \
+            FAILF("fill key %u failed", i); \
+        owner[idx] = KEY_BASE + i + 1u; \
+    } \
+    /* scatter: keep every third key */ \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        KEY_T key = MAKE_KEY(KEY_BASE + i); \
+        uint32_t idx; \
+\
+        if (i % 3u == 0u) \
+            continue; \
+        idx = fc_##PREFIX##_cache_find(&fc, &key, 0u); \
+        if (idx == 0u || !fc_##PREFIX##_cache_del_idx(&fc, idx)) \
+            FAILF("scatter: del key %u failed", i); \
+        owner[idx] = 0u; \
+    } \
+\
+    /* dense pass, with churn between the steps */ \
+    steps = 0u; \
+    while (fc_##PREFIX##_cache_compact_step(&fc, 8u, 0u, compact_moved_cb, \
+                                            owner)) { \
+        KEY_T key = MAKE_KEY(KEY_BASE + NB_KEYS + steps); \
+        uint32_t idx = fc_##PREFIX##_cache_findadd(&fc, &key, 20u); \
+\
+        if (idx == 0u) \
+            FAILF("churn insert %u failed", steps); \
+        owner[idx] = KEY_BASE + NB_KEYS + steps + 1u; \
+        if (steps % 4u == 3u) { \
+            if (!fc_##PREFIX##_cache_del_idx(&fc, idx)) \
+                FAILF("churn del %u failed", steps); \
+            owner[idx] = 0u; \
+        } \
+        if (++steps > 4096u) \
+            FAIL("dense pass does not finish"); \
+    } \
+    if (steps == 0u) \
+        FAIL("dense pass finished in one call"); \
+    /* churn may leave a few holes; a quiet pass must close them */ \
+    while (fc_##PREFIX##_cache_compact_step(&fc, 8u, 0u, compact_moved_cb, \
+                                            owner)) \
+        ; \
+    test_##PREFIX##_compact_check(&fc, owner, MAX_ENTRIES, "dense"); \
+\
+    /* bucket order: walking the buckets must yield 1, 2, 3, ... */ \
+    while (fc_##PREFIX##_cache_compact_step(&fc, 8u, \
+                                            FC_COMPACT_BUCKET_ORDER, \
+                                            compact_moved_cb, owner)) \
+        ; \
+    test_##PREFIX##_compact_check(&fc, owner, MAX_ENTRIES, "order"); \
+    prev = 0u; \
+    for (unsigned b = 0; b < NB_BK; b++) { \
+        for (unsigned s = 0; s < RIX_HASH_BUCKET_ENTRY_SZ; s++) { \
+            uint32_t idx = fc.buckets[b].idx[s]; \
+\
+            if (idx == 0u) \
+                continue; \
+            if (idx != prev + 1u) \
+                FAILF("order: bk %u slot %u holds %u after %u", \
+                      b, s, idx, prev); \
+            prev = idx; \
+        } \
+    } \
+\
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (st.compact_passes < 3u || st.compact_moves == 0u) \
+        FAILF("stats: passes=%" PRIu64 " moves=%" PRIu64, \
+              st.compact_passes, st.compact_moves); \
+\
+    /* flush drops a pass in progress */ \
+    fc_##PREFIX##_cache_compact_step(&fc, 1u, 0u, NULL, NULL); \
+    fc_##PREFIX##_cache_flush(&fc); \
+    if (fc_##PREFIX##_cache_compact_step(&fc, 64u, 0u, NULL, NULL) != 0) \
+        FAIL("compact on an empty cache must finish at once"); \
+} \
+\
+/*--- promote ---*/ \
+static uint64_t \
+test_##PREFIX##_promote_lookup(CACHE_T *fc, const uint32_t *idx_of, \
+                               unsigned nb_keys, uint64_t now) \
+{ \
+    STATS_T st; \
+    uint64_t before; \
+\
+    fc_##PREFIX##_cache_stats(fc, &st); \
+    before = st.hits_bk1; \
+    for (unsigned i = 0; i < nb_keys; i++) { \
+        KEY_T key = MAKE_KEY(i); \
+        uint32_t got; \
+\
+        if (idx_of[i] == 0u) \
+            continue; \
+        got = fc_##PREFIX##_cache_find(fc, &key, now); \
+        if (got != idx_of[i]) \
+            FAILF("promote: key %u found at %u, expected %u", \
+                  i, got, idx_of[i]); \
+    } \
+    fc_##PREFIX##_cache_stats(fc, &st); \
+    return st.hits_bk1 - before; \
+} \
+\
+static void \
+test_##PREFIX##_promote(void) \
+{ \
+    enum { NB_BK = 16u, MAX_ENTRIES = 256u, NB_KEYS = 240u }; \
+    static struct rix_hash_bucket_s buckets[NB_BK]; \
+    static ENTRY_T pool[MAX_ENTRIES]; \
+    static uint32_t idx_of[NB_KEYS]; \
+    CONFIG_T cfg; \
+    CACHE_T fc; \
+    STATS_T st; \
+    uint64_t bk1_full, bk1_maint, bk1_promoted; \
+    unsigned moved, live = 0u; \
+\
+    printf("[T] fc " #PREFIX " promote\n"); \
+    memset(&cfg, 0, sizeof(cfg)); \
+    cfg.timeout_tsc = UINT64_C(1000000); \
+    cfg.promote_hits = 3u; \
+    fc_##PREFIX##_cache_init(&fc, buckets, NB_BK, pool, MAX_ENTRIES, &cfg); \
+    for (unsigned i = 0; i < NB_KEYS; i++) { \
+        KEY_T key = MAKE_KEY(i); \
+\
+        idx_of[i] = fc_##PREFIX##_cache_findadd(&fc, &key, 10u); \
+        if (idx_of[i] != 0u) \
+            live++; \
+    } \
+    bk1_full = test_##PREFIX##_promote_lookup(&fc, idx_of, NB_KEYS, 20u); \
+    if (bk1_full == 0u) \
+        FAIL("promote: a full table has no alternate-bucket hit"); \
+    /* open room in the primary buckets */ \
+    for (unsigned i = 0; i < NB_KEYS; i += 3u) { \
+        if (idx_of[i] == 0u) \
+            continue; \
+        if (!fc_##PREFIX##_cache_del_idx(&fc, idx_of[i])) \
+            FAILF("promote: del key %u failed", i); \
+        idx_of[i] = 0u; \
+        live--; \
+    } \
+\
+    /* two hits each are below promote_hits: maintain leaves them be */ \
+    test_##PREFIX##_promote_lookup(&fc, idx_of, NB_KEYS, 30u); \
+    fc_##PREFIX##_cache_maintain(&fc, 0u, NB_BK, 40u); \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (st.promotions != 0u) \
+        FAILF("promote: maintain promoted %" PRIu64 " cold entries", \
+              st.promotions); \
+    bk1_maint = test_##PREFIX##_promote_lookup(&fc, idx_of, NB_KEYS, 50u); \
+    if (bk1_maint == 0u) \
+        FAIL("promote: deletes left no alternate-bucket hit"); \
+    fc_##PREFIX##_cache_maintain(&fc, 0u, NB_BK, 60u); \
+    fc_##PREFIX##_cache_stats(&fc, &st); \
+    if (st.promotions == 0u || st.maint_evictions != 0u) \
+        FAILF("promote: maintain promotions=%" PRIu64 " evictions=%" PRIu64, \
+              st.promotions, st.maint_evictions); \
+    bk1_promoted = test_##PREFIX##_promote_lookup(&fc, idx_of, NB_KEYS, 70u); \
+    if (bk1_promoted >= bk1_maint) \
+        FAILF("promote: bk1 hits %" PRIu64 " -> %" PRIu64, \
+              bk1_maint, bk1_promoted); \
+\
+    /* explicit passes with min_hits 0 take every displaced entry they \
+     * can; each move sends at least one entry home */ \
+    moved = 0u; \
+    for (unsigned pass = 0; ; pass++) { \
+        unsigned n = fc_##PREFIX##_cache_promote(&fc, 5u + pass, NB_BK, 0u); \
+\
+        if (n == 0u) \
+            break; \
+        moved += n; \
+        if (pass > NB_KEYS) \
+            FAIL("promote: passes never settle"); \
+    } \
+    if (test_##PREFIX##_promote_lookup(&fc, idx_of, NB_KEYS, 80u) + moved > \
+        bk1_promoted) \
+        FAILF("promote: %u moved, bk1 hits %" PRIu64 " before", \
+              moved, bk1_promoted); \
+    if (fc_##PREFIX##_cache_nb_entries(&fc) != live) \
+        FAILF("promote: nb_entries %u, expected %u", \
+              fc_##PREFIX##_cache_nb_entries(&fc), live); \
+} \
+\
+/*--- free_idx ---*/ \
+/* The free-index array hands out entries in the same order as the \
+ * linked free list, so both caches must return identical indices. */ \
+static void \
+test_##PREFIX##_free_idx(void) \
+{ \
+    enum { NB_BK = 16u, MAX_ENTRIES = 128u, BATCH = 16u, ROUNDS = 12u, \
+           NB_FILL = MAX_ENTRIES + 4u }; \
+    static struct rix_hash_bucket_s bk_a[NB_BK], bk_b[NB_BK]; \
+    static ENTRY_T pool_a[MAX_ENTRIES], pool_b[MAX_ENTRIES]; \
+    static uint32_t free_idx[MAX_ENTRIES]; \
+    static uint32_t owner[MAX_ENTRIES + 1u]; \
+    KEY_T keys[BATCH]; \
+    RESULT_T res_a[BATCH], res_b[BATCH]; \
+    CONFIG_T cfg; \
+    CACHE_T fa, fb; \
+    STATS_T st; \
+    unsigned next_key = 0u; \
+\
+    printf("[T] fc " #PREFIX " free_idx\n"); \
+    memset(&cfg, 0, sizeof(cfg)); \
+    cfg.timeout_tsc = UINT64_C(1000000); \
+    fc_##PREFIX##_cache_init(&fa, bk_a, NB_BK, pool_a, MAX_ENTRIES, &cfg); \
+    cfg.free_idx = free_idx; \
+    fc_##PREFIX##_cache_init(&fb, bk_b, NB_BK, pool_b, MAX_ENTRIES, &cfg); \
+\
+    for (unsigned r = 0; r < ROUNDS; r++) { \
+        uint64_t now = 10u + r; \
+\
+        /* findadd_bulk: new keys, with an in-batch duplicate */ \
+        for (unsigned i = 0; i < BATCH; i++) \
+            keys[i] = MAKE_KEY(next_key + i % (BATCH - 2u)); \
+        fc_##PREFIX##_cache_findadd_bulk(&fa, keys, BATCH, now, res_a); \
+        fc_##PREFIX##_cache_findadd_bulk(&fb, keys, BATCH, now, res_b); \
+        for (unsigned i = 0; i < BATCH; i++) \
+            if (res_a[i].entry_idx != res_b[i].entry_idx) \
+                FAILF("round %u findadd %u: list %u, array %u", r, i, \
+                      res_a[i].entry_idx, res_b[i].entry_idx); \
+        next_key += BATCH - 2u; \
+\
+        /* add_bulk: keys not in the cache yet */ \
+        for (unsigned i = 0; i < BATCH / 2u; i++) \
+            keys[i] = MAKE_KEY(next_key + i); \
+        fc_##PREFIX##_cache_add_bulk(&fa, keys, BATCH / 2u, now, res_a); \
+        fc_##PREFIX##_cache_add_bulk(&fb, keys, BATCH / 2u, now, res_b); \
+        for (unsigned i = 0; i < BATCH / 2u; i++) \
+            if (res_a[i].entry_idx != res_b[i].entry_idx) \
+                FAILF("round %u add %u: list %u, array %u", r, i, \
+                      res_a[i].entry_idx, res_b[i].entry_idx); \
+        next_key += BATCH / 2u; \
+\
+        /* free a scattered few so the next round reuses them */ \
+        for (unsigned i = 0; i < BATCH / 2u; i += 3u) { \
+            if (res_a[i].entry_idx == 0u) \
+                continue; \
+            if (!fc_##PREFIX##_cache_del_idx(&fa, res_a[i].entry_idx) || \
+                !fc_##PREFIX##_cache_del_idx(&fb, res_b[i].entry_idx)) \
+                FAILF("round %u del %u failed", r, i); \
+        } \
+        if (fc_##PREFIX##_cache_nb_entries(&fa) != \
+            fc_##PREFIX##_cache_nb_entries(&fb)) \
+            FAILF("round %u: nb_entries %u vs %u", r, \
+                  fc_##PREFIX##_cache_nb_entries(&fa), \
+                  fc_##PREFIX##_cache_nb_entries(&fb)); \
+    } \
+\
+    /* expire all and refill to the last entry */ \
+    fc_##PREFIX##_cache_maintain(&fa, 0u, NB_BK, UINT64_C(10000000)); \
+    fc_##PREFIX##_cache_maintain(&fb, 0u, NB_BK, UINT64_C(10000000)); \
+    if (fc_##PREFIX##_cache_nb_entries(&fb) != 0u) \
+        FAILF("expire left %u", fc_##PREFIX##_cache_nb_entries(&fb)); \
+    for (unsigned i = 0; i < NB_FILL; i++) { \
+        KEY_T key = MAKE_KEY(100000u + i); \
+        uint32_t ia = fc_##PREFIX##_cache_add(&fa, &key, 20000000u); \
+        uint32_t ib = fc_##PREFIX##_cache_add(&fb, &key, 20000000u); \
+\
+        if (ia != ib) \
+            FAILF("refill %u: list %u, array %u", i, ia, ib); \
+    } \
+    fc_##PREFIX##_cache_stats(&fb, &st); \
+    if (fc_##PREFIX##_cache_nb_entries(&fb) == MAX_ENTRIES && \
+        st.fill_full == 0u) \
+        FAIL("exhausted pool did not count fill_full"); \
+\
+    /* compaction parks entries at the bottom of the array */ \
+    memset(owner, 0, sizeof(owner)); \
+    for (unsigned i = 0; i < NB_FILL; i++) { \
+        KEY_T key = MAKE_KEY(100000u + i); \
+        uint32_t idx = fc_##PREFIX##_cache_find(&fb, &key, 0u); \
+\
+        if (idx == 0u) \
+            continue; \
+        if (i % 3u != 0u) { \
+            if (!fc_##PREFIX##_cache_del_idx(&fb, idx)) \
+                FAILF("scatter del %u failed", i); \
+            continue; \
+        } \
+        owner[idx] = 100000u + i + 1u; \
+    } \
+    for (unsigned steps = 0; \
+         fc_##PREFIX##_cache_compact_step(&fb, 4u, 0u, compact_moved_cb, \
+                                          owner); steps++) { \
+        KEY_T key = MAKE_KEY(200000u + steps); \
+        uint32_t idx = fc_##PREFIX##_cache_findadd(&fb, &key, 20000001u); \
+\
+        if (idx == 0u) \
+            FAILF("churn insert %u failed", steps); \
+        owner[idx] = 200000u + steps + 1u; \
+        if (steps > 4096u) \
+            FAIL("dense pass does not finish"); \
+    } \
+    while (fc_##PREFIX##_cache_compact_step(&fb, 8u, 0u, compact_moved_cb, \
+                                            owner)) \
+        ; \
+    test_##PREFIX##_compact_check(&fb, owner, MAX_ENTRIES, "free_idx"); \
+    fc_##PREFIX##_cache_flush(&fb); \
+    if (fb.free_nb != MAX_ENTRIES || fb.free_lo != 0u) \
+        FAILF("after flush: free_nb %u free_lo %u", fb.free_nb, fb.free_lo); \
 }
 
 /*===========================================================================
@@ -1027,6 +1815,11 @@ test_flowu_v4_v6_coexist(void)
     test_##PREFIX##_pressure_relief(); \
     test_##PREFIX##_fill_miss_full_without_relief(); \
     test_##PREFIX##_duplicate_miss_batch(); \
+    test_##PREFIX##_findadd_coalesce(); \
+    test_##PREFIX##_lookup_split(); \
+    test_##PREFIX##_hashed(); \
+    test_##PREFIX##_hashed_promote(); \
+    test_##PREFIX##_find_by_hint(); \
     test_##PREFIX##_flush_and_invalid_remove(); \
     test_##PREFIX##_maintenance(); \
     test_##PREFIX##_timeout_boundary(); \
@@ -1040,7 +1833,10 @@ test_flowu_v4_v6_coexist(void)
     test_##PREFIX##_del_single(); \
     test_##PREFIX##_del_idx_bulk(); \
     test_##PREFIX##_walk(); \
-    test_##PREFIX##_findadd_single()
+    test_##PREFIX##_findadd_single(); \
+    test_##PREFIX##_compact(); \
+    test_##PREFIX##_promote(); \
+    test_##PREFIX##_free_idx()
 
 static unsigned
 parse_arch_opt(int *argc_p, char ***argv_p)
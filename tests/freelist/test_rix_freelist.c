@@ -0,0 +1,244 @@
+/* test_rix_freelist.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../../include/librix.h"
+
+#define FAIL(msg) do { \
+  fprintf(stderr, "FAIL %s:%d:%s: %s\n", __FILE__, __LINE__, __func__, (msg)); \
+  abort(); \
+} while (0)
+
+#define FAILF(fmt, ...) do { \
+  fprintf(stderr, "FAIL %s:%d:%s: " fmt "\n", __FILE__, __LINE__, __func__, __VA_ARGS__); \
+  abort(); \
+} while (0)
+
+struct obj {
+    unsigned owner;             /* 0 = free, else thread id + 1 */
+    unsigned payload;
+    RIX_SLIST_ENTRY(obj) free_link;
+};
+
+RIX_FREELIST_GENERATE_STATIC(objfl, struct obj, free_link.rsle_next)
+
+#define NB_OBJ 1024u
+
+static struct obj g_pool[NB_OBJ];
+static struct rix_freelist_s g_fl;
+
+/* Walk the (quiescent) list; every element must appear once. */
+static unsigned list_len(void){
+    static unsigned char seen[NB_OBJ + 1];
+    unsigned n = 0;
+    unsigned i = (unsigned)(u32)g_fl.head;
+
+    memset(seen, 0, sizeof(seen));
+    while (i != RIX_NIL) {
+        if (i > NB_OBJ) FAILF("bad index %u", i);
+        if (seen[i]++) FAILF("cycle at %u", i);
+        n++;
+        i = g_pool[i - 1].free_link.rsle_next;
+    }
+    return n;
+}
+
+/*===========================================================================
+ * Single-thread semantics
+ *===========================================================================*/
+static void test_basic(void){
+    struct obj *a, *b;
+    u32 idx[16];
+    unsigned n;
+
+    objfl_init(&g_fl, g_pool, 0);
+    if (!rix_freelist_empty(&g_fl)) FAIL("init 0 not empty");
+    if (objfl_pop(&g_fl, g_pool) != NULL) FAIL("pop empty");
+    if (objfl_pop_bulk(&g_fl, g_pool, idx, 4) != 0) FAIL("pop_bulk empty");
+
+    objfl_init(&g_fl, g_pool, 8);
+    if (list_len() != 8) FAIL("init 8");
+
+    /* LIFO, starting from index 1 */
+    a = objfl_pop(&g_fl, g_pool);
+    b = objfl_pop(&g_fl, g_pool);
+    if (a != &g_pool[0] || b != &g_pool[1]) FAIL("pop order");
+    objfl_push(&g_fl, g_pool, a);
+    if (objfl_pop(&g_fl, g_pool) != a) FAIL("push/pop LIFO");
+    objfl_push(&g_fl, g_pool, a);
+    objfl_push(&g_fl, g_pool, b);
+    if (list_len() != 8) FAIL("len after push");
+
+    /* bulk: burst semantics, idx[0] is the top */
+    n = objfl_pop_bulk(&g_fl, g_pool, idx, 5);
+    if (n != 5 || idx[0] != 2 || idx[1] != 1) FAILF("pop_bulk n=%u", n);
+    if (list_len() != 3) FAIL("len after pop_bulk");
+    n = objfl_pop_bulk(&g_fl, g_pool, idx + 5, 16);
+    if (n != 3 || !rix_freelist_empty(&g_fl)) FAILF("pop_bulk rest n=%u", n);
+    objfl_push_bulk(&g_fl, g_pool, idx, 8);
+    if (list_len() != 8) FAIL("len after push_bulk");
+    if (objfl_pop(&g_fl, g_pool) != &g_pool[idx[0] - 1]) FAIL("bulk top");
+    objfl_push_bulk(&g_fl, g_pool, idx, 0);
+    if (list_len() != 7) FAIL("push_bulk 0");
+}
+
+static void test_magazine(void){
+    struct rix_freelist_mag_s mag;
+    struct obj *o[NB_OBJ];
+    unsigned n = 0;
+
+    memset(&mag, 0, sizeof(mag));
+    objfl_init(&g_fl, g_pool, NB_OBJ);
+
+    /* first alloc refills one batch */
+    o[n++] = objfl_mag_alloc(&g_fl, &mag, g_pool);
+    if (mag.nb != RIX_FREELIST_MAG_BATCH - 1u) FAILF("refill nb=%u", mag.nb);
+    if (list_len() != NB_OBJ - RIX_FREELIST_MAG_BATCH) FAIL("refill len");
+
+    /* drain the whole pool through the magazine */
+    while ((o[n] = objfl_mag_alloc(&g_fl, &mag, g_pool)) != NULL)
+        n++;
+    if (n != NB_OBJ) FAILF("allocated %u", n);
+    for (unsigned i = 0; i < n; i++) {
+        if (o[i]->owner) FAILF("double alloc %u", i);
+        o[i]->owner = 1;
+    }
+
+    /* free everything: full magazines flush a batch each time */
+    for (unsigned i = 0; i < n; i++) {
+        o[i]->owner = 0;
+        objfl_mag_free(&g_fl, &mag, g_pool, o[i]);
+        if (mag.nb > RIX_FREELIST_MAG_SIZE) FAIL("magazine overflow");
+    }
+    if (list_len() + mag.nb != NB_OBJ) FAIL("free accounting");
+    objfl_mag_flush(&g_fl, &mag, g_pool);
+    if (mag.nb != 0 || list_len() != NB_OBJ) FAIL("flush");
+}
+
+/*===========================================================================
+ * Multi-thread: shared pool, no element handed out twice
+ *===========================================================================*/
+#define MT_THREADS 4u
+#define MT_OPS     200000u
+#define MT_HOLD    (NB_OBJ / MT_THREADS / 2u)
+
+struct mt_arg {
+    unsigned id;
+    unsigned seed;
+};
+
+static void take(struct obj *o, unsigned id){
+    unsigned prev = __atomic_exchange_n(&o->owner, id + 1u, __ATOMIC_RELAXED);
+    if (prev != 0) FAILF("obj %ld owned by %u and %u",
+                         (long)(o - g_pool), prev - 1u, id);
+}
+
+static void give(struct obj *o, unsigned id){
+    unsigned prev = __atomic_exchange_n(&o->owner, 0u, __ATOMIC_RELAXED);
+    if (prev != id + 1u) FAILF("obj %ld owner %u, freed by %u",
+                               (long)(o - g_pool), prev, id);
+}
+
+static void *mt_worker(void *p){
+    struct mt_arg *a = p;
+    struct rix_freelist_mag_s mag;
+    struct obj *held[MT_HOLD];
+    u32 idx[8];
+    unsigned nh = 0;
+
+    memset(&mag, 0, sizeof(mag));
+    for (unsigned op = 0; op < MT_OPS; op++) {
+        unsigned r = (a->seed = a->seed * 1103515245u + 12345u) >> 16;
+        int alloc = (nh == 0) || (nh < MT_HOLD && (r & 1u));
+        struct obj *o;
+
+        switch ((r >> 1) % 3u) {
+        case 0:                 /* magazine */
+            if (alloc) {
+                if ((o = objfl_mag_alloc(&g_fl, &mag, g_pool)) != NULL) {
+                    take(o, a->id);
+                    held[nh++] = o;
+                }
+            } else {
+                o = held[--nh];
+                give(o, a->id);
+                objfl_mag_free(&g_fl, &mag, g_pool, o);
+            }
+            break;
+        case 1:                 /* single */
+            if (alloc) {
+                if ((o = objfl_pop(&g_fl, g_pool)) != NULL) {
+                    take(o, a->id);
+                    held[nh++] = o;
+                }
+            } else {
+                o = held[--nh];
+                give(o, a->id);
+                objfl_push(&g_fl, g_pool, o);
+            }
+            break;
+        default: {              /* bulk */
+            unsigned k = 1u + (r >> 4) % 8u;
+            if (alloc) {
+                if (k > MT_HOLD - nh) k = MT_HOLD - nh;
+                k = objfl_pop_bulk(&g_fl, g_pool, idx, k);
+                for (unsigned i = 0; i < k; i++) {
+                    o = &g_pool[idx[i] - 1];
+                    take(o, a->id);
+                    held[nh++] = o;
+                }
+            } else {
+                if (k > nh) k = nh;
+                for (unsigned i = 0; i < k; i++) {
+                    o = held[--nh];
+                    give(o, a->id);
+                    idx[i] = (u32)(o - g_pool) + 1u;
+                }
+                objfl_push_bulk(&g_fl, g_pool, idx, k);
+            }
+            break;
+        }
+        }
+    }
+    while (nh) {
+        struct obj *o = held[--nh];
+        give(o, a->id);
+        objfl_push(&g_fl, g_pool, o);
+    }
+    objfl_mag_flush(&g_fl, &mag, g_pool);
+    return NULL;
+}
+
+static void test_threads(void){
+    pthread_t th[MT_THREADS];
+    struct mt_arg args[MT_THREADS];
+
+    memset(g_pool, 0, sizeof(g_pool));
+    objfl_init(&g_fl, g_pool, NB_OBJ);
+    for (unsigned i = 0; i < MT_THREADS; i++) {
+        args[i].id = i;
+        args[i].seed = 0x9E3779B9u * (i + 1u);
+        if (pthread_create(&th[i], NULL, mt_worker, &args[i]) != 0)
+            FAIL("pthread_create");
+    }
+    for (unsigned i = 0; i < MT_THREADS; i++)
+        pthread_join(th[i], NULL);
+
+    if (list_len() != NB_OBJ) FAILF("leaked: %u of %u free",
+                                    list_len(), NB_OBJ);
+    for (unsigned i = 0; i < NB_OBJ; i++)
+        if (g_pool[i].owner) FAILF("obj %u still owned", i);
+    if ((g_fl.head >> 32) == 0) FAIL("tag never advanced");
+}
+
+int main(void){
+    test_basic();
+    test_magazine();
+    test_threads();
+
+    printf("ALL RIX_FREELIST TESTS PASSED \n");
+    return 0;
+}
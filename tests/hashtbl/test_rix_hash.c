@@ -6,6 +6,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
 
 #include "rix_hash.h"
 
@@ -55,6 +57,50 @@ struct mynode_slot {
 RIX_HASH_HEAD(myht_slot);
 RIX_HASH_GENERATE_SLOT(myht_slot, mynode_slot, key, cur_hash, slot, mykey_cmp)
 
+/* Same node, resizable table (online bucket doubling). */
+RIX_HASH_RESIZE_HEAD(myht_dyn);
+RIX_HASH_GENERATE_SLOT_RESIZE(myht_dyn, mynode_slot, key, cur_hash, slot, mykey_cmp)
+
+/* Same node, with an overflow stash behind the main buckets. */
+RIX_HASH_STASH_HEAD(myht_st);
+RIX_HASH_GENERATE_SLOT_STASH(myht_st, mynode_slot, key, cur_hash, slot, mykey_cmp)
+
+/* Same node, keyed hash with a per-table seed. */
+RIX_HASH_SEED_HEAD(myht_sd);
+RIX_HASH_GENERATE_SLOT_SEED(myht_sd, mynode_slot, key, cur_hash, slot, mykey_cmp)
+
+/* Seeded table whose hash puts every key on buckets 0 / 1 under one seed. */
+#define SDX_BAD_SEED 0xBADBADBADBADBADBULL
+
+static RIX_FORCE_INLINE union rix_hash_hash_u
+sdx_hash(const struct mykey *key, u32 mask, u64 seed)
+{
+    union rix_hash_hash_u h =
+        rix_hash_hash_bytes_keyed(key, sizeof(*key), mask, seed);
+
+    if (seed == SDX_BAD_SEED) {
+        h.val32[0] &= ~mask;
+        h.val32[1] = (h.val32[1] & ~mask) | 1u;
+    }
+    return h;
+}
+
+RIX_HASH_SEED_HEAD(myht_sdx);
+RIX_HASH_GENERATE_SLOT_SEED_EX(myht_sdx, mynode_slot, key, cur_hash, slot,
+                               mykey_cmp, sdx_hash)
+
+/* fp node on single-cache-line tag buckets. */
+RIX_HASH_HEAD(myht_tag);
+RIX_HASH_GENERATE_TAG(myht_tag, mynode, key, cur_hash, mykey_cmp)
+
+/* Cuckoo filters over struct mykey (8 / 12 / 16-bit fingerprints). */
+RIX_HASH_HEAD(myflt8);
+RIX_HASH_GENERATE_STATIC_FILTER8(myflt8)
+RIX_HASH_HEAD(myflt12);
+RIX_HASH_GENERATE_FILTER12(myflt12)
+RIX_HASH_HEAD(myflt16);
+RIX_HASH_GENERATE_FILTER16(myflt16)
+
 /* ================================================================== */
 /* keyonly variant: no hash_field (8-byte node)                           */
 /* ================================================================== */
@@ -278,18 +324,20 @@ test_duplicate(void)
 
     /*
      * Insert a different node object that has the same key value.
-     * insert() writes cur_hash to elm before the dup check, but dup is a
-     * stack variable so that write is harmless.  The dup check then finds
-     * &g_basic[0] and returns early before any bucket slot is modified.
+     * The dup check finds &g_basic[0] and returns early before any
+     * bucket slot or the hash_field of the rejected node is modified.
      */
     struct mynode dup;
     dup.key = g_basic[0].key;
+    dup.cur_hash = 0xA5A5A5A5u;
     struct mynode *r2 = myht_insert(&g_head, g_bk, g_basic, &dup);
     if (r2 != &g_basic[0])
         FAILF("key-dup insert must return existing node %p, got %p",
               (void *)&g_basic[0], (void *)r2);
     if (g_head.rhh_nb != 1u)
         FAILF("nb must still be 1 after key-dup, got %u", g_head.rhh_nb);
+    if (dup.cur_hash != 0xA5A5A5A5u)
+        FAILF("key-dup insert clobbered hash_field: %08x", dup.cur_hash);
 }
 
 static void
@@ -367,6 +415,177 @@ test_slot_duplicate(void)
         FAILF("slot nb must still be 1 after dup, got %u", g_head_slot.rhh_nb);
 }
 
+/*
+ * Insert the upper half, relocate it down into the lower half, then swap
+ * pairs: every move must leave find() and the slot invariant intact, and
+ * a node that is not in a bucket must be refused.
+ */
+static void
+test_slot_relocate_swap(void)
+{
+    const unsigned half = NB_BASIC / 2u;
+    u32 seq[NB_BK_BASIC];
+
+    printf("[T] slot relocate/swap\n");
+    slot_basic_init();
+    memset(seq, 0, sizeof(seq));
+    for (unsigned i = half; i < NB_BASIC; i++) {
+        if (myht_slot_insert(&g_head_slot, g_bk_slot, g_slot,
+                             &g_slot[i]) != NULL)
+            FAILF("relocate: insert[%u] failed", i);
+    }
+
+    for (unsigned i = half; i < NB_BASIC; i++) {
+        struct mynode_slot *dst = &g_slot[i - half];
+        struct mynode_slot *r;
+        unsigned bk = g_slot[i].cur_hash & g_head_slot.rhh_mask;
+
+        if (i & 1u)
+            r = RIX_HASH_RELOCATE(myht_slot, &g_head_slot, g_bk_slot,
+                                  g_slot, &g_slot[i], dst);
+        else
+            r = myht_slot_seq_relocate(&g_head_slot, g_bk_slot, seq,
+                                       g_slot, &g_slot[i], dst);
+        if (r != dst)
+            FAILF("relocate[%u] returned %p", i, (void *)r);
+        if (!(i & 1u) && (seq[bk] == 0u || (seq[bk] & 1u)))
+            FAILF("seq_relocate[%u] left seq[%u]=%u", i, bk, seq[bk]);
+        if (dst->key.hi != (uint64_t)(i + 1))
+            FAILF("relocate[%u] did not copy the node", i);
+        slot_verify_node(&g_head_slot, g_bk_slot, g_slot, dst);
+        /* the vacated node no longer matches its bucket entry */
+        if (myht_slot_relocate(&g_head_slot, g_bk_slot, g_slot,
+                               &g_slot[i], &g_slot[i]) != NULL)
+            FAILF("relocate of vacated node[%u] must fail", i);
+        memset(&g_slot[i], 0, sizeof(g_slot[i]));
+    }
+    if (g_head_slot.rhh_nb != half)
+        FAILF("relocate changed nb: %u", g_head_slot.rhh_nb);
+
+    for (unsigned i = 0; i < half; i += 2u) {
+        uint64_t ka = g_slot[i].key.hi;
+        uint64_t kb = g_slot[i + 1u].key.hi;
+
+        if (RIX_HASH_SWAP(myht_slot, &g_head_slot, g_bk_slot, g_slot,
+                          &g_slot[i], &g_slot[i + 1u]) != 0)
+            FAILF("swap[%u] failed", i);
+        if (g_slot[i].key.hi != kb || g_slot[i + 1u].key.hi != ka)
+            FAILF("swap[%u] did not exchange the nodes", i);
+    }
+    if (myht_slot_seq_swap(&g_head_slot, g_bk_slot, seq, g_slot,
+                           &g_slot[0], &g_slot[half]) != -1)
+        FAIL("swap with a free node must fail");
+    if (myht_slot_swap(&g_head_slot, g_bk_slot, g_slot,
+                       &g_slot[1], &g_slot[1]) != 0)
+        FAIL("swap of a node with itself must succeed");
+
+    for (unsigned i = half; i < NB_BASIC; i++) {
+        struct mykey key = { .hi = (uint64_t)(i + 1),
+                             .lo = 0xDEADC0DE00000000ULL };
+        struct mynode_slot *f =
+            myht_slot_find(&g_head_slot, g_bk_slot, g_slot, &key);
+        if (f == NULL || f < g_slot || f >= g_slot + half)
+            FAILF("key %u not found in the lower half", i + 1);
+        slot_verify_node(&g_head_slot, g_bk_slot, g_slot, f);
+    }
+}
+
+static unsigned
+slot_count_displaced(struct myht_slot *head,
+                     struct mynode_slot *nodes,
+                     unsigned n)
+{
+    unsigned cnt = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        union rix_hash_hash_u h =
+            myht_slot_default_hash(&nodes[i].key, head->rhh_mask);
+        if ((nodes[i].cur_hash & head->rhh_mask) !=
+            (h.val32[0] & head->rhh_mask))
+            cnt++;
+    }
+    return cnt;
+}
+
+static void
+test_slot_promote(void)
+{
+    const unsigned NB_BK = 64u;
+    const unsigned N     = 960u;
+    struct mynode_slot *nodes;
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    struct myht_slot head;
+    u32 seq[64];
+    unsigned before, after, moved = 0, removed = 0;
+
+    printf("[T] slot promote\n");
+    nodes = (struct mynode_slot *)calloc((size_t)N, sizeof(*nodes));
+    if (!nodes) { perror("calloc"); exit(1); }
+    if (posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("posix_memalign"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    memset(seq, 0, sizeof(seq));
+    RIX_HASH_INIT(myht_slot, &head, NB_BK);
+    for (unsigned i = 0; i < N; i++) {
+        /* scattered keys: sequential ones spread too evenly to overflow */
+        nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0xA5A5000000000000ULL;
+        if (myht_slot_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            FAILF("promote: insert[%u] failed", i);
+    }
+    before = slot_count_displaced(&head, nodes, N);
+    if (before == 0u)
+        FAIL("promote: 94% fill left no node in its bk_1");
+
+    /* free some room so that promotion has somewhere to go */
+    for (unsigned i = 0; i < N; i += 4u) {
+        if (myht_slot_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+            FAILF("promote: remove[%u] failed", i);
+        memset(&nodes[i], 0, sizeof(nodes[i]));
+        removed++;
+    }
+    if (RIX_HASH_PROMOTE(myht_slot, &head, bk, nodes, &nodes[0]) != -1)
+        FAIL("promote of a removed node must fail");
+
+    before = slot_count_displaced(&head, nodes + 1, N - 1u);
+    for (unsigned i = 1; i < N; i++) {
+        int rc;
+
+        if (nodes[i].key.hi == 0u)
+            continue;
+        rc = (i & 1u) ?
+            RIX_HASH_PROMOTE(myht_slot, &head, bk, nodes, &nodes[i]) :
+            myht_slot_seq_promote(&head, bk, seq, nodes, &nodes[i]);
+        if (rc < -1 || rc > 1)
+            FAILF("promote[%u] returned %d", i, rc);
+        if (rc == 1)
+            moved++;
+        if (rc == 0 && myht_slot_promote(&head, bk, nodes, &nodes[i]) != 0)
+            FAILF("promote[%u] not idempotent", i);
+    }
+    after = slot_count_displaced(&head, nodes + 1, N - 1u);
+    printf("  displaced %u -> %u (%u promoted)\n", before, after, moved);
+    if (moved == 0u || after >= before)
+        FAIL("promote did not move any displaced node home");
+    for (unsigned i = 0; i < NB_BK; i++) {
+        if (seq[i] & 1u)
+            FAILF("seq_promote left seq[%u]=%u odd", i, seq[i]);
+    }
+    if (head.rhh_nb != N - removed)
+        FAILF("promote changed nb: %u", head.rhh_nb);
+    for (unsigned i = 0; i < N; i++) {
+        if (nodes[i].key.hi == 0u)
+            continue;
+        if (myht_slot_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+            FAILF("promote: find[%u] failed", i);
+        slot_verify_node(&head, bk, nodes, &nodes[i]);
+    }
+    free(bk);
+    free(nodes);
+}
+
 /* ================================================================== */
 /* test_staged_find                                                    */
 /* ================================================================== */
@@ -1679,6 +1898,52 @@ test_slot_max_fill(void)
     free(nodes);
 }
 
+/* ================================================================== */
+/* test_slot_bfs_fill - BFS kickout sustains >95% load with no refusal */
+/* ================================================================== */
+static void
+test_slot_bfs_fill(void)
+{
+    printf("[T] slot_bfs_fill (first refusal, 1024 buckets)\n");
+
+    const unsigned NB_BK    = 1024u;
+    const unsigned CAPACITY = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ; /* 16384 */
+
+    struct mynode_slot *nodes =
+        (struct mynode_slot *)calloc((size_t)CAPACITY, sizeof(*nodes));
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    if (!nodes || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    for (unsigned i = 0; i < CAPACITY; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0xBF5BF5BF00000000ULL | i;
+    }
+
+    struct myht_slot head;
+    RIX_HASH_INIT(myht_slot, &head, NB_BK);
+
+    unsigned inserted = 0;
+    while (inserted < CAPACITY &&
+           myht_slot_insert(&head, bk, nodes, &nodes[inserted]) == NULL)
+        inserted++;
+    printf("  first refusal at %u / %u (%.1f%%)\n",
+           inserted, CAPACITY, 100.0 * inserted / CAPACITY);
+    if (inserted * 100u < CAPACITY * 96u)
+        FAILF("kickout refused at %u / %u", inserted, CAPACITY);
+
+    for (unsigned i = 0; i < inserted; i++) {
+        if (myht_slot_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+            FAILF("slot_bfs_fill find[%u] failed", i);
+        slot_verify_node(&head, bk, nodes, &nodes[i]);
+    }
+
+    free(bk);
+    free(nodes);
+}
+
 /* ================================================================== */
 /* test_keyonly_max_fill - keyonly variant: fill until first failure         */
 /* ================================================================== */
@@ -1742,55 +2007,2625 @@ test_keyonly_max_fill(void)
 }
 
 /* ================================================================== */
-/* main                                                                */
+/* test_slot_seq_basic - seqlock forms, single thread                  */
 /* ================================================================== */
-int
-main(int argc, char **argv)
+static void
+test_slot_seq_basic(void)
 {
-    unsigned seed   = 0xC0FFEE11u;
-    unsigned N      = 512u;
-    unsigned nb_bk  = 64u;  /* 64 x 16 = 1024 slots; N/capacity = 0.5 */
-    unsigned ops    = 200000u;
+    printf("[T] slot_seq_basic (single-writer forms, 90%% fill)\n");
 
-    if (argc >= 2) seed  = (unsigned)strtoul(argv[1], NULL, 10);
-    if (argc >= 3) N     = (unsigned)strtoul(argv[2], NULL, 10);
-    if (argc >= 4) nb_bk = (unsigned)strtoul(argv[3], NULL, 10);
-    if (argc >= 5) ops   = (unsigned)strtoul(argv[4], NULL, 10);
+    const unsigned NB_BK = 64u;
+    const unsigned N     = 920u;
 
-    rix_hash_arch_init(RIX_HASH_ARCH_AUTO);
+    struct mynode_slot *nodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*nodes));
+    uint32_t *seq = (uint32_t *)calloc((size_t)NB_BK, sizeof(*seq));
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    if (!nodes || !seq || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1);
+        nodes[i].key.lo = 0x5E05E05E00000000ULL;
+    }
 
-    test_init_empty();
-    test_insert_find_remove();
-    test_duplicate();
-    test_remove_miss();
-    test_staged_find();
-    test_walk();
-    test_fuzz(seed, N, nb_bk, ops);
-    test_slot_insert_find_remove();
-    test_slot_duplicate();
-    test_slot_remove_miss();
-    test_slot_fuzz(seed, N, nb_bk, ops);
+    struct myht_slot head;
+    RIX_HASH_INIT(myht_slot, &head, NB_BK);
 
-    test_keyonly_insert_find_remove();
-    test_keyonly_duplicate();
-    test_keyonly_remove_miss();
-    test_keyonly_fuzz(seed, N, nb_bk, ops);
+    unsigned inserted = 0;
+    for (unsigned i = 0; i < N; i++) {
+        if (myht_slot_seq_insert(&head, bk, seq, nodes, &nodes[i]) != NULL)
+            FAILF("seq insert[%u] failed", i);
+        inserted++;
+    }
 
-    /* High-fill / hash-conflict tests (all 3 variants) */
-    test_high_fill();
-    test_max_fill();
-    test_kickout_corruption();
-    test_slot_high_fill();
-    test_slot_max_fill();
-    test_slot_kickout_corruption();
-    test_keyonly_high_fill();
-    test_keyonly_max_fill();
-    test_keyonly_kickout_corruption();
+    uint64_t total = 0;
+    for (unsigned b = 0; b < NB_BK; b++) {
+        if (seq[b] & 1u)
+            FAILF("seq[%u]=%u odd after writer finished", b, seq[b]);
+        total += seq[b];
+    }
+    /* every insert bumps at least one bucket by 2 */
+    if (total < 2u * (uint64_t)inserted)
+        FAILF("seq total %llu < 2 x %u", (unsigned long long)total, inserted);
 
-    /* Aggressive fuzz: 98% fill ratio (N ~ nb_bk x 16) */
-    test_fuzz(seed, 1000, 64, 500000);
-    test_slot_fuzz(seed, 1000, 64, 500000);
-    test_keyonly_fuzz(seed, 1000, 64, 500000);
+    for (unsigned i = 0; i < inserted; i++) {
+        if (myht_slot_seq_find(&head, bk, seq, nodes, &nodes[i].key)
+            != &nodes[i])
+            FAILF("seq find[%u] failed", i);
+        slot_verify_node(&head, bk, nodes, &nodes[i]);
+    }
+
+    /* staged x4 reader pipeline */
+    for (unsigned i = 0; i + 4 <= inserted; i += 4) {
+        struct rix_hash_find_ctx_s ctx[4];
+        const struct mykey *keys[4];
+        struct mynode_slot *res[4];
+        for (unsigned j = 0; j < 4; j++)
+            keys[j] = &nodes[i + j].key;
+        myht_slot_seq_hash_key_n(ctx, 4, &head, bk, seq, keys);
+        myht_slot_seq_scan_bk_n(ctx, 4, &head, bk, seq);
+        myht_slot_prefetch_node_n(ctx, 4, nodes);
+        myht_slot_seq_cmp_key_n(ctx, 4, &head, bk, seq, nodes, res);
+        for (unsigned j = 0; j < 4; j++)
+            if (res[j] != &nodes[i + j])
+                FAILF("seq staged[%u] mismatch", i + j);
+    }
+
+    for (unsigned i = 0; i < inserted; i += 2) {
+        unsigned b = nodes[i].cur_hash & head.rhh_mask;
+        uint32_t before = seq[b];
+        if (myht_slot_seq_remove(&head, bk, seq, nodes, &nodes[i])
+            != &nodes[i])
+            FAILF("seq remove[%u] failed", i);
+        if (seq[b] != before + 2u)
+            FAILF("seq remove[%u]: seq %u -> %u", i, before, seq[b]);
+    }
+    for (unsigned i = 0; i < inserted; i++) {
+        struct mynode_slot *f =
+            myht_slot_seq_find(&head, bk, seq, nodes, &nodes[i].key);
+        if (f != ((i & 1u) ? &nodes[i] : NULL))
+            FAILF("seq find after remove[%u] mismatch", i);
+    }
+
+    free(bk);
+    free(seq);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* test_slot_seq_concurrent - 1 writer churning at high fill (forcing  */
+/* kickouts) while readers look up keys that are never removed.        */
+/* A reader must never miss a stable key.                              */
+/* ================================================================== */
+#define SEQ_NB_BK       64u
+#define SEQ_N_STABLE   448u
+#define SEQ_N_CHURN    560u
+#define SEQ_READERS      3u
+
+struct seq_shared {
+    struct myht_slot          head;
+    struct rix_hash_bucket_s *bk;
+    uint32_t                 *seq;
+    struct mynode_slot       *nodes;
+    volatile int              stop;
+    uint64_t                  lookups[SEQ_READERS];
+};
+
+struct seq_reader_arg {
+    struct seq_shared *sh;
+    unsigned           id;
+};
+
+static void *
+seq_reader_main(void *p)
+{
+    struct seq_reader_arg *a = (struct seq_reader_arg *)p;
+    struct seq_shared *sh = a->sh;
+    uint64_t n = 0;
+    unsigned i = a->id;
+
+    while (!sh->stop) {
+        struct rix_hash_find_ctx_s ctx[4];
+        const struct mykey *keys[4];
+        struct mynode_slot *res[4];
+
+        for (unsigned j = 0; j < 4; j++)
+            keys[j] = &sh->nodes[(i + j * 97u) % SEQ_N_STABLE].key;
+        myht_slot_seq_hash_key_n(ctx, 4, &sh->head, sh->bk, sh->seq, keys);
+        myht_slot_seq_scan_bk_n(ctx, 4, &sh->head, sh->bk, sh->seq);
+        myht_slot_seq_cmp_key_n(ctx, 4, &sh->head, sh->bk, sh->seq,
+                                sh->nodes, res);
+        for (unsigned j = 0; j < 4; j++) {
+            unsigned k = (i + j * 97u) % SEQ_N_STABLE;
+            if (res[j] != &sh->nodes[k])
+                FAILF("reader %u: stable key %u lost (got %p)",
+                      a->id, k, (void *)res[j]);
+        }
+        i = (i + 1u) % SEQ_N_STABLE;
+        n += 4;
+    }
+    sh->lookups[a->id] = n;
+    return NULL;
+}
+
+static void
+test_slot_seq_concurrent(unsigned seed, unsigned ops)
+{
+    printf("[T] slot_seq_concurrent (1 writer + %u readers, %u ops)\n",
+           SEQ_READERS, ops);
+
+    struct seq_shared sh;
+    const unsigned N = SEQ_N_STABLE + SEQ_N_CHURN;
+    unsigned char *present = (unsigned char *)calloc(N, 1);
+    pthread_t th[SEQ_READERS];
+    struct seq_reader_arg args[SEQ_READERS];
+
+    memset(&sh, 0, sizeof(sh));
+    sh.nodes = (struct mynode_slot *)calloc((size_t)N, sizeof(*sh.nodes));
+    sh.seq   = (uint32_t *)calloc(SEQ_NB_BK, sizeof(*sh.seq));
+    if (!present || !sh.nodes || !sh.seq ||
+        posix_memalign((void **)&sh.bk, 64,
+                       SEQ_NB_BK * sizeof(*sh.bk)) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(sh.bk, 0, SEQ_NB_BK * sizeof(*sh.bk));
+    RIX_HASH_INIT(myht_slot, &sh.head, SEQ_NB_BK);
+    for (unsigned i = 0; i < N; i++) {
+        sh.nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        sh.nodes[i].key.lo = 0x5EC5EC5E00000000ULL | i;
+    }
+    for (unsigned i = 0; i < SEQ_N_STABLE; i++)
+        if (myht_slot_seq_insert(&sh.head, sh.bk, sh.seq, sh.nodes,
+                                 &sh.nodes[i]) != NULL)
+            FAILF("stable insert[%u] failed", i);
+    uint32_t *home = (uint32_t *)calloc(SEQ_N_STABLE, sizeof(*home));
+    if (!home) { perror("calloc"); exit(1); }
+    for (unsigned i = 0; i < SEQ_N_STABLE; i++)
+        home[i] = sh.nodes[i].cur_hash;
+
+    for (unsigned r = 0; r < SEQ_READERS; r++) {
+        args[r].sh = &sh;
+        args[r].id = r;
+        if (pthread_create(&th[r], NULL, seq_reader_main, &args[r]) != 0) {
+            perror("pthread_create"); exit(1);
+        }
+    }
+
+    xr_fuzz = seed;
+    unsigned refused = 0;
+    for (unsigned op = 0; op < ops; op++) {
+        unsigned c = SEQ_N_STABLE + xorshift32() % SEQ_N_CHURN;
+        struct mynode_slot *nd = &sh.nodes[c];
+        if (present[c]) {
+            if (xorshift32() & 3u)
+                continue;   /* bias towards ~88% fill so kickouts happen */
+            if (myht_slot_seq_remove(&sh.head, sh.bk, sh.seq, sh.nodes, nd)
+                != nd)
+                FAILF("churn remove[%u] failed", c);
+            present[c] = 0;
+        } else {
+            struct mynode_slot *ret =
+                myht_slot_seq_insert(&sh.head, sh.bk, sh.seq, sh.nodes, nd);
+            if (ret == NULL)
+                present[c] = 1;
+            else if (ret != nd)
+                FAILF("churn insert[%u] found duplicate", c);
+            else
+                refused++;  /* table full: insert refused */
+        }
+    }
+    sh.stop = 1;
+    uint64_t total = 0;
+    for (unsigned r = 0; r < SEQ_READERS; r++) {
+        pthread_join(th[r], NULL);
+        total += sh.lookups[r];
+    }
+    unsigned moved = 0;
+    for (unsigned i = 0; i < SEQ_N_STABLE; i++)
+        moved += (sh.nodes[i].cur_hash != home[i]);
+    printf("  reader lookups %llu, refused inserts %u, nb %u,"
+           " stable keys displaced %u\n",
+           (unsigned long long)total, refused, sh.head.rhh_nb, moved);
+    if (moved == 0)
+        FAIL("no stable key was displaced; kickout path not exercised");
+
+    for (unsigned b = 0; b < SEQ_NB_BK; b++)
+        if (sh.seq[b] & 1u)
+            FAILF("seq[%u] odd after writer finished", b);
+    for (unsigned i = 0; i < N; i++) {
+        struct mynode_slot *f =
+            myht_slot_seq_find(&sh.head, sh.bk, sh.seq, sh.nodes,
+                               &sh.nodes[i].key);
+        int want = (i < SEQ_N_STABLE) || present[i];
+        if (want ? (f != &sh.nodes[i]) : (f != NULL))
+            FAILF("final find[%u] mismatch", i);
+        if (want)
+            slot_verify_node(&sh.head, sh.bk, sh.nodes, &sh.nodes[i]);
+    }
+
+    free(sh.bk);
+    free(sh.seq);
+    free(sh.nodes);
+    free(home);
+    free(present);
+}
+
+/* ================================================================== */
+/* test_slot_resize - online doubling interleaved with all rs_* ops    */
+/* ================================================================== */
+static void
+rs_verify_node(struct myht_dyn *head,
+               struct rix_hash_bucket_s *bk,
+               struct mynode_slot *base,
+               struct mynode_slot *node)
+{
+    unsigned node_idx = RIX_IDX_FROM_PTR(base, node);
+    unsigned bucket = _rix_hash_rs_bucket(node->cur_hash, head->rhh_mask,
+                                          &head->rhh_rs);
+    unsigned slot = (unsigned)node->slot;
+
+    if (slot >= RIX_HASH_BUCKET_ENTRY_SZ || bk[bucket].idx[slot] != node_idx)
+        FAILF("rs slot invariant: node_idx=%u bucket=%u slot=%u",
+              node_idx, bucket, slot);
+}
+
+static int
+rs_count_cb(struct mynode_slot *node, void *arg)
+{
+    (void)node;
+    (*(unsigned *)arg)++;
+    return 0;
+}
+
+static void
+rs_verify_all(struct myht_dyn *head,
+              struct rix_hash_bucket_s *bk,
+              struct mynode_slot *nodes,
+              const unsigned char *present,
+              unsigned N, unsigned in_table)
+{
+    unsigned walked = 0;
+
+    for (unsigned i = 0; i < N; i++) {
+        struct mynode_slot *f = myht_dyn_rs_find(head, bk, nodes, &nodes[i].key);
+        if (present[i] ? (f != &nodes[i]) : (f != NULL))
+            FAILF("rs find[%u]: present=%u got %p", i, present[i], (void *)f);
+        if (present[i])
+            rs_verify_node(head, bk, nodes, &nodes[i]);
+    }
+    myht_dyn_rs_walk(head, bk, nodes, rs_count_cb, &walked);
+    if (head->rhh_nb != in_table || walked != in_table)
+        FAILF("rs count: nb=%u walked=%u model=%u",
+              head->rhh_nb, walked, in_table);
+}
+
+static void
+test_slot_resize(unsigned seed)
+{
+    printf("[T] slot_resize (16 -> 32 -> 64 buckets, ops between steps)\n");
+
+    const unsigned NB_BK0 = 16u;
+    const unsigned NB_MAX = 64u;
+    const unsigned N      = 1400u;
+
+    struct mynode_slot *nodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*nodes));
+    unsigned char *present = (unsigned char *)calloc((size_t)N, 1);
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_MAX * sizeof(*bk);
+    if (!nodes || !present || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    /* Only the initial buckets are zeroed; the grow must not read the rest. */
+    memset(bk, 0xA5, bk_sz);
+    memset(bk, 0, (size_t)NB_BK0 * sizeof(*bk));
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0x5E51E000ULL | i;
+    }
+
+    struct myht_dyn head;
+    myht_dyn_rs_init(&head, NB_BK0);
+    if (myht_dyn_rs_resizing(&head) ||
+        myht_dyn_rs_grow_step(&head, bk, nodes, 4u) != 0u)
+        FAIL("fresh table reports a grow in flight");
+
+    xr_fuzz = seed;
+    unsigned in_table = 0;
+    unsigned fill     = 200u;    /* 78% of 256 slots */
+    for (unsigned round = 0; round < 2; round++) {
+        for (unsigned i = 0; i < fill; i++) {
+            if (present[i]) continue;
+            if (myht_dyn_rs_insert(&head, bk, nodes, &nodes[i]) != NULL)
+                FAILF("round %u prefill insert[%u] failed", round, i);
+            present[i] = 1;
+            in_table++;
+        }
+        rs_verify_all(&head, bk, nodes, present, N, in_table);
+
+        unsigned old_mask = head.rhh_mask;
+        if (myht_dyn_rs_grow_begin(&head) != 0 || !myht_dyn_rs_resizing(&head))
+            FAILF("round %u grow_begin refused", round);
+        if (myht_dyn_rs_grow_begin(&head) == 0)
+            FAIL("nested grow_begin accepted");
+        rs_verify_all(&head, bk, nodes, present, N, in_table);
+
+        unsigned steps = 0;
+        unsigned left;
+        do {
+            left = myht_dyn_rs_grow_step(&head, bk, nodes, 1u + round * 2u);
+            steps++;
+            /* random churn over the grown key range between steps */
+            for (unsigned k = 0; k < 8; k++) {
+                unsigned i = xorshift32() % (fill * 2u);
+                unsigned op = xorshift32() % 3u;
+                struct mynode_slot *nd = &nodes[i];
+                if (op == 0) {
+                    struct mynode_slot *r =
+                        myht_dyn_rs_insert(&head, bk, nodes, nd);
+                    if (present[i] ? (r != nd) : (r != NULL))
+                        FAILF("grow insert[%u]: present=%u ret=%p",
+                              i, present[i], (void *)r);
+                    if (!present[i]) {
+                        present[i] = 1;
+                        in_table++;
+                        rs_verify_node(&head, bk, nodes, nd);
+                    }
+                } else if (op == 1) {
+                    struct mynode_slot *r =
+                        myht_dyn_rs_remove(&head, bk, nodes, nd);
+                    if (present[i] ? (r != nd) : (r != NULL))
+                        FAILF("grow remove[%u]: present=%u ret=%p",
+                              i, present[i], (void *)r);
+                    if (present[i]) {
+                        present[i] = 0;
+                        in_table--;
+                    }
+                } else {
+                    /* staged x4 pipeline on neighbouring keys */
+                    struct rix_hash_find_ctx_s ctx[4];
+                    const struct mykey *keys[4];
+                    struct mynode_slot *res[4];
+                    unsigned id[4];
+                    for (unsigned j = 0; j < 4; j++) {
+                        id[j] = (i + j) % N;
+                        keys[j] = &nodes[id[j]].key;
+                    }
+                    myht_dyn_rs_hash_key_n(ctx, 4, &head, bk, keys);
+                    myht_dyn_scan_bk_n(ctx, 4, &head, bk);
+                    myht_dyn_prefetch_node_n(ctx, 4, nodes);
+                    myht_dyn_cmp_key_n(ctx, 4, nodes, res);
+                    for (unsigned j = 0; j < 4; j++)
+                        if (present[id[j]] ? (res[j] != &nodes[id[j]])
+                                           : (res[j] != NULL))
+                            FAILF("grow staged find[%u] mismatch", id[j]);
+                }
+            }
+            if ((steps & 3u) == 0u)
+                rs_verify_all(&head, bk, nodes, present, N, in_table);
+        } while (left != 0u);
+
+        if (myht_dyn_rs_resizing(&head) || head.rhh_mask != old_mask * 2u + 1u)
+            FAILF("round %u: grow did not finish (mask=%u)",
+                  round, head.rhh_mask);
+        rs_verify_all(&head, bk, nodes, present, N, in_table);
+        printf("  grow %u -> %u buckets in %u steps, nb %u\n",
+               old_mask + 1u, head.rhh_mask + 1u, steps, head.rhh_nb);
+        fill *= 2u;
+    }
+
+    /* the grown table takes the load that the initial one could not */
+    for (unsigned i = 0; i < 800u; i++) {
+        if (present[i]) continue;
+        if (myht_dyn_rs_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            FAILF("post-grow insert[%u] failed", i);
+        present[i] = 1;
+        in_table++;
+    }
+    rs_verify_all(&head, bk, nodes, present, N, in_table);
+
+    free(bk);
+    free(present);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* test_slot_stash - overflow stash absorbs kickout failures          */
+/* ================================================================== */
+static void
+st_verify_all(struct myht_st *head,
+              struct rix_hash_bucket_s *bk,
+              struct mynode_slot *nodes,
+              const unsigned char *present,
+              unsigned N, unsigned in_table)
+{
+    unsigned walked = 0, stashed = 0;
+    uint64_t filter[RIX_HASH_STASH_FILTER_BITS / 64u] = { 0 };
+
+    for (unsigned i = 0; i < N; i++) {
+        struct mynode_slot *nd = &nodes[i];
+        struct mynode_slot *f = myht_st_st_find(head, bk, nodes, &nd->key);
+        if (present[i] ? (f != nd) : (f != NULL))
+            FAILF("st find[%u]: present=%u got %p", i, present[i], (void *)f);
+        if (!present[i])
+            continue;
+        if (nd->slot < RIX_HASH_BUCKET_ENTRY_SZ) {
+            unsigned b = nd->cur_hash & head->rhh_mask;
+            if (bk[b].idx[nd->slot] != i + 1u)
+                FAILF("st main invariant: node %u bucket %u slot %u",
+                      i, b, nd->slot);
+        } else {
+            unsigned p = nd->slot - RIX_HASH_BUCKET_ENTRY_SZ;
+            struct rix_hash_bucket_s *sb = bk + head->rhh_mask + 1u;
+            if (sb[p / RIX_HASH_BUCKET_ENTRY_SZ]
+                    .idx[p % RIX_HASH_BUCKET_ENTRY_SZ] != i + 1u)
+                FAILF("st stash invariant: node %u pos %u", i, p);
+            unsigned c = sb[p / RIX_HASH_BUCKET_ENTRY_SZ]
+                             .hash[p % RIX_HASH_BUCKET_ENTRY_SZ] >> 24;
+            filter[c / 64u] |= (uint64_t)1 << (c % 64u);
+            stashed++;
+        }
+    }
+    /* the miss filter holds exactly the classes of the stashed entries */
+    if (memcmp(filter, head->rhh_st.filter, sizeof(filter)) != 0)
+        FAIL("st miss filter out of sync with the stash");
+    myht_st_st_walk(head, bk, nodes, rs_count_cb, &walked);
+    if (head->rhh_nb != in_table || walked != in_table ||
+        head->rhh_st.nb != stashed)
+        FAILF("st count: nb=%u walked=%u model=%u stash=%u/%u",
+              head->rhh_nb, walked, in_table, head->rhh_st.nb, stashed);
+}
+
+static void
+test_slot_stash(unsigned seed)
+{
+    printf("[T] slot_stash (64 buckets + 4 stash buckets)\n");
+
+    const unsigned NB_BK = 64u;
+    const unsigned ST_BK = 4u;
+    const unsigned N     = (NB_BK + ST_BK) * RIX_HASH_BUCKET_ENTRY_SZ;
+
+    struct mynode_slot *nodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*nodes));
+    unsigned char *present = (unsigned char *)calloc((size_t)N, 1);
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)(NB_BK + ST_BK) * sizeof(*bk);
+    if (!nodes || !present || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0x57A5B000ULL | i;
+    }
+
+    struct myht_st head;
+    myht_st_st_init(&head, NB_BK, ST_BK);
+
+    /* fill until the stash is exhausted too */
+    unsigned in_table = 0, first_stash = 0;
+    for (unsigned i = 0; i < N; i++) {
+        unsigned before = head.rhh_st.nb;
+        if (myht_st_st_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            break;
+        if (before == 0u && head.rhh_st.nb == 1u)
+            first_stash = in_table;
+        present[i] = 1;
+        in_table++;
+    }
+    printf("  first stash at %u, full at %u / %u main slots\n",
+           first_stash, in_table, NB_BK * RIX_HASH_BUCKET_ENTRY_SZ);
+    if (head.rhh_st.nb != ST_BK * RIX_HASH_BUCKET_ENTRY_SZ)
+        FAILF("refused with a non-full stash (%u)", head.rhh_st.nb);
+    st_verify_all(&head, bk, nodes, present, N, in_table);
+
+    /* duplicates are found in the stash as well */
+    for (unsigned i = 0; i < N; i++) {
+        if (!present[i] || nodes[i].slot < RIX_HASH_BUCKET_ENTRY_SZ)
+            continue;
+        struct mynode_slot dup;
+        dup.key = nodes[i].key;
+        if (myht_st_st_insert(&head, bk, nodes, &nodes[i]) != &nodes[i] ||
+            myht_st_st_insert(&head, bk, nodes, &dup) != &nodes[i])
+            FAILF("stashed key %u not reported as duplicate", i);
+    }
+
+    /* staged pipeline with name_st_cmp_key as last stage */
+    for (unsigned i = 0; i + 4u <= N; i += 4u) {
+        struct rix_hash_find_ctx_s ctx[4];
+        for (unsigned j = 0; j < 4u; j++) {
+            myht_st_hash_key(&ctx[j], &head, bk, &nodes[i + j].key);
+            myht_st_scan_bk(&ctx[j], &head, bk);
+            myht_st_prefetch_node(&ctx[j], nodes);
+        }
+        for (unsigned j = 0; j < 4u; j++) {
+            struct mynode_slot *r = myht_st_st_cmp_key(&ctx[j], &head, bk, nodes);
+            if (r != (present[i + j] ? &nodes[i + j] : NULL))
+                FAILF("st staged find[%u] mismatch", i + j);
+        }
+    }
+
+    /* main-table removes refill their bucket from the stash */
+    unsigned removed = 0;
+    for (unsigned i = 0; i < N && head.rhh_st.nb; i++) {
+        if (!present[i] || nodes[i].slot >= RIX_HASH_BUCKET_ENTRY_SZ)
+            continue;
+        if (myht_st_st_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+            FAILF("st remove[%u] failed", i);
+        present[i] = 0;
+        in_table--;
+        removed++;
+    }
+    printf("  stash emptied by %u main removes\n", removed);
+    if (head.rhh_st.nb != 0u)
+        FAILF("stash not drained: %u left", head.rhh_st.nb);
+    st_verify_all(&head, bk, nodes, present, N, in_table);
+
+    /* slots freed behind the table's back: name_st_drain re-inserts */
+    for (unsigned i = 0; i < N; i++) {
+        if (present[i]) continue;
+        if (myht_st_st_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            break;
+        present[i] = 1;
+        in_table++;
+    }
+    unsigned stashed = head.rhh_st.nb;
+    if (stashed == 0u)
+        FAIL("refill did not reach the stash");
+    for (unsigned i = 0, n = 0; i < N && n < 2u * stashed; i++) {
+        struct mynode_slot *nd = &nodes[i];
+        if (!present[i] || nd->slot >= RIX_HASH_BUCKET_ENTRY_SZ)
+            continue;
+        if (myht_st_remove_at(&head, bk, nd->cur_hash & head.rhh_mask,
+                              nd->slot) != i + 1u)
+            FAILF("remove_at[%u] failed", i);
+        present[i] = 0;
+        in_table--;
+        n++;
+    }
+    if (myht_st_st_drain(&head, bk, nodes) != 0u)
+        FAILF("drain left %u of %u stashed", head.rhh_st.nb, stashed);
+    st_verify_all(&head, bk, nodes, present, N, in_table);
+
+    /* churn just below the combined capacity */
+    xr_fuzz = seed;
+    for (unsigned step = 0; step < 200000u; step++) {
+        unsigned i = xorshift32() % N;
+        struct mynode_slot *nd = &nodes[i];
+        unsigned op = xorshift32() % 100u;
+        if (op < 55u) {
+            struct mynode_slot *r = myht_st_st_insert(&head, bk, nodes, nd);
+            if (present[i] ? (r != nd) : (r != NULL && r != nd))
+                FAILF("churn insert[%u]: present=%u ret=%p",
+                      i, present[i], (void *)r);
+            if (!present[i] && r == NULL) {
+                present[i] = 1;
+                in_table++;
+            }
+        } else if (op < 95u) {
+            struct mynode_slot *r = myht_st_st_remove(&head, bk, nodes, nd);
+            if (r != (present[i] ? nd : NULL))
+                FAILF("churn remove[%u]: present=%u ret=%p",
+                      i, present[i], (void *)r);
+            if (present[i]) {
+                present[i] = 0;
+                in_table--;
+            }
+        } else {
+            myht_st_st_drain(&head, bk, nodes);
+        }
+        if ((step & 0x3FFFu) == 0u)
+            st_verify_all(&head, bk, nodes, present, N, in_table);
+    }
+    st_verify_all(&head, bk, nodes, present, N, in_table);
+
+    free(bk);
+    free(present);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* test_slot_seed - keyed hash, kickout trigger and online reseed     */
+/* ================================================================== */
+static void
+sd_verify_all(struct myht_sd *head,
+              struct rix_hash_bucket_s *bk,
+              struct mynode_slot *nodes,
+              const unsigned char *present,
+              unsigned N, unsigned in_table)
+{
+    unsigned walked = 0;
+
+    for (unsigned i = 0; i < N; i++) {
+        struct mynode_slot *nd = &nodes[i];
+        struct mynode_slot *f = myht_sd_sd_find(head, bk, nodes, &nd->key);
+        if (present[i] ? (f != nd) : (f != NULL))
+            FAILF("sd find[%u]: present=%u got %p", i, present[i], (void *)f);
+        if (present[i] &&
+            bk[nd->cur_hash & head->rhh_mask].idx[nd->slot] != i + 1u)
+            FAILF("sd invariant: node %u slot %u", i, nd->slot);
+    }
+    myht_sd_walk(head, bk, nodes, rs_count_cb, &walked);
+    if (head->rhh_nb != in_table || walked != in_table)
+        FAILF("sd count: nb=%u walked=%u model=%u",
+              head->rhh_nb, walked, in_table);
+}
+
+static void
+test_slot_seed(unsigned seed)
+{
+    printf("[T] slot_seed (keyed hash, online reseed)\n");
+
+    const unsigned NB_BK = 256u;
+    const unsigned N     = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ;
+    const u64      S0    = 0x0123456789ABCDEFULL;
+    const u64      S1    = 0xFEDCBA9876543210ULL;
+    const u32      mask  = NB_BK - 1u;
+
+    struct mynode_slot *nodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*nodes));
+    unsigned char *present = (unsigned char *)calloc((size_t)N, 1);
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    if (!nodes || !present || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+
+    /* keyed hash: distinct buckets, and the seed changes the result */
+    {
+        unsigned nb_same = 0;
+        for (unsigned i = 0; i < 1000u; i++) {
+            struct mykey k = { (uint64_t)i * 0x9E3779B97F4A7C15ULL, i };
+            union rix_hash_hash_u a =
+                rix_hash_hash_bytes_keyed(&k, sizeof(k), mask, S0);
+            union rix_hash_hash_u b =
+                rix_hash_hash_bytes_keyed(&k, sizeof(k), mask, S1);
+            if ((a.val32[0] & mask) == (a.val32[1] & mask))
+                FAILF("keyed bk0 == bk1 i=%u", i);
+            if (a.val64 != rix_hash_hash_bytes_keyed(&k, sizeof(k),
+                                                     mask, S0).val64)
+                FAILF("keyed not deterministic i=%u", i);
+            nb_same += (a.val32[0] == b.val32[0]);
+        }
+        if (nb_same > 2u)
+            FAILF("seed ignored: %u / 1000 equal h0", nb_same);
+    }
+
+    /*
+     * Adversarial keys: under S0 both candidate buckets of every key are
+     * among the first 8, so all but 128 of them pile up on full buckets.
+     */
+    unsigned nb_adv = 0;
+    for (u64 c = 1; nb_adv < 640u; c++) {
+        struct mykey k = { c * 0xD6E8FEB86659FD93ULL, c };
+        union rix_hash_hash_u h =
+            rix_hash_hash_bytes_keyed(&k, sizeof(k), mask, S0);
+        if ((h.val32[0] & mask) < 8u && (h.val32[1] & mask) < 8u)
+            nodes[nb_adv++].key = k;
+    }
+    for (unsigned i = nb_adv; i < N; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0x5EED0000ULL | i;
+    }
+
+    struct myht_sd head;
+    myht_sd_sd_init(&head, NB_BK, S0);
+
+    unsigned in_table = 0;
+    for (unsigned i = 0; i < nb_adv; i++) {
+        if (myht_sd_sd_insert(&head, bk, nodes, &nodes[i]) == NULL) {
+            present[i] = 1;
+            in_table++;
+        }
+    }
+    printf("  %u / %u adversarial keys placed, kick %u / %u\n",
+           in_table, nb_adv, head.rhh_sd.nb_kick, head.rhh_sd.nb_ins);
+    if (in_table > 8u * RIX_HASH_BUCKET_ENTRY_SZ)
+        FAILF("adversarial keys escaped their buckets (%u)", in_table);
+    if (!myht_sd_sd_need_reseed(&head))
+        FAIL("flood not detected");
+    sd_verify_all(&head, bk, nodes, present, N, in_table);
+
+    /* reseed in small steps with inserts / removes / finds in between */
+    if (myht_sd_sd_reseed_start(&head, S0) == 0)
+        FAIL("reseed to the same seed accepted");
+    if (myht_sd_sd_reseed_start(&head, S1) != 0)
+        FAIL("reseed_start refused");
+    if (myht_sd_sd_reseed_start(&head, S0) == 0)
+        FAIL("second reseed_start accepted while busy");
+
+    unsigned steps = 0;
+    xr_fuzz = seed ? seed : 1u;
+    while (myht_sd_sd_reseed_step(&head, bk, nodes, 3u) != 0u) {
+        for (unsigned r = 0; r < 8u; r++) {
+            unsigned i = xorshift32() % (N * 3u / 4u);
+            struct mynode_slot *nd = &nodes[i];
+            if (xorshift32() % 4u != 0u) {
+                struct mynode_slot *ret =
+                    myht_sd_sd_insert(&head, bk, nodes, nd);
+                if (present[i] ? (ret != nd) : (ret != NULL))
+                    FAILF("reseed insert[%u]: present=%u ret=%p",
+                          i, present[i], (void *)ret);
+                if (!present[i]) {
+                    present[i] = 1;
+                    in_table++;
+                }
+            } else if (present[i]) {
+                if (myht_sd_sd_remove(&head, bk, nodes, nd) != nd)
+                    FAILF("reseed remove[%u]", i);
+                present[i] = 0;
+                in_table--;
+            }
+        }
+        if ((++steps & 0x1Fu) == 0u)
+            sd_verify_all(&head, bk, nodes, present, N, in_table);
+        if (steps > 100u * NB_BK)
+            FAIL("reseed does not finish");
+    }
+    printf("  reseed done in %u steps, %u entries\n", steps, in_table);
+    if (head.rhh_sd.busy || head.rhh_sd.seed != S1 || head.rhh_sd.old != S1)
+        FAIL("reseed state not settled");
+    sd_verify_all(&head, bk, nodes, present, N, in_table);
+
+    /* every entry now sits where the new seed puts it */
+    for (unsigned i = 0; i < N; i++) {
+        if (!present[i]) continue;
+        union rix_hash_hash_u h = rix_hash_hash_bytes_keyed(
+            &nodes[i].key, sizeof(nodes[i].key), mask, S1);
+        if (nodes[i].cur_hash != h.val32[0] && nodes[i].cur_hash != h.val32[1])
+            FAILF("node %u not placed for the new seed", i);
+    }
+
+    /* the adversarial keys spread out under the new seed */
+    for (unsigned i = 0; i < nb_adv; i++) {
+        struct mynode_slot *ret = myht_sd_sd_insert(&head, bk, nodes, &nodes[i]);
+        if (present[i] ? (ret != &nodes[i]) : (ret != NULL))
+            FAILF("post-reseed insert[%u]", i);
+        if (!present[i]) {
+            present[i] = 1;
+            in_table++;
+        }
+    }
+
+    /* staged pipeline with the sd_ first / last stages */
+    for (unsigned i = 0; i + 4u <= N; i += 4u) {
+        struct rix_hash_find_ctx_s ctx[4];
+        for (unsigned j = 0; j < 4u; j++) {
+            myht_sd_sd_hash_key(&ctx[j], &head, bk, &nodes[i + j].key);
+            myht_sd_scan_bk(&ctx[j], &head, bk);
+            myht_sd_prefetch_node(&ctx[j], nodes);
+        }
+        for (unsigned j = 0; j < 4u; j++) {
+            struct mynode_slot *r =
+                myht_sd_sd_cmp_key(&ctx[j], &head, bk, nodes);
+            if (r != (present[i + j] ? &nodes[i + j] : NULL))
+                FAILF("sd staged find[%u] mismatch", i + j);
+        }
+    }
+    sd_verify_all(&head, bk, nodes, present, N, in_table);
+
+    /* a reseed of a ~90% full table still completes */
+    for (unsigned i = 0; i < N && in_table < N * 9u / 10u; i++) {
+        if (present[i]) continue;
+        if (myht_sd_sd_insert(&head, bk, nodes, &nodes[i]) == NULL) {
+            present[i] = 1;
+            in_table++;
+        }
+    }
+    if (myht_sd_sd_reseed_start(&head, S0 ^ S1) != 0)
+        FAIL("reseed_start refused (full)");
+    steps = 0;
+    while (myht_sd_sd_reseed_step(&head, bk, nodes, 16u) != 0u)
+        if (++steps > 100u * NB_BK)
+            FAIL("full reseed does not finish");
+    sd_verify_all(&head, bk, nodes, present, N, in_table);
+
+    free(bk);
+    free(present);
+    free(nodes);
+}
+
+/* A reseed the new seed cannot place rolls back and clears busy. */
+static void
+test_slot_seed_rollback(void)
+{
+    printf("[T] slot_seed reseed rollback\n");
+
+    const unsigned NB_BK = 64u;
+    const unsigned N     = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ / 2u;
+    const u64      S0    = 0x0123456789ABCDEFULL;
+    const u64      S1    = 0xFEDCBA9876543210ULL;
+    struct myht_sdx head;
+    struct mynode_slot *nodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*nodes));
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    unsigned steps;
+
+    if (!nodes || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    myht_sdx_sd_init(&head, NB_BK, S0);
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi = 0x5eed000000000000ULL | i;
+        nodes[i].key.lo = (u64)i * 0x9E3779B97F4A7C15ULL;
+        if (myht_sdx_sd_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            FAILF("insert[%u] refused", i);
+    }
+
+    /* only 2 buckets fit under the bad seed: the sweep stalls, then rolls back */
+    if (myht_sdx_sd_reseed_start(&head, SDX_BAD_SEED) != 0)
+        FAIL("reseed_start refused");
+    steps = 0;
+    while (myht_sdx_sd_reseed_step(&head, bk, nodes, 8u) != 0u) {
+        /* lookups stay correct while entries sit under both seeds */
+        unsigned i = steps % N;
+        if (myht_sdx_sd_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+            FAILF("find[%u] during rollback", i);
+        if (++steps > 100u * NB_BK)
+            FAIL("failed reseed does not finish");
+    }
+    if (head.rhh_sd.busy || !head.rhh_sd.rollback ||
+        head.rhh_sd.seed != S0 || head.rhh_sd.old != S0)
+        FAILF("rollback state: busy=%u rollback=%u", head.rhh_sd.busy,
+              head.rhh_sd.rollback);
+    for (unsigned i = 0; i < N; i++) {
+        union rix_hash_hash_u h = sdx_hash(&nodes[i].key, head.rhh_mask, S0);
+        if (myht_sdx_sd_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+            FAILF("find[%u] after rollback", i);
+        if (nodes[i].cur_hash != h.val32[0] && nodes[i].cur_hash != h.val32[1])
+            FAILF("node %u not back under the old seed", i);
+    }
+    if (head.rhh_nb != N)
+        FAILF("count after rollback: %u", head.rhh_nb);
+
+    /* a later reseed to a usable seed still completes */
+    if (myht_sdx_sd_reseed_start(&head, S1) != 0)
+        FAIL("reseed_start after rollback refused");
+    steps = 0;
+    while (myht_sdx_sd_reseed_step(&head, bk, nodes, 8u) != 0u)
+        if (++steps > 100u * NB_BK)
+            FAIL("reseed after rollback does not finish");
+    if (head.rhh_sd.busy || head.rhh_sd.rollback || head.rhh_sd.seed != S1)
+        FAIL("reseed after rollback did not switch seeds");
+    for (unsigned i = 0; i < N; i++)
+        if (myht_sdx_sd_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+            FAILF("find[%u] after reseed", i);
+
+    free(bk);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* test_slot_prehashed - Toeplitz vectors, tables fed with NIC hashes  */
+/* ================================================================== */
+static void
+test_slot_prehashed(unsigned seed)
+{
+    static const u8 rss_key[RIX_HASH_RSS_KEY_LEN] = RIX_HASH_RSS_KEY_DEFAULT;
+    /* Microsoft RSS verification suite: addrs, then ports, big-endian */
+    static const struct {
+        u8 tuple[36];
+        unsigned addr_len;
+        u32 h_addr, h_l4;
+    } vec[] = {
+        { { 66, 9, 149, 187, 161, 142, 100, 80, 0x0a, 0xea, 0x06, 0xe6 },
+          8u, 0x323e8fc2u, 0x51ccc178u },
+        { { 199, 92, 111, 2, 65, 69, 140, 83, 0x37, 0x96, 0x12, 0x83 },
+          8u, 0xd718262au, 0xc626b0eau },
+        { { 0x3f, 0xfe, 0x25, 0x01, 0x02, 0x00, 0x1f, 0xff,
+            0, 0, 0, 0, 0, 0, 0, 0x07,
+            0x3f, 0xfe, 0x25, 0x01, 0x02, 0x00, 0x00, 0x03,
+            0, 0, 0, 0, 0, 0, 0, 0x01,
+            0x0a, 0xea, 0x06, 0xe6 },
+          32u, 0x2cc18cd5u, 0x40207d3du },
+    };
+
+    printf("[T] slot prehashed (Toeplitz, hash_from_u32)\n");
+    xr_fuzz = seed ? seed : 0x7E0B1172u;
+
+    for (unsigned v = 0; v < sizeof(vec) / sizeof(vec[0]); v++) {
+        u32 h = rix_hash_toeplitz(rss_key, vec[v].tuple, vec[v].addr_len);
+        if (h != vec[v].h_addr)
+            FAILF("toeplitz vec %u addr 0x%08x", v, h);
+        h = rix_hash_toeplitz(rss_key, vec[v].tuple, vec[v].addr_len + 4u);
+        if (h != vec[v].h_l4)
+            FAILF("toeplitz vec %u l4 0x%08x", v, h);
+    }
+
+    const unsigned NB_BK = 256u;
+    const unsigned N     = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ / 2u;
+    const unsigned mask  = NB_BK - 1u;
+    struct rix_hash_bucket_s *bk = calloc(NB_BK, sizeof(*bk));
+    struct mynode_slot *nodes = calloc(N, sizeof(*nodes));
+    u32 *nic = calloc(N, sizeof(*nic));
+    unsigned *hit = calloc(NB_BK, sizeof(*hit));
+    unsigned nb_used = 0;
+    struct myht_slot head;
+    if (!bk || !nodes || !nic || !hit) FAIL("calloc");
+
+    /* hashes sharing their low 3 bits (one RSS queue of 8) still spread */
+    for (unsigned i = 0; i < N; i++) {
+        union rix_hash_hash_u h;
+
+        nic[i] = (xorshift32() & ~7u) | 5u;
+        h = rix_hash_hash_from_u32(nic[i], mask);
+        if ((h.val32[0] & mask) == (h.val32[1] & mask))
+            FAILF("from_u32 bk0 == bk1 i=%u", i);
+        if (h.val64 != rix_hash_hash_from_u32(nic[i], mask).val64)
+            FAILF("from_u32 not deterministic i=%u", i);
+        nb_used += (hit[h.val32[0] & mask]++ == 0u);
+    }
+    if (nb_used < NB_BK * 3u / 4u)
+        FAILF("from_u32 uses %u of %u buckets", nb_used, NB_BK);
+
+    /* insert and find through the prehashed stage 1 */
+    RIX_HASH_INIT(myht_slot, &head, NB_BK);
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi = i;
+        nodes[i].key.lo = ~(u64)i;
+        if (myht_slot_insert_hashed(&head, bk, nodes, &nodes[i],
+                                    rix_hash_hash_from_u32(nic[i], mask))
+            != NULL)
+            FAILF("insert_hashed[%u]", i);
+    }
+    for (unsigned i = 0; i < N; i++) {
+        struct rix_hash_find_ctx_s ctx;
+        struct mykey miss = { .hi = i, .lo = i };
+
+        myht_slot_hash_key_2bk_hashed(&ctx, &head, bk, &nodes[i].key,
+                                      rix_hash_hash_from_u32(nic[i], mask));
+        myht_slot_scan_bk_empties(&ctx, &head, bk);
+        if (myht_slot_cmp_key_empties(&ctx, nodes) != &nodes[i])
+            FAILF("prehashed find[%u]", i);
+        /* same NIC hash, different key: only the key compare tells */
+        myht_slot_hash_key_2bk_hashed(&ctx, &head, bk, &miss,
+                                      rix_hash_hash_from_u32(nic[i], mask));
+        myht_slot_scan_bk_empties(&ctx, &head, bk);
+        if (myht_slot_cmp_key_empties(&ctx, nodes) != NULL)
+            FAILF("prehashed false hit[%u]", i);
+    }
+    for (unsigned i = 0; i < N; i += 2u)
+        if (myht_slot_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+            FAILF("remove[%u]", i);
+    if (head.rhh_nb != N / 2u)
+        FAILF("nb %u after remove", head.rhh_nb);
+
+    free(hit);
+    free(nic);
+    free(nodes);
+    free(bk);
+}
+
+/* promote_hashed: a table built from NIC hashes, nothing rehashed     */
+static unsigned
+slot_count_displaced_u32(struct myht_slot *head, struct mynode_slot *nodes,
+                         const u32 *nic, unsigned n)
+{
+    unsigned cnt = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        union rix_hash_hash_u h =
+            rix_hash_hash_from_u32(nic[i], head->rhh_mask);
+        if (nodes[i].key.hi == 0u)
+            continue;
+        if ((nodes[i].cur_hash & head->rhh_mask) !=
+            (h.val32[0] & head->rhh_mask))
+            cnt++;
+    }
+    return cnt;
+}
+
+static void
+test_slot_promote_hashed(void)
+{
+    const unsigned NB_BK = 64u;
+    const unsigned N     = 860u;
+    const unsigned mask  = NB_BK - 1u;
+    struct rix_hash_bucket_s *bk = calloc(NB_BK, sizeof(*bk));
+    struct mynode_slot *nodes = calloc(N, sizeof(*nodes));
+    u32 *nic = calloc(N, sizeof(*nic));
+    struct myht_slot head;
+    u32 seq[64];
+    unsigned before, after, moved = 0;
+
+    printf("[T] slot promote_hashed\n");
+    if (!bk || !nodes || !nic) FAIL("calloc");
+    memset(seq, 0, sizeof(seq));
+    RIX_HASH_INIT(myht_slot, &head, NB_BK);
+    for (unsigned i = 0; i < N; i++) {
+        nic[i] = (i + 1u) * 0x9E3779B1u;
+        nodes[i].key.hi = i + 1u;
+        nodes[i].key.lo = 0x5A5A5A5A00000000ULL;
+        if (myht_slot_insert_hashed(&head, bk, nodes, &nodes[i],
+                                    rix_hash_hash_from_u32(nic[i], mask))
+            != NULL)
+            FAILF("promote_hashed: insert[%u] failed", i);
+    }
+    /* the stored pair alone tells bk_0 from bk_1 */
+    for (unsigned i = 0; i < N; i++) {
+        union rix_hash_hash_u h = rix_hash_hash_from_u32(nic[i], mask);
+        u32 cur = nodes[i].cur_hash;
+        u32 fp = bk[cur & mask].hash[nodes[i].slot];
+
+        if (rix_hash_from_u32_is_bk1(cur, cur ^ fp, mask) !=
+            (cur != h.val32[0]))
+            FAILF("is_bk1[%u] disagrees with the hash", i);
+    }
+    if (slot_count_displaced_u32(&head, nodes, nic, N) == 0u)
+        FAIL("promote_hashed: 84% fill left no node in its bk_1");
+
+    for (unsigned i = 0; i < N; i += 4u) {
+        if (myht_slot_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+            FAILF("promote_hashed: remove[%u] failed", i);
+        memset(&nodes[i], 0, sizeof(nodes[i]));
+    }
+    if (RIX_HASH_PROMOTE_HASHED(myht_slot, &head, bk, nodes,
+                                &nodes[0]) != -1)
+        FAIL("promote_hashed of a removed node must fail");
+
+    before = slot_count_displaced_u32(&head, nodes, nic, N);
+    for (unsigned i = 1; i < N; i++) {
+        int rc;
+
+        if (nodes[i].key.hi == 0u)
+            continue;
+        rc = (i & 1u) ?
+            RIX_HASH_PROMOTE_HASHED(myht_slot, &head, bk, nodes,
+                                    &nodes[i]) :
+            myht_slot_seq_promote_hashed(&head, bk, seq, nodes, &nodes[i]);
+        if (rc < -1 || rc > 1)
+            FAILF("promote_hashed[%u] returned %d", i, rc);
+        if (rc == 1)
+            moved++;
+        if (rc == 0 &&
+            myht_slot_promote_hashed(&head, bk, nodes, &nodes[i]) != 0)
+            FAILF("promote_hashed[%u] not idempotent", i);
+    }
+    after = slot_count_displaced_u32(&head, nodes, nic, N);
+    printf("  displaced %u -> %u (%u promoted)\n", before, after, moved);
+    if (moved == 0u || after >= before)
+        FAIL("promote_hashed did not move any displaced node home");
+    for (unsigned i = 0; i < NB_BK; i++) {
+        if (seq[i] & 1u)
+            FAILF("seq_promote_hashed left seq[%u]=%u odd", i, seq[i]);
+    }
+    for (unsigned i = 0; i < N; i++) {
+        struct rix_hash_find_ctx_s ctx;
+
+        if (nodes[i].key.hi == 0u)
+            continue;
+        myht_slot_hash_key_2bk_hashed(&ctx, &head, bk, &nodes[i].key,
+                                      rix_hash_hash_from_u32(nic[i], mask));
+        myht_slot_scan_bk_empties(&ctx, &head, bk);
+        if (myht_slot_cmp_key_empties(&ctx, nodes) != &nodes[i])
+            FAILF("promote_hashed: find[%u] failed", i);
+        slot_verify_node(&head, bk, nodes, &nodes[i]);
+    }
+    free(nic);
+    free(nodes);
+    free(bk);
+}
+
+/* ================================================================== */
+/* Cuckoo filter                                                       */
+/* ================================================================== */
+static void
+test_find_u8x16(unsigned seed)
+{
+    printf("[T] find_u8x16 (dispatch vs GEN)\n");
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    u8 arr[16];
+    for (unsigned iter = 0; iter < 10000u; iter++) {
+        for (unsigned i = 0; i < 16u; i++)
+            arr[i] = (u8)((xorshift32() & 0x7u) * 0x25u); /* incl. 0, sign bit */
+        u8 val = arr[xorshift32() & 15u];
+        if (iter & 1u)
+            val = (u8)((xorshift32() & 0x7u) * 0x25u);
+        u32 want = _rix_hash_find_u8x16_GEN(arr, val);
+        u32 got  = rix_hash_arch->find_u8x16(arr, val);
+        if (got != want)
+            FAILF("iter %u val=0x%02x: got 0x%04x want 0x%04x",
+                  iter, val, got, want);
+    }
+    for (unsigned i = 0; i < 16u; i++)
+        arr[i] = (u8)(0x80u | i);
+    if (rix_hash_arch->find_u8x16(arr, 0x8fu) != 0x8000u)
+        FAIL("high lane miss");
+    if (rix_hash_arch->find_u8x16(arr, 0x80u) != 0x0001u)
+        FAIL("low lane miss");
+}
+
+#define FLT_NB_BK   256u
+#define FLT_LANES   (FLT_NB_BK * RIX_HASH_BUCKET_ENTRY_SZ)
+#define FLT_NB_IN   (FLT_LANES / 8u * 7u)   /* 87.5% lane fill */
+#define FLT_NB_Q    200000u
+#define FLT_BULK    1000u
+
+static struct mykey
+flt_key(unsigned i, unsigned salt)
+{
+    struct mykey k;
+    k.hi = (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+    k.lo = ((uint64_t)salt << 32) | i;
+    return k;
+}
+
+/*
+ * One test function per width: no false negatives, measured false-positive
+ * rate within 1.5x of the 32 / (2^bits - 1) full-load bound, bulk ==
+ * single, remove, 32-copy limit of one key, and a refused insert leaves
+ * the filter unchanged.
+ */
+#define FLT_TEST(name, bkt, bits)                                           \
+static void                                                                 \
+test_filter_##name(unsigned seed)                                           \
+{                                                                           \
+    printf("[T] filter %u-bit\n", (unsigned)(bits));                        \
+    struct name head;                                                       \
+    bkt *bk = aligned_alloc(64, FLT_NB_BK * sizeof(*bk));                   \
+    bkt *snap = malloc(FLT_NB_BK * sizeof(*bk));                            \
+    struct mykey *q = malloc(FLT_BULK * sizeof(*q));                        \
+    const void **qp = malloc(FLT_BULK * sizeof(*qp));                       \
+    union rix_hash_hash_u *qh = malloc(FLT_BULK * sizeof(*qh));             \
+    u8 *maybe = malloc(FLT_BULK);                                           \
+    unsigned salt = seed ? seed : 1u;                                       \
+    unsigned fp_cnt = 0u, nb, nq;                                           \
+    if (!bk || !snap || !q || !qp || !qh || !maybe)                         \
+        FAIL("alloc");                                                      \
+                                                                            \
+    name##_init(&head, bk, FLT_NB_BK);                                      \
+    for (unsigned i = 0; i < FLT_NB_IN; i++) {                              \
+        struct mykey k = flt_key(i, salt);                                  \
+        if (name##_insert(&head, bk, &k, sizeof(k)) != 0)                   \
+            FAILF("insert %u refused", i);                                  \
+    }                                                                       \
+    if (head.rhh_nb != FLT_NB_IN)                                           \
+        FAILF("rhh_nb=%u", head.rhh_nb);                                    \
+    for (unsigned i = 0; i < FLT_NB_IN; i++) {                              \
+        struct mykey k = flt_key(i, salt);                                  \
+        if (!name##_contains(&head, bk, &k, sizeof(k)))                     \
+            FAILF("false negative %u", i);                                  \
+    }                                                                       \
+    for (unsigned i = 0; i < FLT_NB_Q; i++) {                               \
+        struct mykey k = flt_key(i, salt + 1u);                             \
+        fp_cnt += (unsigned)name##_contains(&head, bk, &k, sizeof(k));      \
+    }                                                                       \
+    printf("    fill %u/%u  false positives %u/%u\n",                       \
+           head.rhh_nb, FLT_LANES, fp_cnt, FLT_NB_Q);                       \
+    if ((uint64_t)fp_cnt * ((1u << (bits)) - 1u) * 2u >                     \
+        (uint64_t)FLT_NB_Q * 32u * 3u)                                      \
+        FAILF("false positive rate %u/%u", fp_cnt, FLT_NB_Q);               \
+                                                                            \
+    /* bulk: half inserted, half not */                                     \
+    for (unsigned i = 0; i < FLT_BULK; i++) {                               \
+        q[i]  = flt_key(i * 3u, salt + (i & 1u));                           \
+        qp[i] = &q[i];                                                      \
+        qh[i] = name##_hash(&head, &q[i], sizeof(q[i]));                    \
+    }                                                                       \
+    for (unsigned n = 0; n <= FLT_BULK; n += n < 40u ? 1u : 137u) {         \
+        unsigned want = 0u, got;                                            \
+        for (unsigned i = 0; i < n; i++)                                    \
+            want += (unsigned)name##_contains(&head, bk, &q[i], sizeof(q[i])); \
+        memset(maybe, 0xff, FLT_BULK);                                      \
+        got = name##_contains_bulk(&head, bk, qp, sizeof(q[0]), n, maybe);  \
+        for (unsigned i = 0; i < n; i++)                                    \
+            if (maybe[i] !=                                                 \
+                name##_contains(&head, bk, &q[i], sizeof(q[i])))            \
+                FAILF("bulk n=%u i=%u", n, i);                              \
+        if (got != want)                                                    \
+            FAILF("bulk n=%u got %u want %u", n, got, want);                \
+        got = name##_contains_bulk_hashed(&head, bk, qh, n, maybe);         \
+        if (got != want)                                                    \
+            FAILF("bulk_hashed n=%u got %u want %u", n, got, want);         \
+    }                                                                       \
+                                                                            \
+    /* remove the even keys; the odd ones must stay */                      \
+    for (unsigned i = 0; i < FLT_NB_IN; i += 2u) {                          \
+        struct mykey k = flt_key(i, salt);                                  \
+        if (name##_remove(&head, bk, &k, sizeof(k)) != 0)                   \
+            FAILF("remove %u", i);                                          \
+    }                                                                       \
+    if (head.rhh_nb != FLT_NB_IN / 2u)                                      \
+        FAILF("rhh_nb=%u after remove", head.rhh_nb);                       \
+    for (unsigned i = 1; i < FLT_NB_IN; i += 2u) {                          \
+        struct mykey k = flt_key(i, salt);                                  \
+        if (!name##_contains(&head, bk, &k, sizeof(k)))                     \
+            FAILF("false negative %u after remove", i);                     \
+    }                                                                       \
+                                                                            \
+    /* one key fits 2 x 16 copies, then both buckets are full */            \
+    name##_init(&head, bk, FLT_NB_BK);                                      \
+    {                                                                       \
+        struct mykey k = flt_key(7u, salt);                                 \
+        for (unsigned c = 0; c < 2u * RIX_HASH_BUCKET_ENTRY_SZ; c++)        \
+            if (name##_insert(&head, bk, &k, sizeof(k)) != 0)               \
+                FAILF("copy %u refused", c);                                \
+        if (name##_insert(&head, bk, &k, sizeof(k)) != -1)                  \
+            FAIL("copy 33 accepted");                                       \
+        for (unsigned c = 0; c < 2u * RIX_HASH_BUCKET_ENTRY_SZ; c++)        \
+            if (name##_remove(&head, bk, &k, sizeof(k)) != 0)               \
+                FAILF("copy %u not removed", c);                            \
+        if (name##_remove(&head, bk, &k, sizeof(k)) != -1 ||                \
+            name##_contains(&head, bk, &k, sizeof(k)) || head.rhh_nb != 0u) \
+            FAIL("copies left");                                            \
+    }                                                                       \
+                                                                            \
+    /* fill until refused: the refused insert changes nothing */            \
+    for (nb = 0u;; nb++) {                                                  \
+        struct mykey k = flt_key(nb, salt + 2u);                            \
+        memcpy(snap, bk, FLT_NB_BK * sizeof(*bk));                          \
+        if (name##_insert(&head, bk, &k, sizeof(k)) != 0)                   \
+            break;                                                          \
+    }                                                                       \
+    printf("    max fill %u/%u\n", nb, FLT_LANES);                          \
+    if (head.rhh_nb != nb || nb < FLT_LANES / 10u * 9u)                     \
+        FAILF("max fill %u", nb);                                           \
+    if (memcmp(snap, bk, FLT_NB_BK * sizeof(*bk)) != 0)                     \
+        FAIL("refused insert modified the filter");                         \
+    for (nq = 0u; nq < nb; nq++) {                                          \
+        struct mykey k = flt_key(nq, salt + 2u);                            \
+        if (!name##_contains(&head, bk, &k, sizeof(k)))                     \
+            FAILF("false negative %u at max fill", nq);                     \
+    }                                                                       \
+                                                                            \
+    free(maybe);                                                            \
+    free(qh);                                                               \
+    free(qp);                                                               \
+    free(q);                                                                \
+    free(snap);                                                             \
+    free(bk);                                                               \
+}
+
+FLT_TEST(myflt8,  struct rix_hash_filter8_bucket_s,  8)
+FLT_TEST(myflt12, struct rix_hash_filter16_bucket_s, 12)
+FLT_TEST(myflt16, struct rix_hash_filter16_bucket_s, 16)
+
+/* ================================================================== */
+/* Tag variant (single-cache-line buckets)                             */
+/* ================================================================== */
+static void
+test_find_u16x16(unsigned seed)
+{
+    printf("[T] find_u16x16 (dispatch vs GEN)\n");
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    u16 arr[16];
+    for (unsigned iter = 0; iter < 10000u; iter++) {
+        for (unsigned i = 0; i < 16u; i++)
+            arr[i] = (u16)(xorshift32() & 0x7u) * 0x2492u; /* incl. 0, sign bit */
+        u16 val = arr[xorshift32() & 15u];
+        if (iter & 1u)
+            val = (u16)(xorshift32() & 0x7u) * 0x2492u;
+        u32 want = _rix_hash_find_u16x16_GEN(arr, val);
+        u32 got  = rix_hash_arch->find_u16x16(arr, val);
+        if (got != want)
+            FAILF("iter %u val=0x%04x: got 0x%04x want 0x%04x",
+                  iter, val, got, want);
+    }
+    /* sign bit set in every lane must not confuse the saturating pack */
+    for (unsigned i = 0; i < 16u; i++)
+        arr[i] = (u16)(0x8000u | i);
+    if (rix_hash_arch->find_u16x16(arr, 0x800fu) != 0x8000u)
+        FAIL("high lane miss");
+    if (rix_hash_arch->find_u16x16(arr, 0x8000u) != 0x0001u)
+        FAIL("low lane miss");
+}
+
+static void
+test_find_u16x12(unsigned seed)
+{
+    printf("[T] find_u16x12 (dispatch vs GEN, lanes 12..15 ignored)\n");
+    xr_fuzz = seed ? seed : 0xC0FFEE12u;
+
+    u16 arr[16];
+    for (unsigned iter = 0; iter < 10000u; iter++) {
+        for (unsigned i = 0; i < 12u; i++)
+            arr[i] = (u16)(xorshift32() & 0x7u) * 0x2492u;
+        u16 val = arr[xorshift32() % 12u];
+        if (iter & 1u)
+            val = (u16)(xorshift32() & 0x7u) * 0x2492u;
+        /* what follows the tags (idx[] in a tag bucket) must not match */
+        for (unsigned i = 12u; i < 16u; i++)
+            arr[i] = val;
+        u32 want = _rix_hash_find_u16x12_GEN(arr, val);
+        u32 got  = rix_hash_arch->find_u16x12(arr, val);
+        if (got != want || (got & ~0x0fffu))
+            FAILF("iter %u val=0x%04x: got 0x%04x want 0x%04x",
+                  iter, val, got, want);
+    }
+    /* zero (the empty-slot tag) must not match the zero-filled lanes */
+    for (unsigned i = 0; i < 16u; i++)
+        arr[i] = (u16)(i + 1u);
+    if (rix_hash_arch->find_u16x12(arr, 0u) != 0u)
+        FAIL("zero matched beyond lane 11");
+    if (rix_hash_arch->find_u16x12(arr, 12u) != 0x0800u)
+        FAIL("lane 11 miss");
+}
+
+static void
+tag_verify_node(struct myht_tag *head,
+                struct rix_hash_tag_bucket_s *bk,
+                struct mynode *base,
+                struct mynode *node)
+{
+    unsigned node_idx = RIX_IDX_FROM_PTR(base, node);
+    unsigned bucket = node->cur_hash & head->rhh_mask;
+    struct rix_hash_tag_bucket_s *b = bk + bucket;
+    unsigned s;
+
+    for (s = 0; s < RIX_HASH_TAG_BUCKET_ENTRY_SZ; s++)
+        if (b->idx[s] == node_idx)
+            break;
+    if (s == RIX_HASH_TAG_BUCKET_ENTRY_SZ)
+        FAILF("tag invariant: node_idx=%u not in bucket %u", node_idx, bucket);
+    if (b->tag[s] == 0u)
+        FAILF("tag invariant: node_idx=%u bucket=%u slot=%u tag=0",
+              node_idx, bucket, s);
+    if (b->tag[10] != 0u || b->tag[11] != 0u)
+        FAILF("tag invariant: bucket=%u pad tags dirty", bucket);
+}
+
+static void
+test_tag_fuzz(unsigned seed, unsigned N, unsigned nb_bk, unsigned ops)
+{
+    printf("[T] tag fuzz seed=%u N=%u nb_bk=%u ops=%u\n",
+           seed, N, nb_bk, ops);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    struct mynode *nodes = (struct mynode *)calloc((size_t)N, sizeof(*nodes));
+    unsigned char *present = (unsigned char *)calloc((size_t)N + 1, 1);
+    struct rix_hash_tag_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)nb_bk * sizeof(*bk);
+    if (!nodes || !present || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1);
+        nodes[i].key.lo = 0x7A67000000000000ULL;
+    }
+
+    struct myht_tag head;
+    RIX_HASH_INIT(myht_tag, &head, nb_bk);
+    unsigned in_table = 0;
+
+    for (unsigned step = 0; step < ops; step++) {
+        unsigned op  = xorshift32() % 100;
+        unsigned idx = rnd_in(1, N);
+        struct mynode *elm = &nodes[idx - 1];
+
+        if (op < 60) {
+            struct mynode *ret = myht_tag_insert(&head, bk, nodes, elm);
+            if (present[idx]) {
+                if (ret != elm)
+                    FAILF("tag insert dup[%u]: got %p", idx, (void *)ret);
+            } else if (ret == NULL) {
+                present[idx] = 1;
+                in_table++;
+                tag_verify_node(&head, bk, nodes, elm);
+            } else if (ret != elm) {
+                FAILF("tag insert[%u]: unexpected ret %p", idx, (void *)ret);
+            }
+        } else if (op < 80) {
+            struct mynode *ret = myht_tag_remove(&head, bk, nodes, elm);
+            if (ret != (present[idx] ? elm : NULL))
+                FAILF("tag remove[%u]: got %p present=%u",
+                      idx, (void *)ret, present[idx]);
+            if (present[idx]) {
+                present[idx] = 0;
+                in_table--;
+            }
+        } else {
+            struct mynode *ret = myht_tag_find(&head, bk, nodes, &elm->key);
+            if (ret != (present[idx] ? elm : NULL))
+                FAILF("tag find[%u]: got %p present=%u",
+                      idx, (void *)ret, present[idx]);
+        }
+
+        if ((step & 0x3FFu) == 0u && head.rhh_nb != in_table)
+            FAILF("tag step %u: rhh_nb=%u model=%u",
+                  step, head.rhh_nb, in_table);
+    }
+
+    /* Staged x4 pipeline over the whole key space. */
+    for (unsigned i = 0; i + 4u <= N; i += 4u) {
+        struct rix_hash_tag_find_ctx_s ctx[4];
+        const struct mykey *keys[4];
+        struct mynode *res[4];
+        for (unsigned j = 0; j < 4u; j++)
+            keys[j] = &nodes[i + j].key;
+        RIX_HASH_HASH_KEY4(myht_tag, ctx, &head, bk, keys);
+        RIX_HASH_SCAN_BK4(myht_tag, ctx, &head, bk);
+        RIX_HASH_PREFETCH_NODE4(myht_tag, ctx, nodes);
+        RIX_HASH_CMP_KEY4(myht_tag, ctx, nodes, res);
+        for (unsigned j = 0; j < 4u; j++) {
+            if (res[j] != (present[i + j + 1] ? &nodes[i + j] : NULL))
+                FAILF("tag staged find[%u]: got %p", i + j, (void *)res[j]);
+            if (res[j])
+                tag_verify_node(&head, bk, nodes, res[j]);
+        }
+    }
+
+    free(present);
+    free(bk);
+    free(nodes);
+}
+
+static void
+test_tag_fill(void)
+{
+    printf("[T] tag_fill (first refusal, 1024 buckets)\n");
+
+    const unsigned NB_BK    = 1024u;
+    const unsigned CAPACITY = NB_BK * RIX_HASH_TAG_BUCKET_ENTRY_SZ; /* 10240 */
+
+    struct mynode *nodes =
+        (struct mynode *)calloc((size_t)CAPACITY, sizeof(*nodes));
+    struct rix_hash_tag_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    if (!nodes || posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(bk, 0, bk_sz);
+    for (unsigned i = 0; i < CAPACITY; i++) {
+        nodes[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0x7A67F11100000000ULL | i;
+    }
+
+    struct myht_tag head;
+    RIX_HASH_INIT(myht_tag, &head, NB_BK);
+
+    unsigned inserted = 0;
+    while (inserted < CAPACITY &&
+           myht_tag_insert(&head, bk, nodes, &nodes[inserted]) == NULL)
+        inserted++;
+    printf("  first refusal at %u / %u (%.1f%%)\n",
+           inserted, CAPACITY, 100.0 * inserted / CAPACITY);
+    if (inserted * 100u < CAPACITY * 90u)
+        FAILF("kickout refused at %u / %u", inserted, CAPACITY);
+
+    for (unsigned i = 0; i < inserted; i++) {
+        if (myht_tag_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+            FAILF("tag_fill find[%u] failed", i);
+        tag_verify_node(&head, bk, nodes, &nodes[i]);
+    }
+    for (unsigned i = 0; i < inserted; i += 2u)
+        if (myht_tag_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+            FAILF("tag_fill remove[%u] failed", i);
+    if (head.rhh_nb != inserted - (inserted + 1u) / 2u)
+        FAILF("tag_fill rhh_nb=%u", head.rhh_nb);
+
+    free(bk);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* Resumable walk (walk_step)                                          */
+/* ================================================================== */
+/*
+ * Drain a table with fn(head, bk, cursor, budget, idx, max_out, &n) and
+ * count each reported idx in seen[idx - 1].  Every step must stay within
+ * budget buckets and max_out entries and make progress.
+ */
+#define WS_DRAIN(fn, head, bk, budget, max_out, idx, seen) do {           \
+    unsigned _cur = 0u, _n, _next;                                        \
+    do {                                                                  \
+        _next = fn(head, bk, _cur, budget, idx, max_out, &_n);            \
+        if (_n > (max_out) ||                                             \
+            (_next != 0u && (_next <= _cur || _next - _cur > (budget))))  \
+            FAILF(#fn " at %u: n=%u next=%u", _cur, _n, _next);           \
+        for (unsigned _j = 0; _j < _n; _j++)                              \
+            (seen)[(idx)[_j] - 1u]++;                                     \
+        _cur = _next;                                                     \
+    } while (_cur != 0u);                                                 \
+} while (0)
+
+static void
+ws_check(const char *what, const unsigned *seen,
+         const unsigned char *present, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        if (seen[i] != present[i])
+            FAILF("%s: node %u seen %u times (present %u)",
+                  what, i, seen[i], present[i]);
+}
+
+static void
+test_walk_step(unsigned seed)
+{
+    printf("[T] walk_step (resumable walk, all variants)\n");
+
+    const unsigned NB_BK = 256u;
+    const unsigned N     = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ * 3u / 4u;
+    static const unsigned cfg[][2] = {  /* budget, max_out */
+        { 1u, 16u }, { 7u, 40u }, { 256u, 16u }, { 256u, 4096u },
+    };
+
+    struct mynode *nodes = (struct mynode *)calloc((size_t)N, sizeof(*nodes));
+    struct mynode_keyonly *knodes =
+        (struct mynode_keyonly *)calloc((size_t)N, sizeof(*knodes));
+    struct mynode_slot *snodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*snodes));
+    unsigned *seen = (unsigned *)calloc((size_t)N, sizeof(*seen));
+    unsigned char *present = (unsigned char *)calloc((size_t)N, 1);
+    u32 *idx = (u32 *)calloc(4096u, sizeof(*idx));
+    struct rix_hash_bucket_s *bk = NULL;
+    struct rix_hash_tag_bucket_s *tbk = NULL;
+    size_t bk_sz  = (size_t)(NB_BK + 4u) * sizeof(*bk);
+    size_t tbk_sz = (size_t)NB_BK * 2u * sizeof(*tbk);
+    if (!nodes || !knodes || !snodes || !seen || !present || !idx ||
+        posix_memalign((void **)&bk, 64, bk_sz) != 0 ||
+        posix_memalign((void **)&tbk, 64, tbk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi  = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo  = 0x3A1C0000ULL | i;
+        knodes[i].key    = nodes[i].key;
+        snodes[i].key    = nodes[i].key;
+    }
+
+    /* fp: every budget / max_out combination reports each entry once */
+    struct myht head;
+    memset(bk, 0, bk_sz);
+    RIX_HASH_INIT(myht, &head, NB_BK);
+    {
+        unsigned n, next = myht_walk_step(&head, bk, 0u, NB_BK, idx, 16u, &n);
+        if (next != 0u || n != 0u)
+            FAILF("empty table: next=%u n=%u", next, n);
+        next = myht_walk_step(&head, bk, NB_BK, 1u, idx, 16u, &n);
+        if (next != 0u || n != 0u)
+            FAILF("cursor past the end: next=%u n=%u", next, n);
+    }
+    for (unsigned i = 0; i < N; i++) {
+        if (myht_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            FAILF("fp insert %u", i);
+        present[i] = 1;
+    }
+    for (unsigned c = 0; c < sizeof(cfg) / sizeof(cfg[0]); c++) {
+        memset(seen, 0, (size_t)N * sizeof(*seen));
+        WS_DRAIN(myht_walk_step, &head, bk, cfg[c][0], cfg[c][1], idx, seen);
+        ws_check("fp", seen, present, N);
+    }
+
+    /* fp with removals between steps: untouched entries exactly once */
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    {
+        unsigned cur = 0u, n;
+        do {
+            cur = myht_walk_step(&head, bk, cur, 5u, idx, 32u, &n);
+            for (unsigned j = 0; j < n; j++)
+                seen[idx[j] - 1u]++;
+            for (unsigned k = 0; k < 8u; k++) {
+                unsigned i = xorshift32() % N;
+                if (!present[i])
+                    continue;
+                if (myht_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+                    FAILF("fp remove %u", i);
+                present[i] = 0;
+            }
+        } while (cur != 0u);
+    }
+    for (unsigned i = 0; i < N; i++)
+        if (present[i] ? seen[i] != 1u : seen[i] > 1u)
+            FAILF("fp churn: node %u seen %u times (present %u)",
+                  i, seen[i], present[i]);
+
+    /* keyonly */
+    struct myht_keyonly khead;
+    memset(bk, 0, bk_sz);
+    RIX_HASH_INIT(myht_keyonly, &khead, NB_BK);
+    for (unsigned i = 0; i < N; i++) {
+        if (myht_keyonly_insert(&khead, bk, knodes, &knodes[i]) != NULL)
+            FAILF("keyonly insert %u", i);
+        present[i] = 1;
+    }
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WS_DRAIN(myht_keyonly_walk_step, &khead, bk, 3u, 16u, idx, seen);
+    ws_check("keyonly", seen, present, N);
+
+    /* tag: 10 slots per bucket */
+    struct myht_tag thead;
+    memset(tbk, 0, tbk_sz);
+    RIX_HASH_INIT(myht_tag, &thead, NB_BK * 2u);
+    for (unsigned i = 0; i < N; i++)
+        if (myht_tag_insert(&thead, tbk, nodes, &nodes[i]) != NULL)
+            FAILF("tag insert %u", i);
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WS_DRAIN(myht_tag_walk_step, &thead, tbk, 3u,
+             RIX_HASH_TAG_BUCKET_ENTRY_SZ, idx, seen);
+    ws_check("tag", seen, present, N);
+
+    /* stash: main buckets plus the stash behind them */
+    struct myht_st shead;
+    unsigned nst = 0u;
+    memset(bk, 0, bk_sz);
+    memset(present, 0, N);
+    myht_st_st_init(&shead, 64u, 4u);
+    for (unsigned i = 0; i < N; i++) {
+        if (myht_st_st_insert(&shead, bk, snodes, &snodes[i]) != NULL)
+            break;
+        present[i] = 1;
+        nst++;
+    }
+    if (shead.rhh_st.nb == 0u)
+        FAIL("stash unused");
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WS_DRAIN(myht_st_st_walk_step, &shead, bk, 2u, 16u, idx, seen);
+    ws_check("stash", seen, present, N);
+
+    /* resize: in the middle of a grow, split and unsplit halves */
+    struct myht_dyn rhead;
+    memset(bk, 0, bk_sz);
+    memset(present, 0, N);
+    myht_dyn_rs_init(&rhead, 64u);
+    for (unsigned i = 0; i < 700u; i++) {
+        if (myht_dyn_rs_insert(&rhead, bk, snodes, &snodes[i]) != NULL)
+            FAILF("rs insert %u", i);
+        present[i] = 1;
+    }
+    if (myht_dyn_rs_grow_begin(&rhead) != 0)
+        FAIL("grow_begin");
+    (void)myht_dyn_rs_grow_step(&rhead, bk, snodes, 20u);
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WS_DRAIN(myht_dyn_rs_walk_step, &rhead, bk, 4u, 16u, idx, seen);
+    ws_check("resize", seen, present, N);
+    printf("  stash table %u entries (%u in stash), grow split %u/64\n",
+           nst, shead.rhh_st.nb, rhead.rhh_rs.split);
+
+    free(tbk);
+    free(bk);
+    free(idx);
+    free(present);
+    free(seen);
+    free(snodes);
+    free(knodes);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* Bucket range walk (walk_range)                                      */
+/* ================================================================== */
+struct wr_arg {
+    const char *base;
+    size_t      sz;
+    unsigned   *seen;
+};
+
+static int
+wr_cb(struct mynode *node, void *arg)
+{
+    struct wr_arg *a = (struct wr_arg *)arg;
+    a->seen[(size_t)((const char *)node - a->base) / a->sz]++;
+    return 0;
+}
+
+static int
+wr_slot_cb(struct mynode_slot *node, void *arg)
+{
+    struct wr_arg *a = (struct wr_arg *)arg;
+    a->seen[(size_t)((const char *)node - a->base) / a->sz]++;
+    return 0;
+}
+
+static int
+wr_keyonly_cb(struct mynode_keyonly *node, void *arg)
+{
+    struct wr_arg *a = (struct wr_arg *)arg;
+    a->seen[(size_t)((const char *)node - a->base) / a->sz]++;
+    return 0;
+}
+
+/*
+ * Walk [0, nb) as consecutive ranges of width w; the last one is passed
+ * as [lo, UINT_MAX) to exercise the clamp.
+ */
+#define WR_SPLIT(fn, head, bk, base, cb, arg, nb, w) do {                 \
+    for (unsigned _lo = 0u; _lo < (nb); _lo += (w)) {                     \
+        unsigned _hi = (_lo + (w) >= (nb)) ? UINT_MAX : _lo + (w);        \
+        if (fn(head, bk, base, _lo, _hi, cb, arg) != 0)                   \
+            FAILF(#fn " [%u, %u) returned non-zero", _lo, _hi);           \
+    }                                                                     \
+} while (0)
+
+static void
+test_walk_range(void)
+{
+    printf("[T] walk_range (bucket ranges, all variants)\n");
+
+    const unsigned NB_BK = 256u;
+    const unsigned N     = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ * 3u / 4u;
+
+    struct mynode *nodes = (struct mynode *)calloc((size_t)N, sizeof(*nodes));
+    struct mynode_keyonly *knodes =
+        (struct mynode_keyonly *)calloc((size_t)N, sizeof(*knodes));
+    struct mynode_slot *snodes =
+        (struct mynode_slot *)calloc((size_t)N, sizeof(*snodes));
+    unsigned *seen = (unsigned *)calloc((size_t)N, sizeof(*seen));
+    unsigned char *present = (unsigned char *)calloc((size_t)N, 1);
+    struct rix_hash_bucket_s *bk = NULL;
+    struct rix_hash_tag_bucket_s *tbk = NULL;
+    size_t bk_sz  = (size_t)(NB_BK + 4u) * sizeof(*bk);
+    size_t tbk_sz = (size_t)NB_BK * 2u * sizeof(*tbk);
+    if (!nodes || !knodes || !snodes || !seen || !present ||
+        posix_memalign((void **)&bk, 64, bk_sz) != 0 ||
+        posix_memalign((void **)&tbk, 64, tbk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    for (unsigned i = 0; i < N; i++) {
+        nodes[i].key.hi  = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo  = 0x5B2E0000ULL | i;
+        knodes[i].key    = nodes[i].key;
+        snodes[i].key    = nodes[i].key;
+    }
+    struct wr_arg a  = { (const char *)nodes,  sizeof(*nodes),  seen };
+    struct wr_arg ka = { (const char *)knodes, sizeof(*knodes), seen };
+    struct wr_arg sa = { (const char *)snodes, sizeof(*snodes), seen };
+
+    /* fp: any split into ranges reports each entry once */
+    struct myht head;
+    memset(bk, 0, bk_sz);
+    RIX_HASH_INIT(myht, &head, NB_BK);
+    for (unsigned i = 0; i < N; i++) {
+        if (myht_insert(&head, bk, nodes, &nodes[i]) != NULL)
+            FAILF("fp insert %u", i);
+        present[i] = 1;
+    }
+    static const unsigned widths[] = { 1u, 7u, 64u, 255u, 256u };
+    for (unsigned w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        memset(seen, 0, (size_t)N * sizeof(*seen));
+        WR_SPLIT(myht_walk_range, &head, bk, nodes, wr_cb, &a,
+                 NB_BK, widths[w]);
+        ws_check("fp", seen, present, N);
+    }
+
+    /* empty and out-of-table ranges visit nothing; early stop */
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    myht_walk_range(&head, bk, nodes, 5u, 5u, wr_cb, &a);
+    myht_walk_range(&head, bk, nodes, 9u, 3u, wr_cb, &a);
+    myht_walk_range(&head, bk, nodes, NB_BK, UINT_MAX, wr_cb, &a);
+    for (unsigned i = 0; i < N; i++)
+        if (seen[i] != 0u)
+            FAILF("empty range visited node %u", i);
+    {
+        int scnt = 0;
+        int ret = myht_walk_range(&head, bk, nodes, 100u, 200u,
+                                  walk_stop_cb, &scnt);
+        if (ret != 99 || scnt != 3)
+            FAILF("early stop: ret=%d cnt=%d", ret, scnt);
+    }
+
+    /* keyonly */
+    struct myht_keyonly khead;
+    memset(bk, 0, bk_sz);
+    RIX_HASH_INIT(myht_keyonly, &khead, NB_BK);
+    for (unsigned i = 0; i < N; i++)
+        if (myht_keyonly_insert(&khead, bk, knodes, &knodes[i]) != NULL)
+            FAILF("keyonly insert %u", i);
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WR_SPLIT(myht_keyonly_walk_range, &khead, bk, knodes, wr_keyonly_cb,
+             &ka, NB_BK, 37u);
+    ws_check("keyonly", seen, present, N);
+
+    /* tag */
+    struct myht_tag thead;
+    memset(tbk, 0, tbk_sz);
+    RIX_HASH_INIT(myht_tag, &thead, NB_BK * 2u);
+    for (unsigned i = 0; i < N; i++)
+        if (myht_tag_insert(&thead, tbk, nodes, &nodes[i]) != NULL)
+            FAILF("tag insert %u", i);
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WR_SPLIT(myht_tag_walk_range, &thead, tbk, nodes, wr_cb, &a,
+             NB_BK * 2u, 100u);
+    ws_check("tag", seen, present, N);
+
+    /* stash: the ranges run on into the stash buckets */
+    struct myht_st shead;
+    memset(bk, 0, bk_sz);
+    memset(present, 0, N);
+    myht_st_st_init(&shead, 64u, 4u);
+    for (unsigned i = 0; i < N; i++) {
+        if (myht_st_st_insert(&shead, bk, snodes, &snodes[i]) != NULL)
+            break;
+        present[i] = 1;
+    }
+    if (shead.rhh_st.nb == 0u)
+        FAIL("stash unused");
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WR_SPLIT(myht_st_st_walk_range, &shead, bk, snodes, wr_slot_cb, &sa,
+             64u + 4u, 5u);
+    ws_check("stash", seen, present, N);
+
+    /* resize: in the middle of a grow */
+    struct myht_dyn rhead;
+    memset(bk, 0, bk_sz);
+    memset(present, 0, N);
+    myht_dyn_rs_init(&rhead, 64u);
+    for (unsigned i = 0; i < 700u; i++) {
+        if (myht_dyn_rs_insert(&rhead, bk, snodes, &snodes[i]) != NULL)
+            FAILF("rs insert %u", i);
+        present[i] = 1;
+    }
+    if (myht_dyn_rs_grow_begin(&rhead) != 0)
+        FAIL("grow_begin");
+    (void)myht_dyn_rs_grow_step(&rhead, bk, snodes, 20u);
+    memset(seen, 0, (size_t)N * sizeof(*seen));
+    WR_SPLIT(myht_dyn_rs_walk_range, &rhead, bk, snodes, wr_slot_cb, &sa,
+             128u, 9u);
+    ws_check("resize", seen, present, N);
+
+    free(tbk);
+    free(bk);
+    free(present);
+    free(seen);
+    free(snodes);
+    free(knodes);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* Parallel bulk build (build_range / build_finish)                    */
+/* ================================================================== */
+#define BUILD_THREADS 4u
+
+struct build_arg {
+    struct myht               *head;
+    struct rix_hash_bucket_s  *bk;
+    struct mynode             *base;
+    struct mynode * const     *elms;
+    unsigned                   n;
+    unsigned                   bk_begin;
+    unsigned                   bk_end;
+    struct mynode            **spill;
+    unsigned                   nb_spill;
+    unsigned                   placed;
+};
+
+static void *
+build_main(void *p)
+{
+    struct build_arg *a = (struct build_arg *)p;
+    a->placed = myht_build_range(a->head, a->bk, a->base, a->elms, a->n,
+                                 a->bk_begin, a->bk_end,
+                                 a->spill, &a->nb_spill);
+    return NULL;
+}
+
+/*
+ * N unique keys at 90% fill, then D copies of earlier keys at the end of
+ * elms[].  BUILD_THREADS threads build disjoint ranges either from the
+ * whole elms[] or from a build_bk partition; build_finish must leave the
+ * same set a serial insert would: the N originals, the D copies reported
+ * as duplicates of them.
+ */
+static void
+test_build_range(unsigned seed)
+{
+    printf("[T] build_range (parallel bulk build, %u threads)\n",
+           BUILD_THREADS);
+
+    const unsigned NB_BK = 1024u;
+    const unsigned N     = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ * 9u / 10u;
+    const unsigned D     = 200u;
+    const unsigned T     = N + D;
+
+    struct mynode *nodes = (struct mynode *)calloc((size_t)T, sizeof(*nodes));
+    struct mynode_slot *snodes =
+        (struct mynode_slot *)calloc((size_t)T, sizeof(*snodes));
+    struct mynode_keyonly *knodes =
+        (struct mynode_keyonly *)calloc((size_t)T, sizeof(*knodes));
+    struct mynode **elms  = (struct mynode **)calloc((size_t)T, sizeof(*elms));
+    struct mynode **part  = (struct mynode **)calloc((size_t)T, sizeof(*part));
+    struct mynode **spill =
+        (struct mynode **)calloc((size_t)T * BUILD_THREADS, sizeof(*spill));
+    struct mynode **res   = (struct mynode **)calloc((size_t)T, sizeof(*res));
+    struct mynode_slot **selms =
+        (struct mynode_slot **)calloc((size_t)T, sizeof(*selms));
+    struct mynode_slot **sspill =
+        (struct mynode_slot **)calloc((size_t)T, sizeof(*sspill));
+    struct mynode_keyonly **kelms =
+        (struct mynode_keyonly **)calloc((size_t)T, sizeof(*kelms));
+    struct mynode_keyonly **kspill =
+        (struct mynode_keyonly **)calloc((size_t)T, sizeof(*kspill));
+    struct rix_hash_bucket_s *bk = NULL;
+    size_t bk_sz = (size_t)NB_BK * sizeof(*bk);
+    if (!nodes || !snodes || !knodes || !elms || !part || !spill || !res ||
+        !selms || !sspill || !kelms || !kspill ||
+        posix_memalign((void **)&bk, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+    for (unsigned i = 0; i < T; i++) {
+        unsigned src = (i < N) ? i : xorshift32() % N;
+        nodes[i].key.hi = (uint64_t)(src + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].key.lo = 0x6C0B0000ULL | src;
+        snodes[i].key   = nodes[i].key;
+        knodes[i].key   = nodes[i].key;
+        elms[i]  = &nodes[i];
+        selms[i] = &snodes[i];
+        kelms[i] = &knodes[i];
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        struct myht head;
+        struct build_arg args[BUILD_THREADS];
+        pthread_t th[BUILD_THREADS];
+        unsigned per = NB_BK / BUILD_THREADS, off = 0u;
+        unsigned placed = 0u, nsp = 0u, ok;
+
+        memset(bk, 0, bk_sz);
+        RIX_HASH_INIT(myht, &head, NB_BK);
+        for (unsigned t = 0; t < BUILD_THREADS; t++) {
+            struct build_arg *a = &args[t];
+            a->head     = &head;
+            a->bk       = bk;
+            a->base     = nodes;
+            a->bk_begin = t * per;
+            a->bk_end   = (t == BUILD_THREADS - 1u) ? UINT_MAX : (t + 1u) * per;
+            a->spill    = spill + (size_t)t * T;
+            if (mode == 0) {
+                a->elms = elms;
+                a->n    = T;
+            } else {
+                /* partition by primary bucket, keeping elms[] order */
+                a->elms = part + off;
+                a->n    = 0u;
+                for (unsigned i = 0; i < T; i++) {
+                    unsigned b = myht_build_bk(&head, elms[i]);
+                    if (b >= a->bk_begin && b < a->bk_end)
+                        part[off + a->n++] = elms[i];
+                }
+                off += a->n;
+            }
+        }
+        for (unsigned t = 0; t < BUILD_THREADS; t++)
+            if (pthread_create(&th[t], NULL, build_main, &args[t]) != 0) {
+                perror("pthread_create"); exit(1);
+            }
+        for (unsigned t = 0; t < BUILD_THREADS; t++)
+            pthread_join(th[t], NULL);
+        if (head.rhh_nb != 0u)
+            FAILF("rhh_nb=%u before build_finish", head.rhh_nb);
+
+        for (unsigned t = 0; t < BUILD_THREADS; t++) {
+            placed += args[t].placed;
+            memmove(spill + nsp, args[t].spill,
+                    (size_t)args[t].nb_spill * sizeof(*spill));
+            nsp += args[t].nb_spill;
+        }
+        if (nsp < D)
+            FAILF("only %u spills for %u duplicates", nsp, D);
+        ok = myht_build_finish(&head, bk, nodes, placed, spill, nsp, res);
+        if (placed + ok != N || head.rhh_nb != N)
+            FAILF("mode %d: placed=%u finish=%u rhh_nb=%u (N=%u)",
+                  mode, placed, ok, head.rhh_nb, N);
+        for (unsigned j = 0; j < nsp; j++) {
+            unsigned i = (unsigned)(spill[j] - nodes);
+            struct mynode *want = (i < N) ? NULL
+                : &nodes[nodes[i].key.lo & 0xFFFFu];
+            if (res[j] != want)
+                FAILF("mode %d: spill %u (node %u) result %p want %p",
+                      mode, j, i, (void *)res[j], (void *)want);
+        }
+        for (unsigned i = 0; i < N; i++)
+            if (myht_find(&head, bk, nodes, &nodes[i].key) != &nodes[i])
+                FAILF("mode %d: find[%u]", mode, i);
+        for (unsigned i = 0; i < N; i++)
+            if (myht_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+                FAILF("mode %d: remove[%u]", mode, i);
+        if (head.rhh_nb != 0u)
+            FAILF("mode %d: rhh_nb=%u after removing all", mode, head.rhh_nb);
+        printf("  %s: %u placed in range, %u spilled (%u duplicates)\n",
+               mode ? "partitioned" : "whole elms ", placed, nsp, D);
+    }
+
+    /* slot and keyonly: the ranges one after another */
+    {
+        struct myht_slot head;
+        unsigned placed = 0u, nsp = 0u, n;
+        memset(bk, 0, bk_sz);
+        RIX_HASH_INIT(myht_slot, &head, NB_BK);
+        for (unsigned lo = 0; lo < NB_BK; lo += NB_BK / 8u) {
+            placed += myht_slot_build_range(&head, bk, snodes, selms, T,
+                                            lo, lo + NB_BK / 8u,
+                                            sspill + nsp, &n);
+            nsp += n;
+        }
+        if (placed + myht_slot_build_finish(&head, bk, snodes, placed,
+                                            sspill, nsp, NULL) != N ||
+            head.rhh_nb != N)
+            FAILF("slot: placed=%u rhh_nb=%u", placed, head.rhh_nb);
+        for (unsigned i = 0; i < N; i++)
+            if (myht_slot_find(&head, bk, snodes, &snodes[i].key) != &snodes[i])
+                FAILF("slot find[%u]", i);
+        for (unsigned i = 0; i < N; i++)
+            if (myht_slot_remove(&head, bk, snodes, &snodes[i]) != &snodes[i])
+                FAILF("slot remove[%u]", i);
+        if (head.rhh_nb != 0u)
+            FAILF("slot rhh_nb=%u after removing all", head.rhh_nb);
+    }
+    {
+        struct myht_keyonly head;
+        unsigned placed = 0u, nsp = 0u, n;
+        memset(bk, 0, bk_sz);
+        RIX_HASH_INIT(myht_keyonly, &head, NB_BK);
+        for (unsigned lo = 0; lo < NB_BK; lo += NB_BK / 8u) {
+            placed += myht_keyonly_build_range(&head, bk, knodes, kelms, T,
+                                               lo, lo + NB_BK / 8u,
+                                               kspill + nsp, &n);
+            nsp += n;
+        }
+        if (placed + myht_keyonly_build_finish(&head, bk, knodes, placed,
+                                               kspill, nsp, NULL) != N ||
+            head.rhh_nb != N)
+            FAILF("keyonly: placed=%u rhh_nb=%u", placed, head.rhh_nb);
+        for (unsigned i = 0; i < N; i++)
+            if (myht_keyonly_find(&head, bk, knodes, &knodes[i].key) !=
+                &knodes[i])
+                FAILF("keyonly find[%u]", i);
+    }
+    /* into a non-empty table: keys already stored (some in a bk1 of    */
+    /* another range, with room in bk0) must not be placed again        */
+    {
+        struct myht head;
+        unsigned placed = 0u, nsp = 0u, nb, ok;
+        memset(bk, 0, bk_sz);
+        RIX_HASH_INIT(myht, &head, NB_BK);
+        /* fill to 90% so kickouts move many keys to bk1, then free half */
+        for (unsigned i = 0; i < N; i++)
+            if (myht_insert(&head, bk, nodes, &nodes[i]) != NULL)
+                FAILF("non-empty: pre-insert[%u]", i);
+        for (unsigned i = 1; i < N; i += 2u)
+            if (myht_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+                FAILF("non-empty: pre-remove[%u]", i);
+        nb = head.rhh_nb;
+        for (unsigned lo = 0; lo < NB_BK; lo += NB_BK / 8u) {
+            unsigned k;
+            placed += myht_build_range(&head, bk, nodes, elms, T,
+                                       lo, lo + NB_BK / 8u,
+                                       spill + nsp, &k);
+            nsp += k;
+        }
+        ok = myht_build_finish(&head, bk, nodes, placed, spill, nsp, res);
+        if (nb + placed + ok != N || head.rhh_nb != N)
+            FAILF("non-empty: pre=%u placed=%u finish=%u rhh_nb=%u (N=%u)",
+                  nb, placed, ok, head.rhh_nb, N);
+        /* one remove per key must empty the table: no second copy */
+        for (unsigned i = 0; i < N; i++)
+            if (myht_remove(&head, bk, nodes, &nodes[i]) != &nodes[i])
+                FAILF("non-empty: remove[%u]", i);
+        for (unsigned i = 0; i < N; i++)
+            if (myht_find(&head, bk, nodes, &nodes[i].key) != NULL)
+                FAILF("non-empty: key %u stored twice", i);
+        if (head.rhh_nb != 0u)
+            FAILF("non-empty: rhh_nb=%u after removing all", head.rhh_nb);
+    }
+
+    free(bk);
+    free(kspill);
+    free(kelms);
+    free(sspill);
+    free(selms);
+    free(res);
+    free(spill);
+    free(part);
+    free(elms);
+    free(knodes);
+    free(snodes);
+    free(nodes);
+}
+
+/* ================================================================== */
+/* Bulk insert / remove: must match sequential single-shot calls      */
+/* ================================================================== */
+#define BULK_N      1000u
+#define BULK_NB_BK    64u  /* 1024 slots: the table fills up */
+#define BULK_MAX      96u
+
+/*
+ * Table A is driven by insert_bulk / remove_bulk, table B by the same
+ * elements one call at a time.  Per-element results, counts, node
+ * fields and the raw bucket arrays must stay identical.
+ */
+static void
+test_bulk(unsigned seed, unsigned rounds)
+{
+    printf("[T] fp bulk insert/remove seed=%u rounds=%u\n", seed, rounds);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    struct mynode *na = (struct mynode *)calloc(BULK_N, sizeof(*na));
+    struct mynode *nb = (struct mynode *)calloc(BULK_N, sizeof(*nb));
+    struct rix_hash_bucket_s *ba = NULL, *bb = NULL;
+    size_t bk_sz = (size_t)BULK_NB_BK * sizeof(*ba);
+    if (!na || !nb || posix_memalign((void **)&ba, 64, bk_sz) != 0 ||
+        posix_memalign((void **)&bb, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(ba, 0, bk_sz);
+    memset(bb, 0, bk_sz);
+    for (unsigned i = 0; i < BULK_N; i++) {
+        na[i].key.hi = nb[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        na[i].key.lo = nb[i].key.lo = 0xB01C000000000000ULL | i;
+    }
+
+    struct myht ha, hb;
+    RIX_HASH_INIT(myht, &ha, BULK_NB_BK);
+    RIX_HASH_INIT(myht, &hb, BULK_NB_BK);
+
+    for (unsigned r = 0; r < rounds; r++) {
+        struct mynode *ea[BULK_MAX], *eb[BULK_MAX], *res[BULK_MAX];
+        unsigned n = rnd_in(1, BULK_MAX);
+        int ins = (xorshift32() % 100u) < 60u;
+        unsigned exp = 0;
+
+        for (unsigned j = 0; j < n; j++) {
+            /* narrow range on odd rounds: many in-batch duplicates */
+            unsigned idx = (r & 1u) ? rnd_in(0, 31) : rnd_in(0, BULK_N - 1);
+            ea[j] = &na[idx];
+            eb[j] = &nb[idx];
+        }
+        if (ins) {
+            unsigned got = myht_insert_bulk(&ha, ba, na, ea, n, res);
+            for (unsigned j = 0; j < n; j++) {
+                struct mynode *rb = myht_insert(&hb, bb, nb, eb[j]);
+                unsigned ia = res[j] ? RIX_IDX_FROM_PTR(na, res[j]) : 0u;
+                unsigned ib = rb ? RIX_IDX_FROM_PTR(nb, rb) : 0u;
+                if (ia != ib)
+                    FAILF("round %u insert[%u]: bulk=%u seq=%u", r, j, ia, ib);
+                exp += (rb == NULL);
+            }
+            if (got != exp)
+                FAILF("round %u insert_bulk returned %u, expected %u",
+                      r, got, exp);
+        } else {
+            unsigned got = myht_remove_bulk(&ha, ba, na, ea, n);
+            for (unsigned j = 0; j < n; j++)
+                exp += (myht_remove(&hb, bb, nb, eb[j]) != NULL);
+            if (got != exp)
+                FAILF("round %u remove_bulk returned %u, expected %u",
+                      r, got, exp);
+        }
+        if (ha.rhh_nb != hb.rhh_nb)
+            FAILF("round %u rhh_nb bulk=%u seq=%u", r, ha.rhh_nb, hb.rhh_nb);
+        if (memcmp(ba, bb, bk_sz) != 0 ||
+            memcmp(na, nb, (size_t)BULK_N * sizeof(*na)) != 0)
+            FAILF("round %u: bulk and sequential tables diverged", r);
+    }
+    if (myht_insert_bulk(&ha, ba, na, NULL, 0u, NULL) != 0u ||
+        myht_remove_bulk(&ha, ba, na, NULL, 0u) != 0u)
+        FAIL("empty batch must be a no-op");
+
+    free(bb);
+    free(ba);
+    free(nb);
+    free(na);
+}
+
+static void
+test_slot_bulk(unsigned seed, unsigned rounds)
+{
+    printf("[T] slot bulk insert/remove seed=%u rounds=%u\n", seed, rounds);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    struct mynode_slot *na = (struct mynode_slot *)calloc(BULK_N, sizeof(*na));
+    struct mynode_slot *nb = (struct mynode_slot *)calloc(BULK_N, sizeof(*nb));
+    struct rix_hash_bucket_s *ba = NULL, *bb = NULL;
+    size_t bk_sz = (size_t)BULK_NB_BK * sizeof(*ba);
+    if (!na || !nb || posix_memalign((void **)&ba, 64, bk_sz) != 0 ||
+        posix_memalign((void **)&bb, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(ba, 0, bk_sz);
+    memset(bb, 0, bk_sz);
+    for (unsigned i = 0; i < BULK_N; i++) {
+        na[i].key.hi = nb[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        na[i].key.lo = nb[i].key.lo = 0xB01C000000000000ULL | i;
+    }
+
+    struct myht_slot ha, hb;
+    RIX_HASH_INIT(myht_slot, &ha, BULK_NB_BK);
+    RIX_HASH_INIT(myht_slot, &hb, BULK_NB_BK);
+
+    for (unsigned r = 0; r < rounds; r++) {
+        struct mynode_slot *ea[BULK_MAX], *eb[BULK_MAX], *res[BULK_MAX];
+        unsigned n = rnd_in(1, BULK_MAX);
+        int ins = (xorshift32() % 100u) < 60u;
+        unsigned exp = 0;
+
+        for (unsigned j = 0; j < n; j++) {
+            unsigned idx = (r & 1u) ? rnd_in(0, 31) : rnd_in(0, BULK_N - 1);
+            ea[j] = &na[idx];
+            eb[j] = &nb[idx];
+        }
+        if (ins) {
+            unsigned got = myht_slot_insert_bulk(&ha, ba, na, ea, n, res);
+            for (unsigned j = 0; j < n; j++) {
+                struct mynode_slot *rb = myht_slot_insert(&hb, bb, nb, eb[j]);
+                unsigned ia = res[j] ? RIX_IDX_FROM_PTR(na, res[j]) : 0u;
+                unsigned ib = rb ? RIX_IDX_FROM_PTR(nb, rb) : 0u;
+                if (ia != ib)
+                    FAILF("round %u insert[%u]: bulk=%u seq=%u", r, j, ia, ib);
+                exp += (rb == NULL);
+            }
+            if (got != exp)
+                FAILF("round %u insert_bulk returned %u, expected %u",
+                      r, got, exp);
+        } else {
+            unsigned got = myht_slot_remove_bulk(&ha, ba, na, ea, n);
+            for (unsigned j = 0; j < n; j++)
+                exp += (myht_slot_remove(&hb, bb, nb, eb[j]) != NULL);
+            if (got != exp)
+                FAILF("round %u remove_bulk returned %u, expected %u",
+                      r, got, exp);
+        }
+        if (ha.rhh_nb != hb.rhh_nb)
+            FAILF("round %u rhh_nb bulk=%u seq=%u", r, ha.rhh_nb, hb.rhh_nb);
+        if (memcmp(ba, bb, bk_sz) != 0 ||
+            memcmp(na, nb, (size_t)BULK_N * sizeof(*na)) != 0)
+            FAILF("round %u: bulk and sequential tables diverged", r);
+    }
+    for (unsigned i = 0; i < BULK_N; i++)
+        if (myht_slot_find(&ha, ba, na, &na[i].key) == &na[i])
+            slot_verify_node(&ha, ba, na, &na[i]);
+
+    free(bb);
+    free(ba);
+    free(nb);
+    free(na);
+}
+
+static void
+test_keyonly_bulk(unsigned seed, unsigned rounds)
+{
+    printf("[T] keyonly bulk insert/remove seed=%u rounds=%u\n", seed, rounds);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    struct mynode_keyonly *na =
+        (struct mynode_keyonly *)calloc(BULK_N, sizeof(*na));
+    struct mynode_keyonly *nb =
+        (struct mynode_keyonly *)calloc(BULK_N, sizeof(*nb));
+    struct rix_hash_bucket_s *ba = NULL, *bb = NULL;
+    size_t bk_sz = (size_t)BULK_NB_BK * sizeof(*ba);
+    if (!na || !nb || posix_memalign((void **)&ba, 64, bk_sz) != 0 ||
+        posix_memalign((void **)&bb, 64, bk_sz) != 0) {
+        perror("alloc"); exit(1);
+    }
+    memset(ba, 0, bk_sz);
+    memset(bb, 0, bk_sz);
+    for (unsigned i = 0; i < BULK_N; i++) {
+        na[i].key.hi = nb[i].key.hi = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        na[i].key.lo = nb[i].key.lo = 0xB01C000000000000ULL | i;
+    }
+
+    struct myht_keyonly ha, hb;
+    RIX_HASH_INIT(myht_keyonly, &ha, BULK_NB_BK);
+    RIX_HASH_INIT(myht_keyonly, &hb, BULK_NB_BK);
+
+    for (unsigned r = 0; r < rounds; r++) {
+        struct mynode_keyonly *ea[BULK_MAX], *eb[BULK_MAX], *res[BULK_MAX];
+        unsigned n = rnd_in(1, BULK_MAX);
+        int ins = (xorshift32() % 100u) < 60u;
+        unsigned exp = 0;
+
+        for (unsigned j = 0; j < n; j++) {
+            unsigned idx = (r & 1u) ? rnd_in(0, 31) : rnd_in(0, BULK_N - 1);
+            ea[j] = &na[idx];
+            eb[j] = &nb[idx];
+        }
+        if (ins) {
+            unsigned got = myht_keyonly_insert_bulk(&ha, ba, na, ea, n, res);
+            for (unsigned j = 0; j < n; j++) {
+                struct mynode_keyonly *rb =
+                    myht_keyonly_insert(&hb, bb, nb, eb[j]);
+                unsigned ia = res[j] ? RIX_IDX_FROM_PTR(na, res[j]) : 0u;
+                unsigned ib = rb ? RIX_IDX_FROM_PTR(nb, rb) : 0u;
+                if (ia != ib)
+                    FAILF("round %u insert[%u]: bulk=%u seq=%u", r, j, ia, ib);
+                exp += (rb == NULL);
+            }
+            if (got != exp)
+                FAILF("round %u insert_bulk returned %u, expected %u",
+                      r, got, exp);
+        } else {
+            unsigned got = myht_keyonly_remove_bulk(&ha, ba, na, ea, n);
+            for (unsigned j = 0; j < n; j++)
+                exp += (myht_keyonly_remove(&hb, bb, nb, eb[j]) != NULL);
+            if (got != exp)
+                FAILF("round %u remove_bulk returned %u, expected %u",
+                      r, got, exp);
+        }
+        if (ha.rhh_nb != hb.rhh_nb)
+            FAILF("round %u rhh_nb bulk=%u seq=%u", r, ha.rhh_nb, hb.rhh_nb);
+        if (memcmp(ba, bb, bk_sz) != 0)
+            FAILF("round %u: bulk and sequential tables diverged", r);
+    }
+
+    free(bb);
+    free(ba);
+    free(nb);
+    free(na);
+}
+
+/* ================================================================== */
+/* Batch hash kernels: must match the single-key forms bit for bit    */
+/* ================================================================== */
+#define HN_MAX 37u   /* not a multiple of RIX_HASH_N_LANES */
+
+static void
+test_hash_n_level(u32 level)
+{
+    static const u32 masks[] = { 1u, 3u, 63u, 0xFFFFu };
+    static const unsigned ns[] = { 1u, 7u, 8u, 9u, HN_MAX };
+    u8 buf[HN_MAX][40];
+    const void *kp[HN_MAX];
+    u32 k32[HN_MAX];
+    u64 k64[HN_MAX];
+    union rix_hash_hash_u out[HN_MAX];
+
+    rix_hash_arch_init(level);
+    for (unsigned i = 0; i < HN_MAX; i++) {
+        for (unsigned b = 0; b < sizeof(buf[i]); b++)
+            buf[i][b] = (u8)xorshift32();
+        kp[i]  = buf[i];
+        k32[i] = xorshift32();
+        k64[i] = ((u64)xorshift32() << 32) | xorshift32();
+    }
+    for (unsigned m = 0; m < sizeof(masks) / sizeof(masks[0]); m++) {
+        u32 mask = masks[m];
+        for (unsigned j = 0; j < sizeof(ns) / sizeof(ns[0]); j++) {
+            unsigned n = ns[j];
+
+            for (size_t kb = 1; kb <= sizeof(buf[0]); kb++) {
+                rix_hash_arch->hash_bytes_n(kp, kb, n, mask, out);
+                for (unsigned i = 0; i < n; i++) {
+                    union rix_hash_hash_u h =
+                        rix_hash_arch->hash_bytes(kp[i], kb, mask);
+                    if (h.val64 != out[i].val64)
+                        FAILF("level=%u bytes kb=%zu n=%u i=%u mask=%x",
+                              level, kb, n, i, mask);
+                }
+            }
+            rix_hash_arch->hash_u32_n(k32, n, mask, out);
+            for (unsigned i = 0; i < n; i++)
+                if (rix_hash_arch->hash_u32(k32[i], mask).val64 !=
+                    out[i].val64)
+                    FAILF("level=%u u32 n=%u i=%u mask=%x",
+                          level, n, i, mask);
+            rix_hash_arch->hash_u64_n(k64, n, mask, out);
+            for (unsigned i = 0; i < n; i++)
+                if (rix_hash_arch->hash_u64(k64[i], mask).val64 !=
+                    out[i].val64)
+                    FAILF("level=%u u64 n=%u i=%u mask=%x",
+                          level, n, i, mask);
+        }
+    }
+}
+
+static void
+test_hash_n(unsigned seed)
+{
+    static const u32 levels[] = {
+        0u, RIX_HASH_ARCH_SSE, RIX_HASH_ARCH_AVX2, RIX_HASH_ARCH_AUTO,
+    };
+    struct myht head;
+    struct rix_hash_bucket_s *bk;
+    struct mykey keys[HN_MAX];
+    const struct mykey *kp[HN_MAX];
+    struct rix_hash_find_ctx_s c1, cn[HN_MAX];
+
+    xr_fuzz = seed ? seed : 1u;
+    for (unsigned l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+        test_hash_n_level(levels[l]);
+
+    /* hash_key_n (batched) vs hash_key (one at a time) */
+    bk = calloc(64u, sizeof(*bk));
+    if (!bk)
+        FAIL("calloc");
+    RIX_HASH_INIT(myht, &head, 64u);
+    for (unsigned i = 0; i < HN_MAX; i++) {
+        keys[i].hi = ((u64)xorshift32() << 32) | xorshift32();
+        keys[i].lo = i;
+        kp[i] = &keys[i];
+    }
+    myht_hash_key_n(cn, (int)HN_MAX, &head, bk, kp);
+    for (unsigned i = 0; i < HN_MAX; i++) {
+        myht_hash_key(&c1, &head, bk, kp[i]);
+        if (c1.hash.val64 != cn[i].hash.val64 || c1.fp != cn[i].fp ||
+            c1.bk[0] != cn[i].bk[0] || c1.bk[1] != cn[i].bk[1] ||
+            c1.key != cn[i].key)
+            FAILF("hash_key_n i=%u", i);
+    }
+    free(bk);
+}
+
+/* ================================================================== */
+/* AES-round dual hash                                                 */
+/* ================================================================== */
+static void
+test_hash_aes(unsigned seed)
+{
+    static const u32 masks[] = { 1u, 3u, 63u, 0xFFFFu, 0xFFFFFFFFu };
+    u8 key[64];
+    unsigned nb_same0 = 0, nb_same1 = 0, nb_flip = 0;
+
+#if defined(__x86_64__) && defined(__AES__)
+    if (!__builtin_cpu_supports("aes")) {
+        printf("[T] hash aes: skipped (no AES-NI)\n");
+        return;
+    }
+#endif
+    xr_fuzz = seed ? seed : 1u;
+    for (unsigned iter = 0; iter < 2000u; iter++) {
+        size_t kb = 1u + iter % sizeof(key);
+
+        for (unsigned b = 0; b < sizeof(key); b++)
+            key[b] = (u8)xorshift32();
+        for (unsigned m = 0; m < sizeof(masks) / sizeof(masks[0]); m++) {
+            union rix_hash_hash_u h =
+                rix_hash_hash_bytes_aes(key, kb, masks[m]);
+            union rix_hash_hash_u h2 =
+                rix_hash_hash_bytes_aes(key, kb, masks[m]);
+
+            if (h.val64 != h2.val64)
+                FAILF("aes not deterministic kb=%zu", kb);
+            if ((h.val32[0] & masks[m]) == (h.val32[1] & masks[m]))
+                FAILF("aes bk0 == bk1 kb=%zu mask=%x", kb, masks[m]);
+            /* the software rounds give the AES-NI table layout */
+            if (h.val64 !=
+                _rix_hash_hash_bytes_aes_soft(key, kb, masks[m]).val64)
+                FAILF("aes soft != aes kb=%zu mask=%x", kb, masks[m]);
+        }
+        /* one flipped key bit should move both halves */
+        {
+            union rix_hash_hash_u a, b;
+            unsigned bit = xorshift32() % (unsigned)(kb * 8u);
+
+            a = rix_hash_hash_bytes_aes(key, kb, 0xFFFFFFFFu);
+            key[bit / 8u] ^= (u8)(1u << (bit % 8u));
+            b = rix_hash_hash_bytes_aes(key, kb, 0xFFFFFFFFu);
+            nb_flip++;
+            if (a.val32[0] == b.val32[0])
+                nb_same0++;
+            if (a.val32[1] == b.val32[1])
+                nb_same1++;
+        }
+    }
+    if (nb_same0 > nb_flip / 100u || nb_same1 > nb_flip / 100u)
+        FAILF("aes weak avalanche same0=%u same1=%u / %u",
+              nb_same0, nb_same1, nb_flip);
+    /* the batch form is bit-identical, across lane-block boundaries */
+    {
+        static const size_t kbs[] = { 1u, 13u, 16u, 24u, 44u, 64u };
+        u8 keys[19][64];
+        const void *kp[19];
+        union rix_hash_hash_u out[19];
+
+        for (unsigned i = 0; i < 19u; i++) {
+            for (unsigned b = 0; b < sizeof(keys[i]); b++)
+                keys[i][b] = (u8)xorshift32();
+            kp[i] = keys[i];
+        }
+        for (unsigned k = 0; k < sizeof(kbs) / sizeof(kbs[0]); k++)
+            for (unsigned m = 0; m < sizeof(masks) / sizeof(masks[0]); m++) {
+                rix_hash_hash_bytes_aes_n(kp, kbs[k], 19u, masks[m], out);
+                for (unsigned i = 0; i < 19u; i++)
+                    if (out[i].val64 !=
+                        rix_hash_hash_bytes_aes(keys[i], kbs[k],
+                                                masks[m]).val64)
+                        FAILF("aes_n kb=%zu mask=%x i=%u",
+                              kbs[k], masks[m], i);
+            }
+    }
+}
+
+/* ================================================================== */
+/* main                                                                */
+/* ================================================================== */
+int
+main(int argc, char **argv)
+{
+    unsigned seed   = 0xC0FFEE11u;
+    unsigned N      = 512u;
+    unsigned nb_bk  = 64u;  /* 64 x 16 = 1024 slots; N/capacity = 0.5 */
+    unsigned ops    = 200000u;
+
+    if (argc >= 2) seed  = (unsigned)strtoul(argv[1], NULL, 10);
+    if (argc >= 3) N     = (unsigned)strtoul(argv[2], NULL, 10);
+    if (argc >= 4) nb_bk = (unsigned)strtoul(argv[3], NULL, 10);
+    if (argc >= 5) ops   = (unsigned)strtoul(argv[4], NULL, 10);
+
+    rix_hash_arch_init(RIX_HASH_ARCH_AUTO);
+
+    test_init_empty();
+    test_insert_find_remove();
+    test_duplicate();
+    test_remove_miss();
+    test_staged_find();
+    test_walk();
+    test_fuzz(seed, N, nb_bk, ops);
+    test_slot_insert_find_remove();
+    test_slot_duplicate();
+    test_slot_relocate_swap();
+    test_slot_promote();
+    test_slot_remove_miss();
+    test_slot_fuzz(seed, N, nb_bk, ops);
+
+    test_keyonly_insert_find_remove();
+    test_keyonly_duplicate();
+    test_keyonly_remove_miss();
+    test_keyonly_fuzz(seed, N, nb_bk, ops);
+
+    /* High-fill / hash-conflict tests (all 3 variants) */
+    test_high_fill();
+    test_max_fill();
+    test_kickout_corruption();
+    test_slot_high_fill();
+    test_slot_max_fill();
+    test_slot_bfs_fill();
+    test_slot_kickout_corruption();
+    test_keyonly_high_fill();
+    test_keyonly_max_fill();
+    test_keyonly_kickout_corruption();
+
+    /* Aggressive fuzz: 98% fill ratio (N ~ nb_bk x 16) */
+    test_fuzz(seed, 1000, 64, 500000);
+    test_slot_fuzz(seed, 1000, 64, 500000);
+    test_keyonly_fuzz(seed, 1000, 64, 500000);
+
+    /* Single-writer / multi-reader (seqlock) slot forms */
+    test_slot_seq_basic();
+    test_slot_seq_concurrent(seed, 400000);
+
+    /* Online resize (slot variant) */
+    test_slot_resize(seed);
+
+    /* Overflow stash (slot variant) */
+    test_slot_stash(seed);
+
+    /* Keyed hash with online reseed (slot variant) */
+    test_slot_seed(seed);
+    test_slot_seed_rollback();
+
+    /* Caller-supplied (NIC RSS) hashes */
+    test_slot_prehashed(seed);
+    test_slot_promote_hashed();
+
+    /* Single-cache-line tag buckets */
+    test_find_u16x16(seed);
+    test_find_u16x12(seed);
+    test_tag_fuzz(seed, N, nb_bk * 2u, ops);
+    test_tag_fuzz(seed, 600, 64, 500000);
+    test_tag_fill();
+
+    /* Cuckoo filter */
+    test_find_u8x16(seed);
+    test_filter_myflt8(seed);
+    test_filter_myflt12(seed);
+    test_filter_myflt16(seed);
+
+    /* Resumable walk */
+    test_walk_step(seed);
+
+    /* Bucket range walk, parallel bulk build */
+    test_walk_range();
+    test_build_range(seed);
+
+    /* Pipelined bulk insert / remove */
+    test_bulk(seed, 4000);
+    test_slot_bulk(seed, 4000);
+    test_keyonly_bulk(seed, 4000);
+
+    /* Batch hash kernels (restores the AUTO dispatch level) */
+    test_hash_n(seed);
+    test_hash_aes(seed);
 
     printf("ALL RIX_HASH TESTS PASSED\n");
     return 0;
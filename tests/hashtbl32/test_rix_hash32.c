@@ -11,8 +11,32 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
 #include <assert.h>
 
+/*
+ * RIX_ASSERT hook: the out-of-range remove_at test expects exactly one
+ * assertion to fire and checks that the call is still refused.  Any
+ * other failed assertion aborts as usual.
+ */
+static unsigned assert_expect;
+static unsigned assert_hits;
+
+static void
+test_assert_failed(const char *cond, const char *file, int line)
+{
+    if (assert_expect) {
+        assert_hits++;
+        return;
+    }
+    fprintf(stderr, "%s:%d: assertion `%s' failed\n", file, line, cond);
+    abort();
+}
+
+#define RIX_ASSERT(cond)                                                      \
+    ((cond) ? (void)0 : test_assert_failed(#cond, __FILE__, __LINE__))
+
 #include "rix_hash32.h"
 
 /*---------------------------------------------------------------------------
@@ -288,6 +312,100 @@ test_walk(void)
     PASS("walk visits all %u inserted nodes", cnt);
 }
 
+/*---------------------------------------------------------------------------
+ * Test: walk_step - resumable walk, every entry exactly once per pass
+ *---------------------------------------------------------------------------*/
+static void
+test_walk_step(void)
+{
+    static const unsigned cfg[][2] = {  /* budget, max_out */
+        { 1u, 16u }, { 5u, 16u }, { 5u, 100u }, { NB_BUCKETS, NB_NODES },
+    };
+    static unsigned char seen[NB_NODES];
+    static uint32_t idx[NB_NODES];
+
+    printf("[test_walk_step]\n");
+    reset_table();
+    for (unsigned i = 0; i < NB_NODES; i++) {
+        nodes[i].key = (i + 1u) * 0x9E3779B1u;
+        if (RIX_HASH32_INSERT(myht32, &head, buckets, nodes, &nodes[i]) != NULL)
+            FAIL("insert[%u] returned non-NULL", i);
+    }
+    for (unsigned c = 0; c < sizeof(cfg) / sizeof(cfg[0]); c++) {
+        unsigned cur = 0u, steps = 0u;
+        memset(seen, 0, sizeof(seen));
+        do {
+            unsigned n;
+            unsigned next = RIX_HASH32_WALK_STEP(myht32, &head, buckets, cur,
+                                                 cfg[c][0], idx, cfg[c][1],
+                                                 &n);
+            if (n > cfg[c][1] ||
+                (next != 0u && (next <= cur || next - cur > cfg[c][0])))
+                FAIL("step at %u: n=%u next=%u", cur, n, next);
+            for (unsigned j = 0; j < n; j++)
+                if (seen[idx[j] - 1u]++)
+                    FAIL("idx %u reported twice", idx[j]);
+            cur = next;
+            steps++;
+        } while (cur != 0u);
+        for (unsigned i = 0; i < NB_NODES; i++)
+            if (!seen[i])
+                FAIL("budget %u max_out %u: node %u missed",
+                     cfg[c][0], cfg[c][1], i);
+        PASS("walk_step budget %u max_out %u: %u steps",
+             cfg[c][0], cfg[c][1], steps);
+    }
+}
+
+/*---------------------------------------------------------------------------
+ * Test: walk_range - disjoint bucket ranges cover every entry once
+ *---------------------------------------------------------------------------*/
+static int
+walk_range_cb(mynode_t *node, void *arg)
+{
+    unsigned char *seen = (unsigned char *)arg;
+    seen[node - nodes]++;
+    return 0;
+}
+
+static void
+test_walk_range(void)
+{
+    static const unsigned widths[] = { 1u, 7u, 100u, NB_BUCKETS };
+    static unsigned char seen[NB_NODES];
+
+    printf("[test_walk_range]\n");
+    reset_table();
+    for (unsigned i = 0; i < NB_NODES; i++) {
+        nodes[i].key = (i + 1u) * 0x9E3779B1u;
+        if (RIX_HASH32_INSERT(myht32, &head, buckets, nodes, &nodes[i]) != NULL)
+            FAIL("insert[%u] returned non-NULL", i);
+    }
+    for (unsigned w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        memset(seen, 0, sizeof(seen));
+        for (unsigned lo = 0; lo < NB_BUCKETS; lo += widths[w]) {
+            /* the last range runs to UINT_MAX: clamped to the table */
+            unsigned hi = (lo + widths[w] >= NB_BUCKETS) ?
+                          UINT_MAX : lo + widths[w];
+            if (RIX_HASH32_WALK_RANGE(myht32, &head, buckets, nodes, lo, hi,
+                                      walk_range_cb, seen) != 0)
+                FAIL("walk_range [%u, %u) returned non-zero", lo, hi);
+        }
+        for (unsigned i = 0; i < NB_NODES; i++)
+            if (seen[i] != 1u)
+                FAIL("width %u: node %u seen %u times", widths[w], i, seen[i]);
+    }
+    memset(seen, 0, sizeof(seen));
+    RIX_HASH32_WALK_RANGE(myht32, &head, buckets, nodes, 9u, 9u,
+                          walk_range_cb, seen);
+    RIX_HASH32_WALK_RANGE(myht32, &head, buckets, nodes, NB_BUCKETS, UINT_MAX,
+                          walk_range_cb, seen);
+    for (unsigned i = 0; i < NB_NODES; i++)
+        if (seen[i] != 0u)
+            FAIL("empty range visited node %u", i);
+    PASS("walk_range: widths 1..%u cover each entry once", NB_BUCKETS);
+}
+
 /*---------------------------------------------------------------------------
  * Test: bulk insert / find at ~50% load
  *---------------------------------------------------------------------------*/
@@ -547,7 +665,10 @@ test_kickout_corruption(void)
     mynode_t *kc_nodes = (mynode_t *)calloc(KC_N, sizeof(mynode_t));
     struct rix_hash32_bucket_s *kc_bk =
         (struct rix_hash32_bucket_s *)aligned_alloc(64, KC_NB_BK * sizeof(*kc_bk));
-    if (!kc_nodes || !kc_bk) { perror("alloc"); abort(); }
+    /* A later key may still fit after an earlier one was refused, so
+     * track membership per node rather than by insertion count. */
+    unsigned char *kc_in = (unsigned char *)calloc(KC_N, 1);
+    if (!kc_nodes || !kc_bk || !kc_in) { perror("alloc"); abort(); }
 
     for (unsigned i = 0; i < KC_N; i++) {
         kc_nodes[i].key = i + 1;
@@ -561,9 +682,10 @@ test_kickout_corruption(void)
     unsigned inserted = 0;
     for (unsigned i = 0; i < KC_N; i++) {
         mynode_t *r = RIX_HASH32_INSERT(myht32, &kc_head, kc_bk, kc_nodes, &kc_nodes[i]);
-        if (r == NULL)
+        if (r == NULL) {
+            kc_in[i] = 1;
             inserted++;
-        else if (r == &kc_nodes[i])
+        } else if (r == &kc_nodes[i])
             break;
     }
 
@@ -573,10 +695,12 @@ test_kickout_corruption(void)
     for (unsigned i = inserted; i < KC_N; i++) {
         mynode_t *r = RIX_HASH32_INSERT(myht32, &kc_head, kc_bk, kc_nodes, &kc_nodes[i]);
         if (r == NULL) {
+            kc_in[i] = 1;
             inserted++;
         } else if (r == &kc_nodes[i]) {
             /* Failed insert - verify all previously inserted entries */
-            for (unsigned j = 0; j < inserted; j++) {
+            for (unsigned j = 0; j < KC_N; j++) {
+                if (!kc_in[j]) continue;
                 mynode_t *f = RIX_HASH32_FIND(myht32, &kc_head, kc_bk, kc_nodes, kc_nodes[j].key);
                 if (f != &kc_nodes[j]) {
                     lost++;
@@ -595,7 +719,7 @@ test_kickout_corruption(void)
     else
         FAIL("kickout_corruption: victim loss detected (%u)", lost);
 
-    free(kc_nodes); free(kc_bk);
+    free(kc_in); free(kc_nodes); free(kc_bk);
 }
 
 /*---------------------------------------------------------------------------
@@ -682,6 +806,826 @@ test_fuzz(unsigned seed, unsigned N, unsigned nb_bk, unsigned ops)
     free(fz_nodes); free(fz_bk); free(in_tbl);
 }
 
+/*---------------------------------------------------------------------------
+ * Test: insert_bulk / remove_bulk match sequential single-shot calls
+ *
+ * The node array is shared; table A is driven by the bulk forms, table B
+ * by one call per element.  Results, counts and buckets must match.
+ *---------------------------------------------------------------------------*/
+#define IRB_N       1000u
+#define IRB_NB_BK     64u   /* 1024 slots: the table fills up */
+#define IRB_MAX       96u
+
+static void
+test_insert_remove_bulk(unsigned seed, unsigned rounds)
+{
+    printf("[test_insert_remove_bulk] seed=%u rounds=%u\n", seed, rounds);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    size_t bk_sz = IRB_NB_BK * sizeof(struct rix_hash32_bucket_s);
+    mynode_t *nd = (mynode_t *)calloc(IRB_N, sizeof(mynode_t));
+    struct rix_hash32_bucket_s *ba =
+        (struct rix_hash32_bucket_s *)aligned_alloc(64, bk_sz);
+    struct rix_hash32_bucket_s *bb =
+        (struct rix_hash32_bucket_s *)aligned_alloc(64, bk_sz);
+    if (!nd || !ba || !bb) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < IRB_N; i++) {
+        nd[i].key = (i + 1) * 0x9E3779B1u;
+        nd[i].val = i;
+    }
+
+    struct myht32 ha, hb;
+    RIX_HASH32_INIT(myht32, &ha, ba, IRB_NB_BK);
+    RIX_HASH32_INIT(myht32, &hb, bb, IRB_NB_BK);
+
+    for (unsigned r = 0; r < rounds; r++) {
+        mynode_t *elms[IRB_MAX], *res[IRB_MAX];
+        unsigned n = 1u + xorshift32() % IRB_MAX;
+        int ins = (xorshift32() % 100u) < 60u;
+        unsigned exp = 0;
+
+        /* narrow range on odd rounds: many in-batch duplicates */
+        for (unsigned j = 0; j < n; j++)
+            elms[j] = &nd[xorshift32() % ((r & 1u) ? 32u : IRB_N)];
+
+        if (ins) {
+            unsigned got = myht32_insert_bulk(&ha, ba, nd, elms, n, res);
+            for (unsigned j = 0; j < n; j++) {
+                mynode_t *rb = myht32_insert(&hb, bb, nd, elms[j]);
+                if (res[j] != rb)
+                    FAIL("round %u insert[%u]: bulk=%p seq=%p",
+                         r, j, (void *)res[j], (void *)rb);
+                exp += (rb == NULL);
+            }
+            if (got != exp)
+                FAIL("round %u insert_bulk returned %u, expected %u",
+                     r, got, exp);
+        } else {
+            unsigned got = myht32_remove_bulk(&ha, ba, nd, elms, n);
+            for (unsigned j = 0; j < n; j++)
+                exp += (myht32_remove(&hb, bb, nd, elms[j]) != NULL);
+            if (got != exp)
+                FAIL("round %u remove_bulk returned %u, expected %u",
+                     r, got, exp);
+        }
+        if (ha.rhh_nb != hb.rhh_nb || memcmp(ba, bb, bk_sz) != 0)
+            FAIL("round %u: bulk and sequential tables diverged", r);
+    }
+
+    PASS("insert_remove_bulk: %u rounds, final rhh_nb=%u", rounds, ha.rhh_nb);
+    free(nd); free(ba); free(bb);
+}
+
+/*---------------------------------------------------------------------------
+ * Test: slot variant - recorded (bucket, slot), O(1) remove
+ *
+ * The slot table and a plain table over the same nodes get the same ops;
+ * their buckets must stay identical, and every node in the slot table
+ * must point at its own bucket slot.
+ *---------------------------------------------------------------------------*/
+typedef struct slotnode_s {
+    uint32_t key;
+    uint32_t bk;
+    uint16_t slot;
+    uint16_t val;
+} slotnode_t;
+
+RIX_HASH32_HEAD(myht32s);
+RIX_HASH32_GENERATE_SLOT(myht32s, slotnode_t, key, bk, slot, INVALID_KEY)
+RIX_HASH32_HEAD(myht32p);
+RIX_HASH32_GENERATE(myht32p, slotnode_t, key, INVALID_KEY)
+
+#define SL_N       1000u
+#define SL_NB_BK     64u   /* 1024 slots: runs close to full */
+
+static void
+slot_check(const struct myht32s *hs, const struct rix_hash32_bucket_s *bs,
+           const struct myht32p *hp, const struct rix_hash32_bucket_s *bp,
+           const slotnode_t *nd, const unsigned char *in, const char *what)
+{
+    unsigned cnt = 0;
+
+    if (memcmp(bs, bp, SL_NB_BK * sizeof(*bs)) != 0)
+        FAIL("slot %s: buckets differ from the plain table", what);
+    for (unsigned i = 0; i < SL_N; i++) {
+        if (!in[i])
+            continue;
+        if (nd[i].bk >= SL_NB_BK || nd[i].slot >= RIX_HASH_BUCKET_ENTRY_SZ ||
+            bs[nd[i].bk].idx[nd[i].slot] != i + 1u)
+            FAIL("slot %s: node %u records bk=%u slot=%u",
+                 what, i, nd[i].bk, nd[i].slot);
+        cnt++;
+    }
+    if (hs->rhh_nb != cnt || hp->rhh_nb != cnt)
+        FAIL("slot %s: rhh_nb=%u/%u model=%u", what, hs->rhh_nb, hp->rhh_nb,
+             cnt);
+}
+
+static void
+test_slot(unsigned seed, unsigned ops)
+{
+    printf("[test_slot] seed=%u ops=%u\n", seed, ops);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    size_t bk_sz = SL_NB_BK * sizeof(struct rix_hash32_bucket_s);
+    slotnode_t *nd = (slotnode_t *)calloc(SL_N, sizeof(*nd));
+    unsigned char *in = (unsigned char *)calloc(SL_N, 1);
+    struct rix_hash32_bucket_s *bs =
+        (struct rix_hash32_bucket_s *)aligned_alloc(64, bk_sz);
+    struct rix_hash32_bucket_s *bp =
+        (struct rix_hash32_bucket_s *)aligned_alloc(64, bk_sz);
+    if (!nd || !in || !bs || !bp) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < SL_N; i++)
+        nd[i].key = (i + 1u) * 0x9E3779B1u;
+
+    struct myht32s hs;
+    struct myht32p hp;
+    myht32s_init(&hs, bs, SL_NB_BK);
+    myht32p_init(&hp, bp, SL_NB_BK);
+
+    for (unsigned step = 0; step < ops; step++) {
+        unsigned i = xorshift32() % SL_N;
+        unsigned op = xorshift32() % 100u;
+
+        if (op < 60u) {
+            slotnode_t *rs = myht32s_insert(&hs, bs, nd, &nd[i]);
+            slotnode_t *rp = myht32p_insert(&hp, bp, nd, &nd[i]);
+            if (rs != rp)
+                FAIL("slot insert[%u]: slot=%p plain=%p",
+                     i, (void *)rs, (void *)rp);
+            if (rs == NULL)
+                in[i] = 1;
+        } else if (op < 95u) {
+            slotnode_t *rs = myht32s_remove(&hs, bs, nd, &nd[i]);
+            slotnode_t *rp = myht32p_remove(&hp, bp, nd, &nd[i]);
+            if (rs != rp || rs != (in[i] ? &nd[i] : NULL))
+                FAIL("slot remove[%u]: in=%u slot=%p plain=%p",
+                     i, in[i], (void *)rs, (void *)rp);
+            in[i] = 0;
+        } else {
+            slotnode_t *f = myht32s_find(&hs, bs, nd, nd[i].key);
+            if (f != (in[i] ? &nd[i] : NULL))
+                FAIL("slot find[%u]: in=%u got %p", i, in[i], (void *)f);
+        }
+        if ((step & 0xFFFu) == 0u)
+            slot_check(&hs, bs, &hp, bp, nd, in, "fuzz");
+    }
+    slot_check(&hs, bs, &hp, bp, nd, in, "fuzz");
+
+    /* bulk forms against each other */
+    {
+        slotnode_t *elms[SL_N];
+        unsigned n = 0, exp = 0;
+        for (unsigned i = 0; i < SL_N; i += 3u) {
+            elms[n++] = &nd[i];
+            exp += in[i];
+        }
+        if (myht32s_remove_bulk(&hs, bs, nd, elms, n) != exp ||
+            myht32p_remove_bulk(&hp, bp, nd, elms, n) != exp)
+            FAIL("slot remove_bulk count != %u", exp);
+        for (unsigned j = 0; j < n; j++)
+            in[elms[j] - nd] = 0;
+        slot_check(&hs, bs, &hp, bp, nd, in, "remove_bulk");
+
+        exp = myht32s_insert_bulk(&hs, bs, nd, elms, n, NULL);
+        if (myht32p_insert_bulk(&hp, bp, nd, elms, n, NULL) != exp)
+            FAIL("slot insert_bulk counts differ");
+        for (unsigned j = 0; j < n; j++)
+            if (myht32s_find(&hs, bs, nd, elms[j]->key) == elms[j])
+                in[elms[j] - nd] = 1;
+        slot_check(&hs, bs, &hp, bp, nd, in, "insert_bulk");
+    }
+
+    /* an out-of-range slot trips the assertion and is still refused */
+    {
+        unsigned nb = hs.rhh_nb;
+
+        assert_expect = 1u;
+        assert_hits = 0u;
+        if (myht32s_remove_at(&hs, bs, 0u, RIX_HASH_BUCKET_ENTRY_SZ)
+            != (unsigned)RIX_NIL)
+            FAIL("slot remove_at out-of-range slot");
+        assert_expect = 0u;
+        if (assert_hits != 1u || hs.rhh_nb != nb)
+            FAIL("slot remove_at out-of-range: hits=%u nb=%u",
+                 assert_hits, hs.rhh_nb);
+    }
+
+    /* remove_at by recorded position; stale positions are refused */
+    for (unsigned i = 0; i < SL_N; i++) {
+        if (!in[i])
+            continue;
+        unsigned b = nd[i].bk, s = nd[i].slot;
+        if (myht32s_remove_at(&hs, bs, b, s) != i + 1u)
+            FAIL("slot remove_at[%u]", i);
+        if (myht32s_remove_at(&hs, bs, b, s) != (unsigned)RIX_NIL)
+            FAIL("slot remove_at[%u] twice", i);
+        if (myht32s_remove(&hs, bs, nd, &nd[i]) != NULL)
+            FAIL("slot remove[%u] after remove_at", i);
+        in[i] = 0;
+    }
+    if (hs.rhh_nb != 0u)
+        FAIL("slot: rhh_nb=%u after removing all", hs.rhh_nb);
+
+    PASS("slot: %u ops, buckets match the plain table", ops);
+    free(nd); free(in); free(bs); free(bp);
+}
+
+/*---------------------------------------------------------------------------
+ * Test: parallel bulk build - build_range per thread, then build_finish
+ *---------------------------------------------------------------------------*/
+#define BLD_NB_BK    256u
+#define BLD_N        (BLD_NB_BK * 16u * 9u / 10u)   /* 90% fill */
+#define BLD_D        100u                          /* repeated keys */
+#define BLD_THREADS    4u
+
+struct bld_arg {
+    struct myht32              *head;
+    struct rix_hash32_bucket_s *bk;
+    mynode_t                   *nd;
+    mynode_t * const           *elms;
+    unsigned                    lo, hi;
+    mynode_t                  **spill;
+    unsigned                    nb_spill;
+    unsigned                    placed;
+};
+
+static void *
+bld_main(void *p)
+{
+    struct bld_arg *a = (struct bld_arg *)p;
+    a->placed = myht32_build_range(a->head, a->bk, a->nd, a->elms,
+                                   BLD_N + BLD_D, a->lo, a->hi,
+                                   a->spill, &a->nb_spill);
+    return NULL;
+}
+
+static void
+test_build_range(unsigned seed)
+{
+    printf("[test_build_range] seed=%u\n", seed);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    const unsigned T = BLD_N + BLD_D;
+    size_t bk_sz = BLD_NB_BK * sizeof(struct rix_hash32_bucket_s);
+    mynode_t *nd = (mynode_t *)calloc(T, sizeof(*nd));
+    mynode_t **elms = (mynode_t **)calloc(T, sizeof(*elms));
+    mynode_t **spill = (mynode_t **)calloc((size_t)T * BLD_THREADS,
+                                           sizeof(*spill));
+    mynode_t **res = (mynode_t **)calloc(T, sizeof(*res));
+    slotnode_t *sn = (slotnode_t *)calloc(T, sizeof(*sn));
+    slotnode_t **selms = (slotnode_t **)calloc(T, sizeof(*selms));
+    slotnode_t **sspill = (slotnode_t **)calloc(T, sizeof(*sspill));
+    struct rix_hash32_bucket_s *bk =
+        (struct rix_hash32_bucket_s *)aligned_alloc(64, bk_sz);
+    if (!nd || !elms || !spill || !res || !sn || !selms || !sspill || !bk) {
+        perror("alloc"); abort();
+    }
+    /* the last BLD_D elements repeat earlier keys; val = original index */
+    for (unsigned i = 0; i < T; i++) {
+        unsigned src = (i < BLD_N) ? i : xorshift32() % BLD_N;
+        nd[i].key = (src + 1u) * 0x9E3779B1u;
+        nd[i].val = src;
+        sn[i].key = nd[i].key;
+        elms[i]  = &nd[i];
+        selms[i] = &sn[i];
+    }
+
+    struct myht32 h;
+    struct bld_arg args[BLD_THREADS];
+    pthread_t th[BLD_THREADS];
+    unsigned placed = 0, nsp = 0, ok;
+    myht32_init(&h, bk, BLD_NB_BK);
+    for (unsigned t = 0; t < BLD_THREADS; t++) {
+        args[t] = (struct bld_arg){
+            &h, bk, nd, elms, t * (BLD_NB_BK / BLD_THREADS),
+            (t + 1u) * (BLD_NB_BK / BLD_THREADS),
+            spill + (size_t)t * T, 0u, 0u };
+        if (pthread_create(&th[t], NULL, bld_main, &args[t]) != 0) {
+            perror("pthread_create"); abort();
+        }
+    }
+    for (unsigned t = 0; t < BLD_THREADS; t++) {
+        pthread_join(th[t], NULL);
+        placed += args[t].placed;
+        memmove(spill + nsp, args[t].spill,
+                args[t].nb_spill * sizeof(*spill));
+        nsp += args[t].nb_spill;
+    }
+    if (h.rhh_nb != 0u)
+        FAIL("rhh_nb=%u before build_finish", h.rhh_nb);
+    ok = myht32_build_finish(&h, bk, nd, placed, spill, nsp, res);
+    if (placed + ok != BLD_N || h.rhh_nb != BLD_N)
+        FAIL("placed=%u finish=%u rhh_nb=%u", placed, ok, h.rhh_nb);
+    for (unsigned j = 0; j < nsp; j++) {
+        unsigned i = (unsigned)(spill[j] - nd);
+        if (res[j] != (i < BLD_N ? NULL : &nd[nd[i].val]))
+            FAIL("spill %u (node %u): result %p", j, i, (void *)res[j]);
+    }
+    for (unsigned i = 0; i < BLD_N; i++)
+        if (myht32_find(&h, bk, nd, nd[i].key) != &nd[i])
+            FAIL("find[%u] after build", i);
+    PASS("build: %u placed by %u threads, %u spilled (%u repeats)",
+         placed, BLD_THREADS, nsp, BLD_D);
+
+    /* slot form: recorded positions must match the buckets */
+    struct myht32s hs;
+    myht32s_init(&hs, bk, BLD_NB_BK);
+    placed = nsp = 0;
+    for (unsigned lo = 0; lo < BLD_NB_BK; lo += 32u) {
+        unsigned n;
+        placed += myht32s_build_range(&hs, bk, sn, selms, T, lo, lo + 32u,
+                                      sspill + nsp, &n);
+        nsp += n;
+    }
+    if (placed + myht32s_build_finish(&hs, bk, sn, placed, sspill, nsp,
+                                      NULL) != BLD_N || hs.rhh_nb != BLD_N)
+        FAIL("slot build: placed=%u rhh_nb=%u", placed, hs.rhh_nb);
+    for (unsigned i = 0; i < BLD_N; i++)
+        if (bk[sn[i].bk].idx[sn[i].slot] != i + 1u)
+            FAIL("slot build: node %u records bk=%u slot=%u",
+                 i, sn[i].bk, sn[i].slot);
+    for (unsigned i = 0; i < BLD_N; i++)
+        if (myht32s_remove(&hs, bk, sn, &sn[i]) != &sn[i])
+            FAIL("slot build: remove[%u]", i);
+    PASS("slot build: positions recorded, all removed");
+
+    free(nd); free(elms); free(spill); free(res);
+    free(sn); free(selms); free(sspill); free(bk);
+}
+
+/*---------------------------------------------------------------------------
+ * Test: inline-value map - fuzz against a model, bulk find, full table
+ *---------------------------------------------------------------------------*/
+RIX_HASH32_HEAD(mymap32);
+RIX_HASH32_GENERATE_MAP(mymap32, INVALID_KEY)
+
+#define MAP_N       1100u  /* more keys than the 1024 slots */
+#define MAP_NB_BK     64u
+
+static int
+map_walk_cb(uint32_t key, uint32_t *val, void *arg)
+{
+    uint64_t *acc = (uint64_t *)arg;
+    acc[0]++;
+    acc[1] += key ^ *val;
+    return 0;
+}
+
+static void
+test_map(unsigned seed, unsigned ops)
+{
+    printf("[test_map] seed=%u ops=%u\n", seed, ops);
+    xr_fuzz = seed ? seed : 0xC0FFEE11u;
+
+    size_t bk_sz = MAP_NB_BK * sizeof(struct rix_hash32_map_bucket_s);
+    struct rix_hash32_map_bucket_s *bk =
+        (struct rix_hash32_map_bucket_s *)aligned_alloc(64, bk_sz);
+    struct rix_hash32_map_bucket_s *snap =
+        (struct rix_hash32_map_bucket_s *)aligned_alloc(64, bk_sz);
+    uint32_t *keys = (uint32_t *)calloc(MAP_N, sizeof(*keys));
+    uint32_t *model = (uint32_t *)calloc(MAP_N, sizeof(*model));
+    unsigned char *in = (unsigned char *)calloc(MAP_N, 1);
+    if (!bk || !snap || !keys || !model || !in) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < MAP_N; i++)
+        keys[i] = (i + 1u) * 0x9E3779B1u;
+
+    struct mymap32 head;
+    mymap32_init(&head, bk, MAP_NB_BK);
+    unsigned cnt = 0;
+
+    for (unsigned step = 0; step < ops; step++) {
+        unsigned i = xorshift32() % MAP_N;
+        unsigned op = xorshift32() % 100u;
+        uint32_t v = (xorshift32() & 1u) ? 0u : (uint32_t)xorshift32();
+
+        if (op < 50u) {
+            int rc;
+            memcpy(snap, bk, bk_sz);
+            rc = mymap32_insert(&head, bk, keys[i], v);
+            if (in[i] ? rc != 1 : rc == 1)
+                FAIL("map insert[%u]: in=%u rc=%d", i, in[i], rc);
+            if (rc == 0) {
+                in[i] = 1;
+                model[i] = v;
+                cnt++;
+            } else if (memcmp(snap, bk, bk_sz) != 0) {
+                FAIL("map insert[%u] rc=%d modified the table", i, rc);
+            }
+        } else if (op < 75u) {
+            int rc = mymap32_remove(&head, bk, keys[i]);
+            if (rc != (in[i] ? 0 : -1))
+                FAIL("map remove[%u]: in=%u rc=%d", i, in[i], rc);
+            if (in[i]) {
+                in[i] = 0;
+                cnt--;
+            }
+        } else if (op < 90u) {
+            uint32_t *p = mymap32_find(&head, bk, keys[i]);
+            if ((p != NULL) != in[i] || (p && *p != model[i]))
+                FAIL("map find[%u]: in=%u", i, in[i]);
+            if (p) {
+                *p = v;         /* update in place */
+                model[i] = v;
+            }
+        } else {
+            uint32_t k[37], out[37];
+            unsigned exp = 0;
+            for (unsigned j = 0; j < 37u; j++) {
+                unsigned x = (i + j * 29u) % MAP_N;
+                k[j] = keys[x];
+                exp += in[x];
+            }
+            if (mymap32_find_bulk(&head, bk, k, 37u, out, INVALID_KEY) != exp)
+                FAIL("map find_bulk hits != %u", exp);
+            for (unsigned j = 0; j < 37u; j++) {
+                unsigned x = (i + j * 29u) % MAP_N;
+                if (out[j] != (in[x] ? model[x] : INVALID_KEY))
+                    FAIL("map find_bulk[%u] value", j);
+            }
+        }
+        if (head.rhh_nb != cnt)
+            FAIL("map step %u: rhh_nb=%u model=%u", step, head.rhh_nb, cnt);
+    }
+
+    /* invalid_key marks empty slots: looking it up always misses */
+    {
+        struct rix_hash32_map_find_ctx_s ctx;
+        uint32_t k[3] = { keys[0], INVALID_KEY, keys[1] }, out[3];
+        unsigned exp = in[0] + in[1];
+
+        if (mymap32_find(&head, bk, INVALID_KEY) != NULL)
+            FAIL("map find(invalid_key) hit");
+        mymap32_hash_key(&ctx, &head, bk, INVALID_KEY);
+        mymap32_scan_bk(&ctx, &head, bk);
+        if (mymap32_get(&ctx) != NULL)
+            FAIL("map get(invalid_key) hit");
+        if (mymap32_find_bulk(&head, bk, k, 3u, out, 7u) != exp ||
+            out[1] != 7u)
+            FAIL("map find_bulk(invalid_key) hit");
+        if (mymap32_remove(&head, bk, INVALID_KEY) != -1 ||
+            head.rhh_nb != cnt)
+            FAIL("map remove(invalid_key) freed a slot");
+    }
+
+    /* staged x4 */
+    for (unsigned i = 0; i + 4u <= MAP_N; i += 4u) {
+        struct rix_hash32_map_find_ctx_s ctx[4];
+        uint32_t *res[4];
+        mymap32_hash_key_n(ctx, 4, &head, bk, &keys[i]);
+        mymap32_scan_bk_n(ctx, 4, &head, bk);
+        mymap32_get_n(ctx, 4, res);
+        for (unsigned j = 0; j < 4u; j++)
+            if ((res[j] != NULL) != in[i + j] ||
+                (res[j] && *res[j] != model[i + j]))
+                FAIL("map staged[%u]", i + j);
+    }
+
+    uint64_t acc[2] = { 0, 0 }, sum = 0;
+    for (unsigned i = 0; i < MAP_N; i++)
+        if (in[i])
+            sum += keys[i] ^ model[i];
+    mymap32_walk(&head, bk, map_walk_cb, acc);
+    if (acc[0] != cnt || acc[1] != sum)
+        FAIL("map walk: %u entries, expected %u", (unsigned)acc[0], cnt);
+
+    /* walk_step in small steps sees the same entries */
+    {
+        uint32_t wk[16], wv[16];
+        unsigned cur = 0u, n;
+        uint64_t wcnt = 0, wsum = 0;
+        do {
+            cur = mymap32_walk_step(&head, bk, cur, 3u, wk, wv, 16u, &n);
+            for (unsigned j = 0; j < n; j++) {
+                wcnt++;
+                wsum += wk[j] ^ wv[j];
+            }
+        } while (cur != 0u);
+        if (wcnt != cnt || wsum != sum)
+            FAIL("map walk_step: %u entries, expected %u",
+                 (unsigned)wcnt, cnt);
+    }
+
+    /* walk_range over two halves sees the same entries */
+    {
+        uint64_t racc[2] = { 0, 0 };
+        mymap32_walk_range(&head, bk, 0u, MAP_NB_BK / 2u, map_walk_cb, racc);
+        mymap32_walk_range(&head, bk, MAP_NB_BK / 2u, UINT_MAX,
+                           map_walk_cb, racc);
+        if (racc[0] != cnt || racc[1] != sum)
+            FAIL("map walk_range: %u entries, expected %u",
+                 (unsigned)racc[0], cnt);
+    }
+
+    /* fill until refused: the refusal leaves the table untouched */
+    unsigned refused = 0;
+    for (unsigned i = 0; i < MAP_N; i++) {
+        if (in[i])
+            continue;
+        memcpy(snap, bk, bk_sz);
+        int rc = mymap32_insert(&head, bk, keys[i], (uint32_t)i);
+        if (rc == 0) {
+            in[i] = 1;
+            model[i] = (uint32_t)i;
+            cnt++;
+        } else if (rc != -1 || memcmp(snap, bk, bk_sz) != 0) {
+            FAIL("map fill[%u]: rc=%d", i, rc);
+        } else {
+            refused++;
+        }
+    }
+    for (unsigned i = 0; i < MAP_N; i++) {
+        uint32_t *p = mymap32_find(&head, bk, keys[i]);
+        if ((p != NULL) != in[i] || (p && *p != model[i]))
+            FAIL("map full find[%u]", i);
+    }
+
+    PASS("map: %u ops, full at %u / %u slots (%u refused)", ops, cnt,
+         MAP_NB_BK * RIX_HASH_BUCKET_ENTRY_SZ, refused);
+    free(bk); free(snap); free(keys); free(model); free(in);
+}
+
+/*---------------------------------------------------------------------------
+ * Test: mt_concurrent - several writers + one lock-free reader
+ *
+ * Stable keys are never removed and must always be visible to the reader.
+ * Each writer churns its own key range (forcing kickouts at ~80% fill),
+ * and all writers race to insert the same shared keys with their own
+ * nodes: exactly one insert per shared key may win.
+ *---------------------------------------------------------------------------*/
+#define MT_NB_BK      64u
+#define MT_WRITERS     4u
+#define MT_N_STABLE  300u
+#define MT_N_CHURN   150u
+#define MT_N_RACE     64u
+#define MT_OPS     50000u
+
+RIX_HASH32_HEAD(myht32mt);
+RIX_HASH32_GENERATE_MT(myht32mt, mynode_t, key, INVALID_KEY)
+
+/* node layout: [stable][churn x writers][race x writers] */
+#define MT_N_NODES (MT_N_STABLE + MT_WRITERS * (MT_N_CHURN + MT_N_RACE))
+
+struct mt_shared {
+    struct myht32mt             head;
+    struct rix_hash32_bucket_s *bk;
+    uint32_t                    *seq;
+    mynode_t                    *nodes;
+    volatile int                 stop;
+    unsigned char                present[MT_WRITERS][MT_N_CHURN];
+    unsigned                     race_won[MT_WRITERS];
+};
+
+struct mt_arg {
+    struct mt_shared *sh;
+    unsigned          id;
+};
+
+static inline mynode_t *
+mt_churn_node(struct mt_shared *sh, unsigned w, unsigned i)
+{
+    return &sh->nodes[MT_N_STABLE + w * MT_N_CHURN + i];
+}
+
+static inline mynode_t *
+mt_race_node(struct mt_shared *sh, unsigned w, unsigned i)
+{
+    return &sh->nodes[MT_N_STABLE + MT_WRITERS * MT_N_CHURN +
+                      w * MT_N_RACE + i];
+}
+
+static void *
+mt_writer_main(void *p)
+{
+    struct mt_arg *a = (struct mt_arg *)p;
+    struct mt_shared *sh = a->sh;
+    unsigned w = a->id;
+    uint32_t x = 0x9E3779B9u * (w + 1u);
+
+    for (unsigned op = 0; op < MT_OPS; op++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        if (op % 64u == 0u && op / 64u < MT_N_RACE) {
+            unsigned k = (op / 64u + w * 7u) % MT_N_RACE;
+            mynode_t *nd = mt_race_node(sh, w, k);
+            mynode_t *r = myht32mt_mt_insert(&sh->head, sh->bk, sh->seq,
+                                            sh->nodes, nd);
+            if (r == NULL)
+                sh->race_won[w]++;
+            else if (r == nd)
+                FAIL("writer %u: race insert %u refused (table full)", w, k);
+            else if (r->key != nd->key)
+                FAIL("writer %u: race insert %u returned wrong node", w, k);
+            continue;
+        }
+        unsigned c = x % MT_N_CHURN;
+        mynode_t *nd = mt_churn_node(sh, w, c);
+        if (sh->present[w][c]) {
+            if ((x >> 16) & 3u)
+                continue;       /* bias towards high fill */
+            if (myht32mt_mt_remove(&sh->head, sh->bk, sh->seq,
+                                   sh->nodes, nd) != nd)
+                FAIL("writer %u: remove churn %u failed", w, c);
+            sh->present[w][c] = 0;
+        } else {
+            mynode_t *r = myht32mt_mt_insert(&sh->head, sh->bk, sh->seq,
+                                            sh->nodes, nd);
+            if (r == NULL)
+                sh->present[w][c] = 1;
+            else if (r != nd)
+                FAIL("writer %u: churn %u duplicate", w, c);
+        }
+    }
+    return NULL;
+}
+
+static void *
+mt_reader_main(void *p)
+{
+    struct mt_shared *sh = (struct mt_shared *)p;
+    unsigned i = 0;
+
+    while (!sh->stop) {
+        struct rix_hash32_find_ctx_s ctx[4];
+        uint32_t keys[4];
+        mynode_t *res[4];
+
+        for (unsigned j = 0; j < 4; j++)
+            keys[j] = sh->nodes[(i + j * 61u) % MT_N_STABLE].key;
+        myht32mt_mt_hash_key_n(ctx, 4, &sh->head, sh->bk, sh->seq, keys);
+        myht32mt_mt_scan_bk_n(ctx, 4, &sh->head, sh->bk, sh->seq);
+        myht32mt_prefetch_node_n(ctx, 4, sh->nodes);
+        myht32mt_mt_cmp_key_n(ctx, 4, &sh->head, sh->bk, sh->seq,
+                             sh->nodes, res);
+        for (unsigned j = 0; j < 4; j++) {
+            unsigned k = (i + j * 61u) % MT_N_STABLE;
+            if (res[j] != &sh->nodes[k])
+                FAIL("reader: stable key %u lost", k);
+        }
+        if (myht32mt_mt_find(&sh->head, sh->bk, sh->seq, sh->nodes,
+                             sh->nodes[i].key) != &sh->nodes[i])
+            FAIL("reader: mt_find stable key %u lost", i);
+        i = (i + 1u) % MT_N_STABLE;
+    }
+    return NULL;
+}
+
+static int
+mt_walk_cb(mynode_t *node, void *arg)
+{
+    (void)node;
+    (*(unsigned *)arg)++;
+    return 0;
+}
+
+static void
+test_mt_concurrent(void)
+{
+    printf("[test_mt_concurrent] %u writers + 1 reader\n", MT_WRITERS);
+
+    struct mt_shared *sh = (struct mt_shared *)calloc(1, sizeof(*sh));
+    pthread_t wth[MT_WRITERS], rth;
+    struct mt_arg args[MT_WRITERS];
+
+    if (!sh) { perror("calloc"); abort(); }
+    sh->nodes = (mynode_t *)calloc(MT_N_NODES, sizeof(mynode_t));
+    sh->seq   = (uint32_t *)calloc(MT_NB_BK, sizeof(uint32_t));
+    sh->bk    = (struct rix_hash32_bucket_s *)
+        aligned_alloc(64, MT_NB_BK * sizeof(*sh->bk));
+    if (!sh->nodes || !sh->seq || !sh->bk) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < MT_N_STABLE + MT_WRITERS * MT_N_CHURN; i++)
+        sh->nodes[i].key = (uint32_t)(i + 1u) * 2654435761u;
+    for (unsigned w = 0; w < MT_WRITERS; w++)
+        for (unsigned k = 0; k < MT_N_RACE; k++) {
+            mt_race_node(sh, w, k)->key = (uint32_t)(0x40000000u + k);
+            mt_race_node(sh, w, k)->val = w;
+        }
+
+    RIX_HASH32_INIT(myht32mt, &sh->head, sh->bk, MT_NB_BK);
+    for (unsigned i = 0; i < MT_N_STABLE; i++)
+        if (RIX_HASH32_MT_INSERT(myht32mt, &sh->head, sh->bk, sh->seq,
+                                sh->nodes, &sh->nodes[i]) != NULL)
+            FAIL("stable insert %u failed", i);
+
+    if (pthread_create(&rth, NULL, mt_reader_main, sh) != 0) {
+        perror("pthread_create"); abort();
+    }
+    for (unsigned w = 0; w < MT_WRITERS; w++) {
+        args[w].sh = sh;
+        args[w].id = w;
+        if (pthread_create(&wth[w], NULL, mt_writer_main, &args[w]) != 0) {
+            perror("pthread_create"); abort();
+        }
+    }
+    for (unsigned w = 0; w < MT_WRITERS; w++)
+        pthread_join(wth[w], NULL);
+    sh->stop = 1;
+    pthread_join(rth, NULL);
+
+    /* Verify against the per-writer models */
+    unsigned expect = MT_N_STABLE, won = 0;
+    for (unsigned i = 0; i < MT_N_STABLE; i++)
+        if (RIX_HASH32_MT_FIND(myht32mt, &sh->head, sh->bk, sh->seq,
+                              sh->nodes, sh->nodes[i].key) != &sh->nodes[i])
+            FAIL("final: stable %u missing", i);
+    for (unsigned w = 0; w < MT_WRITERS; w++) {
+        won += sh->race_won[w];
+        for (unsigned c = 0; c < MT_N_CHURN; c++) {
+            mynode_t *nd = mt_churn_node(sh, w, c);
+            mynode_t *f = myht32mt_find(&sh->head, sh->bk, sh->nodes, nd->key);
+            if (f != (sh->present[w][c] ? nd : NULL))
+                FAIL("final: churn w=%u c=%u mismatch", w, c);
+            expect += sh->present[w][c];
+        }
+    }
+    for (unsigned k = 0; k < MT_N_RACE; k++) {
+        mynode_t *f = myht32mt_find(&sh->head, sh->bk, sh->nodes,
+                                   mt_race_node(sh, 0, k)->key);
+        if (f == NULL || f != mt_race_node(sh, (unsigned)f->val, k))
+            FAIL("final: race key %u has no single owner", k);
+    }
+    if (won != MT_N_RACE)
+        FAIL("race: %u winners for %u keys", won, MT_N_RACE);
+    expect += MT_N_RACE;
+
+    unsigned cnt = 0;
+    myht32mt_walk(&sh->head, sh->bk, sh->nodes, mt_walk_cb, &cnt);
+    if (sh->head.rhh_nb != expect || cnt != expect)
+        FAIL("final: rhh_nb=%u walk=%u expected %u",
+             sh->head.rhh_nb, cnt, expect);
+    for (unsigned b = 0; b < MT_NB_BK; b++)
+        if (sh->seq[b] & 1u)
+            FAIL("final: bucket %u left locked", b);
+
+    PASS("mt_concurrent: %u entries, %u race keys single-owner", expect, MT_N_RACE);
+    free(sh->bk); free(sh->seq); free(sh->nodes); free(sh);
+}
+
+/*---------------------------------------------------------------------------
+ * Test: mt_fill - mt_insert up to the first refusal
+ *
+ * The cuckoo path is searched without locks, so any insert, including
+ * the refused one, takes at most RIX_HASH_MT_INSERT_RETRY x
+ * (1 + RIX_HASH_FOLLOW_DEPTH) pair locks.  Each lock/unlock advances both
+ * seq words of the pair by 2.
+ *---------------------------------------------------------------------------*/
+static uint64_t
+mt_seq_sum(const uint32_t *seq, unsigned nb_bk)
+{
+    uint64_t sum = 0;
+    for (unsigned b = 0; b < nb_bk; b++)
+        sum += seq[b];
+    return sum;
+}
+
+static void
+test_mt_fill(void)
+{
+    enum { NB_BK = 64u, N = NB_BK * RIX_HASH_BUCKET_ENTRY_SZ };
+    printf("[test_mt_fill] %u buckets\n", NB_BK);
+
+    struct myht32mt head;
+    struct rix_hash32_bucket_s *bk = (struct rix_hash32_bucket_s *)
+        aligned_alloc(64, NB_BK * sizeof(*bk));
+    uint32_t *seq = (uint32_t *)calloc(NB_BK, sizeof(*seq));
+    mynode_t *nodes = (mynode_t *)calloc(N + 1u, sizeof(*nodes));
+    if (!bk || !seq || !nodes) { perror("alloc"); abort(); }
+
+    RIX_HASH32_INIT(myht32mt, &head, bk, NB_BK);
+    unsigned n;
+    for (n = 0; n <= N; n++) {
+        nodes[n].key = (uint32_t)(n + 1u) * 2654435761u;
+        uint64_t before = mt_seq_sum(seq, NB_BK);
+        mynode_t *r = myht32mt_mt_insert(&head, bk, seq, nodes, &nodes[n]);
+        uint64_t locks = (mt_seq_sum(seq, NB_BK) - before) / 4u;
+        if (locks > (uint64_t)RIX_HASH_MT_INSERT_RETRY *
+                    (1u + RIX_HASH_FOLLOW_DEPTH))
+            FAIL("mt_insert %u took %llu pair locks", n,
+                 (unsigned long long)locks);
+        if (r == &nodes[n])
+            break;
+        if (r != NULL)
+            FAIL("mt_insert %u: unexpected duplicate", n);
+    }
+    if (n < N * 95u / 100u)
+        FAIL("mt_insert refused at %u / %u", n, N);
+    for (unsigned i = 0; i < n; i++)
+        if (myht32mt_mt_find(&head, bk, seq, nodes, nodes[i].key) != &nodes[i])
+            FAIL("mt_fill: key %u lost", i);
+    for (unsigned b = 0; b < NB_BK; b++)
+        if (seq[b] & 1u)
+            FAIL("mt_fill: bucket %u left locked", b);
+    if (head.rhh_nb != n)
+        FAIL("mt_fill: rhh_nb=%u expected %u", head.rhh_nb, n);
+
+    PASS("mt_fill: first refusal at %u / %u (%.1f%%)",
+         n, N, 100.0 * n / N);
+    free(bk); free(seq); free(nodes);
+}
+
 /*---------------------------------------------------------------------------
  * main
  *---------------------------------------------------------------------------*/
@@ -701,6 +1645,8 @@ main(void)
     test_remove_restores_invalid_key();
     test_key_zero();
     test_walk();
+    test_walk_step();
+    test_walk_range();
     test_bulk();
     test_staged_x4();
     test_remove_all();
@@ -709,6 +1655,12 @@ main(void)
     test_kickout_corruption();
     test_fuzz(3237998097u, 512, 64, 200000);
     test_fuzz(3237998097u, 1000, 64, 500000);
+    test_insert_remove_bulk(3237998097u, 4000);
+    test_slot(3237998097u, 400000);
+    test_build_range(3237998097u);
+    test_map(3237998097u, 400000);
+    test_mt_concurrent();
+    test_mt_fill();
 
     printf("ALL RIX_HASH32 TESTS PASSED\n");
     return 0;
@@ -6,6 +6,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+
+/*
+ * RIX_ASSERT hook: the out-of-range remove_at test expects exactly one
+ * assertion to fire and checks that the call is still refused.  Any
+ * other failed assertion aborts as usual.
+ */
+static unsigned assert_expect;
+static unsigned assert_hits;
+
+static void
+test_assert_failed(const char *cond, const char *file, int line)
+{
+    if (assert_expect) {
+        assert_hits++;
+        return;
+    }
+    fprintf(stderr, "%s:%d: assertion `%s' failed\n", file, line, cond);
+    abort();
+}
+
+#define RIX_ASSERT(cond)                                                      \
+    ((cond) ? (void)0 : test_assert_failed(#cond, __FILE__, __LINE__))
 
 #include "rix_hash64.h"
 
@@ -206,6 +230,122 @@ test_walk(void)
         FAILF("walk visited %u expected %u", g_walk_visited, NB_BASIC);
 }
 
+/* ================================================================== */
+/* test_walk_step - resumable walk, every entry exactly once per pass  */
+/* ================================================================== */
+#define WS_NB_BK  256u
+#define WS_N      (WS_NB_BK * RIX_HASH64_BUCKET_ENTRY_SZ / 2u)
+
+static void
+test_walk_step(void)
+{
+    static const unsigned cfg[][2] = {  /* budget, max_out */
+        { 1u, 16u }, { 5u, 16u }, { 5u, 100u }, { WS_NB_BK, WS_N },
+    };
+    printf("[T] walk_step\n");
+
+    struct myht64 head;
+    struct rix_hash64_bucket_s *bk =
+        aligned_alloc(64, WS_NB_BK * sizeof(*bk));
+    mynode_t *nd = calloc(WS_N, sizeof(*nd));
+    unsigned char *seen = calloc(WS_N, 1);
+    uint32_t *idx = calloc(WS_N, sizeof(*idx));
+    if (!bk || !nd || !seen || !idx)
+        FAIL("alloc");
+
+    RIX_HASH64_INIT(myht64, &head, bk, WS_NB_BK);
+    for (unsigned i = 0; i < WS_N; i++) {
+        nd[i].key = (uint64_t)(i + 1u) * 0x9E3779B97F4A7C15ULL;
+        if (RIX_HASH64_INSERT(myht64, &head, bk, nd, &nd[i]) != NULL)
+            FAILF("insert[%u] failed", i);
+    }
+    for (unsigned c = 0; c < sizeof(cfg) / sizeof(cfg[0]); c++) {
+        unsigned cur = 0u;
+        memset(seen, 0, WS_N);
+        do {
+            unsigned n;
+            unsigned next = RIX_HASH64_WALK_STEP(myht64, &head, bk, cur,
+                                                 cfg[c][0], idx, cfg[c][1],
+                                                 &n);
+            if (n > cfg[c][1] ||
+                (next != 0u && (next <= cur || next - cur > cfg[c][0])))
+                FAILF("step at %u: n=%u next=%u", cur, n, next);
+            for (unsigned j = 0; j < n; j++)
+                if (seen[idx[j] - 1u]++)
+                    FAILF("idx %u reported twice", idx[j]);
+            cur = next;
+        } while (cur != 0u);
+        for (unsigned i = 0; i < WS_N; i++)
+            if (!seen[i])
+                FAILF("budget %u max_out %u: node %u missed",
+                      cfg[c][0], cfg[c][1], i);
+    }
+    free(idx);
+    free(seen);
+    free(nd);
+    free(bk);
+}
+
+/* ================================================================== */
+/* test_walk_range - disjoint bucket ranges cover every entry once     */
+/* ================================================================== */
+static int
+walk_range_cb(mynode_t *node, void *arg)
+{
+    unsigned char *seen = (unsigned char *)arg;
+    seen[node->val]++;
+    return 0;
+}
+
+static void
+test_walk_range(void)
+{
+    static const unsigned widths[] = { 1u, 7u, 100u, WS_NB_BK };
+    printf("[T] walk_range\n");
+
+    struct myht64 head;
+    struct rix_hash64_bucket_s *bk =
+        aligned_alloc(64, WS_NB_BK * sizeof(*bk));
+    mynode_t *nd = calloc(WS_N, sizeof(*nd));
+    unsigned char *seen = calloc(WS_N, 1);
+    if (!bk || !nd || !seen)
+        FAIL("alloc");
+
+    RIX_HASH64_INIT(myht64, &head, bk, WS_NB_BK);
+    for (unsigned i = 0; i < WS_N; i++) {
+        nd[i].key = (uint64_t)(i + 1u) * 0x9E3779B97F4A7C15ULL;
+        nd[i].val = i;
+        if (RIX_HASH64_INSERT(myht64, &head, bk, nd, &nd[i]) != NULL)
+            FAILF("insert[%u] failed", i);
+    }
+    for (unsigned w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        memset(seen, 0, WS_N);
+        for (unsigned lo = 0; lo < WS_NB_BK; lo += widths[w]) {
+            /* the last range runs to UINT_MAX: clamped to the table */
+            unsigned hi = (lo + widths[w] >= WS_NB_BK) ?
+                          UINT_MAX : lo + widths[w];
+            if (RIX_HASH64_WALK_RANGE(myht64, &head, bk, nd, lo, hi,
+                                      walk_range_cb, seen) != 0)
+                FAILF("walk_range [%u, %u) returned non-zero", lo, hi);
+        }
+        for (unsigned i = 0; i < WS_N; i++)
+            if (seen[i] != 1u)
+                FAILF("width %u: node %u seen %u times",
+                      widths[w], i, seen[i]);
+    }
+    memset(seen, 0, WS_N);
+    RIX_HASH64_WALK_RANGE(myht64, &head, bk, nd, 9u, 9u,
+                          walk_range_cb, seen);
+    RIX_HASH64_WALK_RANGE(myht64, &head, bk, nd, WS_NB_BK, UINT_MAX,
+                          walk_range_cb, seen);
+    for (unsigned i = 0; i < WS_N; i++)
+        if (seen[i] != 0u)
+            FAILF("empty range visited node %u", i);
+    free(seen);
+    free(nd);
+    free(bk);
+}
+
 /* ================================================================== */
 /* test_remove_miss - remove not-in-table and double remove            */
 /* ================================================================== */
@@ -417,7 +557,10 @@ test_kickout_corruption(void)
     mynode_t *kc_nodes = (mynode_t *)calloc(KC_N, sizeof(mynode_t));
     struct rix_hash64_bucket_s *kc_bk =
         (struct rix_hash64_bucket_s *)aligned_alloc(64, KC_NB_BK * sizeof(*kc_bk));
-    if (!kc_nodes || !kc_bk) { perror("alloc"); abort(); }
+    /* A later key may still fit after an earlier one was refused, so
+     * track membership per node rather than by insertion count. */
+    unsigned char *kc_in = (unsigned char *)calloc(KC_N, 1);
+    if (!kc_nodes || !kc_bk || !kc_in) { perror("alloc"); abort(); }
 
     for (unsigned i = 0; i < KC_N; i++) {
         kc_nodes[i].key = (uint64_t)(i + 1);
@@ -431,9 +574,10 @@ test_kickout_corruption(void)
     unsigned inserted = 0;
     for (unsigned i = 0; i < KC_N; i++) {
         mynode_t *r = RIX_HASH64_INSERT(myht64, &kc_head, kc_bk, kc_nodes, &kc_nodes[i]);
-        if (r == NULL)
+        if (r == NULL) {
+            kc_in[i] = 1;
             inserted++;
-        else if (r == &kc_nodes[i])
+        } else if (r == &kc_nodes[i])
             break;
     }
 
@@ -443,9 +587,11 @@ test_kickout_corruption(void)
     for (unsigned i = inserted; i < KC_N; i++) {
         mynode_t *r = RIX_HASH64_INSERT(myht64, &kc_head, kc_bk, kc_nodes, &kc_nodes[i]);
         if (r == NULL) {
+            kc_in[i] = 1;
             inserted++;
         } else if (r == &kc_nodes[i]) {
-            for (unsigned j = 0; j < inserted; j++) {
+            for (unsigned j = 0; j < KC_N; j++) {
+                if (!kc_in[j]) continue;
                 mynode_t *f = RIX_HASH64_FIND(myht64, &kc_head, kc_bk, kc_nodes, kc_nodes[j].key);
                 if (f != &kc_nodes[j]) {
                     lost++;
@@ -462,7 +608,782 @@ test_kickout_corruption(void)
     if (lost > 0)
         FAILF("kickout_corruption: victim loss detected (%u)", lost);
 
-    free(kc_nodes); free(kc_bk);
+    free(kc_in); free(kc_nodes); free(kc_bk);
+}
+
+/* ================================================================== */
+/* test_mt_concurrent - several writers + one lock-free reader        */
+/*                                                                    */
+/* Stable keys are never removed and must always be visible to the    */
+/* reader.  Each writer churns its own key range (kickouts at ~80%    */
+/* fill) and all writers race to insert the same shared keys with     */
+/* their own nodes: exactly one insert per shared key may win.        */
+/* ================================================================== */
+#define MT_NB_BK      64u
+#define MT_WRITERS     4u
+#define MT_N_STABLE  300u
+#define MT_N_CHURN   150u
+#define MT_N_RACE     64u
+#define MT_OPS     50000u
+
+RIX_HASH64_HEAD(myht64mt);
+RIX_HASH64_GENERATE_MT(myht64mt, mynode_t, key, INVALID_KEY)
+
+/* node layout: [stable][churn x writers][race x writers] */
+#define MT_N_NODES (MT_N_STABLE + MT_WRITERS * (MT_N_CHURN + MT_N_RACE))
+
+struct mt_shared {
+    struct myht64mt             head;
+    struct rix_hash64_bucket_s *bk;
+    uint32_t                    *seq;
+    mynode_t                    *nodes;
+    volatile int                 stop;
+    unsigned char                present[MT_WRITERS][MT_N_CHURN];
+    unsigned                     race_won[MT_WRITERS];
+};
+
+struct mt_arg {
+    struct mt_shared *sh;
+    unsigned          id;
+};
+
+static inline mynode_t *
+mt_churn_node(struct mt_shared *sh, unsigned w, unsigned i)
+{
+    return &sh->nodes[MT_N_STABLE + w * MT_N_CHURN + i];
+}
+
+static inline mynode_t *
+mt_race_node(struct mt_shared *sh, unsigned w, unsigned i)
+{
+    return &sh->nodes[MT_N_STABLE + MT_WRITERS * MT_N_CHURN +
+                      w * MT_N_RACE + i];
+}
+
+static void *
+mt_writer_main(void *p)
+{
+    struct mt_arg *a = (struct mt_arg *)p;
+    struct mt_shared *sh = a->sh;
+    unsigned w = a->id;
+    uint32_t x = 0x9E3779B9u * (w + 1u);
+
+    for (unsigned op = 0; op < MT_OPS; op++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        if (op % 64u == 0u && op / 64u < MT_N_RACE) {
+            unsigned k = (op / 64u + w * 7u) % MT_N_RACE;
+            mynode_t *nd = mt_race_node(sh, w, k);
+            mynode_t *r = myht64mt_mt_insert(&sh->head, sh->bk, sh->seq,
+                                            sh->nodes, nd);
+            if (r == NULL)
+                sh->race_won[w]++;
+            else if (r == nd)
+                FAILF("writer %u: race insert %u refused (table full)", w, k);
+            else if (r->key != nd->key)
+                FAILF("writer %u: race insert %u returned wrong node", w, k);
+            continue;
+        }
+        unsigned c = x % MT_N_CHURN;
+        mynode_t *nd = mt_churn_node(sh, w, c);
+        if (sh->present[w][c]) {
+            if ((x >> 16) & 3u)
+                continue;       /* bias towards high fill */
+            if (myht64mt_mt_remove(&sh->head, sh->bk, sh->seq,
+                                   sh->nodes, nd) != nd)
+                FAILF("writer %u: remove churn %u failed", w, c);
+            sh->present[w][c] = 0;
+        } else {
+            mynode_t *r = myht64mt_mt_insert(&sh->head, sh->bk, sh->seq,
+                                            sh->nodes, nd);
+            if (r == NULL)
+                sh->present[w][c] = 1;
+            else if (r != nd)
+                FAILF("writer %u: churn %u duplicate", w, c);
+        }
+    }
+    return NULL;
+}
+
+static void *
+mt_reader_main(void *p)
+{
+    struct mt_shared *sh = (struct mt_shared *)p;
+    unsigned i = 0;
+
+    while (!sh->stop) {
+        struct rix_hash64_find_ctx_s ctx[4];
+        uint64_t keys[4];
+        mynode_t *res[4];
+
+        for (unsigned j = 0; j < 4; j++)
+            keys[j] = sh->nodes[(i + j * 61u) % MT_N_STABLE].key;
+        myht64mt_mt_hash_key_n(ctx, 4, &sh->head, sh->bk, sh->seq, keys);
+        myht64mt_mt_scan_bk_n(ctx, 4, &sh->head, sh->bk, sh->seq);
+        myht64mt_prefetch_node_n(ctx, 4, sh->nodes);
+        myht64mt_mt_cmp_key_n(ctx, 4, &sh->head, sh->bk, sh->seq,
+                             sh->nodes, res);
+        for (unsigned j = 0; j < 4; j++) {
+            unsigned k = (i + j * 61u) % MT_N_STABLE;
+            if (res[j] != &sh->nodes[k])
+                FAILF("reader: stable key %u lost", k);
+        }
+        if (myht64mt_mt_find(&sh->head, sh->bk, sh->seq, sh->nodes,
+                             sh->nodes[i].key) != &sh->nodes[i])
+            FAILF("reader: mt_find stable key %u lost", i);
+        i = (i + 1u) % MT_N_STABLE;
+    }
+    return NULL;
+}
+
+static int
+mt_walk_cb(mynode_t *node, void *arg)
+{
+    (void)node;
+    (*(unsigned *)arg)++;
+    return 0;
+}
+
+static void
+test_mt_concurrent(void)
+{
+    printf("[T] mt_concurrent (%u writers + 1 reader)\n", MT_WRITERS);
+
+    struct mt_shared *sh = (struct mt_shared *)calloc(1, sizeof(*sh));
+    pthread_t wth[MT_WRITERS], rth;
+    struct mt_arg args[MT_WRITERS];
+
+    if (!sh) { perror("calloc"); abort(); }
+    sh->nodes = (mynode_t *)calloc(MT_N_NODES, sizeof(mynode_t));
+    sh->seq   = (uint32_t *)calloc(MT_NB_BK, sizeof(uint32_t));
+    sh->bk    = (struct rix_hash64_bucket_s *)
+        aligned_alloc(64, MT_NB_BK * sizeof(*sh->bk));
+    if (!sh->nodes || !sh->seq || !sh->bk) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < MT_N_STABLE + MT_WRITERS * MT_N_CHURN; i++)
+        sh->nodes[i].key = (uint64_t)(i + 1u) * 2654435761u;
+    for (unsigned w = 0; w < MT_WRITERS; w++)
+        for (unsigned k = 0; k < MT_N_RACE; k++) {
+            mt_race_node(sh, w, k)->key = (uint64_t)(0x40000000u + k);
+            mt_race_node(sh, w, k)->val = w;
+        }
+
+    RIX_HASH64_INIT(myht64mt, &sh->head, sh->bk, MT_NB_BK);
+    for (unsigned i = 0; i < MT_N_STABLE; i++)
+        if (RIX_HASH64_MT_INSERT(myht64mt, &sh->head, sh->bk, sh->seq,
+                                sh->nodes, &sh->nodes[i]) != NULL)
+            FAILF("stable insert %u failed", i);
+
+    if (pthread_create(&rth, NULL, mt_reader_main, sh) != 0) {
+        perror("pthread_create"); abort();
+    }
+    for (unsigned w = 0; w < MT_WRITERS; w++) {
+        args[w].sh = sh;
+        args[w].id = w;
+        if (pthread_create(&wth[w], NULL, mt_writer_main, &args[w]) != 0) {
+            perror("pthread_create"); abort();
+        }
+    }
+    for (unsigned w = 0; w < MT_WRITERS; w++)
+        pthread_join(wth[w], NULL);
+    sh->stop = 1;
+    pthread_join(rth, NULL);
+
+    /* Verify against the per-writer models */
+    unsigned expect = MT_N_STABLE, won = 0;
+    for (unsigned i = 0; i < MT_N_STABLE; i++)
+        if (RIX_HASH64_MT_FIND(myht64mt, &sh->head, sh->bk, sh->seq,
+                              sh->nodes, sh->nodes[i].key) != &sh->nodes[i])
+            FAILF("final: stable %u missing", i);
+    for (unsigned w = 0; w < MT_WRITERS; w++) {
+        won += sh->race_won[w];
+        for (unsigned c = 0; c < MT_N_CHURN; c++) {
+            mynode_t *nd = mt_churn_node(sh, w, c);
+            mynode_t *f = myht64mt_find(&sh->head, sh->bk, sh->nodes, nd->key);
+            if (f != (sh->present[w][c] ? nd : NULL))
+                FAILF("final: churn w=%u c=%u mismatch", w, c);
+            expect += sh->present[w][c];
+        }
+    }
+    for (unsigned k = 0; k < MT_N_RACE; k++) {
+        mynode_t *f = myht64mt_find(&sh->head, sh->bk, sh->nodes,
+                                   mt_race_node(sh, 0, k)->key);
+        if (f == NULL || f != mt_race_node(sh, (unsigned)f->val, k))
+            FAILF("final: race key %u has no single owner", k);
+    }
+    if (won != MT_N_RACE)
+        FAILF("race: %u winners for %u keys", won, MT_N_RACE);
+    expect += MT_N_RACE;
+
+    unsigned cnt = 0;
+    myht64mt_walk(&sh->head, sh->bk, sh->nodes, mt_walk_cb, &cnt);
+    if (sh->head.rhh_nb != expect || cnt != expect)
+        FAILF("final: rhh_nb=%u walk=%u expected %u",
+             sh->head.rhh_nb, cnt, expect);
+    for (unsigned b = 0; b < MT_NB_BK; b++)
+        if (sh->seq[b] & 1u)
+            FAILF("final: bucket %u left locked", b);
+
+    printf("  mt_concurrent: %u entries, %u race keys single-owner\n",
+           expect, MT_N_RACE);
+    free(sh->bk); free(sh->seq); free(sh->nodes); free(sh);
+}
+
+/* ================================================================== */
+/* test_insert_remove_bulk - bulk forms match sequential calls         */
+/* ================================================================== */
+#define IRB_N       1000u
+#define IRB_NB_BK     64u  /* 64 x 16 = 1024 slots: the table fills up */
+#define IRB_MAX       96u
+
+/*
+ * The node array is shared; table A is driven by the bulk forms, table B
+ * by one call per element.  Results, counts and buckets must match.
+ */
+static void
+test_insert_remove_bulk(unsigned seed, unsigned rounds)
+{
+    printf("[T] insert_remove_bulk seed=%u rounds=%u\n", seed, rounds);
+
+    size_t bk_sz = IRB_NB_BK * sizeof(struct rix_hash64_bucket_s);
+    mynode_t                   *nodes = calloc(IRB_N, sizeof(*nodes));
+    struct rix_hash64_bucket_s *ba    = aligned_alloc(64, bk_sz);
+    struct rix_hash64_bucket_s *bb    = aligned_alloc(64, bk_sz);
+    if (!nodes || !ba || !bb) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < IRB_N; i++) {
+        nodes[i].key = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        nodes[i].val = i;
+    }
+
+    struct myht64 ha, hb;
+    RIX_HASH64_INIT(myht64, &ha, ba, IRB_NB_BK);
+    RIX_HASH64_INIT(myht64, &hb, bb, IRB_NB_BK);
+
+    /* Simple LCG */
+    uint64_t rng = seed;
+#define IRB_RND() \
+    (rng = rng * 6364136223846793005ULL + 1442695040888963407ULL, \
+     (unsigned)(rng >> 33))
+
+    for (unsigned r = 0; r < rounds; r++) {
+        mynode_t *elms[IRB_MAX], *res[IRB_MAX];
+        unsigned n = 1u + IRB_RND() % IRB_MAX;
+        int ins = (IRB_RND() % 100u) < 60u;
+        unsigned exp = 0;
+
+        /* narrow range on odd rounds: many in-batch duplicates */
+        for (unsigned j = 0; j < n; j++)
+            elms[j] = &nodes[IRB_RND() % ((r & 1u) ? 32u : IRB_N)];
+
+        if (ins) {
+            unsigned got = myht64_insert_bulk(&ha, ba, nodes, elms, n, res);
+            for (unsigned j = 0; j < n; j++) {
+                mynode_t *rb = myht64_insert(&hb, bb, nodes, elms[j]);
+                if (res[j] != rb)
+                    FAILF("round %u insert[%u]: bulk=%p seq=%p",
+                          r, j, (void *)res[j], (void *)rb);
+                exp += (rb == NULL);
+            }
+            if (got != exp)
+                FAILF("round %u insert_bulk returned %u, expected %u",
+                      r, got, exp);
+        } else {
+            unsigned got = myht64_remove_bulk(&ha, ba, nodes, elms, n);
+            for (unsigned j = 0; j < n; j++)
+                exp += (myht64_remove(&hb, bb, nodes, elms[j]) != NULL);
+            if (got != exp)
+                FAILF("round %u remove_bulk returned %u, expected %u",
+                      r, got, exp);
+        }
+        if (ha.rhh_nb != hb.rhh_nb || memcmp(ba, bb, bk_sz) != 0)
+            FAILF("round %u: bulk and sequential tables diverged", r);
+    }
+#undef IRB_RND
+
+    printf("  insert_remove_bulk: final rhh_nb=%u\n", ha.rhh_nb);
+    free(nodes); free(ba); free(bb);
+}
+
+/* ================================================================== */
+/* test_slot - recorded (bucket, slot), O(1) remove                    */
+/* ================================================================== */
+/*
+ * The slot table and a plain table over the same nodes get the same ops;
+ * their buckets must stay identical, and every node in the slot table
+ * must point at its own bucket slot.
+ */
+typedef struct slotnode_s {
+    uint64_t key;
+    uint32_t bk;
+    uint16_t slot;
+    uint16_t val;
+} slotnode_t;
+
+RIX_HASH64_HEAD(myht64s);
+RIX_HASH64_GENERATE_SLOT(myht64s, slotnode_t, key, bk, slot, INVALID_KEY)
+RIX_HASH64_HEAD(myht64p);
+RIX_HASH64_GENERATE(myht64p, slotnode_t, key, INVALID_KEY)
+
+#define SL_N       1000u
+#define SL_NB_BK     64u   /* 1024 slots: runs close to full */
+
+static void
+slot_check(const struct myht64s *hs, const struct rix_hash64_bucket_s *bs,
+           const struct myht64p *hp, const struct rix_hash64_bucket_s *bp,
+           const slotnode_t *nd, const unsigned char *in, const char *what)
+{
+    unsigned cnt = 0;
+
+    if (memcmp(bs, bp, SL_NB_BK * sizeof(*bs)) != 0)
+        FAILF("slot %s: buckets differ from the plain table", what);
+    for (unsigned i = 0; i < SL_N; i++) {
+        if (!in[i])
+            continue;
+        if (nd[i].bk >= SL_NB_BK || nd[i].slot >= RIX_HASH_BUCKET_ENTRY_SZ ||
+            bs[nd[i].bk].idx[nd[i].slot] != i + 1u)
+            FAILF("slot %s: node %u records bk=%u slot=%u",
+                  what, i, nd[i].bk, nd[i].slot);
+        cnt++;
+    }
+    if (hs->rhh_nb != cnt || hp->rhh_nb != cnt)
+        FAILF("slot %s: rhh_nb=%u/%u model=%u", what, hs->rhh_nb, hp->rhh_nb,
+              cnt);
+}
+
+static void
+test_slot(unsigned seed, unsigned ops)
+{
+    printf("[T] slot seed=%u ops=%u\n", seed, ops);
+    uint64_t rng = seed;
+#define SL_RND() \
+    (rng = rng * 6364136223846793005ULL + 1442695040888963407ULL, \
+     (unsigned)(rng >> 33))
+
+    size_t bk_sz = SL_NB_BK * sizeof(struct rix_hash64_bucket_s);
+    slotnode_t *nd = (slotnode_t *)calloc(SL_N, sizeof(*nd));
+    unsigned char *in = (unsigned char *)calloc(SL_N, 1);
+    struct rix_hash64_bucket_s *bs =
+        (struct rix_hash64_bucket_s *)aligned_alloc(64, bk_sz);
+    struct rix_hash64_bucket_s *bp =
+        (struct rix_hash64_bucket_s *)aligned_alloc(64, bk_sz);
+    if (!nd || !in || !bs || !bp) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < SL_N; i++)
+        nd[i].key = (uint64_t)(i + 1u) * 0x9E3779B97F4A7C15ULL;
+
+    struct myht64s hs;
+    struct myht64p hp;
+    myht64s_init(&hs, bs, SL_NB_BK);
+    myht64p_init(&hp, bp, SL_NB_BK);
+
+    for (unsigned step = 0; step < ops; step++) {
+        unsigned i = SL_RND() % SL_N;
+        unsigned op = SL_RND() % 100u;
+
+        if (op < 60u) {
+            slotnode_t *rs = myht64s_insert(&hs, bs, nd, &nd[i]);
+            slotnode_t *rp = myht64p_insert(&hp, bp, nd, &nd[i]);
+            if (rs != rp)
+                FAILF("slot insert[%u]: slot=%p plain=%p",
+                      i, (void *)rs, (void *)rp);
+            if (rs == NULL)
+                in[i] = 1;
+        } else if (op < 95u) {
+            slotnode_t *rs = myht64s_remove(&hs, bs, nd, &nd[i]);
+            slotnode_t *rp = myht64p_remove(&hp, bp, nd, &nd[i]);
+            if (rs != rp || rs != (in[i] ? &nd[i] : NULL))
+                FAILF("slot remove[%u]: in=%u slot=%p plain=%p",
+                      i, in[i], (void *)rs, (void *)rp);
+            in[i] = 0;
+        } else {
+            slotnode_t *f = myht64s_find(&hs, bs, nd, nd[i].key);
+            if (f != (in[i] ? &nd[i] : NULL))
+                FAILF("slot find[%u]: in=%u got %p", i, in[i], (void *)f);
+        }
+        if ((step & 0xFFFu) == 0u)
+            slot_check(&hs, bs, &hp, bp, nd, in, "fuzz");
+    }
+    slot_check(&hs, bs, &hp, bp, nd, in, "fuzz");
+
+    /* bulk forms against each other */
+    {
+        slotnode_t *elms[SL_N];
+        unsigned n = 0, exp = 0;
+        for (unsigned i = 0; i < SL_N; i += 3u) {
+            elms[n++] = &nd[i];
+            exp += in[i];
+        }
+        if (myht64s_remove_bulk(&hs, bs, nd, elms, n) != exp ||
+            myht64p_remove_bulk(&hp, bp, nd, elms, n) != exp)
+            FAILF("slot remove_bulk count != %u", exp);
+        for (unsigned j = 0; j < n; j++)
+            in[elms[j] - nd] = 0;
+        slot_check(&hs, bs, &hp, bp, nd, in, "remove_bulk");
+
+        exp = myht64s_insert_bulk(&hs, bs, nd, elms, n, NULL);
+        if (myht64p_insert_bulk(&hp, bp, nd, elms, n, NULL) != exp)
+            FAIL("slot insert_bulk counts differ");
+        for (unsigned j = 0; j < n; j++)
+            if (myht64s_find(&hs, bs, nd, elms[j]->key) == elms[j])
+                in[elms[j] - nd] = 1;
+        slot_check(&hs, bs, &hp, bp, nd, in, "insert_bulk");
+    }
+
+    /* an out-of-range slot trips the assertion and is still refused */
+    {
+        unsigned nb = hs.rhh_nb;
+
+        assert_expect = 1u;
+        assert_hits = 0u;
+        if (myht64s_remove_at(&hs, bs, 0u, RIX_HASH_BUCKET_ENTRY_SZ)
+            != (unsigned)RIX_NIL)
+            FAIL("slot remove_at out-of-range slot");
+        assert_expect = 0u;
+        if (assert_hits != 1u || hs.rhh_nb != nb)
+            FAILF("slot remove_at out-of-range: hits=%u nb=%u",
+                  assert_hits, hs.rhh_nb);
+    }
+
+    /* remove_at by recorded position; stale positions are refused */
+    for (unsigned i = 0; i < SL_N; i++) {
+        if (!in[i])
+            continue;
+        unsigned b = nd[i].bk, s = nd[i].slot;
+        if (myht64s_remove_at(&hs, bs, b, s) != i + 1u)
+            FAILF("slot remove_at[%u]", i);
+        if (myht64s_remove_at(&hs, bs, b, s) != (unsigned)RIX_NIL)
+            FAILF("slot remove_at[%u] twice", i);
+        if (myht64s_remove(&hs, bs, nd, &nd[i]) != NULL)
+            FAILF("slot remove[%u] after remove_at", i);
+        in[i] = 0;
+    }
+    if (hs.rhh_nb != 0u)
+        FAILF("slot: rhh_nb=%u after removing all", hs.rhh_nb);
+
+#undef SL_RND
+
+    printf("  slot: %u ops, buckets match the plain table\n", ops);
+    free(nd); free(in); free(bs); free(bp);
+}
+
+/* ================================================================== */
+/* test_build_range - build_range per thread, then build_finish        */
+/* ================================================================== */
+#define BLD_NB_BK    256u
+#define BLD_N        (BLD_NB_BK * RIX_HASH64_BUCKET_ENTRY_SZ * 9u / 10u)
+#define BLD_D        100u   /* repeated keys */
+#define BLD_THREADS    4u
+
+struct bld_arg {
+    struct myht64              *head;
+    struct rix_hash64_bucket_s *bk;
+    mynode_t                   *nd;
+    mynode_t * const           *elms;
+    unsigned                    lo, hi;
+    mynode_t                  **spill;
+    unsigned                    nb_spill;
+    unsigned                    placed;
+};
+
+static void *
+bld_main(void *p)
+{
+    struct bld_arg *a = (struct bld_arg *)p;
+    a->placed = myht64_build_range(a->head, a->bk, a->nd, a->elms,
+                                   BLD_N + BLD_D, a->lo, a->hi,
+                                   a->spill, &a->nb_spill);
+    return NULL;
+}
+
+static void
+test_build_range(unsigned seed)
+{
+    printf("[T] build_range seed=%u threads=%u\n", seed, BLD_THREADS);
+    uint64_t rng = seed;
+#define BLD_RND() \
+    (rng = rng * 6364136223846793005ULL + 1442695040888963407ULL, \
+     (unsigned)(rng >> 33))
+
+    const unsigned T = BLD_N + BLD_D;
+    size_t bk_sz = BLD_NB_BK * sizeof(struct rix_hash64_bucket_s);
+    mynode_t *nd = calloc(T, sizeof(*nd));
+    mynode_t **elms = calloc(T, sizeof(*elms));
+    mynode_t **spill = calloc((size_t)T * BLD_THREADS, sizeof(*spill));
+    mynode_t **res = calloc(T, sizeof(*res));
+    slotnode_t *sn = calloc(T, sizeof(*sn));
+    slotnode_t **selms = calloc(T, sizeof(*selms));
+    slotnode_t **sspill = calloc(T, sizeof(*sspill));
+    struct rix_hash64_bucket_s *bk = aligned_alloc(64, bk_sz);
+    if (!nd || !elms || !spill || !res || !sn || !selms || !sspill || !bk)
+        FAIL("alloc");
+    /* the last BLD_D elements repeat earlier keys; val = original index */
+    for (unsigned i = 0; i < T; i++) {
+        unsigned src = (i < BLD_N) ? i : BLD_RND() % BLD_N;
+        nd[i].key = (uint64_t)(src + 1u) * 0x9E3779B97F4A7C15ULL;
+        nd[i].val = src;
+        sn[i].key = nd[i].key;
+        elms[i]  = &nd[i];
+        selms[i] = &sn[i];
+    }
+#undef BLD_RND
+
+    struct myht64 h;
+    struct bld_arg args[BLD_THREADS];
+    pthread_t th[BLD_THREADS];
+    unsigned placed = 0, nsp = 0, ok;
+    myht64_init(&h, bk, BLD_NB_BK);
+    for (unsigned t = 0; t < BLD_THREADS; t++) {
+        args[t] = (struct bld_arg){
+            &h, bk, nd, elms, t * (BLD_NB_BK / BLD_THREADS),
+            (t + 1u) * (BLD_NB_BK / BLD_THREADS),
+            spill + (size_t)t * T, 0u, 0u };
+        if (pthread_create(&th[t], NULL, bld_main, &args[t]) != 0)
+            FAIL("pthread_create");
+    }
+    for (unsigned t = 0; t < BLD_THREADS; t++) {
+        pthread_join(th[t], NULL);
+        placed += args[t].placed;
+        memmove(spill + nsp, args[t].spill,
+                args[t].nb_spill * sizeof(*spill));
+        nsp += args[t].nb_spill;
+    }
+    if (h.rhh_nb != 0u)
+        FAILF("rhh_nb=%u before build_finish", h.rhh_nb);
+    ok = myht64_build_finish(&h, bk, nd, placed, spill, nsp, res);
+    if (placed + ok != BLD_N || h.rhh_nb != BLD_N)
+        FAILF("placed=%u finish=%u rhh_nb=%u", placed, ok, h.rhh_nb);
+    for (unsigned j = 0; j < nsp; j++) {
+        unsigned i = (unsigned)(spill[j] - nd);
+        if (res[j] != (i < BLD_N ? NULL : &nd[nd[i].val]))
+            FAILF("spill %u (node %u): result %p", j, i, (void *)res[j]);
+    }
+    for (unsigned i = 0; i < BLD_N; i++)
+        if (myht64_find(&h, bk, nd, nd[i].key) != &nd[i])
+            FAILF("find[%u] after build", i);
+    printf("  build: %u placed by %u threads, %u spilled (%u repeats)\n",
+           placed, BLD_THREADS, nsp, BLD_D);
+
+    /* slot form: recorded positions must match the buckets */
+    struct myht64s hs;
+    myht64s_init(&hs, bk, BLD_NB_BK);
+    placed = nsp = 0;
+    for (unsigned lo = 0; lo < BLD_NB_BK; lo += 32u) {
+        unsigned n;
+        placed += myht64s_build_range(&hs, bk, sn, selms, T, lo, lo + 32u,
+                                      sspill + nsp, &n);
+        nsp += n;
+    }
+    if (placed + myht64s_build_finish(&hs, bk, sn, placed, sspill, nsp,
+                                      NULL) != BLD_N || hs.rhh_nb != BLD_N)
+        FAILF("slot build: placed=%u rhh_nb=%u", placed, hs.rhh_nb);
+    for (unsigned i = 0; i < BLD_N; i++)
+        if (bk[sn[i].bk].idx[sn[i].slot] != i + 1u)
+            FAILF("slot build: node %u records bk=%u slot=%u",
+                  i, sn[i].bk, sn[i].slot);
+    for (unsigned i = 0; i < BLD_N; i++)
+        if (myht64s_remove(&hs, bk, sn, &sn[i]) != &sn[i])
+            FAILF("slot build: remove[%u]", i);
+
+    free(nd); free(elms); free(spill); free(res);
+    free(sn); free(selms); free(sspill); free(bk);
+}
+
+/* ================================================================== */
+/* test_map - inline-value map: fuzz vs model, bulk find, full table  */
+/* ================================================================== */
+RIX_HASH64_HEAD(mymap64);
+RIX_HASH64_GENERATE_MAP(mymap64, INVALID_KEY)
+
+#define MAP_N       1100u  /* more keys than the 1024 slots */
+#define MAP_NB_BK     64u
+
+static int
+map_walk_cb(uint64_t key, uint64_t *val, void *arg)
+{
+    uint64_t *acc = (uint64_t *)arg;
+    acc[0]++;
+    acc[1] += key ^ *val;
+    return 0;
+}
+
+static void
+test_map(unsigned seed, unsigned ops)
+{
+    printf("[T] map seed=%u ops=%u\n", seed, ops);
+    uint64_t rng = seed;
+#define MAP_RND() \
+    (rng = rng * 6364136223846793005ULL + 1442695040888963407ULL, \
+     (unsigned)(rng >> 33))
+
+    size_t bk_sz = MAP_NB_BK * sizeof(struct rix_hash64_map_bucket_s);
+    struct rix_hash64_map_bucket_s *bk =
+        (struct rix_hash64_map_bucket_s *)aligned_alloc(64, bk_sz);
+    struct rix_hash64_map_bucket_s *snap =
+        (struct rix_hash64_map_bucket_s *)aligned_alloc(64, bk_sz);
+    uint64_t *keys = (uint64_t *)calloc(MAP_N, sizeof(*keys));
+    uint64_t *model = (uint64_t *)calloc(MAP_N, sizeof(*model));
+    unsigned char *in = (unsigned char *)calloc(MAP_N, 1);
+    if (!bk || !snap || !keys || !model || !in) { perror("alloc"); abort(); }
+
+    for (unsigned i = 0; i < MAP_N; i++)
+        keys[i] = (uint64_t)(i + 1u) * 0x9E3779B97F4A7C15ULL;
+
+    struct mymap64 head;
+    mymap64_init(&head, bk, MAP_NB_BK);
+    unsigned cnt = 0;
+
+    for (unsigned step = 0; step < ops; step++) {
+        unsigned i = MAP_RND() % MAP_N;
+        unsigned op = MAP_RND() % 100u;
+        uint64_t v = (MAP_RND() & 1u) ? 0u :
+                     (uint64_t)MAP_RND() * 0x9E3779B97F4A7C15ULL;
+
+        if (op < 50u) {
+            int rc;
+            memcpy(snap, bk, bk_sz);
+            rc = mymap64_insert(&head, bk, keys[i], v);
+            if (in[i] ? rc != 1 : rc == 1)
+                FAILF("map insert[%u]: in=%u rc=%d", i, in[i], rc);
+            if (rc == 0) {
+                in[i] = 1;
+                model[i] = v;
+                cnt++;
+            } else if (memcmp(snap, bk, bk_sz) != 0) {
+                FAILF("map insert[%u] rc=%d modified the table", i, rc);
+            }
+        } else if (op < 75u) {
+            int rc = mymap64_remove(&head, bk, keys[i]);
+            if (rc != (in[i] ? 0 : -1))
+                FAILF("map remove[%u]: in=%u rc=%d", i, in[i], rc);
+            if (in[i]) {
+                in[i] = 0;
+                cnt--;
+            }
+        } else if (op < 90u) {
+            uint64_t *p = mymap64_find(&head, bk, keys[i]);
+            if ((p != NULL) != in[i] || (p && *p != model[i]))
+                FAILF("map find[%u]: in=%u", i, in[i]);
+            if (p) {
+                *p = v;         /* update in place */
+                model[i] = v;
+            }
+        } else {
+            uint64_t k[37], out[37];
+            unsigned exp = 0;
+            for (unsigned j = 0; j < 37u; j++) {
+                unsigned x = (i + j * 29u) % MAP_N;
+                k[j] = keys[x];
+                exp += in[x];
+            }
+            if (mymap64_find_bulk(&head, bk, k, 37u, out, INVALID_KEY) != exp)
+                FAILF("map find_bulk hits != %u", exp);
+            for (unsigned j = 0; j < 37u; j++) {
+                unsigned x = (i + j * 29u) % MAP_N;
+                if (out[j] != (in[x] ? model[x] : INVALID_KEY))
+                    FAILF("map find_bulk[%u] value", j);
+            }
+        }
+        if (head.rhh_nb != cnt)
+            FAILF("map step %u: rhh_nb=%u model=%u", step, head.rhh_nb, cnt);
+    }
+
+    /* invalid_key marks empty slots: looking it up always misses */
+    {
+        struct rix_hash64_map_find_ctx_s ctx;
+        uint64_t k[3] = { keys[0], INVALID_KEY, keys[1] }, out[3];
+        unsigned exp = in[0] + in[1];
+
+        if (mymap64_find(&head, bk, INVALID_KEY) != NULL)
+            FAIL("map find(invalid_key) hit");
+        mymap64_hash_key(&ctx, &head, bk, INVALID_KEY);
+        mymap64_scan_bk(&ctx, &head, bk);
+        if (mymap64_get(&ctx) != NULL)
+            FAIL("map get(invalid_key) hit");
+        if (mymap64_find_bulk(&head, bk, k, 3u, out, 7u) != exp ||
+            out[1] != 7u)
+            FAIL("map find_bulk(invalid_key) hit");
+        if (mymap64_remove(&head, bk, INVALID_KEY) != -1 ||
+            head.rhh_nb != cnt)
+            FAIL("map remove(invalid_key) freed a slot");
+    }
+
+    /* staged x4 */
+    for (unsigned i = 0; i + 4u <= MAP_N; i += 4u) {
+        struct rix_hash64_map_find_ctx_s ctx[4];
+        uint64_t *res[4];
+        mymap64_hash_key_n(ctx, 4, &head, bk, &keys[i]);
+        mymap64_scan_bk_n(ctx, 4, &head, bk);
+        mymap64_get_n(ctx, 4, res);
+        for (unsigned j = 0; j < 4u; j++)
+            if ((res[j] != NULL) != in[i + j] ||
+                (res[j] && *res[j] != model[i + j]))
+                FAILF("map staged[%u]", i + j);
+    }
+
+    uint64_t acc[2] = { 0, 0 }, sum = 0;
+    for (unsigned i = 0; i < MAP_N; i++)
+        if (in[i])
+            sum += keys[i] ^ model[i];
+    mymap64_walk(&head, bk, map_walk_cb, acc);
+    if (acc[0] != cnt || acc[1] != sum)
+        FAILF("map walk: %u entries, expected %u", (unsigned)acc[0], cnt);
+
+    /* walk_step in small steps sees the same entries */
+    {
+        uint64_t wk[16], wv[16];
+        unsigned cur = 0u, n;
+        uint64_t wcnt = 0, wsum = 0;
+        do {
+            cur = mymap64_walk_step(&head, bk, cur, 3u, wk, wv, 16u, &n);
+            for (unsigned j = 0; j < n; j++) {
+                wcnt++;
+                wsum += wk[j] ^ wv[j];
+            }
+        } while (cur != 0u);
+        if (wcnt != cnt || wsum != sum)
+            FAILF("map walk_step: %u entries, expected %u",
+                  (unsigned)wcnt, cnt);
+    }
+
+    /* walk_range over two halves sees the same entries */
+    {
+        uint64_t racc[2] = { 0, 0 };
+        mymap64_walk_range(&head, bk, 0u, MAP_NB_BK / 2u, map_walk_cb, racc);
+        mymap64_walk_range(&head, bk, MAP_NB_BK / 2u, UINT_MAX,
+                           map_walk_cb, racc);
+        if (racc[0] != cnt || racc[1] != sum)
+            FAILF("map walk_range: %u entries, expected %u",
+                  (unsigned)racc[0], cnt);
+    }
+
+    /* fill until refused: the refusal leaves the table untouched */
+    unsigned refused = 0;
+    for (unsigned i = 0; i < MAP_N; i++) {
+        if (in[i])
+            continue;
+        memcpy(snap, bk, bk_sz);
+        int rc = mymap64_insert(&head, bk, keys[i], (uint64_t)i);
+        if (rc == 0) {
+            in[i] = 1;
+            model[i] = (uint64_t)i;
+            cnt++;
+        } else if (rc != -1 || memcmp(snap, bk, bk_sz) != 0) {
+            FAILF("map fill[%u]: rc=%d", i, rc);
+        } else {
+            refused++;
+        }
+    }
+    for (unsigned i = 0; i < MAP_N; i++) {
+        uint64_t *p = mymap64_find(&head, bk, keys[i]);
+        if ((p != NULL) != in[i] || (p && *p != model[i]))
+            FAILF("map full find[%u]", i);
+    }
+
+#undef MAP_RND
+
+    printf("  map: %u ops, full at %u / %u slots (%u refused)\n", ops, cnt,
+           MAP_NB_BK * RIX_HASH_BUCKET_ENTRY_SZ, refused);
+    free(bk); free(snap); free(keys); free(model); free(in);
 }
 
 /* ================================================================== */
@@ -478,12 +1399,19 @@ main(void)
     test_duplicate_insert();
     test_staged_find();
     test_walk();
+    test_walk_step();
+    test_walk_range();
     test_remove_miss();
     test_max_fill();
     test_high_fill();
     test_kickout_corruption();
     test_fuzz(3237998097u, 512, 64, 200000);
     test_fuzz(3237998097u, 1000, 64, 500000);
+    test_insert_remove_bulk(3237998097u, 4000);
+    test_slot(3237998097u, 400000);
+    test_build_range(3237998097u);
+    test_map(3237998097u, 400000);
+    test_mt_concurrent();
 
     printf("ALL RIX_HASH64 TESTS PASSED\n");
     return 0;